@@ -9,6 +9,10 @@ source_files=(
     "src/doc.c" 
     "src/parser.c" 
     "src/symboltable.c"
+    "src/dictionary.c"
+    "src/sequence.c"
+    "src/output.c"
+    "src/memo.c"
     "src/opcodes.c"
     "src/vm.c"
     "src/interpreter.c" 
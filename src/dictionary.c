@@ -0,0 +1,259 @@
+#ifndef HEX_H
+#include "hex.h"
+#endif
+
+// Dictionaries map strings and integers to items. Entries are appended in
+// insertion order, so that keys are always listed in the same order, and each
+// used slot of an open addressing table (with linear probing) points to one of
+// them. Deleted entries keep their slot until the table is rebuilt.
+// Dictionaries are reference counted: copying a dictionary item only adds a
+// reference, and natives that modify a dictionary unshare it first.
+
+static size_t hex_dict_hash(const hex_item_t *key)
+{
+    // FNV-1a over the bytes of the string, or of the integer
+    uint8_t integer[4];
+    const uint8_t *bytes;
+    size_t size;
+    if (key->type == HEX_TYPE_INTEGER)
+    {
+        uint32_t value = (uint32_t)key->data.int_value;
+        integer[0] = value & 0xff;
+        integer[1] = (value >> 8) & 0xff;
+        integer[2] = (value >> 16) & 0xff;
+        integer[3] = (value >> 24) & 0xff;
+        bytes = integer;
+        size = 4;
+    }
+    else
+    {
+        bytes = (const uint8_t *)key->data.str_value;
+        size = key->str_size;
+    }
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int hex_dict_same_key(const hex_item_t *a, const hex_item_t *b)
+{
+    if (a->type != b->type)
+    {
+        return 0;
+    }
+    if (a->type == HEX_TYPE_INTEGER)
+    {
+        return a->data.int_value == b->data.int_value;
+    }
+    return a->str_size == b->str_size && memcmp(a->data.str_value, b->data.str_value, a->str_size) == 0;
+}
+
+// Find the slot of a key, or the empty slot where it can be inserted
+static size_t hex_dict_find_slot(const hex_dict_t *dict, const hex_item_t *key, size_t hash)
+{
+    size_t mask = dict->slot_count - 1;
+    size_t i = hash & mask;
+    while (dict->slots[i] != 0)
+    {
+        const hex_dict_entry_t *entry = &dict->entries[dict->slots[i] - 1];
+        if (entry->key && entry->hash == hash && hex_dict_same_key(entry->key, key))
+        {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+// Drop deleted entries and rebuild the table, so that it is at most half full
+static int hex_dict_rebuild(hex_dict_t *dict)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < dict->count; i++)
+    {
+        if (dict->entries[i].key)
+        {
+            size++;
+        }
+    }
+    size_t slot_count = HEX_DICT_INITIAL_SLOTS;
+    while ((size + 1) * 2 > slot_count)
+    {
+        slot_count *= 2;
+    }
+    size_t *slots = (size_t *)calloc(slot_count, sizeof(size_t));
+    if (!slots)
+    {
+        return 1;
+    }
+    free(dict->slots);
+    dict->slots = slots;
+    dict->slot_count = slot_count;
+    size_t count = 0;
+    for (size_t i = 0; i < dict->count; i++)
+    {
+        if (dict->entries[i].key)
+        {
+            dict->entries[count] = dict->entries[i];
+            dict->slots[hex_dict_find_slot(dict, dict->entries[count].key, dict->entries[count].hash)] = count + 1;
+            count++;
+        }
+    }
+    dict->count = count;
+    return 0;
+}
+
+hex_dict_t *hex_dict_create(void)
+{
+    hex_dict_t *dict = (hex_dict_t *)calloc(1, sizeof(hex_dict_t));
+    if (dict)
+    {
+        dict->refs = 1;
+    }
+    return dict;
+}
+
+// Release a reference to a dictionary, freeing it and its items with the last one
+void hex_dict_release(hex_context_t *ctx, hex_dict_t *dict)
+{
+    if (!dict || --dict->refs > 0)
+    {
+        return;
+    }
+    for (size_t i = 0; i < dict->count; i++)
+    {
+        if (dict->entries[i].key)
+        {
+            HEX_FREE(ctx, dict->entries[i].key);
+            HEX_FREE(ctx, dict->entries[i].value);
+        }
+    }
+    free(dict->entries);
+    free(dict->slots);
+    free(dict);
+}
+
+// Copy a dictionary and its items
+hex_dict_t *hex_dict_copy(hex_context_t *ctx, const hex_dict_t *dict)
+{
+    hex_dict_t *copy = hex_dict_create();
+    if (!copy)
+    {
+        return NULL;
+    }
+    for (size_t i = 0; i < dict->count; i++)
+    {
+        if (!dict->entries[i].key)
+        {
+            continue;
+        }
+        hex_item_t *key = hex_copy_item(ctx, dict->entries[i].key);
+        hex_item_t *value = key ? hex_copy_item(ctx, dict->entries[i].value) : NULL;
+        if (!value || hex_dict_put(ctx, copy, key, value) != 0)
+        {
+            if (key)
+            {
+                HEX_FREE(ctx, key);
+            }
+            if (value)
+            {
+                HEX_FREE(ctx, value);
+            }
+            hex_dict_release(ctx, copy);
+            return NULL;
+        }
+    }
+    return copy;
+}
+
+// Get a dictionary that can be modified in place by the holder of a reference,
+// copying it if it is shared. Returns NULL if the copy fails.
+hex_dict_t *hex_dict_unshare(hex_context_t *ctx, hex_dict_t *dict)
+{
+    if (dict->refs == 1)
+    {
+        return dict;
+    }
+    hex_dict_t *copy = hex_dict_copy(ctx, dict);
+    if (copy)
+    {
+        dict->refs--;
+    }
+    return copy;
+}
+
+// Get the value of a key, still owned by the dictionary, or NULL if the key is not found
+hex_item_t *hex_dict_get(const hex_dict_t *dict, const hex_item_t *key)
+{
+    if (dict->slot_count == 0)
+    {
+        return NULL;
+    }
+    size_t slot = hex_dict_find_slot(dict, key, hex_dict_hash(key));
+    return dict->slots[slot] ? dict->entries[dict->slots[slot] - 1].value : NULL;
+}
+
+// Set the value of a key, taking ownership of both items if successful
+int hex_dict_put(hex_context_t *ctx, hex_dict_t *dict, hex_item_t *key, hex_item_t *value)
+{
+    size_t hash = hex_dict_hash(key);
+    if (dict->slot_count > 0)
+    {
+        size_t slot = hex_dict_find_slot(dict, key, hash);
+        if (dict->slots[slot])
+        {
+            hex_dict_entry_t *entry = &dict->entries[dict->slots[slot] - 1];
+            HEX_FREE(ctx, entry->value);
+            entry->value = value;
+            HEX_FREE(ctx, key);
+            return 0;
+        }
+    }
+    if ((dict->count + 1) * 4 > dict->slot_count * 3 && hex_dict_rebuild(dict) != 0)
+    {
+        return 1;
+    }
+    if (dict->count == dict->capacity)
+    {
+        size_t capacity = dict->capacity > 0 ? dict->capacity * 2 : HEX_DICT_INITIAL_SLOTS;
+        hex_dict_entry_t *entries = (hex_dict_entry_t *)realloc(dict->entries, capacity * sizeof(hex_dict_entry_t));
+        if (!entries)
+        {
+            return 1;
+        }
+        dict->entries = entries;
+        dict->capacity = capacity;
+    }
+    dict->entries[dict->count].hash = hash;
+    dict->entries[dict->count].key = key;
+    dict->entries[dict->count].value = value;
+    dict->slots[hex_dict_find_slot(dict, key, hash)] = dict->count + 1;
+    dict->count++;
+    dict->size++;
+    return 0;
+}
+
+// Delete a key and its value; returns 1 if the key was found, 0 otherwise
+int hex_dict_delete(hex_context_t *ctx, hex_dict_t *dict, const hex_item_t *key)
+{
+    if (dict->slot_count == 0)
+    {
+        return 0;
+    }
+    size_t slot = hex_dict_find_slot(dict, key, hex_dict_hash(key));
+    if (!dict->slots[slot])
+    {
+        return 0;
+    }
+    hex_dict_entry_t *entry = &dict->entries[dict->slots[slot] - 1];
+    HEX_FREE(ctx, entry->key);
+    HEX_FREE(ctx, entry->value);
+    entry->key = NULL;
+    entry->value = NULL;
+    dict->size--;
+    return 1;
+}
@@ -45,6 +45,9 @@ void hex_create_docs(hex_doc_dictionary_t *docs)
     // Control flow
     hex_set_doc(docs, "if", "q q q", "*", "If 'q1' is not $0, executes 'q2', else 'q3'.");
     hex_set_doc(docs, "while", "q1 q2", "*", "While 'q1' is not $0, executes 'q2'.");
+    hex_set_doc(docs, "times", "q i", "*", "Executes 'q' 'i' times.");
+    hex_set_doc(docs, "memo", "q i", "*", "Executes 'q' on 'i' items, or pushes its cached results.");
+    hex_set_doc(docs, "memostats", "", "d", "Returns statistics about the results cached by memo.");
     hex_set_doc(docs, "error", "", "s", "Returns the last error message.");
     hex_set_doc(docs, "try", "q1 q2", "*", "If 'q1' fails, executes 'q2'.");
     hex_set_doc(docs, "throw", "s", "", "Throws error 's'.");
@@ -57,32 +60,32 @@ void hex_create_docs(hex_doc_dictionary_t *docs)
 
     // Evaluation
     hex_set_doc(docs, ".", "q", "*", "Pushes each item of 'q' on the stack.");
-    hex_set_doc(docs, "!", "(s1|q) s2", "*", "Evaluates 's1' as a hex program or 'q' as hex bytecode (using s2 as file name).");
+    hex_set_doc(docs, "!", "(s1|q|b) s2", "*", "Evaluates 's1' as a hex program or 'q' or 'b' as hex bytecode (using s2 as file name).");
     hex_set_doc(docs, "'", "a", "q", "Wraps 'a' in a quotation.");
     hex_set_doc(docs, "debug", "q", "*", "Enables debug mode and pushes each item of 'q' on the stack.");
 
     // Arithmetic
-    hex_set_doc(docs, "+", "i1 12", "i", "Adds two integers.");
-    hex_set_doc(docs, "-", "i1 12", "i", "Subtracts 'i2' from 'i1'.");
-    hex_set_doc(docs, "*", "i1 12", "i", "Multiplies two integers.");
+    hex_set_doc(docs, "+", "(i1|v1) (i2|v2)", "(i|v)", "Adds two integers, or vector elements.");
+    hex_set_doc(docs, "-", "(i1|v1) (i2|v2)", "(i|v)", "Subtracts 'i2' from 'i1', or vector elements.");
+    hex_set_doc(docs, "*", "(i1|v1) (i2|v2)", "(i|v)", "Multiplies two integers, or vector elements.");
     hex_set_doc(docs, "/", "i1 12", "i", "Divides 'i1' by 'i2'.");
     hex_set_doc(docs, "%", "i1 12", "i", "Calculates the modulo of 'i1' divided by 'i2'.");
 
     // Bitwise
-    hex_set_doc(docs, "&", "i1 12", "i", "Calculates the bitwise AND of two integers.");
-    hex_set_doc(docs, "|", "i1 12", "i", "Calculates the bitwise OR of two integers.");
-    hex_set_doc(docs, "^", "i1 12", "i", "Calculates the bitwise XOR of two integers.");
+    hex_set_doc(docs, "&", "(i1|v1) (i2|v2)", "(i|v)", "Calculates the bitwise AND of two integers, or vector elements.");
+    hex_set_doc(docs, "|", "(i1|v1) (i2|v2)", "(i|v)", "Calculates the bitwise OR of two integers, or vector elements.");
+    hex_set_doc(docs, "^", "(i1|v1) (i2|v2)", "(i|v)", "Calculates the bitwise XOR of two integers, or vector elements.");
     hex_set_doc(docs, "~", "i", "i", "Calculates the bitwise NOT of an integer.");
-    hex_set_doc(docs, "<<", "i1 12", "i", "Shifts 'i1' by 'i2' bytes to the left.");
-    hex_set_doc(docs, ">>", "i1 12", "i", "Shifts 'i1' by 'i2' bytes to the right.");
+    hex_set_doc(docs, "<<", "(i1|v1) (i2|v2)", "(i|v)", "Shifts 'i1' by 'i2' bytes to the left, or vector elements.");
+    hex_set_doc(docs, ">>", "(i1|v1) (i2|v2)", "(i|v)", "Shifts 'i1' by 'i2' bytes to the right, or vector elements.");
 
     // Comparison
     hex_set_doc(docs, "==", "a1 a2", "i", "Returns $1 if 'a1' == 'a2', $0 otherwise.");
     hex_set_doc(docs, "!=", "a1 a2", "i", "Returns $1 if 'a1' != 'a2', $0 otherwise.");
-    hex_set_doc(docs, ">", "a1 a2", "i", "Returns $1 if 'a1' > 'a2', $0 otherwise.");
-    hex_set_doc(docs, "<", "a1 a2", "i", "Returns $1 if 'a1' < 'a2', $0 otherwise.");
-    hex_set_doc(docs, ">=", "a1 a2", "i", "Returns $1 if 'a1' >= 'a2', $0 otherwise.");
-    hex_set_doc(docs, "<=", "a1 a2", "i", "Returns $1 if 'a1' <= 'a2', $0 otherwise.");
+    hex_set_doc(docs, ">", "a1 a2", "(i|v)", "Returns $1 if 'a1' > 'a2', $0 otherwise (for each element of vectors).");
+    hex_set_doc(docs, "<", "a1 a2", "(i|v)", "Returns $1 if 'a1' < 'a2', $0 otherwise (for each element of vectors).");
+    hex_set_doc(docs, ">=", "a1 a2", "(i|v)", "Returns $1 if 'a1' >= 'a2', $0 otherwise (for each element of vectors).");
+    hex_set_doc(docs, "<=", "a1 a2", "(i|v)", "Returns $1 if 'a1' <= 'a2', $0 otherwise (for each element of vectors).");
 
     // Logical
     hex_set_doc(docs, "and", "i1 i2", "i", "Returns $1 if both 'i1' and 'i2' are not $0.");
@@ -95,19 +98,57 @@ void hex_create_docs(hex_doc_dictionary_t *docs)
     hex_set_doc(docs, "str", "i", "s", "Converts a hex integer to a string.");
     hex_set_doc(docs, "dec", "i", "s", "Converts a hex integer to a decimal string.");
     hex_set_doc(docs, "hex", "s", "i", "Converter a decimal string to a hex integer.");
+    hex_set_doc(docs, "ints", "s", "v", "Parses the integers in 's', separated by whitespace.");
     hex_set_doc(docs, "chr", "i", "s", "Converts an integer to a single-character.");
     hex_set_doc(docs, "ord", "s", "i", "Converts a single-character to an integer.");
     hex_set_doc(docs, "type", "a", "s", "Pushes the data type of 'a' on the stack.");
 
     // List
-    hex_set_doc(docs, "cat", "(s1 s2|q1 q2) ", "(s3|q3)", "Concatenates two quotations or two strings.");
-    hex_set_doc(docs, "len", "(s|q)", "i ", "Returns the length of 's' or 'q'.");
-    hex_set_doc(docs, "get", "(s|q)", "a", "Gets the item at position 'i' in 's' or 'q'.");
-    hex_set_doc(docs, "index", "(s a|q a)", "i", "Returns the index of 'a' within 's' or 'q'.");
+    hex_set_doc(docs, "cat", "(s1 s2|q1 q2|b1 b2|v1 v2) ", "(s3|q3|b3|v3)", "Concatenates two quotations, two strings, two buffers or two vectors.");
+    hex_set_doc(docs, "len", "(s|q|b|v|d)", "i ", "Returns the length of 's', 'q', 'b' or 'v', or the number of keys in 'd'.");
+    hex_set_doc(docs, "get", "(s|q|b|v|d)", "a", "Gets the item at position 'i' in 's', 'q', 'b' or 'v', or the value of a key in 'd'.");
+    hex_set_doc(docs, "index", "(s a|q a|b a|v a)", "i", "Returns the index of 'a' within 's', 'q', 'b' or 'v'.");
+    hex_set_doc(docs, "push", "q1 a", "q2", "Appends 'a' to the end of 'q1'.");
+    hex_set_doc(docs, "pop", "q1", "q2", "Removes the last item of 'q1'.");
+    hex_set_doc(docs, "ins", "q1 a i", "q2", "Inserts 'a' before position 'i' within 'q1'.");
+    hex_set_doc(docs, "rem", "q1 i", "q2", "Removes the item at position 'i' of 'q1'.");
+    hex_set_doc(docs, "set", "q1 a i", "q2", "Sets the item at position 'i' of 'q1' to 'a'.");
+    hex_set_doc(docs, "reverse", "q1", "q2", "Reverses the order of the items of 'q1'.");
+    hex_set_doc(docs, "uncons", "q1", "a q2", "Pushes the first item of 'q1' and 'q2' containing the rest of its items.");
+    hex_set_doc(docs, "swons", "q1 a", "q2", "Prepends 'a' to the beginning of 'q1'.");
     hex_set_doc(docs, "join", "q s", "s", "Joins the strings in 'q' using separator 's'.");
     hex_set_doc(docs, "split", "s1 s2", "q", "Splits 's1' using separator 's2'.");
-    hex_set_doc(docs, "sub", "s1 s2 s3", "s", "Replaces 's2' with 's3' within 's1'.");
-    hex_set_doc(docs, "map", "q1 q2", "q3", "Applies 'q2' to 'q1' items and returns results.");
+    hex_set_doc(docs, "sub", "(s1 s2 s3|b1 i1 i2)", "(s|b2)", "Replaces 's2' with 's3' within 's1', or slices 'b1' from 'i1' to 'i2'.");
+    hex_set_doc(docs, "gsub", "s1 s2 s3", "s", "Replaces all occurrences of 's2' with 's3' within 's1'.");
+    hex_set_doc(docs, "fmt", "s1 q", "s2", "Replaces placeholders ${0} to ${9} in 's1' with the strings in 'q', or pushed by its symbols.");
+    hex_set_doc(docs, "begins", "s1 s2", "i", "Returns $1 if 's1' begins with 's2', $0 otherwise.");
+    hex_set_doc(docs, "ends", "s1 s2", "i", "Returns $1 if 's1' ends with 's2', $0 otherwise.");
+    hex_set_doc(docs, "map", "(q1|v1|S1) q2", "(q3|v2|S2)", "Applies 'q2' to 'q1', 'v1' or 'S1' items and returns results.");
+    hex_set_doc(docs, "each", "(q1|S) q2", "*", "Applies 'q2' to each item of 'q1' or 'S'.");
+    hex_set_doc(docs, "filter", "(q1|S1) q2", "(q3|S2)", "Returns the items of 'q1' or 'S1' for which 'q2' pushes a positive integer.");
+    hex_set_doc(docs, "fold", "(q1|S) a1 q2", "a2", "Applies 'q2' to 'a1' and the first item of 'q1' or 'S', then to each result and the next item.");
+    hex_set_doc(docs, "range", "i1 i2", "q", "Returns the integers from 'i1' (included) to 'i2' (excluded).");
+    hex_set_doc(docs, "sort", "(q1|v1)", "(q2|v2)", "Sorts the integers or strings of 'q1', or the integers of 'v1', in ascending order.");
+    hex_set_doc(docs, "sortby", "q1 q2", "q3", "Sorts 'q1' placing an item after the next one when 'q2' pushes $1 for them.");
+
+    // Vector
+    hex_set_doc(docs, "vec", "(q|b)", "v", "Converts a quotation of integers or a buffer to a vector.");
+    hex_set_doc(docs, "sum", "(q|v)", "i", "Returns the sum of the integers in 'q' or 'v'.");
+    hex_set_doc(docs, "min", "(q|v)", "a", "Returns the minimum item of 'q' or 'v'.");
+    hex_set_doc(docs, "max", "(q|v)", "a", "Returns the maximum item of 'q' or 'v'.");
+
+    // Dictionary
+    hex_set_doc(docs, "dict", "q", "d", "Creates a dictionary from a quotation of key/value pairs.");
+    hex_set_doc(docs, "put", "d1 (s|i) a", "d2", "Sets the value of key 's' or 'i' in 'd1' to 'a'.");
+    hex_set_doc(docs, "has", "d (s|i)", "i", "Returns $1 if 'd' contains key 's' or 'i', $0 otherwise.");
+    hex_set_doc(docs, "del", "d1 (s|i)", "d2", "Removes key 's' or 'i' and its value from 'd1'.");
+    hex_set_doc(docs, "keys", "d", "q", "Returns the keys of 'd' in insertion order.");
+
+    // Sequence
+    hex_set_doc(docs, "seq", "i1 i2", "S", "Returns a sequence of the integers from 'i1' (included) to 'i2' (excluded).");
+    hex_set_doc(docs, "lines", "s", "S", "Returns a sequence of the lines of file 's'.");
+    hex_set_doc(docs, "pieces", "s1 s2", "S", "Returns a sequence of the pieces of 's1' split using separator 's2'.");
+    hex_set_doc(docs, "take", "S i", "q", "Returns a quotation of the next 'i' items of 'S' at most.");
 
     // I/O
     hex_set_doc(docs, "puts", "a", "", "Prints 'a' and a new line to standard output.");
@@ -116,9 +157,15 @@ void hex_create_docs(hex_doc_dictionary_t *docs)
     hex_set_doc(docs, "gets", "", "s", "Gets a string from standard input.");
 
     // File
-    hex_set_doc(docs, "read", "s1", "(s2|q)", "Returns the contents of the specified file.");
-    hex_set_doc(docs, "write", "(s1|q) s2", "", "Writes 's1' or 'q' to the file 's2'.");
-    hex_set_doc(docs, "append", "(s1|q) s2", "", "Appends 's1' or 'q' to the file 's2'.");
+    hex_set_doc(docs, "read", "s1", "(s2|b)", "Returns the contents of the specified file.");
+    hex_set_doc(docs, "write", "(s1|q|b|v) (s2|i)", "", "Writes 's1', 'q', 'b' or 'v' to the file 's2' or to file handle 'i'.");
+    hex_set_doc(docs, "append", "(s1|q|b|v) s2", "", "Appends 's1', 'q', 'b' or 'v' to the file 's2'.");
+    hex_set_doc(docs, "open", "s1 s2", "i", "Opens file 's1' in mode 's2' (r, w or a) and returns its handle.");
+    hex_set_doc(docs, "close", "i", "", "Closes file handle 'i'.");
+    hex_set_doc(docs, "flush", "i", "", "Writes buffered output of file handle 'i'.");
+    hex_set_doc(docs, "readl", "i1", "(s|i2)", "Reads the next line from file handle 'i1', or pushes 0x0 at its end.");
+    hex_set_doc(docs, "readb", "i1 i2", "b", "Reads up to 'i2' bytes from file handle 'i1'.");
+    hex_set_doc(docs, "eof", "i1", "i2", "Pushes 0x1 if file handle 'i1' is at its end, 0x0 otherwise.");
 
     // Shell
     hex_set_doc(docs, "args", "", "q", "Returns the program arguments.");
@@ -6,29 +6,258 @@
 // Error & Debugging                  //
 ////////////////////////////////////////
 
+// Capture the arguments of an error raised within a try frame so that the
+// message can be formatted later, only if it is read.
+static int hex_defer_error(hex_context_t *ctx, const char *format, va_list args)
+{
+    hex_deferred_error_t *deferred = &ctx->pending_error;
+    deferred->count = 0;
+    deferred->strings_size = 0;
+    for (const char *p = format; *p != '\0'; p++)
+    {
+        if (*p != '%')
+        {
+            continue;
+        }
+        p++;
+        if (*p == '%')
+        {
+            continue;
+        }
+        while (*p != '\0' && strchr("-+ #0123456789.", *p))
+        {
+            p++;
+        }
+        char modifier = 0;
+        if (*p == 'l' || *p == 'z')
+        {
+            modifier = *p++;
+        }
+        if (deferred->count >= HEX_MAX_ERROR_ARGS)
+        {
+            return 1;
+        }
+        hex_error_arg_t *arg = &deferred->args[deferred->count];
+        arg->conversion = *p;
+        arg->modifier = modifier;
+        switch (*p)
+        {
+        case 's':
+        {
+            const char *str = va_arg(args, const char *);
+            size_t available = sizeof(deferred->strings) - deferred->strings_size;
+            if (str == NULL)
+            {
+                str = "(null)";
+            }
+            if (available == 0)
+            {
+                return 1; // No room left, format the message right away
+            }
+            size_t len = strlen(str);
+            if (len >= available)
+            {
+                len = available - 1; // The message is truncated anyway
+            }
+            memcpy(deferred->strings + deferred->strings_size, str, len);
+            deferred->strings[deferred->strings_size + len] = '\0';
+            arg->value.string_offset = deferred->strings_size;
+            deferred->strings_size += len + 1;
+            break;
+        }
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'c':
+            if (modifier == 'z')
+            {
+                arg->value.size_value = va_arg(args, size_t);
+            }
+            else if (modifier == 'l')
+            {
+                arg->value.long_value = va_arg(args, long);
+            }
+            else
+            {
+                arg->value.long_value = va_arg(args, int);
+            }
+            break;
+        default:
+            return 1; // Unsupported conversion
+        }
+        deferred->count++;
+    }
+    deferred->format = format;
+    return 0;
+}
+
+// Format a deferred error into ctx->error
+static void hex_format_deferred_error(hex_context_t *ctx)
+{
+    hex_deferred_error_t *deferred = &ctx->pending_error;
+    size_t size = 0;
+    size_t n = 0;
+    const char *p = deferred->format;
+    while (*p != '\0' && size < sizeof(ctx->error) - 1)
+    {
+        if (*p != '%')
+        {
+            ctx->error[size++] = *p++;
+            continue;
+        }
+        if (*(p + 1) == '%')
+        {
+            ctx->error[size++] = '%';
+            p += 2;
+            continue;
+        }
+        // Rebuild the conversion specification and format its argument
+        const char *start = p++;
+        while (*p != '\0' && strchr("-+ #0123456789.lz", *p))
+        {
+            p++;
+        }
+        char spec[16];
+        size_t spec_len = p - start + 1;
+        if (spec_len >= sizeof(spec) || n >= deferred->count)
+        {
+            break;
+        }
+        memcpy(spec, start, spec_len);
+        spec[spec_len] = '\0';
+        hex_error_arg_t *arg = &deferred->args[n++];
+        char *dst = ctx->error + size;
+        size_t available = sizeof(ctx->error) - size;
+        int written;
+        if (arg->conversion == 's')
+        {
+            written = snprintf(dst, available, spec, deferred->strings + arg->value.string_offset);
+        }
+        else if (arg->modifier == 'z')
+        {
+            written = snprintf(dst, available, spec, arg->value.size_value);
+        }
+        else if (arg->modifier == 'l')
+        {
+            written = snprintf(dst, available, spec, arg->value.long_value);
+        }
+        else
+        {
+            written = snprintf(dst, available, spec, (int)arg->value.long_value);
+        }
+        if (written < 0)
+        {
+            break;
+        }
+        size += ((size_t)written < available) ? (size_t)written : available - 1;
+        p++;
+    }
+    ctx->error[size] = '\0';
+    deferred->format = NULL;
+}
+
 void hex_error(hex_context_t *ctx, const char *format, ...)
 {
     va_list args;
     va_start(args, format);
+    if (ctx->try_frame != NULL)
+    {
+        // Within a try frame errors are not printed, so formatting is deferred
+        va_list capture;
+        va_copy(capture, args);
+        int deferred = hex_defer_error(ctx, format, capture) == 0;
+        va_end(capture);
+        if (deferred)
+        {
+            ctx->error[0] = '\0';
+            va_end(args);
+            return;
+        }
+    }
+    ctx->pending_error.format = NULL;
     vsnprintf(ctx->error, sizeof(ctx->error), format, args);
-    if (ctx->settings->errors_enabled) /// FC
+    if (ctx->settings->errors_enabled && ctx->try_frame == NULL) /// FC
     {
+        hex_flush_output(ctx);
         fprintf(stderr, "ERROR: ");
         fprintf(stderr, "%s\n", ctx->error);
     }
     va_end(args);
 }
 
+// Return the last error message, formatting it if it was deferred
+const char *hex_error_message(hex_context_t *ctx)
+{
+    if (ctx->pending_error.format != NULL)
+    {
+        hex_format_deferred_error(ctx);
+    }
+    return ctx->error;
+}
+
+int hex_has_error(hex_context_t *ctx)
+{
+    return ctx->pending_error.format != NULL || ctx->error[0] != '\0';
+}
+
+void hex_clear_error(hex_context_t *ctx)
+{
+    ctx->pending_error.format = NULL;
+    ctx->error[0] = '\0';
+}
+
+// Push a frame on the handler stack; errors raised until the frame is left are
+// not printed and only formatted on demand.
+void hex_enter_try(hex_context_t *ctx, hex_try_frame_t *frame)
+{
+    frame->has_error = hex_has_error(ctx);
+    if (frame->has_error)
+    {
+        memcpy(frame->error, ctx->error, sizeof(ctx->error));
+        frame->pending_error = ctx->pending_error;
+    }
+    hex_clear_error(ctx);
+    frame->previous = ctx->try_frame;
+    ctx->try_frame = frame;
+}
+
+// Pop a frame from the handler stack
+void hex_leave_try(hex_context_t *ctx, hex_try_frame_t *frame)
+{
+    ctx->try_frame = frame->previous;
+}
+
+// Restore the error that was set when the frame was entered
+void hex_restore_error(hex_context_t *ctx, hex_try_frame_t *frame)
+{
+    if (frame->has_error)
+    {
+        memcpy(ctx->error, frame->error, sizeof(ctx->error));
+        ctx->pending_error = frame->pending_error;
+    }
+    else
+    {
+        hex_clear_error(ctx);
+    }
+}
+
 void hex_debug(hex_context_t *ctx, const char *format, ...)
 {
     if (ctx->settings->debugging_enabled)
     {
+        char message[1024];
         va_list args;
         va_start(args, format);
-        fprintf(stdout, "*** ");
-        vfprintf(stdout, format, args);
-        fprintf(stdout, "\n");
+        int size = vsnprintf(message, sizeof(message), format, args);
         va_end(args);
+        if (size < 0)
+        {
+            return;
+        }
+        hex_output_write(&ctx->out, "*** ", 4);
+        hex_output_write(&ctx->out, message, (size_t)size < sizeof(message) ? (size_t)size : sizeof(message) - 1);
+        hex_output_char(&ctx->out, '\n');
     }
 }
 
@@ -42,6 +271,14 @@ char *hex_type(hex_item_type_t type)
         return "string";
     case HEX_TYPE_QUOTATION:
         return "quotation";
+    case HEX_TYPE_BUFFER:
+        return "buffer";
+    case HEX_TYPE_VECTOR:
+        return "vector";
+    case HEX_TYPE_DICTIONARY:
+        return "dictionary";
+    case HEX_TYPE_SEQUENCE:
+        return "sequence";
     case HEX_TYPE_NATIVE_SYMBOL:
         return "native-symbol";
     case HEX_TYPE_USER_SYMBOL:
@@ -57,9 +294,11 @@ void hex_debug_item(hex_context_t *ctx, const char *message, hex_item_t *item)
 {
     if (ctx->settings->debugging_enabled)
     {
-        fprintf(stdout, "*** %s: ", message);
-        hex_print_item(stdout, item);
-        fprintf(stdout, "\n");
+        hex_output_write(&ctx->out, "*** ", 4);
+        hex_output_write(&ctx->out, message, strlen(message));
+        hex_output_write(&ctx->out, ": ", 2);
+        hex_output_item(&ctx->out, item, 0);
+        hex_output_char(&ctx->out, '\n');
     }
 }
 
@@ -96,7 +335,7 @@ void add_to_stack_trace(hex_context_t *ctx, hex_token_t *token)
 // Print the stack trace
 void print_stack_trace(hex_context_t *ctx)
 {
-    if (!ctx->settings->stack_trace_enabled || !ctx->settings->errors_enabled || ctx->stack_trace->size <= 0)
+    if (!ctx->settings->stack_trace_enabled || !ctx->settings->errors_enabled || ctx->try_frame != NULL || ctx->stack_trace->size <= 0)
     {
         return;
     }
@@ -17,9 +17,11 @@
 #include <windows.h>
 #include <io.h>
 int isatty(int fd);
+#define HEX_GETC(file) _getc_nolock(file)
 #else
 #include <unistd.h>
 #include <sys/wait.h>
+#define HEX_GETC(file) getc_unlocked(file) // Streams are only used by the interpreter thread
 #endif
 
 // Constants
@@ -29,8 +31,25 @@ int isatty(int fd);
 #define HEX_REGISTRY_SIZE 4096
 #define HEX_STACK_SIZE 256
 #define HEX_STACK_TRACE_SIZE 16
-#define HEX_NATIVE_SYMBOLS 64
+#define HEX_NATIVE_SYMBOLS 128
 #define HEX_MAX_SYMBOL_LENGTH 256
+#define HEX_ERROR_SIZE 256
+#define HEX_MAX_ERROR_ARGS 8
+#define HEX_MAX_NATIVE_ARITY 3
+#define HEX_EVAL_CACHE_SIZE 64
+#define HEX_KERNEL_DEPTH 8
+#define HEX_KERNEL_BLOCK 256
+#define HEX_DICT_INITIAL_SLOTS 8
+#define HEX_SORT_RUN 16
+#define HEX_INDEX_MIN_SIZE 32 // Quotations with fewer items are always scanned by index
+#define HEX_INDEX_LOOKUPS 4   // Lookups in the same quotation items before they are indexed
+#define HEX_MAX_OPEN_FILES 64
+#define HEX_FILE_BUFFER_SIZE 65536
+#define HEX_READ_CHUNK 65536 // Bytes read at a time by readb, which grows its buffer as they arrive
+#define HEX_OUTPUT_BUFFER_SIZE 8192
+#define HEX_MEMO_SIZE 4096    // Results kept by memo, beyond which the least recently used one is evicted
+#define HEX_MEMO_BUCKETS 8192 // Buckets of the memo table, a power of 2
+#define HEX_INTEGER_TEXT_SIZE 12 // "-2147483648", or "$" and 8 hexadecimal digits, and a terminator
 #define HEX_MAX_USER_SYMBOLS (HEX_REGISTRY_SIZE - HEX_NATIVE_SYMBOLS)
 
 // Type Definitions
@@ -39,11 +58,25 @@ typedef enum hex_item_type_t
     HEX_TYPE_INTEGER,
     HEX_TYPE_STRING,
     HEX_TYPE_QUOTATION,
+    HEX_TYPE_BUFFER,
+    HEX_TYPE_VECTOR,
+    HEX_TYPE_DICTIONARY,
+    HEX_TYPE_SEQUENCE,
     HEX_TYPE_NATIVE_SYMBOL,
     HEX_TYPE_USER_SYMBOL,
     HEX_TYPE_INVALID
 } hex_item_type_t;
 
+// Type masks used in native symbol signatures
+#define HEX_ARG_INTEGER (1 << HEX_TYPE_INTEGER)
+#define HEX_ARG_STRING (1 << HEX_TYPE_STRING)
+#define HEX_ARG_QUOTATION (1 << HEX_TYPE_QUOTATION)
+#define HEX_ARG_BUFFER (1 << HEX_TYPE_BUFFER)
+#define HEX_ARG_VECTOR (1 << HEX_TYPE_VECTOR)
+#define HEX_ARG_DICTIONARY (1 << HEX_TYPE_DICTIONARY)
+#define HEX_ARG_SEQUENCE (1 << HEX_TYPE_SEQUENCE)
+#define HEX_ARG_ANY (HEX_ARG_INTEGER | HEX_ARG_STRING | HEX_ARG_QUOTATION | HEX_ARG_BUFFER | HEX_ARG_VECTOR | HEX_ARG_DICTIONARY | HEX_ARG_SEQUENCE)
+
 typedef enum hex_token_type_t
 {
     HEX_TOKEN_INTEGER,
@@ -72,6 +105,35 @@ typedef struct hex_token_t
 
 typedef struct hex_context_t hex_context_t;
 
+// Native symbol signature, checked by the dispatcher before the native is called.
+// Operands are listed from the deepest to the topmost stack item.
+typedef struct hex_native_t
+{
+    const char *name;
+    int (*fn)(hex_context_t *);
+    int arity;
+    int types[HEX_MAX_NATIVE_ARITY];          // Accepted types of each operand (HEX_ARG_* masks)
+    const char *errors[HEX_MAX_NATIVE_ARITY]; // Error raised if an operand does not match its mask
+} hex_native_t;
+
+// Copies of a quotation item share its items, which are copied before being
+// modified if they have other references. The structural hash of the items is
+// cached with them, and so is a hash index of the items once they are looked up
+// repeatedly. Copies of a string item share its bytes the same way, except that a
+// string may append to them in place if it ends where they are used up and its
+// other references are held by the registry: those only see a prefix of the bytes,
+// and are copied again when read (see hex_copy_item).
+typedef struct hex_share_t
+{
+    int refs;           // References held by quotation or string items
+    int stored;         // References held by registry values (strings only)
+    size_t used;        // Bytes written before the terminator (strings only)
+    size_t hash;        // Structural hash of the items, 0 if not computed yet
+    size_t lookups;     // Lookups in the items so far
+    size_t *index;      // Position of an item plus one, 0 for an empty slot; NULL if not built yet
+    size_t index_slots; // Slots of the index, a power of 2
+} hex_share_t;
+
 typedef struct hex_item_t
 {
     hex_item_type_t type;
@@ -79,14 +141,70 @@ typedef struct hex_item_t
     {
         int32_t int_value;
         char *str_value;
-        int (*fn_value)(hex_context_t *);
+        uint8_t *buffer_value;
+        int32_t *vector_value;
+        struct hex_dict_t *dict_value;
+        struct hex_seq_t *seq_value;
+        const hex_native_t *native_value;
         struct hex_item_t **quotation_value;
     } data;
     int is_operator;
     hex_token_t *token;    // Token containing stack information (valid for HEX_TYPE_NATIVE_SYMBOL and HEX_TYPE_USER_SYMBOL)
-    size_t quotation_size; // Size of the quotation (valid for HEX_TYPE_QUOTATION)
+    size_t quotation_size; // Number of items (valid for HEX_TYPE_QUOTATION and HEX_TYPE_VECTOR)
+    size_t quotation_capacity; // Items allocated, if more than quotation_size (valid for HEX_TYPE_QUOTATION)
+    size_t str_size;       // Length in bytes, without the terminator of strings (valid for HEX_TYPE_STRING and HEX_TYPE_BUFFER)
+    size_t str_capacity;   // Bytes allocated, if more than str_size + 1 (valid for HEX_TYPE_STRING and HEX_TYPE_BUFFER)
+    hex_share_t *share;    // Shared state of the items, NULL if not shared yet (valid for HEX_TYPE_QUOTATION and HEX_TYPE_STRING)
+    size_t hash;           // Structural hash, 0 if not computed yet (valid for HEX_TYPE_STRING, HEX_TYPE_BUFFER and HEX_TYPE_VECTOR)
 } hex_item_t;
 
+// Entry of a dictionary
+typedef struct hex_dict_entry_t
+{
+    size_t hash;
+    hex_item_t *key; // NULL if the entry was deleted
+    hex_item_t *value;
+} hex_dict_entry_t;
+
+// Dictionaries keep their entries in insertion order, and find them through an
+// open addressing table of entry indexes. Copies of a dictionary item share the
+// dictionary, which is copied before being modified if it has other references.
+typedef struct hex_dict_t
+{
+    int refs; // References held by dictionary items
+    hex_dict_entry_t *entries;
+    size_t count;      // Entries used, including deleted ones
+    size_t capacity;   // Entries allocated
+    size_t size;       // Entries not deleted
+    size_t *slots;     // Index of an entry plus one, 0 for an empty slot
+    size_t slot_count; // Number of slots, a power of two
+} hex_dict_t;
+
+typedef enum hex_seq_kind_t
+{
+    HEX_SEQ_RANGE,  // Integers from current to end (excluded)
+    HEX_SEQ_LINES,  // Lines of a file
+    HEX_SEQ_PIECES, // Pieces of a string split by a separator
+    HEX_SEQ_MAP,    // Items of a source sequence with a quotation applied to them
+    HEX_SEQ_FILTER  // Items of a source sequence for which a quotation pushes a positive integer
+} hex_seq_kind_t;
+
+// Sequences produce their items one at a time, when they are consumed. Copies of a
+// sequence item share the sequence, and so its position: a sequence is consumed once.
+typedef struct hex_seq_t
+{
+    int refs; // References held by sequence items
+    hex_seq_kind_t kind;
+    int32_t current;          // Next integer (HEX_SEQ_RANGE)
+    int32_t end;              // First integer excluded (HEX_SEQ_RANGE)
+    FILE *file;               // File being read, NULL once closed (HEX_SEQ_LINES)
+    hex_item_t *string;       // String being split (HEX_SEQ_PIECES)
+    hex_item_t *separator;    // Separator (HEX_SEQ_PIECES)
+    size_t position;          // Start of the next piece (HEX_SEQ_PIECES)
+    struct hex_seq_t *source; // Source sequence (HEX_SEQ_MAP and HEX_SEQ_FILTER)
+    hex_item_t *action;       // Quotation applied to each item (HEX_SEQ_MAP and HEX_SEQ_FILTER)
+} hex_seq_t;
+
 typedef struct hex_stack_trace_t
 {
     hex_token_t **entries;
@@ -134,14 +252,110 @@ typedef struct hex_settings_t
     int debugging_enabled;
     int errors_enabled;
     int stack_trace_enabled;
+    int hash_consing_enabled; // Share the items of identical quotation literals decoded from bytecode
 } hex_settings_t;
 
+typedef struct hex_error_arg_t
+{
+    char conversion; // printf conversion character (d, i, u, x, c or s)
+    char modifier;   // Length modifier (l, z or 0)
+    union
+    {
+        long long_value;
+        size_t size_value;
+        size_t string_offset; // Offset of the captured string in hex_deferred_error_t.strings
+    } value;
+} hex_error_arg_t;
+
+// Error raised while a try frame is active: arguments are captured and the
+// message is only formatted if it is actually read.
+typedef struct hex_deferred_error_t
+{
+    const char *format; // NULL when no error is pending
+    hex_error_arg_t args[HEX_MAX_ERROR_ARGS];
+    size_t count;
+    char strings[HEX_ERROR_SIZE];
+    size_t strings_size;
+} hex_deferred_error_t;
+
+// Handler stack entry, allocated on the C stack by the try symbol
+typedef struct hex_try_frame_t
+{
+    struct hex_try_frame_t *previous;
+    int has_error;                      // Whether an error was set when the frame was entered
+    char error[HEX_ERROR_SIZE];         // Formatted error saved on entry (if any)
+    hex_deferred_error_t pending_error; // Deferred error saved on entry (if any)
+} hex_try_frame_t;
+
 typedef struct hex_symbol_table_t
 {
-    char **symbols;
-    uint16_t count;
+    char **symbols;                    // Symbols added on top of the parent
+    size_t capacity;                   // Allocated slots in symbols
+    uint16_t base;                     // Indexes below base belong to the parent
+    uint16_t count;                    // Total number of visible symbols
+    struct hex_symbol_table_t *parent; // Table this one is an overlay of (if any)
 } hex_symbol_table_t;
 
+// Program evaluated by !, parsed or decoded once and kept in the eval cache
+typedef struct hex_compiled_t
+{
+    int refs;     // References held by the cache and by running evaluations
+    size_t hash;  // Hash of the code and of the scope name
+    int bytecode; // Whether the code is a bytecode image
+    char *scope;
+    uint8_t *code;
+    size_t code_size;
+    hex_item_t **items; // Items pushed when the program is run
+    size_t count;
+} hex_compiled_t;
+
+// Step of a quotation compiled by map into a kernel over blocks of vector elements
+typedef struct hex_kernel_step_t
+{
+    uint8_t op;    // Opcode of a native symbol, or 0 for an integer literal
+    int32_t value; // Value of an integer literal
+} hex_kernel_step_t;
+
+// Buffer of the output written to stdout or stderr (see output.c)
+typedef struct hex_output_t
+{
+    FILE *stream;
+    int line_buffered; // Flush at each newline, if the stream is a terminal
+    size_t size;
+    char data[HEX_OUTPUT_BUFFER_SIZE];
+} hex_output_t;
+
+// Distinct quotation literals decoded from bytecode, whose items are shared by
+// identical literals (see vm.c)
+typedef struct hex_literal_pool_t
+{
+    hex_item_t **slots; // Open addressing table, NULL for an empty slot
+    size_t count;
+    size_t capacity;
+} hex_literal_pool_t;
+
+// Outputs of a quotation applied by memo to some inputs (see memo.c)
+typedef struct hex_memo_entry_t
+{
+    size_t hash;
+    hex_item_t *key;                // Quotation of the inputs followed by the quotation applied
+    hex_item_t *outputs;            // Quotation of the items pushed
+    struct hex_memo_entry_t *next;  // Next entry in the same bucket
+    struct hex_memo_entry_t *newer; // Entry used after this one
+    struct hex_memo_entry_t *older; // Entry used before this one
+} hex_memo_entry_t;
+
+typedef struct hex_memo_t
+{
+    hex_memo_entry_t **buckets; // NULL until a result is kept
+    hex_memo_entry_t *newest;
+    hex_memo_entry_t *oldest;
+    size_t size;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+} hex_memo_t;
+
 typedef struct hex_context_t
 {
     hex_stack_t *stack;
@@ -151,7 +365,15 @@ typedef struct hex_context_t
     hex_doc_dictionary_t *docs;
     hex_symbol_table_t *symbol_table;
     int hashbang;
-    char error[256];
+    char error[HEX_ERROR_SIZE];
+    hex_deferred_error_t pending_error;
+    hex_try_frame_t *try_frame;
+    hex_compiled_t *eval_cache[HEX_EVAL_CACHE_SIZE];
+    FILE *files[HEX_MAX_OPEN_FILES]; // Streams of file handles; 0, 1 and 2 are stdin, stdout and stderr
+    hex_output_t out;
+    hex_output_t err;
+    hex_literal_pool_t literals;
+    hex_memo_t memo;
     int argc;
     char **argv;
 } hex_context_t;
@@ -242,6 +464,57 @@ typedef enum hex_opcode_t
     HEX_OP_RUN = 0x4e,
     HEX_OP_TIMESTAMP = 0x4f,
 
+    HEX_OP_GSUB = 0x50,
+    HEX_OP_FMT = 0x51,
+    HEX_OP_BEGINS = 0x52,
+    HEX_OP_ENDS = 0x53,
+
+    HEX_OP_VEC = 0x54,
+    HEX_OP_SUM = 0x55,
+    HEX_OP_MIN = 0x56,
+    HEX_OP_MAX = 0x57,
+
+    HEX_OP_DICT = 0x58,
+    HEX_OP_PUT = 0x59,
+    HEX_OP_HAS = 0x5a,
+    HEX_OP_DEL = 0x5b,
+    HEX_OP_KEYS = 0x5c,
+
+    HEX_OP_SORT = 0x5d,
+    HEX_OP_SORTBY = 0x5e,
+
+    HEX_OP_EACH = 0x5f,
+    HEX_OP_FILTER = 0x60,
+    HEX_OP_FOLD = 0x61,
+    HEX_OP_TIMES = 0x62,
+    HEX_OP_RANGE = 0x63,
+
+    HEX_OP_PUSH = 0x64,
+    HEX_OP_POP = 0x65,
+    HEX_OP_INS = 0x66,
+    HEX_OP_REM = 0x67,
+    HEX_OP_SET = 0x68,
+    HEX_OP_REVERSE = 0x69,
+    HEX_OP_UNCONS = 0x6a,
+    HEX_OP_SWONS = 0x6b,
+
+    HEX_OP_SEQ = 0x6c,
+    HEX_OP_LINES = 0x6d,
+    HEX_OP_PIECES = 0x6e,
+    HEX_OP_TAKE = 0x6f,
+
+    HEX_OP_OPEN = 0x70,
+    HEX_OP_CLOSE = 0x71,
+    HEX_OP_FLUSH = 0x72,
+    HEX_OP_READL = 0x73,
+    HEX_OP_READB = 0x74,
+    HEX_OP_EOF = 0x75,
+
+    HEX_OP_INTS = 0x76,
+
+    HEX_OP_MEMO = 0x77,
+    HEX_OP_MEMOSTATS = 0x78,
+
 } hex_opcode_t;
 
 // Help System
@@ -263,12 +536,19 @@ void hex_registry_destroy(hex_context_t *ctx);
 int hex_valid_user_symbol(hex_context_t *ctx, const char *symbol);
 int hex_valid_native_symbol(hex_context_t *ctx, const char *symbol);
 int hex_set_symbol(hex_context_t *ctx, const char *key, hex_item_t *value, int native);
-void hex_set_native_symbol(hex_context_t *ctx, const char *name, int (*func)(hex_context_t *));
+void hex_set_native_symbol(hex_context_t *ctx, const hex_native_t *native);
 int hex_get_symbol(hex_context_t *ctx, const char *key, hex_item_t *result);
+const hex_native_t *hex_get_native_symbol(hex_context_t *ctx, const char *key);
 int hex_delete_symbol(hex_context_t *ctx, const char *key);
 
 // Errors and debugging
 void hex_error(hex_context_t *ctx, const char *format, ...);
+const char *hex_error_message(hex_context_t *ctx);
+int hex_has_error(hex_context_t *ctx);
+void hex_clear_error(hex_context_t *ctx);
+void hex_enter_try(hex_context_t *ctx, hex_try_frame_t *frame);
+void hex_leave_try(hex_context_t *ctx, hex_try_frame_t *frame);
+void hex_restore_error(hex_context_t *ctx, hex_try_frame_t *frame);
 void hex_debug(hex_context_t *ctx, const char *format, ...);
 void hex_debug_item(hex_context_t *ctx, const char *message, hex_item_t *item);
 void hex_print_item(FILE *stream, hex_item_t *item);
@@ -277,14 +557,26 @@ void print_stack_trace(hex_context_t *ctx);
 
 // Item constructors
 hex_item_t *hex_string_item(hex_context_t *ctx, const char *value);
+hex_item_t *hex_string_literal_item(hex_context_t *ctx, const char *value);
+hex_item_t *hex_string_buffer_item(hex_context_t *ctx, char *buffer, size_t size);
+hex_item_t *hex_string_bytes_item(hex_context_t *ctx, const char *value, size_t size);
 hex_item_t *hex_integer_item(hex_context_t *ctx, int value);
 hex_item_t *hex_quotation_item(hex_context_t *ctx, hex_item_t **quotation, size_t size);
+hex_item_t *hex_buffer_item(hex_context_t *ctx, uint8_t *data, size_t size);
+hex_item_t *hex_vector_item(hex_context_t *ctx, int32_t *values, size_t size);
+hex_item_t *hex_dict_item(hex_context_t *ctx, hex_dict_t *dict);
+hex_item_t *hex_seq_item(hex_context_t *ctx, hex_seq_t *seq);
 
 // Stack management
 int hex_push(hex_context_t *ctx, hex_item_t *item);
 int hex_push_integer(hex_context_t *ctx, int value);
 int hex_push_string(hex_context_t *ctx, const char *value);
+int hex_push_string_buffer(hex_context_t *ctx, char *buffer, size_t size);
 int hex_push_quotation(hex_context_t *ctx, hex_item_t **quotation, size_t size);
+int hex_push_buffer(hex_context_t *ctx, uint8_t *data, size_t size);
+int hex_push_vector(hex_context_t *ctx, int32_t *values, size_t size);
+int hex_push_dict(hex_context_t *ctx, hex_dict_t *dict);
+int hex_push_seq(hex_context_t *ctx, hex_seq_t *seq);
 int hex_push_symbol(hex_context_t *ctx, hex_token_t *token);
 hex_item_t *hex_pop(hex_context_t *ctx);
 void hex_free_item(hex_context_t *ctx, hex_item_t *item);
@@ -292,25 +584,45 @@ void hex_free_list(hex_context_t *ctx, hex_item_t **quotation, size_t size);
 void hex_free_token(hex_token_t *token);
 hex_item_t *hex_copy_item(hex_context_t *ctx, const hex_item_t *item);
 hex_token_t *hex_copy_token(hex_context_t *ctx, const hex_token_t *token);
+int hex_quotation_unshare(hex_context_t *ctx, hex_item_t *item);
+int hex_string_unshare(hex_item_t *item);
+int hex_string_store(hex_item_t *item);
+void hex_string_unstore(hex_item_t *item);
+size_t hex_item_hash(hex_item_t *item);
+int hex_quotation_find(hex_item_t *list, hex_item_t *item);
+int hex_equal(hex_item_t *a, hex_item_t *b);
 
 // Parser and interpreter
 hex_token_t *hex_next_token(hex_context_t *ctx, const char **input, hex_file_position_t *position);
 int32_t hex_parse_integer(const char *hex_str);
 int hex_parse_quotation(hex_context_t *ctx, const char **input, hex_item_t *result, hex_file_position_t *position);
 int hex_interpret(hex_context_t *ctx, const char *code, const char *filename, int line, int column);
+int hex_compile(hex_context_t *ctx, const char *code, const char *filename, hex_item_t ***items, size_t *count);
+
+// Eval cache
+hex_compiled_t *hex_get_compiled(hex_context_t *ctx, const uint8_t *code, size_t size, int bytecode, const char *scope);
+int hex_run_compiled(hex_context_t *ctx, hex_compiled_t *compiled);
+void hex_release_compiled(hex_context_t *ctx, hex_compiled_t *compiled);
+void hex_eval_cache_destroy(hex_context_t *ctx);
 
 // Utils
-char *hex_itoa(int num, int base);
-char *hex_itoa_dec(int num);
-char *hex_itoa_hex(int num);
-void hex_raw_print_item(FILE *stream, hex_item_t item);
+char *hex_format_hex(uint32_t value, char *end);
+char *hex_format_decimal(int32_t value, char *end);
+uint32_t hex_parse_hex_digits(const char *text, const char **end);
+uint32_t hex_parse_decimal_digits(const char *text, const char **end);
+int32_t hex_parse_number(const char *text, int base);
 char *hex_type(hex_item_type_t type);
 void hex_rpad(const char *str, int total_length);
 void hex_lpad(const char *str, int total_length);
 void hex_encode_length(uint8_t **bytecode, size_t *size, size_t length);
 int hex_is_binary(const uint8_t *data, size_t size);
-void hex_print_string(FILE *stream, char *value);
-char *hex_bytes_to_string(const uint8_t *bytes, size_t size);
+size_t hex_plain_span(const char *data, size_t size);
+const char *hex_find(const char *haystack, size_t haystack_size, const char *needle, size_t needle_size);
+int32_t hex_shift_left(int32_t value, int32_t count);
+int32_t hex_shift_right(int32_t value, int32_t count);
+int hex_vector_apply(hex_opcode_t op, int32_t *out, const int32_t *left, size_t left_step, const int32_t *right, size_t right_step, size_t size);
+int32_t hex_vector_reduce(hex_opcode_t op, const int32_t *values, size_t size);
+char *hex_bytes_to_string(const uint8_t *bytes, size_t size, size_t *length);
 char *hex_process_string(const char *value);
 size_t hex_min_bytes_to_encode_integer(int32_t value);
 char *hex_unescape_string(const char *input);
@@ -342,6 +654,7 @@ int hex_symbol_int(hex_context_t *ctx);
 int hex_symbol_str(hex_context_t *ctx);
 int hex_symbol_dec(hex_context_t *ctx);
 int hex_symbol_hex(hex_context_t *ctx);
+int hex_symbol_ints(hex_context_t *ctx);
 int hex_symbol_equal(hex_context_t *ctx);
 int hex_symbol_notequal(hex_context_t *ctx);
 int hex_symbol_greater(hex_context_t *ctx);
@@ -357,12 +670,43 @@ int hex_symbol_slice(hex_context_t *ctx);
 int hex_symbol_len(hex_context_t *ctx);
 int hex_symbol_get(hex_context_t *ctx);
 int hex_symbol_index(hex_context_t *ctx);
+int hex_symbol_push(hex_context_t *ctx);
+int hex_symbol_pop(hex_context_t *ctx);
+int hex_symbol_ins(hex_context_t *ctx);
+int hex_symbol_rem(hex_context_t *ctx);
+int hex_symbol_set(hex_context_t *ctx);
+int hex_symbol_reverse(hex_context_t *ctx);
+int hex_symbol_uncons(hex_context_t *ctx);
+int hex_symbol_swons(hex_context_t *ctx);
 int hex_symbol_join(hex_context_t *ctx);
 int hex_symbol_split(hex_context_t *ctx);
 int hex_symbol_sub(hex_context_t *ctx);
+int hex_symbol_gsub(hex_context_t *ctx);
+int hex_symbol_fmt(hex_context_t *ctx);
+int hex_symbol_begins(hex_context_t *ctx);
+int hex_symbol_ends(hex_context_t *ctx);
+int hex_symbol_vec(hex_context_t *ctx);
+int hex_symbol_sum(hex_context_t *ctx);
+int hex_symbol_min(hex_context_t *ctx);
+int hex_symbol_max(hex_context_t *ctx);
+int hex_symbol_dict(hex_context_t *ctx);
+int hex_symbol_put(hex_context_t *ctx);
+int hex_symbol_has(hex_context_t *ctx);
+int hex_symbol_del(hex_context_t *ctx);
+int hex_symbol_keys(hex_context_t *ctx);
+int hex_symbol_seq(hex_context_t *ctx);
+int hex_symbol_lines(hex_context_t *ctx);
+int hex_symbol_pieces(hex_context_t *ctx);
+int hex_symbol_take(hex_context_t *ctx);
 int hex_symbol_read(hex_context_t *ctx);
 int hex_symbol_write(hex_context_t *ctx);
 int hex_symbol_append(hex_context_t *ctx);
+int hex_symbol_open(hex_context_t *ctx);
+int hex_symbol_close(hex_context_t *ctx);
+int hex_symbol_flush(hex_context_t *ctx);
+int hex_symbol_readl(hex_context_t *ctx);
+int hex_symbol_readb(hex_context_t *ctx);
+int hex_symbol_eof(hex_context_t *ctx);
 int hex_symbol_args(hex_context_t *ctx);
 int hex_symbol_exit(hex_context_t *ctx);
 int hex_symbol_exec(hex_context_t *ctx);
@@ -370,11 +714,20 @@ int hex_symbol_run(hex_context_t *ctx);
 int hex_symbol_if(hex_context_t *ctx);
 int hex_symbol_when(hex_context_t *ctx);
 int hex_symbol_while(hex_context_t *ctx);
+int hex_symbol_times(hex_context_t *ctx);
+int hex_symbol_memo(hex_context_t *ctx);
+int hex_symbol_memostats(hex_context_t *ctx);
 int hex_symbol_error(hex_context_t *ctx);
 int hex_symbol_try(hex_context_t *ctx);
 int hex_symbol_throw(hex_context_t *ctx);
 int hex_symbol_q(hex_context_t *ctx);
 int hex_symbol_map(hex_context_t *ctx);
+int hex_symbol_each(hex_context_t *ctx);
+int hex_symbol_filter(hex_context_t *ctx);
+int hex_symbol_fold(hex_context_t *ctx);
+int hex_symbol_range(hex_context_t *ctx);
+int hex_symbol_sort(hex_context_t *ctx);
+int hex_symbol_sortby(hex_context_t *ctx);
 int hex_symbol_swap(hex_context_t *ctx);
 int hex_symbol_dup(hex_context_t *ctx);
 int hex_symbol_stack(hex_context_t *ctx);
@@ -398,6 +751,8 @@ int hex_interpret_bytecode_native_symbol(hex_context_t *ctx, uint8_t opcode, siz
 int hex_interpret_bytecode_user_symbol(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t position, const char *filename, hex_item_t *result);
 int hex_interpret_bytecode_quotation(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t position, const char *filename, hex_item_t *result);
 int hex_interpret_bytecode(hex_context_t *ctx, uint8_t *bytecode, size_t size, const char *filename);
+void hex_literal_pool_destroy(hex_context_t *ctx);
+int hex_compile_bytecode(hex_context_t *ctx, uint8_t *bytecode, size_t size, const char *filename, hex_item_t ***items, size_t *count);
 void hex_header(hex_context_t *ctx, uint8_t header[8]);
 int hex_validate_header(uint8_t header[8]);
 
@@ -407,9 +762,38 @@ int hex_symboltable_get_index(hex_context_t *ctx, const char *symbol);
 char *hex_symboltable_get_value(hex_context_t *ctx, uint16_t index);
 int hex_decode_bytecode_symboltable(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t count);
 uint8_t *hex_encode_bytecode_symboltable(hex_context_t *ctx, size_t *out_size);
-hex_symbol_table_t *hex_symboltable_copy(hex_context_t *ctx);
+hex_symbol_table_t *hex_symboltable_create(hex_symbol_table_t *parent);
+hex_symbol_table_t *hex_symboltable_overlay(hex_context_t *ctx);
 void hex_symboltable_destroy(hex_symbol_table_t *table);
 
+// Dictionaries
+hex_dict_t *hex_dict_create(void);
+void hex_dict_release(hex_context_t *ctx, hex_dict_t *dict);
+hex_dict_t *hex_dict_copy(hex_context_t *ctx, const hex_dict_t *dict);
+hex_dict_t *hex_dict_unshare(hex_context_t *ctx, hex_dict_t *dict);
+hex_item_t *hex_dict_get(const hex_dict_t *dict, const hex_item_t *key);
+int hex_dict_put(hex_context_t *ctx, hex_dict_t *dict, hex_item_t *key, hex_item_t *value);
+int hex_dict_delete(hex_context_t *ctx, hex_dict_t *dict, const hex_item_t *key);
+
+// Output
+void hex_output_init(hex_output_t *out, FILE *stream);
+int hex_output_flush(hex_output_t *out);
+void hex_output_write(hex_output_t *out, const char *data, size_t size);
+void hex_output_char(hex_output_t *out, char c);
+void hex_output_integer(hex_output_t *out, int32_t value);
+void hex_output_string(hex_output_t *out, const char *value, size_t size);
+void hex_output_item(hex_output_t *out, hex_item_t *item, int raw);
+void hex_flush_output(hex_context_t *ctx);
+
+// Sequences
+hex_seq_t *hex_seq_create(hex_seq_kind_t kind);
+void hex_seq_release(hex_context_t *ctx, hex_seq_t *seq);
+
+// Memoization
+hex_item_t *hex_memo_get(hex_context_t *ctx, hex_item_t *key, size_t hash);
+int hex_memo_put(hex_context_t *ctx, hex_item_t *key, size_t hash, hex_item_t *outputs);
+void hex_memo_destroy(hex_context_t *ctx);
+
 // REPL and initialization
 void hex_register_symbols(hex_context_t *ctx);
 hex_context_t *hex_init();
@@ -417,6 +801,8 @@ void hex_destroy(hex_context_t *ctx);
 void hex_repl(hex_context_t *ctx);
 void hex_process_stdin(hex_context_t *ctx);
 void hex_handle_sigint(int sig);
+void hex_check_interrupt(hex_context_t *ctx);
+extern volatile sig_atomic_t hex_interrupted; // Set by hex_handle_sigint on Ctrl+C
 int hex_write_bytecode_file(hex_context_t *ctx, char *filename, uint8_t *bytecode, size_t size);
 int hex_interpret_file(hex_context_t *ctx, const char *file);
 char *hex_read_file(hex_context_t *ctx, const char *filename);
@@ -425,7 +811,7 @@ char *hex_read_file(hex_context_t *ctx, const char *filename);
 #define HEX_POP(ctx, x) hex_item_t *x = hex_pop(ctx)
 #define HEX_FREE(ctx, x) hex_free_item(ctx, x)
 #define HEX_PUSH(ctx, x) hex_push(ctx, x)
-#define HEX_ALLOC(x) hex_item_t *x = (hex_item_t *)malloc(sizeof(hex_item_t));
+#define HEX_ALLOC(x) hex_item_t *x = (hex_item_t *)calloc(1, sizeof(hex_item_t));
 
 #endif // HEX_H
 
@@ -467,6 +853,39 @@ void hex_free_token(hex_token_t *token)
     free(token); // Free the token itself
 }
 
+// Check the operands of a native symbol against its signature, then call it.
+// On failure the operands are consumed, as the native itself would have done.
+static int hex_call_native(hex_context_t *ctx, const hex_native_t *native)
+{
+    hex_stack_t *stack = ctx->stack;
+    int base = stack->top - native->arity + 1;
+    int valid = 1;
+    if (base < 0)
+    {
+        hex_error(ctx, "[symbol %s] Insufficient items on the stack", native->name);
+        base = 0;
+        valid = 0;
+    }
+    for (int i = 0; valid && i < native->arity; i++)
+    {
+        if (!(native->types[i] & (1 << stack->entries[base + i]->type)))
+        {
+            hex_error(ctx, "[symbol %s] %s", native->name, native->errors[i]);
+            valid = 0;
+        }
+    }
+    if (valid)
+    {
+        return native->fn(ctx);
+    }
+    while (stack->top >= base)
+    {
+        hex_free_item(ctx, stack->entries[stack->top]);
+        stack->entries[stack->top--] = NULL;
+    }
+    return 1;
+}
+
 // Push functions
 int hex_push(hex_context_t *ctx, hex_item_t *item)
 {
@@ -475,6 +894,7 @@ int hex_push(hex_context_t *ctx, hex_item_t *item)
         hex_error(ctx, "[push] Stack overflow");
         return 1;
     }
+    hex_check_interrupt(ctx);
     hex_debug_item(ctx, "PUSH", item);
     int result = 0;
 
@@ -520,24 +940,22 @@ int hex_push(hex_context_t *ctx, hex_item_t *item)
     }
     else if (item->type == HEX_TYPE_NATIVE_SYMBOL)
     {
-        hex_item_t *value = calloc(1, sizeof(hex_item_t));
-        if (value == NULL)
+        const hex_native_t *native = item->data.native_value;
+        if (native == NULL)
         {
-            hex_error(ctx, "[push] Failed to allocate memory for value");
-            return 1;
+            native = hex_get_native_symbol(ctx, item->token->value);
         }
-        if (hex_get_symbol(ctx, item->token->value, value))
+        if (native != NULL)
         {
             add_to_stack_trace(ctx, item->token);
             hex_debug_item(ctx, "CALL", item);
-            result = value->data.fn_value(ctx);
+            result = hex_call_native(ctx, native);
         }
         else
         {
             hex_error(ctx, "[push] Undefined native symbol: %s", item->token->value);
             result = 1;
         }
-        hex_free_item(ctx, value); // Free the temporary value
     }
     else
     {
@@ -555,7 +973,28 @@ int hex_push(hex_context_t *ctx, hex_item_t *item)
     return result;
 }
 
+// Create a string item holding a copy of a runtime value, as is
 hex_item_t *hex_string_item(hex_context_t *ctx, const char *value)
+{
+    return hex_string_bytes_item(ctx, value, strlen(value));
+}
+
+// Create a string item holding a copy of the given bytes
+hex_item_t *hex_string_bytes_item(hex_context_t *ctx, const char *value, size_t size)
+{
+    char *str = malloc(size + 1);
+    if (str == NULL)
+    {
+        hex_error(ctx, "[create string] Failed to allocate memory for string");
+        return NULL;
+    }
+    memcpy(str, value, size);
+    str[size] = '\0';
+    return hex_string_buffer_item(ctx, str, size);
+}
+
+// Create a string item from the contents of a string literal, expanding escape sequences
+hex_item_t *hex_string_literal_item(hex_context_t *ctx, const char *value)
 {
     char *str = hex_process_string(value);
     if (str == NULL)
@@ -563,18 +1002,26 @@ hex_item_t *hex_string_item(hex_context_t *ctx, const char *value)
         hex_error(ctx, "[create string] Failed to allocate memory for string");
         return NULL;
     }
+    return hex_string_buffer_item(ctx, str, strlen(str));
+}
+
+// Create a string item taking ownership of a NUL-terminated buffer of known size.
+// The buffer is freed if the item cannot be created.
+hex_item_t *hex_string_buffer_item(hex_context_t *ctx, char *buffer, size_t size)
+{
     hex_item_t *item = calloc(1, sizeof(hex_item_t));
     if (item == NULL)
     {
         hex_error(ctx, "[create string] Failed to allocate memory for item");
-        free(str);
+        free(buffer);
         return NULL;
     }
     item->type = HEX_TYPE_STRING;
-    item->data.str_value = str;
+    item->data.str_value = buffer;
     item->is_operator = 0;
     item->token = NULL;
     item->quotation_size = 0;
+    item->str_size = size;
     return item;
 }
 
@@ -611,6 +1058,83 @@ hex_item_t *hex_quotation_item(hex_context_t *ctx, hex_item_t **quotation, size_
     return item;
 }
 
+// Create a buffer item taking ownership of an array of bytes.
+// The array is freed if the item cannot be created.
+hex_item_t *hex_buffer_item(hex_context_t *ctx, uint8_t *data, size_t size)
+{
+    hex_item_t *item = calloc(1, sizeof(hex_item_t));
+    if (item == NULL)
+    {
+        hex_error(ctx, "[create buffer] Failed to allocate memory for item");
+        free(data);
+        return NULL;
+    }
+    item->type = HEX_TYPE_BUFFER;
+    item->data.buffer_value = data;
+    item->is_operator = 0;
+    item->token = NULL;
+    item->quotation_size = 0;
+    item->str_size = size;
+    return item;
+}
+
+// Create a vector item taking ownership of an array of integers.
+// The array is freed if the item cannot be created.
+hex_item_t *hex_vector_item(hex_context_t *ctx, int32_t *values, size_t size)
+{
+    hex_item_t *item = calloc(1, sizeof(hex_item_t));
+    if (item == NULL)
+    {
+        hex_error(ctx, "[create vector] Failed to allocate memory for item");
+        free(values);
+        return NULL;
+    }
+    item->type = HEX_TYPE_VECTOR;
+    item->data.vector_value = values;
+    item->is_operator = 0;
+    item->token = NULL;
+    item->quotation_size = size;
+    return item;
+}
+
+// Create a dictionary item taking ownership of a dictionary.
+// The dictionary is destroyed if the item cannot be created.
+hex_item_t *hex_dict_item(hex_context_t *ctx, hex_dict_t *dict)
+{
+    hex_item_t *item = calloc(1, sizeof(hex_item_t));
+    if (item == NULL)
+    {
+        hex_error(ctx, "[create dictionary] Failed to allocate memory for item");
+        hex_dict_release(ctx, dict);
+        return NULL;
+    }
+    item->type = HEX_TYPE_DICTIONARY;
+    item->data.dict_value = dict;
+    item->is_operator = 0;
+    item->token = NULL;
+    item->quotation_size = 0;
+    return item;
+}
+
+// Create a sequence item taking ownership of a sequence.
+// The sequence is released if the item cannot be created.
+hex_item_t *hex_seq_item(hex_context_t *ctx, hex_seq_t *seq)
+{
+    hex_item_t *item = calloc(1, sizeof(hex_item_t));
+    if (item == NULL)
+    {
+        hex_error(ctx, "[create sequence] Failed to allocate memory for item");
+        hex_seq_release(ctx, seq);
+        return NULL;
+    }
+    item->type = HEX_TYPE_SEQUENCE;
+    item->data.seq_value = seq;
+    item->is_operator = 0;
+    item->token = NULL;
+    item->quotation_size = 0;
+    return item;
+}
+
 hex_item_t *hex_symbol_item(hex_context_t *ctx, hex_token_t *token)
 {
     hex_item_t *item = calloc(1, sizeof(hex_item_t));
@@ -620,6 +1144,10 @@ hex_item_t *hex_symbol_item(hex_context_t *ctx, hex_token_t *token)
         return NULL;
     }
     item->type = hex_valid_native_symbol(ctx, token->value) ? HEX_TYPE_NATIVE_SYMBOL : HEX_TYPE_USER_SYMBOL;
+    if (item->type == HEX_TYPE_NATIVE_SYMBOL)
+    {
+        item->data.native_value = hex_get_native_symbol(ctx, token->value);
+    }
 
     // Make a copy of the token for this item to ensure clear ownership
     item->token = hex_copy_token(ctx, token);
@@ -646,6 +1174,17 @@ int hex_push_string(hex_context_t *ctx, const char *value)
     return result;
 }
 
+int hex_push_string_buffer(hex_context_t *ctx, char *buffer, size_t size)
+{
+    hex_item_t *item = hex_string_buffer_item(ctx, buffer, size);
+    if (item == NULL)
+    {
+        return 1;
+    }
+    int result = HEX_PUSH(ctx, item);
+    return result;
+}
+
 int hex_push_integer(hex_context_t *ctx, int value)
 {
     hex_item_t *item = hex_integer_item(ctx, value);
@@ -668,6 +1207,50 @@ int hex_push_quotation(hex_context_t *ctx, hex_item_t **quotation, size_t size)
     return result;
 }
 
+int hex_push_buffer(hex_context_t *ctx, uint8_t *data, size_t size)
+{
+    hex_item_t *item = hex_buffer_item(ctx, data, size);
+    if (item == NULL)
+    {
+        return 1;
+    }
+    int result = HEX_PUSH(ctx, item);
+    return result;
+}
+
+int hex_push_vector(hex_context_t *ctx, int32_t *values, size_t size)
+{
+    hex_item_t *item = hex_vector_item(ctx, values, size);
+    if (item == NULL)
+    {
+        return 1;
+    }
+    int result = HEX_PUSH(ctx, item);
+    return result;
+}
+
+int hex_push_dict(hex_context_t *ctx, hex_dict_t *dict)
+{
+    hex_item_t *item = hex_dict_item(ctx, dict);
+    if (item == NULL)
+    {
+        return 1;
+    }
+    int result = HEX_PUSH(ctx, item);
+    return result;
+}
+
+int hex_push_seq(hex_context_t *ctx, hex_seq_t *seq)
+{
+    hex_item_t *item = hex_seq_item(ctx, seq);
+    if (item == NULL)
+    {
+        return 1;
+    }
+    int result = HEX_PUSH(ctx, item);
+    return result;
+}
+
 int hex_push_symbol(hex_context_t *ctx, hex_token_t *token)
 {
     hex_item_t *item = hex_symbol_item(ctx, token);
@@ -704,16 +1287,21 @@ hex_item_t *hex_pop(hex_context_t *ctx)
         return item;
     }
 
-    hex_item_t *orig_item = ctx->stack->entries[ctx->stack->top];
+    // Ownership of the item is transferred to the caller
+    hex_item_t *item = ctx->stack->entries[ctx->stack->top];
     ctx->stack->entries[ctx->stack->top] = NULL; // Clear the stack reference
     ctx->stack->top--;
-
-    // Copying the item to avoid ownership issues when freeing
-    hex_item_t *item = hex_copy_item(ctx, orig_item);
+    item->hash = 0; // Natives can modify the items they pop in place
     hex_debug_item(ctx, " POP", item);
     return item;
 }
 
+static void hex_share_free(hex_share_t *share)
+{
+    free(share->index);
+    free(share);
+}
+
 void hex_free_list(hex_context_t *ctx, hex_item_t **quotation, size_t size)
 {
     if (!quotation)
@@ -745,6 +1333,19 @@ void hex_free_item(hex_context_t *ctx, hex_item_t *item)
     switch (item->type)
     {
     case HEX_TYPE_STRING:
+        if (item->share)
+        {
+            // The bytes are freed with the last reference to them
+            if (--item->share->refs > 0)
+            {
+                item->data.str_value = NULL;
+            }
+            else
+            {
+                hex_share_free(item->share);
+            }
+            item->share = NULL;
+        }
         if (item->data.str_value)
         {
             hex_debug_item(ctx, "FREE", item);
@@ -753,7 +1354,40 @@ void hex_free_item(hex_context_t *ctx, hex_item_t *item)
         }
         break;
 
+    case HEX_TYPE_BUFFER:
+        free(item->data.buffer_value);
+        item->data.buffer_value = NULL;
+        break;
+
+    case HEX_TYPE_VECTOR:
+        free(item->data.vector_value);
+        item->data.vector_value = NULL;
+        break;
+
+    case HEX_TYPE_DICTIONARY:
+        hex_dict_release(ctx, item->data.dict_value);
+        item->data.dict_value = NULL;
+        break;
+
+    case HEX_TYPE_SEQUENCE:
+        hex_seq_release(ctx, item->data.seq_value);
+        item->data.seq_value = NULL;
+        break;
+
     case HEX_TYPE_QUOTATION:
+        if (item->share)
+        {
+            // The items are freed with the last reference to them
+            if (--item->share->refs > 0)
+            {
+                item->data.quotation_value = NULL;
+            }
+            else
+            {
+                hex_share_free(item->share);
+            }
+            item->share = NULL;
+        }
         if (item->data.quotation_value)
         {
             hex_debug(ctx, "FREE: freeing quotation (%zu items)", item->quotation_size);
@@ -910,15 +1544,50 @@ hex_item_t *hex_copy_item(hex_context_t *ctx, const hex_item_t *item)
         break;
 
     case HEX_TYPE_STRING:
-        if (item->data.str_value)
+        if (item->share && item->str_size < item->share->used && item->share->refs == 1)
         {
-            copy->data.str_value = strdup(item->data.str_value); // Deep copy the string
+            // No other item uses the bytes appended after the string any more
+            item->data.str_value[item->str_size] = '\0';
+            item->share->used = item->str_size;
+        }
+        if (item->data.str_value && (!item->share || item->str_size == item->share->used))
+        {
+            // The bytes are shared, and copied only when modified
+            if (!item->share)
+            {
+                hex_share_t *share = (hex_share_t *)calloc(1, sizeof(hex_share_t));
+                if (!share)
+                {
+                    hex_error(ctx, "[copy item] Failed to share string value");
+                    free(copy);
+                    return NULL;
+                }
+                share->refs = 1;
+                share->used = item->str_size;
+                ((hex_item_t *)item)->share = share;
+            }
+            item->share->refs++;
+            copy->share = item->share;
+            copy->data.str_value = item->data.str_value;
+            copy->str_size = item->str_size;
+            copy->str_capacity = item->str_capacity;
+            copy->hash = item->hash;
+        }
+        else if (item->data.str_value)
+        {
+            // The string is a prefix of bytes appended to by another item, and is not
+            // terminated: copy it
+            copy->data.str_value = malloc(item->str_size + 1); // Deep copy the string
             if (!copy->data.str_value)
             {
                 hex_free_item(ctx, copy);
                 hex_error(ctx, "[copy item] Failed to copy string value");
                 return NULL;
             }
+            memcpy(copy->data.str_value, item->data.str_value, item->str_size);
+            copy->data.str_value[item->str_size] = '\0';
+            copy->str_size = item->str_size;
+            copy->hash = item->hash;
         }
         else
         {
@@ -926,45 +1595,68 @@ hex_item_t *hex_copy_item(hex_context_t *ctx, const hex_item_t *item)
         }
         break;
 
-    case HEX_TYPE_QUOTATION:
+    case HEX_TYPE_BUFFER:
+        copy->data.buffer_value = (uint8_t *)malloc(item->str_size > 0 ? item->str_size : 1);
+        if (!copy->data.buffer_value)
+        {
+            hex_free_item(ctx, copy);
+            hex_error(ctx, "[copy item] Failed to copy buffer value");
+            return NULL;
+        }
+        memcpy(copy->data.buffer_value, item->data.buffer_value, item->str_size);
+        copy->str_size = item->str_size;
+        copy->hash = item->hash;
+        break;
+
+    case HEX_TYPE_VECTOR:
+        copy->data.vector_value = (int32_t *)malloc(item->quotation_size > 0 ? item->quotation_size * sizeof(int32_t) : 1);
+        if (!copy->data.vector_value)
+        {
+            hex_free_item(ctx, copy);
+            hex_error(ctx, "[copy item] Failed to copy vector value");
+            return NULL;
+        }
+        memcpy(copy->data.vector_value, item->data.vector_value, item->quotation_size * sizeof(int32_t));
         copy->quotation_size = item->quotation_size;
-        copy->is_operator = item->is_operator;
-        if (item->data.quotation_value)
+        copy->hash = item->hash;
+        break;
+
+    case HEX_TYPE_DICTIONARY:
+        // The dictionary is shared, and copied only when modified
+        copy->data.dict_value = item->data.dict_value;
+        copy->data.dict_value->refs++;
+        break;
+
+    case HEX_TYPE_SEQUENCE:
+        // The sequence is shared, and so is its position
+        copy->data.seq_value = item->data.seq_value;
+        copy->data.seq_value->refs++;
+        break;
+
+    case HEX_TYPE_QUOTATION:
+        // The items are shared, and copied only when modified
+        if (!item->share)
         {
-            copy->data.quotation_value = (hex_item_t **)malloc(item->quotation_size * sizeof(hex_item_t *));
-            if (!copy->data.quotation_value)
+            hex_share_t *share = (hex_share_t *)calloc(1, sizeof(hex_share_t));
+            if (!share)
             {
-                hex_error(ctx, "[copy item] Failed to allocate memory for quotation array");
-                hex_free_item(ctx, copy);
+                hex_error(ctx, "[copy item] Failed to share quotation items");
+                free(copy);
                 return NULL;
             }
-
-            for (size_t i = 0; i < item->quotation_size; ++i)
-            {
-                copy->data.quotation_value[i] = hex_copy_item(ctx, item->data.quotation_value[i]); // Recursively copy each item
-                if (!copy->data.quotation_value[i])
-                {
-                    // Cleanup on failure
-                    hex_error(ctx, "[copy item] Failed to copy quotation item");
-                    // Free already copied items
-                    for (size_t j = 0; j < i; j++)
-                    {
-                        hex_free_item(ctx, copy->data.quotation_value[j]);
-                    }
-                    free(copy->data.quotation_value);
-                    free(copy);
-                    return NULL;
-                }
-            }
-        }
-        else
-        {
-            copy->data.quotation_value = NULL;
+            share->refs = 1;
+            ((hex_item_t *)item)->share = share;
         }
+        item->share->refs++;
+        copy->share = item->share;
+        copy->data.quotation_value = item->data.quotation_value;
+        copy->quotation_size = item->quotation_size;
+        copy->quotation_capacity = item->quotation_capacity;
+        copy->is_operator = item->is_operator;
         break;
 
     case HEX_TYPE_NATIVE_SYMBOL:
-        copy->data.fn_value = item->data.fn_value; // Copy function pointer for native symbols
+        copy->data.native_value = item->data.native_value; // Signatures are static, share them
         break;
 
     case HEX_TYPE_USER_SYMBOL:
@@ -996,35 +1688,318 @@ hex_item_t *hex_copy_item(hex_context_t *ctx, const hex_item_t *item)
     return copy;
 }
 
-/* File: src/registry.c */
-#line 1 "src/registry.c"
-#ifndef HEX_H
-#include "hex.h"
-#endif
-
-////////////////////////////////////////
-// Registry Implementation            //
-////////////////////////////////////////
-
-// Helper: deep-copy an item into an existing struct (wrapper move)
-static int hex_copy_item_into(hex_context_t *ctx, const hex_item_t *src, hex_item_t *dst)
+// Get the items of a quotation ready to be modified in place by the holder of the
+// item, copying them if they are shared. The cached hash of the items is dropped.
+int hex_quotation_unshare(hex_context_t *ctx, hex_item_t *item)
 {
-    hex_item_t *tmp = hex_copy_item(ctx, src);
-    if (!tmp)
+    hex_share_t *share = item->share;
+    if (!share)
     {
         return 0;
     }
-    *dst = *tmp; // move struct fields
-    free(tmp);   // free only the wrapper
-    return 1;
-}
-
-static size_t hash_function(const char *key, size_t bucket_count)
-{
-    size_t hash = 5381;
-    while (*key)
+    if (share->refs > 1)
     {
-        hash = ((hash << 5) + hash) + (unsigned char)(*key); // hash * 33 + key[i]
+        // The copied items share their own items in turn
+        hex_item_t **items = (hex_item_t **)malloc((item->quotation_size > 0 ? item->quotation_size : 1) * sizeof(hex_item_t *));
+        if (!items)
+        {
+            return 1;
+        }
+        for (size_t i = 0; i < item->quotation_size; i++)
+        {
+            items[i] = hex_copy_item(ctx, item->data.quotation_value[i]);
+            if (!items[i])
+            {
+                hex_free_list(ctx, items, i);
+                return 1;
+            }
+        }
+        share->refs--;
+        item->data.quotation_value = items;
+        item->quotation_capacity = 0;
+    }
+    else
+    {
+        hex_share_free(share);
+    }
+    item->share = NULL;
+    return 0;
+}
+
+// Get the bytes of a string ready to be modified in place by the holder of the
+// item, copying them if they are shared.
+int hex_string_unshare(hex_item_t *item)
+{
+    hex_share_t *share = item->share;
+    if (!share)
+    {
+        return 0;
+    }
+    if (share->refs > 1)
+    {
+        char *str = (char *)malloc(item->str_size + 1);
+        if (!str)
+        {
+            return 1;
+        }
+        memcpy(str, item->data.str_value, item->str_size);
+        str[item->str_size] = '\0';
+        share->refs--;
+        item->data.str_value = str;
+        item->str_capacity = 0;
+    }
+    else
+    {
+        hex_share_free(share);
+    }
+    item->share = NULL;
+    return 0;
+}
+
+// Count a string stored as the value of a symbol among the registry references
+// to its bytes, which never read past the end of the string.
+int hex_string_store(hex_item_t *item)
+{
+    if (item->type != HEX_TYPE_STRING || !item->data.str_value)
+    {
+        return 0;
+    }
+    if (!item->share)
+    {
+        item->share = (hex_share_t *)calloc(1, sizeof(hex_share_t));
+        if (!item->share)
+        {
+            return 1;
+        }
+        item->share->refs = 1;
+        item->share->used = item->str_size;
+    }
+    item->share->stored++;
+    return 0;
+}
+
+// Stop counting a string removed from the registry among its registry references
+void hex_string_unstore(hex_item_t *item)
+{
+    if (item->type == HEX_TYPE_STRING && item->share)
+    {
+        item->share->stored--;
+    }
+}
+
+// Structural hashes
+
+static uint32_t hex_hash_bytes(uint32_t hash, const void *data, size_t size)
+{
+    // FNV-1a
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t hex_hash_mix(uint32_t hash, uint32_t value)
+{
+    return hex_hash_bytes(hash, &value, sizeof(value));
+}
+
+// Get a hash of an item consistent with hex_equal: equal items have the same hash.
+// Hashes of strings, buffers and vectors are cached in the item, those of
+// quotations with their items. Never returns 0.
+size_t hex_item_hash(hex_item_t *item)
+{
+    uint32_t hash = 2166136261u;
+    switch (item->type)
+    {
+    case HEX_TYPE_INTEGER:
+        hash = hex_hash_mix(hex_hash_mix(hash, HEX_TYPE_INTEGER), (uint32_t)item->data.int_value);
+        break;
+
+    case HEX_TYPE_STRING:
+        if (!item->hash)
+        {
+            item->hash = hex_hash_bytes(hex_hash_mix(hash, HEX_TYPE_STRING), item->data.str_value, item->str_size) | 1;
+        }
+        return item->hash;
+
+    case HEX_TYPE_BUFFER:
+        if (!item->hash)
+        {
+            item->hash = hex_hash_bytes(hex_hash_mix(hash, HEX_TYPE_BUFFER), item->data.buffer_value, item->str_size) | 1;
+        }
+        return item->hash;
+
+    case HEX_TYPE_VECTOR:
+        if (!item->hash)
+        {
+            item->hash = hex_hash_bytes(hex_hash_mix(hash, HEX_TYPE_VECTOR), item->data.vector_value, item->quotation_size * sizeof(int32_t)) | 1;
+        }
+        return item->hash;
+
+    case HEX_TYPE_NATIVE_SYMBOL:
+    case HEX_TYPE_USER_SYMBOL:
+        // Symbols are equal if they have the same name, whatever their kind
+        hash = hex_hash_bytes(hex_hash_mix(hash, HEX_TYPE_NATIVE_SYMBOL), item->token->value, strlen(item->token->value));
+        break;
+
+    case HEX_TYPE_QUOTATION:
+    {
+        if (item->share && item->share->hash)
+        {
+            return item->share->hash;
+        }
+        hash = hex_hash_mix(hash, HEX_TYPE_QUOTATION);
+        for (size_t i = 0; i < item->quotation_size; i++)
+        {
+            hash = hex_hash_mix(hash, (uint32_t)hex_item_hash(item->data.quotation_value[i]));
+        }
+        hash |= 1;
+        if (!item->share)
+        {
+            // Not cached if the shared state cannot be allocated
+            item->share = (hex_share_t *)calloc(1, sizeof(hex_share_t));
+            if (!item->share)
+            {
+                return hash;
+            }
+            item->share->refs = 1;
+        }
+        item->share->hash = hash;
+        return hash;
+    }
+
+    case HEX_TYPE_DICTIONARY:
+    {
+        // Entries are combined regardless of their order
+        const hex_dict_t *dict = item->data.dict_value;
+        uint32_t entries = 0;
+        for (size_t i = 0; i < dict->count; i++)
+        {
+            if (dict->entries[i].key)
+            {
+                entries += hex_hash_mix((uint32_t)hex_item_hash(dict->entries[i].key), (uint32_t)hex_item_hash(dict->entries[i].value));
+            }
+        }
+        hash = hex_hash_mix(hex_hash_mix(hash, HEX_TYPE_DICTIONARY), entries);
+        break;
+    }
+
+    case HEX_TYPE_SEQUENCE:
+    {
+        // Sequences are only equal to their copies
+        uintptr_t seq = (uintptr_t)item->data.seq_value;
+        hash = hex_hash_bytes(hex_hash_mix(hash, HEX_TYPE_SEQUENCE), &seq, sizeof(seq));
+        break;
+    }
+
+    default:
+        hash = hex_hash_mix(hash, item->type);
+        break;
+    }
+    return hash ? hash : 1;
+}
+
+// Lookups in quotations
+
+// Build the hash index of the items of a quotation, in which only the first of
+// equal items is found
+static void hex_quotation_build_index(hex_item_t *list)
+{
+    size_t slots = HEX_DICT_INITIAL_SLOTS;
+    while (slots < list->quotation_size * 2)
+    {
+        slots *= 2;
+    }
+    size_t *index = (size_t *)calloc(slots, sizeof(size_t));
+    if (!index)
+    {
+        return; // The items are scanned instead
+    }
+    hex_item_t **items = list->data.quotation_value;
+    for (size_t i = 0; i < list->quotation_size; i++)
+    {
+        size_t hash = hex_item_hash(items[i]);
+        size_t j = hash & (slots - 1);
+        while (index[j] && !(hex_item_hash(items[index[j] - 1]) == hash && hex_equal(items[index[j] - 1], items[i])))
+        {
+            j = (j + 1) & (slots - 1);
+        }
+        if (!index[j])
+        {
+            index[j] = i + 1;
+        }
+    }
+    list->share->index = index;
+    list->share->index_slots = slots;
+}
+
+// Find the position of the first item of a quotation equal to an item, or -1.
+// Items shared by quotation items and looked up repeatedly are indexed, as they
+// cannot change until they are unshared, which drops the index.
+int hex_quotation_find(hex_item_t *list, hex_item_t *item)
+{
+    hex_share_t *share = list->share;
+    hex_item_t **items = list->data.quotation_value;
+    size_t hash = hex_item_hash(item);
+    if (share && !share->index && list->quotation_size >= HEX_INDEX_MIN_SIZE && ++share->lookups >= HEX_INDEX_LOOKUPS)
+    {
+        hex_quotation_build_index(list);
+    }
+    if (share && share->index)
+    {
+        for (size_t j = hash & (share->index_slots - 1); share->index[j]; j = (j + 1) & (share->index_slots - 1))
+        {
+            hex_item_t *candidate = items[share->index[j] - 1];
+            if (hex_item_hash(candidate) == hash && hex_equal(candidate, item))
+            {
+                return (int)(share->index[j] - 1);
+            }
+        }
+        return -1;
+    }
+    // Items are compared only if their hashes match
+    for (size_t i = 0; i < list->quotation_size; i++)
+    {
+        if (hex_item_hash(items[i]) == hash && hex_equal(items[i], item))
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/* File: src/registry.c */
+#line 1 "src/registry.c"
+#ifndef HEX_H
+#include "hex.h"
+#endif
+
+////////////////////////////////////////
+// Registry Implementation            //
+////////////////////////////////////////
+
+// Helper: deep-copy an item into an existing struct (wrapper move)
+static int hex_copy_item_into(hex_context_t *ctx, const hex_item_t *src, hex_item_t *dst)
+{
+    hex_item_t *tmp = hex_copy_item(ctx, src);
+    if (!tmp)
+    {
+        return 0;
+    }
+    *dst = *tmp; // move struct fields
+    free(tmp);   // free only the wrapper
+    return 1;
+}
+
+static size_t hash_function(const char *key, size_t bucket_count)
+{
+    size_t hash = 5381;
+    while (*key)
+    {
+        hash = ((hash << 5) + hash) + (unsigned char)(*key); // hash * 33 + key[i]
         key++;
     }
     return hash % bucket_count;
@@ -1184,6 +2159,12 @@ int hex_set_symbol(hex_context_t *ctx, const char *key, hex_item_t *value, int n
         hex_registry_resize(ctx);
     }
 
+    if (hex_string_store(value) != 0)
+    {
+        hex_error(ctx, "[set symbol] Failed to store string value for '%s'", key);
+        return 1;
+    }
+
     size_t bucket_index = hash_function(key, registry->bucket_count);
     hex_registry_entry_t *entry = registry->buckets[bucket_index];
 
@@ -1195,6 +2176,7 @@ int hex_set_symbol(hex_context_t *ctx, const char *key, hex_item_t *value, int n
             // Key already exists, update its value
             hex_item_t *old_value = entry->value;
             entry->value = value;          // Assign new value first
+            hex_string_unstore(old_value);
             hex_free_item(ctx, old_value); // Then free old value
             return 0;
         }
@@ -1218,8 +2200,9 @@ int hex_set_symbol(hex_context_t *ctx, const char *key, hex_item_t *value, int n
     return 0;
 }
 
-void hex_set_native_symbol(hex_context_t *ctx, const char *name, int (*func)(hex_context_t *))
+void hex_set_native_symbol(hex_context_t *ctx, const hex_native_t *native)
 {
+    const char *name = native->name;
     hex_item_t *func_item = calloc(1, sizeof(hex_item_t));
     if (func_item == NULL)
     {
@@ -1227,7 +2210,7 @@ void hex_set_native_symbol(hex_context_t *ctx, const char *name, int (*func)(hex
         return;
     }
     func_item->type = HEX_TYPE_NATIVE_SYMBOL;
-    func_item->data.fn_value = func;
+    func_item->data.native_value = native;
     // Need to create a fake token for native symbols as well.
     func_item->token = calloc(1, sizeof(hex_token_t));
     func_item->token->type = HEX_TOKEN_SYMBOL;
@@ -1268,6 +2251,28 @@ int hex_get_symbol(hex_context_t *ctx, const char *key, hex_item_t *result)
     return 0;
 }
 
+// Look up the signature of a native symbol without copying its registry entry
+const hex_native_t *hex_get_native_symbol(hex_context_t *ctx, const char *key)
+{
+    hex_registry_t *registry = ctx->registry;
+    size_t bucket_index = hash_function(key, registry->bucket_count);
+
+    hex_registry_entry_t *entry = registry->buckets[bucket_index];
+    while (entry != NULL)
+    {
+        if (strcmp(entry->key, key) == 0)
+        {
+            if (entry->value->type != HEX_TYPE_NATIVE_SYMBOL)
+            {
+                return NULL;
+            }
+            return entry->value->data.native_value;
+        }
+        entry = entry->next;
+    }
+    return NULL;
+}
+
 int hex_delete_symbol(hex_context_t *ctx, const char *key)
 {
     hex_registry_t *registry = ctx->registry;
@@ -1291,6 +2296,7 @@ int hex_delete_symbol(hex_context_t *ctx, const char *key)
             }
 
             free(entry->key);
+            hex_string_unstore(entry->value);
             hex_free_item(ctx, entry->value);
             free(entry);
             registry->size--;
@@ -1315,48 +2321,285 @@ int hex_delete_symbol(hex_context_t *ctx, const char *key)
 // Error & Debugging                  //
 ////////////////////////////////////////
 
-void hex_error(hex_context_t *ctx, const char *format, ...)
-{
-    va_list args;
-    va_start(args, format);
-    vsnprintf(ctx->error, sizeof(ctx->error), format, args);
-    if (ctx->settings->errors_enabled) /// FC
-    {
-        fprintf(stderr, "ERROR: ");
-        fprintf(stderr, "%s\n", ctx->error);
-    }
-    va_end(args);
-}
-
-void hex_debug(hex_context_t *ctx, const char *format, ...)
+// Capture the arguments of an error raised within a try frame so that the
+// message can be formatted later, only if it is read.
+static int hex_defer_error(hex_context_t *ctx, const char *format, va_list args)
 {
-    if (ctx->settings->debugging_enabled)
+    hex_deferred_error_t *deferred = &ctx->pending_error;
+    deferred->count = 0;
+    deferred->strings_size = 0;
+    for (const char *p = format; *p != '\0'; p++)
     {
-        va_list args;
-        va_start(args, format);
-        fprintf(stdout, "*** ");
-        vfprintf(stdout, format, args);
-        fprintf(stdout, "\n");
-        va_end(args);
+        if (*p != '%')
+        {
+            continue;
+        }
+        p++;
+        if (*p == '%')
+        {
+            continue;
+        }
+        while (*p != '\0' && strchr("-+ #0123456789.", *p))
+        {
+            p++;
+        }
+        char modifier = 0;
+        if (*p == 'l' || *p == 'z')
+        {
+            modifier = *p++;
+        }
+        if (deferred->count >= HEX_MAX_ERROR_ARGS)
+        {
+            return 1;
+        }
+        hex_error_arg_t *arg = &deferred->args[deferred->count];
+        arg->conversion = *p;
+        arg->modifier = modifier;
+        switch (*p)
+        {
+        case 's':
+        {
+            const char *str = va_arg(args, const char *);
+            size_t available = sizeof(deferred->strings) - deferred->strings_size;
+            if (str == NULL)
+            {
+                str = "(null)";
+            }
+            if (available == 0)
+            {
+                return 1; // No room left, format the message right away
+            }
+            size_t len = strlen(str);
+            if (len >= available)
+            {
+                len = available - 1; // The message is truncated anyway
+            }
+            memcpy(deferred->strings + deferred->strings_size, str, len);
+            deferred->strings[deferred->strings_size + len] = '\0';
+            arg->value.string_offset = deferred->strings_size;
+            deferred->strings_size += len + 1;
+            break;
+        }
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'c':
+            if (modifier == 'z')
+            {
+                arg->value.size_value = va_arg(args, size_t);
+            }
+            else if (modifier == 'l')
+            {
+                arg->value.long_value = va_arg(args, long);
+            }
+            else
+            {
+                arg->value.long_value = va_arg(args, int);
+            }
+            break;
+        default:
+            return 1; // Unsupported conversion
+        }
+        deferred->count++;
     }
+    deferred->format = format;
+    return 0;
 }
 
-char *hex_type(hex_item_type_t type)
+// Format a deferred error into ctx->error
+static void hex_format_deferred_error(hex_context_t *ctx)
 {
-    switch (type)
+    hex_deferred_error_t *deferred = &ctx->pending_error;
+    size_t size = 0;
+    size_t n = 0;
+    const char *p = deferred->format;
+    while (*p != '\0' && size < sizeof(ctx->error) - 1)
     {
-    case HEX_TYPE_INTEGER:
-        return "integer";
-    case HEX_TYPE_STRING:
-        return "string";
-    case HEX_TYPE_QUOTATION:
-        return "quotation";
-    case HEX_TYPE_NATIVE_SYMBOL:
-        return "native-symbol";
-    case HEX_TYPE_USER_SYMBOL:
-        return "user-symbol";
-    case HEX_TYPE_INVALID:
-        return "invalid";
+        if (*p != '%')
+        {
+            ctx->error[size++] = *p++;
+            continue;
+        }
+        if (*(p + 1) == '%')
+        {
+            ctx->error[size++] = '%';
+            p += 2;
+            continue;
+        }
+        // Rebuild the conversion specification and format its argument
+        const char *start = p++;
+        while (*p != '\0' && strchr("-+ #0123456789.lz", *p))
+        {
+            p++;
+        }
+        char spec[16];
+        size_t spec_len = p - start + 1;
+        if (spec_len >= sizeof(spec) || n >= deferred->count)
+        {
+            break;
+        }
+        memcpy(spec, start, spec_len);
+        spec[spec_len] = '\0';
+        hex_error_arg_t *arg = &deferred->args[n++];
+        char *dst = ctx->error + size;
+        size_t available = sizeof(ctx->error) - size;
+        int written;
+        if (arg->conversion == 's')
+        {
+            written = snprintf(dst, available, spec, deferred->strings + arg->value.string_offset);
+        }
+        else if (arg->modifier == 'z')
+        {
+            written = snprintf(dst, available, spec, arg->value.size_value);
+        }
+        else if (arg->modifier == 'l')
+        {
+            written = snprintf(dst, available, spec, arg->value.long_value);
+        }
+        else
+        {
+            written = snprintf(dst, available, spec, (int)arg->value.long_value);
+        }
+        if (written < 0)
+        {
+            break;
+        }
+        size += ((size_t)written < available) ? (size_t)written : available - 1;
+        p++;
+    }
+    ctx->error[size] = '\0';
+    deferred->format = NULL;
+}
+
+void hex_error(hex_context_t *ctx, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    if (ctx->try_frame != NULL)
+    {
+        // Within a try frame errors are not printed, so formatting is deferred
+        va_list capture;
+        va_copy(capture, args);
+        int deferred = hex_defer_error(ctx, format, capture) == 0;
+        va_end(capture);
+        if (deferred)
+        {
+            ctx->error[0] = '\0';
+            va_end(args);
+            return;
+        }
+    }
+    ctx->pending_error.format = NULL;
+    vsnprintf(ctx->error, sizeof(ctx->error), format, args);
+    if (ctx->settings->errors_enabled && ctx->try_frame == NULL) /// FC
+    {
+        hex_flush_output(ctx);
+        fprintf(stderr, "ERROR: ");
+        fprintf(stderr, "%s\n", ctx->error);
+    }
+    va_end(args);
+}
+
+// Return the last error message, formatting it if it was deferred
+const char *hex_error_message(hex_context_t *ctx)
+{
+    if (ctx->pending_error.format != NULL)
+    {
+        hex_format_deferred_error(ctx);
+    }
+    return ctx->error;
+}
+
+int hex_has_error(hex_context_t *ctx)
+{
+    return ctx->pending_error.format != NULL || ctx->error[0] != '\0';
+}
+
+void hex_clear_error(hex_context_t *ctx)
+{
+    ctx->pending_error.format = NULL;
+    ctx->error[0] = '\0';
+}
+
+// Push a frame on the handler stack; errors raised until the frame is left are
+// not printed and only formatted on demand.
+void hex_enter_try(hex_context_t *ctx, hex_try_frame_t *frame)
+{
+    frame->has_error = hex_has_error(ctx);
+    if (frame->has_error)
+    {
+        memcpy(frame->error, ctx->error, sizeof(ctx->error));
+        frame->pending_error = ctx->pending_error;
+    }
+    hex_clear_error(ctx);
+    frame->previous = ctx->try_frame;
+    ctx->try_frame = frame;
+}
+
+// Pop a frame from the handler stack
+void hex_leave_try(hex_context_t *ctx, hex_try_frame_t *frame)
+{
+    ctx->try_frame = frame->previous;
+}
+
+// Restore the error that was set when the frame was entered
+void hex_restore_error(hex_context_t *ctx, hex_try_frame_t *frame)
+{
+    if (frame->has_error)
+    {
+        memcpy(ctx->error, frame->error, sizeof(ctx->error));
+        ctx->pending_error = frame->pending_error;
+    }
+    else
+    {
+        hex_clear_error(ctx);
+    }
+}
+
+void hex_debug(hex_context_t *ctx, const char *format, ...)
+{
+    if (ctx->settings->debugging_enabled)
+    {
+        char message[1024];
+        va_list args;
+        va_start(args, format);
+        int size = vsnprintf(message, sizeof(message), format, args);
+        va_end(args);
+        if (size < 0)
+        {
+            return;
+        }
+        hex_output_write(&ctx->out, "*** ", 4);
+        hex_output_write(&ctx->out, message, (size_t)size < sizeof(message) ? (size_t)size : sizeof(message) - 1);
+        hex_output_char(&ctx->out, '\n');
+    }
+}
+
+char *hex_type(hex_item_type_t type)
+{
+    switch (type)
+    {
+    case HEX_TYPE_INTEGER:
+        return "integer";
+    case HEX_TYPE_STRING:
+        return "string";
+    case HEX_TYPE_QUOTATION:
+        return "quotation";
+    case HEX_TYPE_BUFFER:
+        return "buffer";
+    case HEX_TYPE_VECTOR:
+        return "vector";
+    case HEX_TYPE_DICTIONARY:
+        return "dictionary";
+    case HEX_TYPE_SEQUENCE:
+        return "sequence";
+    case HEX_TYPE_NATIVE_SYMBOL:
+        return "native-symbol";
+    case HEX_TYPE_USER_SYMBOL:
+        return "user-symbol";
+    case HEX_TYPE_INVALID:
+        return "invalid";
     default:
         return "unknown";
     }
@@ -1366,9 +2609,11 @@ void hex_debug_item(hex_context_t *ctx, const char *message, hex_item_t *item)
 {
     if (ctx->settings->debugging_enabled)
     {
-        fprintf(stdout, "*** %s: ", message);
-        hex_print_item(stdout, item);
-        fprintf(stdout, "\n");
+        hex_output_write(&ctx->out, "*** ", 4);
+        hex_output_write(&ctx->out, message, strlen(message));
+        hex_output_write(&ctx->out, ": ", 2);
+        hex_output_item(&ctx->out, item, 0);
+        hex_output_char(&ctx->out, '\n');
     }
 }
 
@@ -1405,7 +2650,7 @@ void add_to_stack_trace(hex_context_t *ctx, hex_token_t *token)
 // Print the stack trace
 void print_stack_trace(hex_context_t *ctx)
 {
-    if (!ctx->settings->stack_trace_enabled || !ctx->settings->errors_enabled || ctx->stack_trace->size <= 0)
+    if (!ctx->settings->stack_trace_enabled || !ctx->settings->errors_enabled || ctx->try_frame != NULL || ctx->stack_trace->size <= 0)
     {
         return;
     }
@@ -1471,6 +2716,9 @@ void hex_create_docs(hex_doc_dictionary_t *docs)
     // Control flow
     hex_set_doc(docs, "if", "q q q", "*", "If 'q1' is not $0, executes 'q2', else 'q3'.");
     hex_set_doc(docs, "while", "q1 q2", "*", "While 'q1' is not $0, executes 'q2'.");
+    hex_set_doc(docs, "times", "q i", "*", "Executes 'q' 'i' times.");
+    hex_set_doc(docs, "memo", "q i", "*", "Executes 'q' on 'i' items, or pushes its cached results.");
+    hex_set_doc(docs, "memostats", "", "d", "Returns statistics about the results cached by memo.");
     hex_set_doc(docs, "error", "", "s", "Returns the last error message.");
     hex_set_doc(docs, "try", "q1 q2", "*", "If 'q1' fails, executes 'q2'.");
     hex_set_doc(docs, "throw", "s", "", "Throws error 's'.");
@@ -1483,32 +2731,32 @@ void hex_create_docs(hex_doc_dictionary_t *docs)
 
     // Evaluation
     hex_set_doc(docs, ".", "q", "*", "Pushes each item of 'q' on the stack.");
-    hex_set_doc(docs, "!", "(s1|q) s2", "*", "Evaluates 's1' as a hex program or 'q' as hex bytecode (using s2 as file name).");
+    hex_set_doc(docs, "!", "(s1|q|b) s2", "*", "Evaluates 's1' as a hex program or 'q' or 'b' as hex bytecode (using s2 as file name).");
     hex_set_doc(docs, "'", "a", "q", "Wraps 'a' in a quotation.");
     hex_set_doc(docs, "debug", "q", "*", "Enables debug mode and pushes each item of 'q' on the stack.");
 
     // Arithmetic
-    hex_set_doc(docs, "+", "i1 12", "i", "Adds two integers.");
-    hex_set_doc(docs, "-", "i1 12", "i", "Subtracts 'i2' from 'i1'.");
-    hex_set_doc(docs, "*", "i1 12", "i", "Multiplies two integers.");
+    hex_set_doc(docs, "+", "(i1|v1) (i2|v2)", "(i|v)", "Adds two integers, or vector elements.");
+    hex_set_doc(docs, "-", "(i1|v1) (i2|v2)", "(i|v)", "Subtracts 'i2' from 'i1', or vector elements.");
+    hex_set_doc(docs, "*", "(i1|v1) (i2|v2)", "(i|v)", "Multiplies two integers, or vector elements.");
     hex_set_doc(docs, "/", "i1 12", "i", "Divides 'i1' by 'i2'.");
     hex_set_doc(docs, "%", "i1 12", "i", "Calculates the modulo of 'i1' divided by 'i2'.");
 
     // Bitwise
-    hex_set_doc(docs, "&", "i1 12", "i", "Calculates the bitwise AND of two integers.");
-    hex_set_doc(docs, "|", "i1 12", "i", "Calculates the bitwise OR of two integers.");
-    hex_set_doc(docs, "^", "i1 12", "i", "Calculates the bitwise XOR of two integers.");
+    hex_set_doc(docs, "&", "(i1|v1) (i2|v2)", "(i|v)", "Calculates the bitwise AND of two integers, or vector elements.");
+    hex_set_doc(docs, "|", "(i1|v1) (i2|v2)", "(i|v)", "Calculates the bitwise OR of two integers, or vector elements.");
+    hex_set_doc(docs, "^", "(i1|v1) (i2|v2)", "(i|v)", "Calculates the bitwise XOR of two integers, or vector elements.");
     hex_set_doc(docs, "~", "i", "i", "Calculates the bitwise NOT of an integer.");
-    hex_set_doc(docs, "<<", "i1 12", "i", "Shifts 'i1' by 'i2' bytes to the left.");
-    hex_set_doc(docs, ">>", "i1 12", "i", "Shifts 'i1' by 'i2' bytes to the right.");
+    hex_set_doc(docs, "<<", "(i1|v1) (i2|v2)", "(i|v)", "Shifts 'i1' by 'i2' bytes to the left, or vector elements.");
+    hex_set_doc(docs, ">>", "(i1|v1) (i2|v2)", "(i|v)", "Shifts 'i1' by 'i2' bytes to the right, or vector elements.");
 
     // Comparison
     hex_set_doc(docs, "==", "a1 a2", "i", "Returns $1 if 'a1' == 'a2', $0 otherwise.");
     hex_set_doc(docs, "!=", "a1 a2", "i", "Returns $1 if 'a1' != 'a2', $0 otherwise.");
-    hex_set_doc(docs, ">", "a1 a2", "i", "Returns $1 if 'a1' > 'a2', $0 otherwise.");
-    hex_set_doc(docs, "<", "a1 a2", "i", "Returns $1 if 'a1' < 'a2', $0 otherwise.");
-    hex_set_doc(docs, ">=", "a1 a2", "i", "Returns $1 if 'a1' >= 'a2', $0 otherwise.");
-    hex_set_doc(docs, "<=", "a1 a2", "i", "Returns $1 if 'a1' <= 'a2', $0 otherwise.");
+    hex_set_doc(docs, ">", "a1 a2", "(i|v)", "Returns $1 if 'a1' > 'a2', $0 otherwise (for each element of vectors).");
+    hex_set_doc(docs, "<", "a1 a2", "(i|v)", "Returns $1 if 'a1' < 'a2', $0 otherwise (for each element of vectors).");
+    hex_set_doc(docs, ">=", "a1 a2", "(i|v)", "Returns $1 if 'a1' >= 'a2', $0 otherwise (for each element of vectors).");
+    hex_set_doc(docs, "<=", "a1 a2", "(i|v)", "Returns $1 if 'a1' <= 'a2', $0 otherwise (for each element of vectors).");
 
     // Logical
     hex_set_doc(docs, "and", "i1 i2", "i", "Returns $1 if both 'i1' and 'i2' are not $0.");
@@ -1521,19 +2769,57 @@ void hex_create_docs(hex_doc_dictionary_t *docs)
     hex_set_doc(docs, "str", "i", "s", "Converts a hex integer to a string.");
     hex_set_doc(docs, "dec", "i", "s", "Converts a hex integer to a decimal string.");
     hex_set_doc(docs, "hex", "s", "i", "Converter a decimal string to a hex integer.");
+    hex_set_doc(docs, "ints", "s", "v", "Parses the integers in 's', separated by whitespace.");
     hex_set_doc(docs, "chr", "i", "s", "Converts an integer to a single-character.");
     hex_set_doc(docs, "ord", "s", "i", "Converts a single-character to an integer.");
     hex_set_doc(docs, "type", "a", "s", "Pushes the data type of 'a' on the stack.");
 
     // List
-    hex_set_doc(docs, "cat", "(s1 s2|q1 q2) ", "(s3|q3)", "Concatenates two quotations or two strings.");
-    hex_set_doc(docs, "len", "(s|q)", "i ", "Returns the length of 's' or 'q'.");
-    hex_set_doc(docs, "get", "(s|q)", "a", "Gets the item at position 'i' in 's' or 'q'.");
-    hex_set_doc(docs, "index", "(s a|q a)", "i", "Returns the index of 'a' within 's' or 'q'.");
+    hex_set_doc(docs, "cat", "(s1 s2|q1 q2|b1 b2|v1 v2) ", "(s3|q3|b3|v3)", "Concatenates two quotations, two strings, two buffers or two vectors.");
+    hex_set_doc(docs, "len", "(s|q|b|v|d)", "i ", "Returns the length of 's', 'q', 'b' or 'v', or the number of keys in 'd'.");
+    hex_set_doc(docs, "get", "(s|q|b|v|d)", "a", "Gets the item at position 'i' in 's', 'q', 'b' or 'v', or the value of a key in 'd'.");
+    hex_set_doc(docs, "index", "(s a|q a|b a|v a)", "i", "Returns the index of 'a' within 's', 'q', 'b' or 'v'.");
+    hex_set_doc(docs, "push", "q1 a", "q2", "Appends 'a' to the end of 'q1'.");
+    hex_set_doc(docs, "pop", "q1", "q2", "Removes the last item of 'q1'.");
+    hex_set_doc(docs, "ins", "q1 a i", "q2", "Inserts 'a' before position 'i' within 'q1'.");
+    hex_set_doc(docs, "rem", "q1 i", "q2", "Removes the item at position 'i' of 'q1'.");
+    hex_set_doc(docs, "set", "q1 a i", "q2", "Sets the item at position 'i' of 'q1' to 'a'.");
+    hex_set_doc(docs, "reverse", "q1", "q2", "Reverses the order of the items of 'q1'.");
+    hex_set_doc(docs, "uncons", "q1", "a q2", "Pushes the first item of 'q1' and 'q2' containing the rest of its items.");
+    hex_set_doc(docs, "swons", "q1 a", "q2", "Prepends 'a' to the beginning of 'q1'.");
     hex_set_doc(docs, "join", "q s", "s", "Joins the strings in 'q' using separator 's'.");
     hex_set_doc(docs, "split", "s1 s2", "q", "Splits 's1' using separator 's2'.");
-    hex_set_doc(docs, "sub", "s1 s2 s3", "s", "Replaces 's2' with 's3' within 's1'.");
-    hex_set_doc(docs, "map", "q1 q2", "q3", "Applies 'q2' to 'q1' items and returns results.");
+    hex_set_doc(docs, "sub", "(s1 s2 s3|b1 i1 i2)", "(s|b2)", "Replaces 's2' with 's3' within 's1', or slices 'b1' from 'i1' to 'i2'.");
+    hex_set_doc(docs, "gsub", "s1 s2 s3", "s", "Replaces all occurrences of 's2' with 's3' within 's1'.");
+    hex_set_doc(docs, "fmt", "s1 q", "s2", "Replaces placeholders ${0} to ${9} in 's1' with the strings in 'q', or pushed by its symbols.");
+    hex_set_doc(docs, "begins", "s1 s2", "i", "Returns $1 if 's1' begins with 's2', $0 otherwise.");
+    hex_set_doc(docs, "ends", "s1 s2", "i", "Returns $1 if 's1' ends with 's2', $0 otherwise.");
+    hex_set_doc(docs, "map", "(q1|v1|S1) q2", "(q3|v2|S2)", "Applies 'q2' to 'q1', 'v1' or 'S1' items and returns results.");
+    hex_set_doc(docs, "each", "(q1|S) q2", "*", "Applies 'q2' to each item of 'q1' or 'S'.");
+    hex_set_doc(docs, "filter", "(q1|S1) q2", "(q3|S2)", "Returns the items of 'q1' or 'S1' for which 'q2' pushes a positive integer.");
+    hex_set_doc(docs, "fold", "(q1|S) a1 q2", "a2", "Applies 'q2' to 'a1' and the first item of 'q1' or 'S', then to each result and the next item.");
+    hex_set_doc(docs, "range", "i1 i2", "q", "Returns the integers from 'i1' (included) to 'i2' (excluded).");
+    hex_set_doc(docs, "sort", "(q1|v1)", "(q2|v2)", "Sorts the integers or strings of 'q1', or the integers of 'v1', in ascending order.");
+    hex_set_doc(docs, "sortby", "q1 q2", "q3", "Sorts 'q1' placing an item after the next one when 'q2' pushes $1 for them.");
+
+    // Vector
+    hex_set_doc(docs, "vec", "(q|b)", "v", "Converts a quotation of integers or a buffer to a vector.");
+    hex_set_doc(docs, "sum", "(q|v)", "i", "Returns the sum of the integers in 'q' or 'v'.");
+    hex_set_doc(docs, "min", "(q|v)", "a", "Returns the minimum item of 'q' or 'v'.");
+    hex_set_doc(docs, "max", "(q|v)", "a", "Returns the maximum item of 'q' or 'v'.");
+
+    // Dictionary
+    hex_set_doc(docs, "dict", "q", "d", "Creates a dictionary from a quotation of key/value pairs.");
+    hex_set_doc(docs, "put", "d1 (s|i) a", "d2", "Sets the value of key 's' or 'i' in 'd1' to 'a'.");
+    hex_set_doc(docs, "has", "d (s|i)", "i", "Returns $1 if 'd' contains key 's' or 'i', $0 otherwise.");
+    hex_set_doc(docs, "del", "d1 (s|i)", "d2", "Removes key 's' or 'i' and its value from 'd1'.");
+    hex_set_doc(docs, "keys", "d", "q", "Returns the keys of 'd' in insertion order.");
+
+    // Sequence
+    hex_set_doc(docs, "seq", "i1 i2", "S", "Returns a sequence of the integers from 'i1' (included) to 'i2' (excluded).");
+    hex_set_doc(docs, "lines", "s", "S", "Returns a sequence of the lines of file 's'.");
+    hex_set_doc(docs, "pieces", "s1 s2", "S", "Returns a sequence of the pieces of 's1' split using separator 's2'.");
+    hex_set_doc(docs, "take", "S i", "q", "Returns a quotation of the next 'i' items of 'S' at most.");
 
     // I/O
     hex_set_doc(docs, "puts", "a", "", "Prints 'a' and a new line to standard output.");
@@ -1542,9 +2828,15 @@ void hex_create_docs(hex_doc_dictionary_t *docs)
     hex_set_doc(docs, "gets", "", "s", "Gets a string from standard input.");
 
     // File
-    hex_set_doc(docs, "read", "s1", "(s2|q)", "Returns the contents of the specified file.");
-    hex_set_doc(docs, "write", "(s1|q) s2", "", "Writes 's1' or 'q' to the file 's2'.");
-    hex_set_doc(docs, "append", "(s1|q) s2", "", "Appends 's1' or 'q' to the file 's2'.");
+    hex_set_doc(docs, "read", "s1", "(s2|b)", "Returns the contents of the specified file.");
+    hex_set_doc(docs, "write", "(s1|q|b|v) (s2|i)", "", "Writes 's1', 'q', 'b' or 'v' to the file 's2' or to file handle 'i'.");
+    hex_set_doc(docs, "append", "(s1|q|b|v) s2", "", "Appends 's1', 'q', 'b' or 'v' to the file 's2'.");
+    hex_set_doc(docs, "open", "s1 s2", "i", "Opens file 's1' in mode 's2' (r, w or a) and returns its handle.");
+    hex_set_doc(docs, "close", "i", "", "Closes file handle 'i'.");
+    hex_set_doc(docs, "flush", "i", "", "Writes buffered output of file handle 'i'.");
+    hex_set_doc(docs, "readl", "i1", "(s|i2)", "Reads the next line from file handle 'i1', or pushes 0x0 at its end.");
+    hex_set_doc(docs, "readb", "i1 i2", "b", "Reads up to 'i2' bytes from file handle 'i1'.");
+    hex_set_doc(docs, "eof", "i1", "i2", "Pushes 0x1 if file handle 'i1' is at its end, 0x0 otherwise.");
 
     // Shell
     hex_set_doc(docs, "args", "", "q", "Returns the program arguments.");
@@ -1669,10 +2961,11 @@ hex_token_t *hex_next_token(hex_context_t *ctx, const char **input, hex_file_pos
                 len++;
                 position->column += 2;
             }
-            if (*ptr == '\\' && *(ptr + 1) == '\\')
+            else if (*ptr == '\\' && *(ptr + 1) == '\\')
             {
+                // Kept escaped in the token, expanded when the string item is created
                 ptr += 2;
-                len++;
+                len += 2;
                 position->column += 2;
             }
             else if (*ptr == '"')
@@ -1807,13 +3100,9 @@ int hex_valid_native_symbol(hex_context_t *ctx, const char *symbol)
 
 int32_t hex_parse_integer(const char *hex_str)
 {
-    // Skip the "$" prefix
-    const char *digits = hex_str + 1;
-    // Parse the hexadecimal string as an unsigned 32-bit integer
-    uint32_t unsigned_value = (uint32_t)strtoul(digits, NULL, 16);
-
-    // Cast the unsigned value to a signed 32-bit integer
-    return (int32_t)unsigned_value;
+    // Skip the "$" prefix and parse the digits as an unsigned 32-bit integer
+    const char *end;
+    return (int32_t)hex_parse_hex_digits(hex_str + 1, &end);
 }
 
 // Helper function to clean up quotation parsing resources
@@ -1879,7 +3168,7 @@ int hex_parse_quotation(hex_context_t *ctx, const char **input, hex_item_t *resu
         }
         else if (token->type == HEX_TOKEN_STRING)
         {
-            item = hex_string_item(ctx, token->value);
+            item = hex_string_literal_item(ctx, token->value);
             hex_free_token(token); // Token no longer needed for strings
             token = NULL;          // Prevent double-free in cleanup
         }
@@ -1890,14 +3179,13 @@ int hex_parse_quotation(hex_context_t *ctx, const char **input, hex_item_t *resu
                 item = calloc(1, sizeof(hex_item_t));
                 if (item)
                 {
-                    hex_item_t *value = calloc(1, sizeof(hex_item_t));
-                    if (hex_get_symbol(ctx, token->value, value))
+                    const hex_native_t *native = hex_get_native_symbol(ctx, token->value);
+                    if (native)
                     {
                         item->type = HEX_TYPE_NATIVE_SYMBOL;
-                        item->data.fn_value = value->data.fn_value;
+                        item->data.native_value = native;
                         item->token = token;
                         token = NULL; // Token is now owned by item, prevent double-free
-                        free(value);  // wrapper only
                     }
                     else
                     {
@@ -2004,6 +3292,35 @@ int hex_parse_quotation(hex_context_t *ctx, const char **input, hex_item_t *resu
 #include "hex.h"
 #endif
 
+// Symbol tables can be overlays on top of a parent table: indexes below `base`
+// are resolved by the parent, and only the symbols added on top are stored.
+
+hex_symbol_table_t *hex_symboltable_create(hex_symbol_table_t *parent)
+{
+    hex_symbol_table_t *table = calloc(1, sizeof(hex_symbol_table_t));
+    if (table == NULL)
+    {
+        return NULL;
+    }
+    table->parent = parent;
+    table->base = parent ? parent->count : 0;
+    table->count = table->base;
+    return table;
+}
+
+static char *hex_symboltable_lookup(hex_symbol_table_t *table, uint16_t index)
+{
+    while (table != NULL && index < table->base)
+    {
+        table = table->parent;
+    }
+    if (table == NULL || index >= table->count)
+    {
+        return NULL;
+    }
+    return table->symbols[index - table->base];
+}
+
 int hex_symboltable_set(hex_context_t *ctx, const char *symbol)
 {
     hex_symbol_table_t *table = ctx->symbol_table;
@@ -2019,15 +3336,28 @@ int hex_symboltable_set(hex_context_t *ctx, const char *symbol)
         return -1; // Table full
     }
 
-    for (uint16_t i = 0; i < table->count; ++i)
+    if (hex_symboltable_get_index(ctx, symbol) >= 0)
+    {
+        return 0;
+    }
+
+    size_t delta = table->count - table->base;
+    if (delta >= table->capacity)
     {
-        if (strcmp(table->symbols[i], symbol) == 0)
+        size_t capacity = table->capacity ? table->capacity * 2 : 16;
+        char **symbols = realloc(table->symbols, capacity * sizeof(char *));
+        if (symbols == NULL)
         {
-            return 0;
+            return -1;
         }
+        table->symbols = symbols;
+        table->capacity = capacity;
+    }
+    table->symbols[delta] = strdup(symbol);
+    if (table->symbols[delta] == NULL)
+    {
+        return -1;
     }
-
-    table->symbols[table->count] = strdup(symbol);
     table->count++;
     return 0;
 }
@@ -2037,7 +3367,7 @@ int hex_symboltable_get_index(hex_context_t *ctx, const char *symbol)
     hex_symbol_table_t *table = ctx->symbol_table;
     for (uint16_t i = 0; i < table->count; ++i)
     {
-        if (strcmp(table->symbols[i], symbol) == 0)
+        if (strcmp(hex_symboltable_lookup(table, i), symbol) == 0)
         {
             return i;
         }
@@ -2047,17 +3377,24 @@ int hex_symboltable_get_index(hex_context_t *ctx, const char *symbol)
 
 char *hex_symboltable_get_value(hex_context_t *ctx, uint16_t index)
 {
-    if (index >= ctx->symbol_table->count)
+    return hex_symboltable_lookup(ctx->symbol_table, index);
+}
+
+// Drop all the symbols of a table, including the ones visible from its parent
+static void hex_symboltable_clear(hex_symbol_table_t *table)
+{
+    for (uint16_t i = 0; i < table->count - table->base; ++i)
     {
-        return NULL;
+        free(table->symbols[i]);
+        table->symbols[i] = NULL;
     }
-    return ctx->symbol_table->symbols[index];
+    table->base = 0;
+    table->count = 0;
 }
 
 int hex_decode_bytecode_symboltable(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t total)
 {
-    hex_symbol_table_t *table = ctx->symbol_table;
-    table->count = 0;
+    hex_symboltable_clear(ctx->symbol_table);
 
     for (size_t i = 0; i < total; i++)
     {
@@ -2089,7 +3426,7 @@ uint8_t *hex_encode_bytecode_symboltable(hex_context_t *ctx, size_t *out_size)
 
     for (uint16_t i = 0; i < table->count; ++i)
     {
-        total_size += 1 + strlen(table->symbols[i]);
+        total_size += 1 + strlen(hex_symboltable_lookup(table, i));
     }
 
     uint8_t *bytecode = malloc(total_size);
@@ -2097,9 +3434,10 @@ uint8_t *hex_encode_bytecode_symboltable(hex_context_t *ctx, size_t *out_size)
 
     for (uint16_t i = 0; i < table->count; ++i)
     {
-        size_t len = strlen(table->symbols[i]);
+        const char *symbol = hex_symboltable_lookup(table, i);
+        size_t len = strlen(symbol);
         bytecode[offset++] = (uint8_t)len;
-        memcpy(bytecode + offset, table->symbols[i], len);
+        memcpy(bytecode + offset, symbol, len);
         offset += len;
     }
 
@@ -2107,43 +3445,17 @@ uint8_t *hex_encode_bytecode_symboltable(hex_context_t *ctx, size_t *out_size)
     return bytecode;
 }
 
-hex_symbol_table_t *hex_symboltable_copy(hex_context_t *ctx)
+// Create a sandbox on top of the current symbol table: symbols added to it
+// do not affect the current table, and nothing is copied.
+hex_symbol_table_t *hex_symboltable_overlay(hex_context_t *ctx)
 {
-    hex_symbol_table_t *original = ctx->symbol_table;
-    hex_symbol_table_t *copy = malloc(sizeof(hex_symbol_table_t));
-    if (copy == NULL)
-    {
-        hex_error(ctx, "[symbol table copy] Memory allocation failed");
-        return NULL;
-    }
-
-    copy->symbols = malloc(sizeof(char *) * HEX_MAX_USER_SYMBOLS);
-    if (copy->symbols == NULL)
+    hex_symbol_table_t *overlay = hex_symboltable_create(ctx->symbol_table);
+    if (overlay == NULL)
     {
-        hex_error(ctx, "[symbol table copy] Memory allocation failed for symbols array");
-        free(copy);
+        hex_error(ctx, "[symbol table overlay] Memory allocation failed");
         return NULL;
     }
-
-    copy->count = original->count;
-    for (uint16_t i = 0; i < original->count; ++i)
-    {
-        copy->symbols[i] = strdup(original->symbols[i]);
-        if (copy->symbols[i] == NULL)
-        {
-            hex_error(ctx, "[symbol table copy] Memory allocation failed for symbol");
-            // Free already allocated symbols
-            for (uint16_t j = 0; j < i; ++j)
-            {
-                free(copy->symbols[j]);
-            }
-            free(copy->symbols);
-            free(copy);
-            return NULL;
-        }
-    }
-
-    return copy;
+    return overlay;
 }
 
 void hex_symboltable_destroy(hex_symbol_table_t *table)
@@ -2154,13 +3466,10 @@ void hex_symboltable_destroy(hex_symbol_table_t *table)
     }
     if (table->symbols)
     {
-        for (uint16_t i = 0; i < table->count; ++i)
+        for (uint16_t i = 0; i < table->count - table->base; ++i)
         {
-            if (table->symbols[i])
-            {
-                free(table->symbols[i]);
-                table->symbols[i] = NULL;
-            }
+            free(table->symbols[i]);
+            table->symbols[i] = NULL;
         }
         free(table->symbols);
         table->symbols = NULL;
@@ -2168,226 +3477,907 @@ void hex_symboltable_destroy(hex_symbol_table_t *table)
     free(table);
 }
 
-/* File: src/opcodes.c */
-#line 1 "src/opcodes.c"
+/* File: src/dictionary.c */
+#line 1 "src/dictionary.c"
 #ifndef HEX_H
 #include "hex.h"
 #endif
 
-uint8_t hex_symbol_to_opcode(const char *symbol)
+// Dictionaries map strings and integers to items. Entries are appended in
+// insertion order, so that keys are always listed in the same order, and each
+// used slot of an open addressing table (with linear probing) points to one of
+// them. Deleted entries keep their slot until the table is rebuilt.
+// Dictionaries are reference counted: copying a dictionary item only adds a
+// reference, and natives that modify a dictionary unshare it first.
+
+static size_t hex_dict_hash(const hex_item_t *key)
 {
-    // Native Symbols
-    if (strcmp(symbol, ":") == 0)
+    // FNV-1a over the bytes of the string, or of the integer
+    uint8_t integer[4];
+    const uint8_t *bytes;
+    size_t size;
+    if (key->type == HEX_TYPE_INTEGER)
     {
-        return HEX_OP_STORE;
+        uint32_t value = (uint32_t)key->data.int_value;
+        integer[0] = value & 0xff;
+        integer[1] = (value >> 8) & 0xff;
+        integer[2] = (value >> 16) & 0xff;
+        integer[3] = (value >> 24) & 0xff;
+        bytes = integer;
+        size = 4;
     }
-    else if (strcmp(symbol, "::") == 0)
+    else
     {
-        return HEX_OP_DEFINE;
+        bytes = (const uint8_t *)key->data.str_value;
+        size = key->str_size;
     }
-    else if (strcmp(symbol, "#") == 0)
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++)
     {
-        return HEX_OP_FREE;
+        hash ^= bytes[i];
+        hash *= 16777619u;
     }
-    else if (strcmp(symbol, "symbols") == 0)
+    return hash;
+}
+
+static int hex_dict_same_key(const hex_item_t *a, const hex_item_t *b)
+{
+    if (a->type != b->type)
     {
-        return HEX_OP_SYMBOLS;
+        return 0;
     }
-    else if (strcmp(symbol, "if") == 0)
+    if (a->type == HEX_TYPE_INTEGER)
     {
-        return HEX_OP_IF;
+        return a->data.int_value == b->data.int_value;
     }
-    else if (strcmp(symbol, "while") == 0)
+    return a->str_size == b->str_size && memcmp(a->data.str_value, b->data.str_value, a->str_size) == 0;
+}
+
+// Find the slot of a key, or the empty slot where it can be inserted
+static size_t hex_dict_find_slot(const hex_dict_t *dict, const hex_item_t *key, size_t hash)
+{
+    size_t mask = dict->slot_count - 1;
+    size_t i = hash & mask;
+    while (dict->slots[i] != 0)
     {
-        return HEX_OP_WHILE;
+        const hex_dict_entry_t *entry = &dict->entries[dict->slots[i] - 1];
+        if (entry->key && entry->hash == hash && hex_dict_same_key(entry->key, key))
+        {
+            return i;
+        }
+        i = (i + 1) & mask;
     }
-    else if (strcmp(symbol, "error") == 0)
+    return i;
+}
+
+// Drop deleted entries and rebuild the table, so that it is at most half full
+static int hex_dict_rebuild(hex_dict_t *dict)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < dict->count; i++)
     {
-        return HEX_OP_ERROR;
+        if (dict->entries[i].key)
+        {
+            size++;
+        }
     }
-    else if (strcmp(symbol, "try") == 0)
+    size_t slot_count = HEX_DICT_INITIAL_SLOTS;
+    while ((size + 1) * 2 > slot_count)
     {
-        return HEX_OP_TRY;
+        slot_count *= 2;
     }
-    else if (strcmp(symbol, "throw") == 0)
+    size_t *slots = (size_t *)calloc(slot_count, sizeof(size_t));
+    if (!slots)
     {
-        return HEX_OP_THROW;
+        return 1;
     }
-    else if (strcmp(symbol, "dup") == 0)
+    free(dict->slots);
+    dict->slots = slots;
+    dict->slot_count = slot_count;
+    size_t count = 0;
+    for (size_t i = 0; i < dict->count; i++)
     {
-        return HEX_OP_DUP;
+        if (dict->entries[i].key)
+        {
+            dict->entries[count] = dict->entries[i];
+            dict->slots[hex_dict_find_slot(dict, dict->entries[count].key, dict->entries[count].hash)] = count + 1;
+            count++;
+        }
     }
-    else if (strcmp(symbol, "stack") == 0)
+    dict->count = count;
+    return 0;
+}
+
+hex_dict_t *hex_dict_create(void)
+{
+    hex_dict_t *dict = (hex_dict_t *)calloc(1, sizeof(hex_dict_t));
+    if (dict)
     {
-        return HEX_OP_STACK;
+        dict->refs = 1;
     }
-    else if (strcmp(symbol, "drop") == 0)
+    return dict;
+}
+
+// Release a reference to a dictionary, freeing it and its items with the last one
+void hex_dict_release(hex_context_t *ctx, hex_dict_t *dict)
+{
+    if (!dict || --dict->refs > 0)
     {
-        return HEX_OP_DROP;
+        return;
     }
-    else if (strcmp(symbol, "swap") == 0)
+    for (size_t i = 0; i < dict->count; i++)
     {
-        return HEX_OP_SWAP;
+        if (dict->entries[i].key)
+        {
+            HEX_FREE(ctx, dict->entries[i].key);
+            HEX_FREE(ctx, dict->entries[i].value);
+        }
     }
-    else if (strcmp(symbol, ".") == 0)
+    free(dict->entries);
+    free(dict->slots);
+    free(dict);
+}
+
+// Copy a dictionary and its items
+hex_dict_t *hex_dict_copy(hex_context_t *ctx, const hex_dict_t *dict)
+{
+    hex_dict_t *copy = hex_dict_create();
+    if (!copy)
     {
-        return HEX_OP_I;
+        return NULL;
     }
-    else if (strcmp(symbol, "!") == 0)
+    for (size_t i = 0; i < dict->count; i++)
     {
-        return HEX_OP_EVAL;
+        if (!dict->entries[i].key)
+        {
+            continue;
+        }
+        hex_item_t *key = hex_copy_item(ctx, dict->entries[i].key);
+        hex_item_t *value = key ? hex_copy_item(ctx, dict->entries[i].value) : NULL;
+        if (!value || hex_dict_put(ctx, copy, key, value) != 0)
+        {
+            if (key)
+            {
+                HEX_FREE(ctx, key);
+            }
+            if (value)
+            {
+                HEX_FREE(ctx, value);
+            }
+            hex_dict_release(ctx, copy);
+            return NULL;
+        }
     }
-    else if (strcmp(symbol, "'") == 0)
+    return copy;
+}
+
+// Get a dictionary that can be modified in place by the holder of a reference,
+// copying it if it is shared. Returns NULL if the copy fails.
+hex_dict_t *hex_dict_unshare(hex_context_t *ctx, hex_dict_t *dict)
+{
+    if (dict->refs == 1)
     {
-        return HEX_OP_QUOTE;
+        return dict;
     }
-    else if (strcmp(symbol, "+") == 0)
+    hex_dict_t *copy = hex_dict_copy(ctx, dict);
+    if (copy)
     {
-        return HEX_OP_ADD;
+        dict->refs--;
     }
-    else if (strcmp(symbol, "-") == 0)
+    return copy;
+}
+
+// Get the value of a key, still owned by the dictionary, or NULL if the key is not found
+hex_item_t *hex_dict_get(const hex_dict_t *dict, const hex_item_t *key)
+{
+    if (dict->slot_count == 0)
     {
-        return HEX_OP_SUBTRACT;
+        return NULL;
     }
-    else if (strcmp(symbol, "*") == 0)
-    {
-        return HEX_OP_MULTIPLY;
-    }
-    else if (strcmp(symbol, "/") == 0)
-    {
-        return HEX_OP_DIVIDE;
-    }
-    else if (strcmp(symbol, "%") == 0)
-    {
-        return HEX_OP_MOD;
-    }
-    else if (strcmp(symbol, "&") == 0)
-    {
-        return HEX_OP_BITAND;
-    }
-    else if (strcmp(symbol, "|") == 0)
+    size_t slot = hex_dict_find_slot(dict, key, hex_dict_hash(key));
+    return dict->slots[slot] ? dict->entries[dict->slots[slot] - 1].value : NULL;
+}
+
+// Set the value of a key, taking ownership of both items if successful
+int hex_dict_put(hex_context_t *ctx, hex_dict_t *dict, hex_item_t *key, hex_item_t *value)
+{
+    size_t hash = hex_dict_hash(key);
+    if (dict->slot_count > 0)
     {
-        return HEX_OP_BITOR;
+        size_t slot = hex_dict_find_slot(dict, key, hash);
+        if (dict->slots[slot])
+        {
+            hex_dict_entry_t *entry = &dict->entries[dict->slots[slot] - 1];
+            HEX_FREE(ctx, entry->value);
+            entry->value = value;
+            HEX_FREE(ctx, key);
+            return 0;
+        }
     }
-    else if (strcmp(symbol, "^") == 0)
+    if ((dict->count + 1) * 4 > dict->slot_count * 3 && hex_dict_rebuild(dict) != 0)
     {
-        return HEX_OP_BITXOR;
+        return 1;
     }
-    else if (strcmp(symbol, "~") == 0)
+    if (dict->count == dict->capacity)
     {
-        return HEX_OP_BITNOT;
+        size_t capacity = dict->capacity > 0 ? dict->capacity * 2 : HEX_DICT_INITIAL_SLOTS;
+        hex_dict_entry_t *entries = (hex_dict_entry_t *)realloc(dict->entries, capacity * sizeof(hex_dict_entry_t));
+        if (!entries)
+        {
+            return 1;
+        }
+        dict->entries = entries;
+        dict->capacity = capacity;
     }
-    else if (strcmp(symbol, "<<") == 0)
+    dict->entries[dict->count].hash = hash;
+    dict->entries[dict->count].key = key;
+    dict->entries[dict->count].value = value;
+    dict->slots[hex_dict_find_slot(dict, key, hash)] = dict->count + 1;
+    dict->count++;
+    dict->size++;
+    return 0;
+}
+
+// Delete a key and its value; returns 1 if the key was found, 0 otherwise
+int hex_dict_delete(hex_context_t *ctx, hex_dict_t *dict, const hex_item_t *key)
+{
+    if (dict->slot_count == 0)
     {
-        return HEX_OP_SHL;
+        return 0;
     }
-    else if (strcmp(symbol, ">>") == 0)
+    size_t slot = hex_dict_find_slot(dict, key, hex_dict_hash(key));
+    if (!dict->slots[slot])
     {
-        return HEX_OP_SHR;
+        return 0;
     }
-    else if (strcmp(symbol, "==") == 0)
+    hex_dict_entry_t *entry = &dict->entries[dict->slots[slot] - 1];
+    HEX_FREE(ctx, entry->key);
+    HEX_FREE(ctx, entry->value);
+    entry->key = NULL;
+    entry->value = NULL;
+    dict->size--;
+    return 1;
+}
+
+/* File: src/sequence.c */
+#line 1 "src/sequence.c"
+#ifndef HEX_H
+#include "hex.h"
+#endif
+
+// Sequences are created by natives and advanced by them, one item at a time (see
+// the sequence symbols). This file manages their storage: a sequence keeps the
+// resources it reads from, like an open file or a string to split, until it is
+// released by the last item that references it.
+
+hex_seq_t *hex_seq_create(hex_seq_kind_t kind)
+{
+    hex_seq_t *seq = (hex_seq_t *)calloc(1, sizeof(hex_seq_t));
+    if (seq)
     {
-        return HEX_OP_EQUAL;
+        seq->refs = 1;
+        seq->kind = kind;
     }
-    else if (strcmp(symbol, "!=") == 0)
+    return seq;
+}
+
+// Release a reference to a sequence, freeing it and its resources with the last one
+void hex_seq_release(hex_context_t *ctx, hex_seq_t *seq)
+{
+    if (!seq || --seq->refs > 0)
     {
-        return HEX_OP_NOTEQUAL;
+        return;
     }
-    else if (strcmp(symbol, ">") == 0)
+    if (seq->file)
     {
-        return HEX_OP_GREATER;
+        fclose(seq->file);
     }
-    else if (strcmp(symbol, "<") == 0)
+    HEX_FREE(ctx, seq->string);
+    HEX_FREE(ctx, seq->separator);
+    HEX_FREE(ctx, seq->action);
+    hex_seq_release(ctx, seq->source);
+    free(seq);
+}
+
+/* File: src/output.c */
+#line 1 "src/output.c"
+#ifndef HEX_H
+#include "hex.h"
+#endif
+
+// Output written by puts, print and warn is collected in a buffer per stream and
+// written with a single fwrite when the buffer is full or flushed: explicitly,
+// before reading from stdin, before running other programs, before errors are
+// printed and when the program exits. Output to a terminal is also flushed at
+// each newline.
+
+void hex_output_init(hex_output_t *out, FILE *stream)
+{
+    out->stream = stream;
+    out->size = 0;
+    out->line_buffered = isatty(fileno(stream));
+}
+
+// Write the buffered output to the stream, without flushing the stream itself
+static int hex_output_drain(hex_output_t *out)
+{
+    size_t size = out->size;
+    out->size = 0;
+    return size > 0 && fwrite(out->data, 1, size, out->stream) != size;
+}
+
+int hex_output_flush(hex_output_t *out)
+{
+    int result = hex_output_drain(out);
+    if (fflush(out->stream) != 0)
     {
-        return HEX_OP_LESS;
+        result = 1;
     }
-    else if (strcmp(symbol, ">=") == 0)
+    return result;
+}
+
+void hex_output_write(hex_output_t *out, const char *data, size_t size)
+{
+    if (out->size + size > HEX_OUTPUT_BUFFER_SIZE)
     {
-        return HEX_OP_GREATEREQUAL;
+        hex_output_drain(out);
     }
-    else if (strcmp(symbol, "<=") == 0)
+    if (size >= HEX_OUTPUT_BUFFER_SIZE)
     {
-        return HEX_OP_LESSEQUAL;
+        fwrite(data, 1, size, out->stream);
     }
-    else if (strcmp(symbol, "and") == 0)
+    else
     {
-        return HEX_OP_AND;
+        memcpy(out->data + out->size, data, size);
+        out->size += size;
     }
-    else if (strcmp(symbol, "or") == 0)
+    if (out->line_buffered && memchr(data, '\n', size))
     {
-        return HEX_OP_OR;
+        hex_output_flush(out);
     }
-    else if (strcmp(symbol, "not") == 0)
+}
+
+void hex_output_char(hex_output_t *out, char c)
+{
+    if (out->size == HEX_OUTPUT_BUFFER_SIZE)
     {
-        return HEX_OP_NOT;
+        hex_output_drain(out);
     }
-    else if (strcmp(symbol, "xor") == 0)
+    out->data[out->size++] = c;
+    if (c == '\n' && out->line_buffered)
     {
-        return HEX_OP_XOR;
+        hex_output_flush(out);
     }
-    else if (strcmp(symbol, "int") == 0)
+}
+
+// Write an integer in hex notation ($ followed by hexadecimal digits, like printf's %x)
+void hex_output_integer(hex_output_t *out, int32_t value)
+{
+    char text[HEX_INTEGER_TEXT_SIZE];
+    char *start = hex_format_hex((uint32_t)value, text + sizeof(text));
+    *--start = '$';
+    hex_output_write(out, start, text + sizeof(text) - start);
+}
+
+// Write a string as a string literal, copying the runs of characters that do not
+// need to be escaped in bulk
+void hex_output_string(hex_output_t *out, const char *value, size_t size)
+{
+    hex_output_char(out, '"');
+    size_t i = 0;
+    while (i < size)
     {
-        return HEX_OP_INT;
+        size_t run = hex_plain_span(value + i, size - i);
+        hex_output_write(out, value + i, run);
+        i += run;
+        if (i == size)
+        {
+            break;
+        }
+        const char *escape = NULL;
+        switch (value[i])
+        {
+        case '\n':
+            escape = "\\n";
+            break;
+        case '\t':
+            escape = "\\t";
+            break;
+        case '\r':
+            escape = "\\r";
+            break;
+        case '\b':
+            escape = "\\b";
+            break;
+        case '\f':
+            escape = "\\f";
+            break;
+        case '\v':
+            escape = "\\v";
+            break;
+        case '\\':
+            escape = "\\\\";
+            break;
+        case '\"':
+            escape = "\\\"";
+            break;
+        }
+        if (escape)
+        {
+            hex_output_write(out, escape, 2);
+        }
+        else
+        {
+            hex_output_char(out, value[i]); // Other control characters and non-ASCII bytes
+        }
+        i++;
     }
-    else if (strcmp(symbol, "str") == 0)
+    hex_output_char(out, '"');
+}
+
+// Write an item in its literal form; if raw is set, a string is written as is
+void hex_output_item(hex_output_t *out, hex_item_t *item, int raw)
+{
+    switch (item->type)
     {
-        return HEX_OP_STR;
-    }
-    else if (strcmp(symbol, "dec") == 0)
+    case HEX_TYPE_INTEGER:
+        hex_output_integer(out, item->data.int_value);
+        break;
+
+    case HEX_TYPE_STRING:
+        if (raw)
+        {
+            hex_output_write(out, item->data.str_value, item->str_size);
+        }
+        else
+        {
+            hex_output_string(out, item->data.str_value, item->str_size);
+        }
+        break;
+
+    case HEX_TYPE_USER_SYMBOL:
+    case HEX_TYPE_NATIVE_SYMBOL:
+        hex_output_write(out, item->token->value, strlen(item->token->value));
+        break;
+
+    case HEX_TYPE_QUOTATION:
+        hex_output_char(out, '(');
+        for (size_t i = 0; i < item->quotation_size; i++)
+        {
+            if (i > 0)
+            {
+                hex_output_char(out, ' ');
+            }
+            hex_output_item(out, item->data.quotation_value[i], 0);
+        }
+        hex_output_char(out, ')');
+        break;
+
+    case HEX_TYPE_BUFFER:
+        // Buffers are written like a quotation of their bytes
+        hex_output_char(out, '(');
+        for (size_t i = 0; i < item->str_size; i++)
+        {
+            if (i > 0)
+            {
+                hex_output_char(out, ' ');
+            }
+            hex_output_integer(out, item->data.buffer_value[i]);
+        }
+        hex_output_char(out, ')');
+        break;
+
+    case HEX_TYPE_VECTOR:
+        // Vectors are written like a quotation of their integers
+        hex_output_char(out, '(');
+        for (size_t i = 0; i < item->quotation_size; i++)
+        {
+            if (i > 0)
+            {
+                hex_output_char(out, ' ');
+            }
+            hex_output_integer(out, item->data.vector_value[i]);
+        }
+        hex_output_char(out, ')');
+        break;
+
+    case HEX_TYPE_DICTIONARY:
     {
-        return HEX_OP_DEC;
+        // Dictionaries are written like a quotation of key and value pairs, in insertion order
+        const hex_dict_t *dict = item->data.dict_value;
+        int first = 1;
+        hex_output_char(out, '(');
+        for (size_t i = 0; i < dict->count; i++)
+        {
+            if (!dict->entries[i].key)
+            {
+                continue;
+            }
+            hex_output_write(out, first ? "(" : " (", first ? 1 : 2);
+            hex_output_item(out, dict->entries[i].key, 0);
+            hex_output_char(out, ' ');
+            hex_output_item(out, dict->entries[i].value, 0);
+            hex_output_char(out, ')');
+            first = 0;
+        }
+        hex_output_char(out, ')');
+        break;
     }
-    else if (strcmp(symbol, "hex") == 0)
+
+    case HEX_TYPE_SEQUENCE:
+        hex_output_write(out, "<sequence>", 10);
+        break;
+
+    case HEX_TYPE_INVALID:
+        hex_output_write(out, "<invalid>", 9);
+        break;
+
+    default:
     {
-        return HEX_OP_HEX;
+        char text[32];
+        int size = snprintf(text, sizeof(text), "<unknown:%d>", item->type);
+        hex_output_write(out, text, (size_t)size);
+        break;
     }
-    else if (strcmp(symbol, "ord") == 0)
-    {
-        return HEX_OP_ORD;
     }
-    else if (strcmp(symbol, "chr") == 0)
+}
+
+// Flush the standard output and error buffers of a context
+void hex_flush_output(hex_context_t *ctx)
+{
+    hex_output_flush(&ctx->out);
+    hex_output_flush(&ctx->err);
+}
+
+/* File: src/memo.c */
+#line 1 "src/memo.c"
+#ifndef HEX_H
+#include "hex.h"
+#endif
+
+// Results of the quotations applied by memo are kept in a hash table with chained
+// buckets, keyed by a quotation of the inputs followed by the quotation applied.
+// Entries are also linked from the most to the least recently used, so that the
+// least recently used one is evicted once the table holds HEX_MEMO_SIZE of them.
+
+static void hex_memo_unlink(hex_memo_t *memo, hex_memo_entry_t *entry)
+{
+    if (entry->newer)
     {
-        return HEX_OP_CHR;
+        entry->newer->older = entry->older;
     }
-    else if (strcmp(symbol, "type") == 0)
+    else
     {
-        return HEX_OP_TYPE;
+        memo->newest = entry->older;
     }
-    else if (strcmp(symbol, "cat") == 0)
+    if (entry->older)
     {
-        return HEX_OP_CAT;
+        entry->older->newer = entry->newer;
     }
-    else if (strcmp(symbol, "len") == 0)
+    else
     {
-        return HEX_OP_LEN;
+        memo->oldest = entry->newer;
     }
-    else if (strcmp(symbol, "get") == 0)
+    entry->newer = NULL;
+    entry->older = NULL;
+}
+
+static void hex_memo_link(hex_memo_t *memo, hex_memo_entry_t *entry)
+{
+    entry->older = memo->newest;
+    if (memo->newest)
     {
-        return HEX_OP_GET;
+        memo->newest->newer = entry;
     }
-    else if (strcmp(symbol, "index") == 0)
+    memo->newest = entry;
+    if (!memo->oldest)
     {
-        return HEX_OP_INDEX;
+        memo->oldest = entry;
     }
-    else if (strcmp(symbol, "join") == 0)
+}
+
+static void hex_memo_free_entry(hex_context_t *ctx, hex_memo_entry_t *entry)
+{
+    HEX_FREE(ctx, entry->key);
+    HEX_FREE(ctx, entry->outputs);
+    free(entry);
+}
+
+// Get the outputs kept for a key, still owned by the cache, or NULL if there are none
+hex_item_t *hex_memo_get(hex_context_t *ctx, hex_item_t *key, size_t hash)
+{
+    hex_memo_t *memo = &ctx->memo;
+    if (memo->buckets)
     {
-        return HEX_OP_JOIN;
+        for (hex_memo_entry_t *entry = memo->buckets[hash & (HEX_MEMO_BUCKETS - 1)]; entry; entry = entry->next)
+        {
+            if (entry->hash == hash && hex_equal(entry->key, key))
+            {
+                hex_memo_unlink(memo, entry);
+                hex_memo_link(memo, entry);
+                memo->hits++;
+                return entry->outputs;
+            }
+        }
     }
-    else if (strcmp(symbol, "split") == 0)
+    memo->misses++;
+    return NULL;
+}
+
+// Keep the outputs of a key, taking ownership of both items if successful
+int hex_memo_put(hex_context_t *ctx, hex_item_t *key, size_t hash, hex_item_t *outputs)
+{
+    hex_memo_t *memo = &ctx->memo;
+    if (!memo->buckets)
     {
-        return HEX_OP_SPLIT;
+        memo->buckets = (hex_memo_entry_t **)calloc(HEX_MEMO_BUCKETS, sizeof(hex_memo_entry_t *));
+        if (!memo->buckets)
+        {
+            return 1;
+        }
     }
-    else if (strcmp(symbol, "sub") == 0)
+    hex_memo_entry_t *entry = (hex_memo_entry_t *)calloc(1, sizeof(hex_memo_entry_t));
+    if (!entry)
     {
-        return HEX_OP_SUB;
+        return 1;
     }
-    else if (strcmp(symbol, "map") == 0)
+    if (memo->size == HEX_MEMO_SIZE)
     {
-        return HEX_OP_MAP;
+        hex_memo_entry_t *oldest = memo->oldest;
+        hex_memo_entry_t **link = &memo->buckets[oldest->hash & (HEX_MEMO_BUCKETS - 1)];
+        while (*link != oldest)
+        {
+            link = &(*link)->next;
+        }
+        *link = oldest->next;
+        hex_memo_unlink(memo, oldest);
+        hex_memo_free_entry(ctx, oldest);
+        memo->size--;
+        memo->evictions++;
     }
-    else if (strcmp(symbol, "puts") == 0)
+    entry->hash = hash;
+    entry->key = key;
+    entry->outputs = outputs;
+    entry->next = memo->buckets[hash & (HEX_MEMO_BUCKETS - 1)];
+    memo->buckets[hash & (HEX_MEMO_BUCKETS - 1)] = entry;
+    hex_memo_link(memo, entry);
+    memo->size++;
+    return 0;
+}
+
+void hex_memo_destroy(hex_context_t *ctx)
+{
+    hex_memo_t *memo = &ctx->memo;
+    while (memo->oldest)
     {
-        return HEX_OP_PUTS;
+        hex_memo_entry_t *entry = memo->oldest;
+        hex_memo_unlink(memo, entry);
+        hex_memo_free_entry(ctx, entry);
+    }
+    free(memo->buckets);
+    memset(memo, 0, sizeof(hex_memo_t));
+}
+
+/* File: src/opcodes.c */
+#line 1 "src/opcodes.c"
+#ifndef HEX_H
+#include "hex.h"
+#endif
+
+uint8_t hex_symbol_to_opcode(const char *symbol)
+{
+    // Native Symbols
+    if (strcmp(symbol, ":") == 0)
+    {
+        return HEX_OP_STORE;
+    }
+    else if (strcmp(symbol, "::") == 0)
+    {
+        return HEX_OP_DEFINE;
+    }
+    else if (strcmp(symbol, "#") == 0)
+    {
+        return HEX_OP_FREE;
+    }
+    else if (strcmp(symbol, "symbols") == 0)
+    {
+        return HEX_OP_SYMBOLS;
+    }
+    else if (strcmp(symbol, "if") == 0)
+    {
+        return HEX_OP_IF;
+    }
+    else if (strcmp(symbol, "while") == 0)
+    {
+        return HEX_OP_WHILE;
+    }
+    else if (strcmp(symbol, "error") == 0)
+    {
+        return HEX_OP_ERROR;
+    }
+    else if (strcmp(symbol, "try") == 0)
+    {
+        return HEX_OP_TRY;
+    }
+    else if (strcmp(symbol, "throw") == 0)
+    {
+        return HEX_OP_THROW;
+    }
+    else if (strcmp(symbol, "dup") == 0)
+    {
+        return HEX_OP_DUP;
+    }
+    else if (strcmp(symbol, "stack") == 0)
+    {
+        return HEX_OP_STACK;
+    }
+    else if (strcmp(symbol, "drop") == 0)
+    {
+        return HEX_OP_DROP;
+    }
+    else if (strcmp(symbol, "swap") == 0)
+    {
+        return HEX_OP_SWAP;
+    }
+    else if (strcmp(symbol, ".") == 0)
+    {
+        return HEX_OP_I;
+    }
+    else if (strcmp(symbol, "!") == 0)
+    {
+        return HEX_OP_EVAL;
+    }
+    else if (strcmp(symbol, "'") == 0)
+    {
+        return HEX_OP_QUOTE;
+    }
+    else if (strcmp(symbol, "+") == 0)
+    {
+        return HEX_OP_ADD;
+    }
+    else if (strcmp(symbol, "-") == 0)
+    {
+        return HEX_OP_SUBTRACT;
+    }
+    else if (strcmp(symbol, "*") == 0)
+    {
+        return HEX_OP_MULTIPLY;
+    }
+    else if (strcmp(symbol, "/") == 0)
+    {
+        return HEX_OP_DIVIDE;
+    }
+    else if (strcmp(symbol, "%") == 0)
+    {
+        return HEX_OP_MOD;
+    }
+    else if (strcmp(symbol, "&") == 0)
+    {
+        return HEX_OP_BITAND;
+    }
+    else if (strcmp(symbol, "|") == 0)
+    {
+        return HEX_OP_BITOR;
+    }
+    else if (strcmp(symbol, "^") == 0)
+    {
+        return HEX_OP_BITXOR;
+    }
+    else if (strcmp(symbol, "~") == 0)
+    {
+        return HEX_OP_BITNOT;
+    }
+    else if (strcmp(symbol, "<<") == 0)
+    {
+        return HEX_OP_SHL;
+    }
+    else if (strcmp(symbol, ">>") == 0)
+    {
+        return HEX_OP_SHR;
+    }
+    else if (strcmp(symbol, "==") == 0)
+    {
+        return HEX_OP_EQUAL;
+    }
+    else if (strcmp(symbol, "!=") == 0)
+    {
+        return HEX_OP_NOTEQUAL;
+    }
+    else if (strcmp(symbol, ">") == 0)
+    {
+        return HEX_OP_GREATER;
+    }
+    else if (strcmp(symbol, "<") == 0)
+    {
+        return HEX_OP_LESS;
+    }
+    else if (strcmp(symbol, ">=") == 0)
+    {
+        return HEX_OP_GREATEREQUAL;
+    }
+    else if (strcmp(symbol, "<=") == 0)
+    {
+        return HEX_OP_LESSEQUAL;
+    }
+    else if (strcmp(symbol, "and") == 0)
+    {
+        return HEX_OP_AND;
+    }
+    else if (strcmp(symbol, "or") == 0)
+    {
+        return HEX_OP_OR;
+    }
+    else if (strcmp(symbol, "not") == 0)
+    {
+        return HEX_OP_NOT;
+    }
+    else if (strcmp(symbol, "xor") == 0)
+    {
+        return HEX_OP_XOR;
+    }
+    else if (strcmp(symbol, "int") == 0)
+    {
+        return HEX_OP_INT;
+    }
+    else if (strcmp(symbol, "str") == 0)
+    {
+        return HEX_OP_STR;
+    }
+    else if (strcmp(symbol, "dec") == 0)
+    {
+        return HEX_OP_DEC;
+    }
+    else if (strcmp(symbol, "hex") == 0)
+    {
+        return HEX_OP_HEX;
+    }
+    else if (strcmp(symbol, "ord") == 0)
+    {
+        return HEX_OP_ORD;
+    }
+    else if (strcmp(symbol, "chr") == 0)
+    {
+        return HEX_OP_CHR;
+    }
+    else if (strcmp(symbol, "type") == 0)
+    {
+        return HEX_OP_TYPE;
+    }
+    else if (strcmp(symbol, "cat") == 0)
+    {
+        return HEX_OP_CAT;
+    }
+    else if (strcmp(symbol, "len") == 0)
+    {
+        return HEX_OP_LEN;
+    }
+    else if (strcmp(symbol, "get") == 0)
+    {
+        return HEX_OP_GET;
+    }
+    else if (strcmp(symbol, "index") == 0)
+    {
+        return HEX_OP_INDEX;
+    }
+    else if (strcmp(symbol, "join") == 0)
+    {
+        return HEX_OP_JOIN;
+    }
+    else if (strcmp(symbol, "split") == 0)
+    {
+        return HEX_OP_SPLIT;
+    }
+    else if (strcmp(symbol, "sub") == 0)
+    {
+        return HEX_OP_SUB;
+    }
+    else if (strcmp(symbol, "map") == 0)
+    {
+        return HEX_OP_MAP;
+    }
+    else if (strcmp(symbol, "puts") == 0)
+    {
+        return HEX_OP_PUTS;
     }
     else if (strcmp(symbol, "warn") == 0)
     {
@@ -2433,40 +4423,204 @@ uint8_t hex_symbol_to_opcode(const char *symbol)
     {
         return HEX_OP_TIMESTAMP;
     }
-    return 0;
-}
-
-const char *hex_opcode_to_symbol(uint8_t opcode)
-{
-    switch (opcode)
+    else if (strcmp(symbol, "gsub") == 0)
     {
-    case HEX_OP_STORE:
-        return ":";
-    case HEX_OP_DEFINE:
-        return "::";
-    case HEX_OP_FREE:
-        return "#";
-    case HEX_OP_SYMBOLS:
-        return "symbols";
-    case HEX_OP_IF:
-        return "if";
-    case HEX_OP_WHILE:
-        return "while";
-    case HEX_OP_ERROR:
-        return "error";
-    case HEX_OP_TRY:
-        return "try";
-    case HEX_OP_THROW:
-        return "throw";
-    case HEX_OP_DUP:
-        return "dup";
-    case HEX_OP_STACK:
-        return "stack";
-    case HEX_OP_DROP:
-        return "drop";
-    case HEX_OP_SWAP:
-        return "swap";
-    case HEX_OP_I:
+        return HEX_OP_GSUB;
+    }
+    else if (strcmp(symbol, "fmt") == 0)
+    {
+        return HEX_OP_FMT;
+    }
+    else if (strcmp(symbol, "begins") == 0)
+    {
+        return HEX_OP_BEGINS;
+    }
+    else if (strcmp(symbol, "ends") == 0)
+    {
+        return HEX_OP_ENDS;
+    }
+    else if (strcmp(symbol, "vec") == 0)
+    {
+        return HEX_OP_VEC;
+    }
+    else if (strcmp(symbol, "sum") == 0)
+    {
+        return HEX_OP_SUM;
+    }
+    else if (strcmp(symbol, "min") == 0)
+    {
+        return HEX_OP_MIN;
+    }
+    else if (strcmp(symbol, "max") == 0)
+    {
+        return HEX_OP_MAX;
+    }
+    else if (strcmp(symbol, "dict") == 0)
+    {
+        return HEX_OP_DICT;
+    }
+    else if (strcmp(symbol, "put") == 0)
+    {
+        return HEX_OP_PUT;
+    }
+    else if (strcmp(symbol, "has") == 0)
+    {
+        return HEX_OP_HAS;
+    }
+    else if (strcmp(symbol, "del") == 0)
+    {
+        return HEX_OP_DEL;
+    }
+    else if (strcmp(symbol, "keys") == 0)
+    {
+        return HEX_OP_KEYS;
+    }
+    else if (strcmp(symbol, "sort") == 0)
+    {
+        return HEX_OP_SORT;
+    }
+    else if (strcmp(symbol, "sortby") == 0)
+    {
+        return HEX_OP_SORTBY;
+    }
+    else if (strcmp(symbol, "each") == 0)
+    {
+        return HEX_OP_EACH;
+    }
+    else if (strcmp(symbol, "filter") == 0)
+    {
+        return HEX_OP_FILTER;
+    }
+    else if (strcmp(symbol, "fold") == 0)
+    {
+        return HEX_OP_FOLD;
+    }
+    else if (strcmp(symbol, "times") == 0)
+    {
+        return HEX_OP_TIMES;
+    }
+    else if (strcmp(symbol, "range") == 0)
+    {
+        return HEX_OP_RANGE;
+    }
+    else if (strcmp(symbol, "push") == 0)
+    {
+        return HEX_OP_PUSH;
+    }
+    else if (strcmp(symbol, "pop") == 0)
+    {
+        return HEX_OP_POP;
+    }
+    else if (strcmp(symbol, "ins") == 0)
+    {
+        return HEX_OP_INS;
+    }
+    else if (strcmp(symbol, "rem") == 0)
+    {
+        return HEX_OP_REM;
+    }
+    else if (strcmp(symbol, "set") == 0)
+    {
+        return HEX_OP_SET;
+    }
+    else if (strcmp(symbol, "reverse") == 0)
+    {
+        return HEX_OP_REVERSE;
+    }
+    else if (strcmp(symbol, "uncons") == 0)
+    {
+        return HEX_OP_UNCONS;
+    }
+    else if (strcmp(symbol, "swons") == 0)
+    {
+        return HEX_OP_SWONS;
+    }
+    else if (strcmp(symbol, "seq") == 0)
+    {
+        return HEX_OP_SEQ;
+    }
+    else if (strcmp(symbol, "lines") == 0)
+    {
+        return HEX_OP_LINES;
+    }
+    else if (strcmp(symbol, "pieces") == 0)
+    {
+        return HEX_OP_PIECES;
+    }
+    else if (strcmp(symbol, "take") == 0)
+    {
+        return HEX_OP_TAKE;
+    }
+    else if (strcmp(symbol, "open") == 0)
+    {
+        return HEX_OP_OPEN;
+    }
+    else if (strcmp(symbol, "close") == 0)
+    {
+        return HEX_OP_CLOSE;
+    }
+    else if (strcmp(symbol, "flush") == 0)
+    {
+        return HEX_OP_FLUSH;
+    }
+    else if (strcmp(symbol, "readl") == 0)
+    {
+        return HEX_OP_READL;
+    }
+    else if (strcmp(symbol, "readb") == 0)
+    {
+        return HEX_OP_READB;
+    }
+    else if (strcmp(symbol, "eof") == 0)
+    {
+        return HEX_OP_EOF;
+    }
+    else if (strcmp(symbol, "ints") == 0)
+    {
+        return HEX_OP_INTS;
+    }
+    else if (strcmp(symbol, "memo") == 0)
+    {
+        return HEX_OP_MEMO;
+    }
+    else if (strcmp(symbol, "memostats") == 0)
+    {
+        return HEX_OP_MEMOSTATS;
+    }
+    return 0;
+}
+
+const char *hex_opcode_to_symbol(uint8_t opcode)
+{
+    switch (opcode)
+    {
+    case HEX_OP_STORE:
+        return ":";
+    case HEX_OP_DEFINE:
+        return "::";
+    case HEX_OP_FREE:
+        return "#";
+    case HEX_OP_SYMBOLS:
+        return "symbols";
+    case HEX_OP_IF:
+        return "if";
+    case HEX_OP_WHILE:
+        return "while";
+    case HEX_OP_ERROR:
+        return "error";
+    case HEX_OP_TRY:
+        return "try";
+    case HEX_OP_THROW:
+        return "throw";
+    case HEX_OP_DUP:
+        return "dup";
+    case HEX_OP_STACK:
+        return "stack";
+    case HEX_OP_DROP:
+        return "drop";
+    case HEX_OP_SWAP:
+        return "swap";
+    case HEX_OP_I:
         return ".";
     case HEX_OP_EVAL:
         return "!";
@@ -2568,6 +4722,88 @@ const char *hex_opcode_to_symbol(uint8_t opcode)
         return "run";
     case HEX_OP_TIMESTAMP:
         return "timestamp";
+    case HEX_OP_GSUB:
+        return "gsub";
+    case HEX_OP_FMT:
+        return "fmt";
+    case HEX_OP_BEGINS:
+        return "begins";
+    case HEX_OP_ENDS:
+        return "ends";
+    case HEX_OP_VEC:
+        return "vec";
+    case HEX_OP_SUM:
+        return "sum";
+    case HEX_OP_MIN:
+        return "min";
+    case HEX_OP_MAX:
+        return "max";
+    case HEX_OP_DICT:
+        return "dict";
+    case HEX_OP_PUT:
+        return "put";
+    case HEX_OP_HAS:
+        return "has";
+    case HEX_OP_DEL:
+        return "del";
+    case HEX_OP_KEYS:
+        return "keys";
+    case HEX_OP_SORT:
+        return "sort";
+    case HEX_OP_SORTBY:
+        return "sortby";
+    case HEX_OP_EACH:
+        return "each";
+    case HEX_OP_FILTER:
+        return "filter";
+    case HEX_OP_FOLD:
+        return "fold";
+    case HEX_OP_TIMES:
+        return "times";
+    case HEX_OP_RANGE:
+        return "range";
+    case HEX_OP_PUSH:
+        return "push";
+    case HEX_OP_POP:
+        return "pop";
+    case HEX_OP_INS:
+        return "ins";
+    case HEX_OP_REM:
+        return "rem";
+    case HEX_OP_SET:
+        return "set";
+    case HEX_OP_REVERSE:
+        return "reverse";
+    case HEX_OP_UNCONS:
+        return "uncons";
+    case HEX_OP_SWONS:
+        return "swons";
+    case HEX_OP_SEQ:
+        return "seq";
+    case HEX_OP_LINES:
+        return "lines";
+    case HEX_OP_PIECES:
+        return "pieces";
+    case HEX_OP_TAKE:
+        return "take";
+    case HEX_OP_OPEN:
+        return "open";
+    case HEX_OP_CLOSE:
+        return "close";
+    case HEX_OP_FLUSH:
+        return "flush";
+    case HEX_OP_READL:
+        return "readl";
+    case HEX_OP_READB:
+        return "readb";
+    case HEX_OP_EOF:
+        return "eof";
+    case HEX_OP_INTS:
+        return "ints";
+    case HEX_OP_MEMO:
+        return "memo";
+    case HEX_OP_MEMOSTATS:
+        return "memostats";
     default:
         return NULL;
     }
@@ -2635,14 +4871,7 @@ int hex_bytecode_integer(hex_context_t *ctx, uint8_t **bytecode, size_t *size, s
 
 int hex_bytecode_string(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t *capacity, const char *value)
 {
-    char *str = hex_process_string(value);
-    if (!str)
-    {
-        hex_error(ctx, "[add bytecode string] Memory allocation failed");
-        return 1;
-    }
-    hex_debug(ctx, "PUSHST[02]: \"%s\"", str);
-    free(str); // only needed for debug output
+    hex_debug(ctx, "PUSHST[02]: \"%s\"", value);
     size_t len = strlen(value);
     // Check if we need to resize the buffer (size + strlen + opcode (1) + max encoded length (4))
     if (*size + len + 1 + 4 > *capacity)
@@ -2893,22 +5122,14 @@ int hex_interpret_bytecode_integer(hex_context_t *ctx, uint8_t **bytecode, size_
         return 1;
     }
 
-    // Decode the integer value based on the length in little-endian format
-    value = 0;
+    // Decode the integer value based on the length in little-endian format.
+    // Negative values are always encoded in 4 bytes, so no sign extension is needed.
+    uint32_t bits = 0;
     for (size_t i = 0; i < length; i++)
     {
-        value |= (*bytecode)[i] << (8 * i); // Accumulate in little-endian order
-    }
-
-    // Handle sign extension for 32-bit value
-    if (length == 4)
-    {
-        // If the value is negative, we need to sign-extend it.
-        if (value & 0x80000000)
-        {                        // If the sign bit is set (negative value)
-            value |= 0xFF000000; // Sign-extend to 32 bits
-        }
+        bits |= (uint32_t)(*bytecode)[i] << (8 * i); // Accumulate in little-endian order
     }
+    value = (int32_t)bits;
 
     *bytecode += length;
     *size -= length;
@@ -2964,7 +5185,7 @@ int hex_interpret_bytecode_string(hex_context_t *ctx, uint8_t **bytecode, size_t
     *bytecode += length;
     *size -= length;
 
-    hex_item_t *item = hex_string_item(ctx, value);
+    hex_item_t *item = hex_string_literal_item(ctx, value);
     free(value); // raw buffer no longer needed after string item is created
     if (!item)
     {
@@ -2994,37 +5215,29 @@ int hex_interpret_bytecode_native_symbol(hex_context_t *ctx, uint8_t opcode, siz
         return 1;
     }
     item->type = HEX_TYPE_NATIVE_SYMBOL;
-    hex_item_t *value = calloc(1, sizeof(hex_item_t));
-    if (!value)
-    {
-        hex_error(ctx, "[interpret bytecode native symbol] Memory allocation failed");
-        free(item);
-        return 1;
-    }
     hex_token_t *token = (hex_token_t *)malloc(sizeof(hex_token_t));
     token->value = strdup(symbol);
     token->position = (hex_file_position_t *)malloc(sizeof(hex_file_position_t));
     token->position->filename = strdup(filename);
     token->position->line = 0;
     token->position->column = position;
-    if (hex_get_symbol(ctx, token->value, value))
+    const hex_native_t *native = hex_get_native_symbol(ctx, token->value);
+    if (native)
     {
         item->token = token;
         item->type = HEX_TYPE_NATIVE_SYMBOL;
-        item->data.fn_value = value->data.fn_value;
-        hex_free_item(ctx, value); // free the registry copy (including its token)
+        item->data.native_value = native;
     }
     else
     {
         hex_error(ctx, "(%d,%d) Unable to reference native symbol: %s (bytecode)", token->position->line, token->position->column, token->value);
         hex_free_token(token);
-        free(value); // just wrapper; get_symbol did not fill it
         free(item);
         return 1;
     }
     hex_debug(ctx, ">> NATSYM[%02x]: %s", opcode, token->value);
     *result = *item;
-    free(item); // free wrapper only; token/fn_value now owned by result
+    free(item); // free wrapper only; token now owned by result
     return 0;
 }
 
@@ -3063,15 +5276,87 @@ int hex_interpret_bytecode_user_symbol(hex_context_t *ctx, uint8_t **bytecode, s
     token->position->line = 0;
     token->position->column = position;
 
-    hex_item_t item;
-    item.type = HEX_TYPE_USER_SYMBOL;
-    item.token = token;
+    result->type = HEX_TYPE_USER_SYMBOL;
+    result->token = token;
 
     hex_debug(ctx, ">> LOOKUP[00]: %02x -> %s", index, value);
-    *result = item;
     return 0;
 }
 
+// Quotation literals are hash-consed: a decoded literal identical to one decoded
+// before shares its items, so that it takes no more memory and is found equal to
+// it without comparing them.
+
+static int hex_literal_pool_grow(hex_literal_pool_t *pool)
+{
+    size_t capacity = pool->capacity > 0 ? pool->capacity * 2 : 64;
+    hex_item_t **slots = (hex_item_t **)calloc(capacity, sizeof(hex_item_t *));
+    if (!slots)
+    {
+        return 1;
+    }
+    for (size_t i = 0; i < pool->capacity; i++)
+    {
+        if (pool->slots[i])
+        {
+            size_t j = hex_item_hash(pool->slots[i]) & (capacity - 1);
+            while (slots[j])
+            {
+                j = (j + 1) & (capacity - 1);
+            }
+            slots[j] = pool->slots[i];
+        }
+    }
+    free(pool->slots);
+    pool->slots = slots;
+    pool->capacity = capacity;
+    return 0;
+}
+
+static void hex_intern_quotation(hex_context_t *ctx, hex_item_t *item)
+{
+    hex_literal_pool_t *pool = &ctx->literals;
+    if ((pool->count + 1) * 2 > pool->capacity && hex_literal_pool_grow(pool) != 0)
+    {
+        return;
+    }
+    size_t hash = hex_item_hash(item);
+    size_t i = hash & (pool->capacity - 1);
+    while (pool->slots[i])
+    {
+        hex_item_t *literal = pool->slots[i];
+        if (hex_item_hash(literal) == hash && hex_equal(literal, item))
+        {
+            hex_item_t *copy = hex_copy_item(ctx, literal);
+            if (copy)
+            {
+                // The items of a literal just decoded are not shared yet
+                hex_free_list(ctx, item->data.quotation_value, item->quotation_size);
+                free(item->share);
+                *item = *copy;
+                free(copy);
+            }
+            return;
+        }
+        i = (i + 1) & (pool->capacity - 1);
+    }
+    pool->slots[i] = hex_copy_item(ctx, item);
+    if (pool->slots[i])
+    {
+        pool->count++;
+    }
+}
+
+void hex_literal_pool_destroy(hex_context_t *ctx)
+{
+    for (size_t i = 0; i < ctx->literals.capacity; i++)
+    {
+        HEX_FREE(ctx, ctx->literals.slots[i]);
+    }
+    free(ctx->literals.slots);
+    memset(&ctx->literals, 0, sizeof(ctx->literals));
+}
+
 int hex_interpret_bytecode_quotation(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t position, const char *filename, hex_item_t *result)
 {
     size_t n_items = 0;
@@ -3122,7 +5407,7 @@ int hex_interpret_bytecode_quotation(hex_context_t *ctx, uint8_t **bytecode, siz
 
     hex_debug(ctx, ">> PUSHQT[03]: <start> (items: %zu)", n_items);
 
-    hex_item_t **items = (hex_item_t **)malloc(n_items * sizeof(hex_item_t));
+    hex_item_t **items = (hex_item_t **)calloc(n_items > 0 ? n_items : 1, sizeof(hex_item_t *));
     if (!items)
     {
         hex_error(ctx, "[interpret bytecode quotation] Memory allocation failed");
@@ -3179,2672 +5464,4110 @@ int hex_interpret_bytecode_quotation(hex_context_t *ctx, uint8_t **bytecode, siz
     result->type = HEX_TYPE_QUOTATION;
     result->data.quotation_value = items;
     result->quotation_size = n_items;
+    if (ctx->settings->hash_consing_enabled)
+    {
+        hex_intern_quotation(ctx, result);
+    }
+
+    hex_debug(ctx, ">> PUSHQT[03]: <end> (items: %zu)", n_items);
+    return 0;
+}
+
+// Validate the header and decode the symbol table of a bytecode image
+static int hex_decode_bytecode_header(hex_context_t *ctx, uint8_t **bytecode, size_t *size)
+{
+    uint8_t header[8];
+    if (*size < 8)
+    {
+        hex_error(ctx, "[interpret bytecode header] Bytecode size too small to contain a header");
+        return 1;
+    }
+    memcpy(header, *bytecode, 8);
+    int symbol_table_size = hex_validate_header(header);
+    hex_debug(ctx, "[Hex Bytecode eXecutable File - version: %d - symbols: %d]", header[4], symbol_table_size);
+    if (symbol_table_size < 0)
+    {
+        hex_error(ctx, "[interpret bytecode header] Invalid bytecode header");
+        return 1;
+    }
+    *bytecode += 8;
+    *size -= 8;
+    // Extract the symbol table
+    if (symbol_table_size > 0)
+    {
+        if (hex_decode_bytecode_symboltable(ctx, bytecode, size, symbol_table_size) != 0)
+        {
+            hex_error(ctx, "[interpret bytecode symbol table] Failed to decode the symbol table");
+            return 1;
+        }
+    }
+    // Debug: Print all symbols in the symbol table
+    hex_debug(ctx, "--- Symbol Table Start ---");
+    for (size_t i = 0; i < ctx->symbol_table->count; i++)
+    {
+        hex_debug(ctx, "%03d: %s", i, hex_symboltable_get_value(ctx, (uint16_t)i));
+    }
+    hex_debug(ctx, "---  Symbol Table End  ---");
+    return 0;
+}
+
+// Decode the next item of a bytecode image
+static hex_item_t *hex_decode_bytecode_item(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t position, const char *filename)
+{
+    uint8_t opcode = **bytecode;
+    hex_debug(ctx, "-- [%08d] OPCODE: %02x", position, opcode);
+    (*bytecode)++;
+    (*size)--;
+
+    hex_item_t *item = calloc(1, sizeof(hex_item_t));
+    if (!item)
+    {
+        hex_error(ctx, "[interpret bytecode] Memory allocation failed");
+        return NULL;
+    }
+    int result;
+    switch (opcode)
+    {
+    case HEX_OP_PUSHIN:
+        result = hex_interpret_bytecode_integer(ctx, bytecode, size, item);
+        break;
+    case HEX_OP_PUSHST:
+        result = hex_interpret_bytecode_string(ctx, bytecode, size, item);
+        break;
+    case HEX_OP_LOOKUP:
+        result = hex_interpret_bytecode_user_symbol(ctx, bytecode, size, position, filename, item);
+        break;
+    case HEX_OP_PUSHQT:
+        result = hex_interpret_bytecode_quotation(ctx, bytecode, size, position, filename, item);
+        break;
+    default:
+        result = hex_interpret_bytecode_native_symbol(ctx, opcode, position, filename, item);
+        break;
+    }
+    if (result != 0)
+    {
+        HEX_FREE(ctx, item);
+        return NULL;
+    }
+    return item;
+}
+
+int hex_interpret_bytecode(hex_context_t *ctx, uint8_t *bytecode, size_t size, const char *filename)
+{
+    size_t bytecode_size = size;
+    if (hex_decode_bytecode_header(ctx, &bytecode, &size) != 0)
+    {
+        return 1;
+    }
+    while (size > 0)
+    {
+        hex_item_t *item = hex_decode_bytecode_item(ctx, &bytecode, &size, bytecode_size - size, filename);
+        if (!item)
+        {
+            return 1;
+        }
+        if (hex_push(ctx, item) != 0)
+        {
+            HEX_FREE(ctx, item);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Decode a whole bytecode image without executing it
+int hex_compile_bytecode(hex_context_t *ctx, uint8_t *bytecode, size_t size, const char *filename, hex_item_t ***items, size_t *count)
+{
+    size_t bytecode_size = size;
+    if (hex_decode_bytecode_header(ctx, &bytecode, &size) != 0)
+    {
+        return 1;
+    }
+    size_t capacity = 16;
+    size_t n = 0;
+    hex_item_t **list = malloc(capacity * sizeof(hex_item_t *));
+    if (!list)
+    {
+        hex_error(ctx, "[compile bytecode] Memory allocation failed");
+        return 1;
+    }
+    while (size > 0)
+    {
+        if (n >= capacity)
+        {
+            capacity *= 2;
+            hex_item_t **tmp = realloc(list, capacity * sizeof(hex_item_t *));
+            if (!tmp)
+            {
+                hex_error(ctx, "[compile bytecode] Memory allocation failed");
+                hex_free_list(ctx, list, n);
+                return 1;
+            }
+            list = tmp;
+        }
+        list[n] = hex_decode_bytecode_item(ctx, &bytecode, &size, bytecode_size - size, filename);
+        if (!list[n])
+        {
+            hex_free_list(ctx, list, n);
+            return 1;
+        }
+        n++;
+    }
+    *items = list;
+    *count = n;
+    return 0;
+}
+
+void hex_header(hex_context_t *ctx, uint8_t header[8])
+{
+    header[0] = 0x01;
+    header[1] = 'h';
+    header[2] = 'e';
+    header[3] = 'x';
+    header[4] = 0x01; // version
+    uint16_t symbol_table_size = (uint16_t)ctx->symbol_table->count;
+    header[5] = symbol_table_size & 0xFF;
+    header[6] = (symbol_table_size >> 8) & 0xFF;
+    header[7] = 0x02;
+}
+
+int hex_validate_header(uint8_t header[8])
+{
+    if (header[0] != 0x01 || header[1] != 'h' || header[2] != 'e' || header[3] != 'x' || header[4] != 0x01 || header[7] != 0x02)
+    {
+        return -1;
+    }
+    uint16_t symbol_table_size = header[5] | (header[6] << 8);
+    return symbol_table_size;
+}
+
+/* File: src/interpreter.c */
+#line 1 "src/interpreter.c"
+#ifndef HEX_H
+#include "hex.h"
+#endif
+
+////////////////////////////////////////
+// Hex Interpreter Implementation     //
+////////////////////////////////////////
+
+hex_context_t *hex_init()
+{
+    hex_context_t *context = malloc(sizeof(hex_context_t));
+    if (!context)
+        return NULL;
+
+    context->argc = 0;
+    context->argv = NULL;
+    context->registry = hex_registry_create();
+    context->docs = malloc(sizeof(hex_doc_dictionary_t));
+    if (context->docs)
+    {
+        context->docs->entries = malloc(HEX_NATIVE_SYMBOLS * sizeof(hex_doc_entry_t));
+        context->docs->size = 0;
+    }
+    context->stack = malloc(sizeof(hex_stack_t));
+    if (context->stack)
+    {
+        context->stack->entries = malloc(HEX_STACK_SIZE * sizeof(hex_item_t *));
+        context->stack->top = -1;
+        context->stack->capacity = HEX_STACK_SIZE;
+        // Initialize all entries to NULL
+        for (int i = 0; i < HEX_STACK_SIZE; i++)
+        {
+            context->stack->entries[i] = NULL;
+        }
+    }
+    context->stack_trace = malloc(sizeof(hex_stack_trace_t));
+    if (context->stack_trace)
+    {
+        context->stack_trace->entries = malloc(HEX_STACK_TRACE_SIZE * sizeof(hex_token_t *));
+        context->stack_trace->start = 0;
+        context->stack_trace->size = 0;
+        // Initialize all entries to NULL
+        for (int i = 0; i < HEX_STACK_TRACE_SIZE; i++)
+        {
+            context->stack_trace->entries[i] = NULL;
+        }
+    }
+    context->error[0] = '\0';
+    context->pending_error.format = NULL;
+    context->try_frame = NULL;
+    memset(context->eval_cache, 0, sizeof(context->eval_cache));
+    memset(context->files, 0, sizeof(context->files));
+    memset(&context->literals, 0, sizeof(context->literals));
+    memset(&context->memo, 0, sizeof(context->memo));
+    context->files[0] = stdin;
+    context->files[1] = stdout;
+    context->files[2] = stderr;
+    hex_output_init(&context->out, stdout);
+    hex_output_init(&context->err, stderr);
+    context->settings = malloc(sizeof(hex_settings_t));
+    if (context->settings)
+    {
+        context->settings->debugging_enabled = 0;
+        context->settings->errors_enabled = 1;
+        context->settings->stack_trace_enabled = 1;
+        context->settings->hash_consing_enabled = 1;
+    }
+    context->symbol_table = hex_symboltable_create(NULL);
+    return context;
+}
+
+int hex_interpret(hex_context_t *ctx, const char *code, const char *filename, int line, int column)
+{
+
+    const char *input = code;
+    hex_file_position_t position = {filename, line, column};
+    hex_token_t *token = hex_next_token(ctx, &input, &position);
+
+    while (token != NULL && token->type != HEX_TOKEN_INVALID)
+    {
+        int result = 0;
+        
+        if (token->type == HEX_TOKEN_INTEGER)
+        {
+            result = hex_push_integer(ctx, hex_parse_integer(token->value));
+        }
+        else if (token->type == HEX_TOKEN_STRING)
+        {
+            hex_item_t *item = hex_string_literal_item(ctx, token->value);
+            result = item ? HEX_PUSH(ctx, item) : 1;
+        }
+        else if (token->type == HEX_TOKEN_SYMBOL)
+        {
+            if (token->position && filename)
+            {
+                if (token->position->filename)
+                {
+                    free((void *)token->position->filename);
+                }
+                token->position->filename = strdup(filename);
+            }
+            result = hex_push_symbol(ctx, token);
+            // hex_push_symbol copies the token (from Patch 2), so we free the original
+        }
+        else if (token->type == HEX_TOKEN_QUOTATION_END)
+        {
+            hex_error(ctx, "(%d,%d) Unexpected end of quotation", position.line, position.column);
+            result = 1;
+        }
+        else if (token->type == HEX_TOKEN_QUOTATION_START)
+        {
+            hex_item_t *quotationItem = (hex_item_t *)malloc(sizeof(hex_item_t));
+            if (!quotationItem)
+            {
+                hex_error(ctx, "(%d,%d) Failed to allocate memory for quotation", position.line, position.column);
+                result = 1;
+            }
+            else if (hex_parse_quotation(ctx, &input, quotationItem, &position) != 0)
+            {
+                hex_error(ctx, "(%d,%d) Failed to parse quotation", position.line, position.column);
+                free(quotationItem);
+                result = 1;
+            }
+            else
+            {
+                result = hex_push_quotation(ctx, quotationItem->data.quotation_value, quotationItem->quotation_size);
+                // Don't free quotationItem here as its content is now owned by the stack
+                free(quotationItem); // Only free the wrapper, not the contents
+            }
+        }
+
+        if (result != 0)
+        {
+            hex_error(ctx, "[interpret] Unable to push: %s", token->value);
+            hex_free_token(token);
+            print_stack_trace(ctx);
+            return result;
+        }
+
+        // Always free the token after processing since no function consumes it
+        // All push functions copy the token data they need, so we own the original
+        hex_free_token(token);
+
+        token = hex_next_token(ctx, &input, &position);
+    }
+    if (token != NULL && token->type == HEX_TOKEN_INVALID)
+    {
+        token->position->filename = strdup(filename);
+        add_to_stack_trace(ctx, token);
+        print_stack_trace(ctx);
+        hex_free_token(token); // Make sure to free the invalid token too
+        return 1;
+    }
+    return 0;
+}
+
+// Parse a whole program into the list of items it pushes, without executing it
+int hex_compile(hex_context_t *ctx, const char *code, const char *filename, hex_item_t ***items, size_t *count)
+{
+    const char *input = code;
+    hex_file_position_t position = {filename, 1, 1};
+    size_t capacity = 16;
+    size_t n = 0;
+    hex_item_t **list = malloc(capacity * sizeof(hex_item_t *));
+    if (!list)
+    {
+        hex_error(ctx, "[compile] Memory allocation failed");
+        return 1;
+    }
+    hex_token_t *token = hex_next_token(ctx, &input, &position);
+    while (token != NULL && token->type != HEX_TOKEN_INVALID)
+    {
+        hex_item_t *item = NULL;
+        if (token->type == HEX_TOKEN_INTEGER)
+        {
+            item = hex_integer_item(ctx, hex_parse_integer(token->value));
+        }
+        else if (token->type == HEX_TOKEN_STRING)
+        {
+            item = hex_string_literal_item(ctx, token->value);
+        }
+        else if (token->type == HEX_TOKEN_SYMBOL)
+        {
+            if (token->position && filename)
+            {
+                if (token->position->filename)
+                {
+                    free((void *)token->position->filename);
+                }
+                token->position->filename = strdup(filename);
+            }
+            item = hex_symbol_item(ctx, token);
+        }
+        else if (token->type == HEX_TOKEN_QUOTATION_START)
+        {
+            item = (hex_item_t *)calloc(1, sizeof(hex_item_t));
+            if (item && hex_parse_quotation(ctx, &input, item, &position) != 0)
+            {
+                free(item);
+                item = NULL;
+            }
+        }
+        hex_free_token(token);
+        if (item != NULL && n >= capacity)
+        {
+            capacity *= 2;
+            hex_item_t **tmp = realloc(list, capacity * sizeof(hex_item_t *));
+            if (!tmp)
+            {
+                hex_free_item(ctx, item);
+                item = NULL;
+            }
+            else
+            {
+                list = tmp;
+            }
+        }
+        if (item == NULL)
+        {
+            hex_free_list(ctx, list, n);
+            return 1;
+        }
+        list[n++] = item;
+        token = hex_next_token(ctx, &input, &position);
+    }
+    if (token != NULL)
+    {
+        hex_free_token(token);
+        hex_free_list(ctx, list, n);
+        return 1;
+    }
+    *items = list;
+    *count = n;
+    return 0;
+}
+
+////////////////////////////////////////
+// Eval Cache                         //
+////////////////////////////////////////
+
+static size_t hex_eval_hash(const uint8_t *code, size_t size, const char *scope)
+{
+    size_t hash = 5381;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = ((hash << 5) + hash) + code[i];
+    }
+    while (*scope)
+    {
+        hash = ((hash << 5) + hash) + (unsigned char)(*scope);
+        scope++;
+    }
+    return hash;
+}
+
+void hex_release_compiled(hex_context_t *ctx, hex_compiled_t *compiled)
+{
+    if (compiled == NULL || --compiled->refs > 0)
+    {
+        return;
+    }
+    hex_free_list(ctx, compiled->items, compiled->count);
+    free(compiled->scope);
+    free(compiled->code);
+    free(compiled);
+}
+
+// Return the compiled form of a program evaluated by !, compiling it on a cache miss.
+// Programs that cannot be compiled as a whole (e.g. because of a syntax error) are not
+// cached: NULL is returned and the caller falls back to the streaming interpreter.
+hex_compiled_t *hex_get_compiled(hex_context_t *ctx, const uint8_t *code, size_t size, int bytecode, const char *scope)
+{
+    size_t hash = hex_eval_hash(code, size, scope);
+    hex_compiled_t **slot = &ctx->eval_cache[hash % HEX_EVAL_CACHE_SIZE];
+    hex_compiled_t *compiled = *slot;
+    if (compiled && compiled->hash == hash && compiled->bytecode == bytecode && compiled->code_size == size &&
+        strcmp(compiled->scope, scope) == 0 && memcmp(compiled->code, code, size) == 0)
+    {
+        compiled->refs++;
+        return compiled;
+    }
+
+    compiled = calloc(1, sizeof(hex_compiled_t));
+    if (!compiled)
+    {
+        return NULL;
+    }
+    compiled->code = malloc(size + 1);
+    compiled->scope = strdup(scope);
+    if (!compiled->code || !compiled->scope)
+    {
+        free(compiled->code);
+        free(compiled->scope);
+        free(compiled);
+        return NULL;
+    }
+    memcpy(compiled->code, code, size);
+    compiled->code[size] = '\0';
+    compiled->code_size = size;
+    compiled->hash = hash;
+    compiled->bytecode = bytecode;
+
+    // Compilation errors are reported by the fallback path, if at all
+    hex_try_frame_t frame;
+    hex_enter_try(ctx, &frame);
+    int result;
+    if (bytecode)
+    {
+        // Decoding replaces the symbol table: work on an overlay
+        hex_symbol_table_t *original_table = ctx->symbol_table;
+        hex_symbol_table_t *overlay = hex_symboltable_overlay(ctx);
+        if (overlay)
+        {
+            ctx->symbol_table = overlay;
+            result = hex_compile_bytecode(ctx, compiled->code, size, scope, &compiled->items, &compiled->count);
+            hex_symboltable_destroy(overlay);
+            ctx->symbol_table = original_table;
+        }
+        else
+        {
+            result = 1;
+        }
+    }
+    else
+    {
+        result = hex_compile(ctx, (const char *)compiled->code, scope, &compiled->items, &compiled->count);
+    }
+    hex_leave_try(ctx, &frame);
+    hex_restore_error(ctx, &frame);
+    if (result != 0)
+    {
+        free(compiled->code);
+        free(compiled->scope);
+        free(compiled);
+        return NULL;
+    }
+
+    // The cache holds one reference, the caller another
+    compiled->refs = 2;
+    hex_release_compiled(ctx, *slot);
+    *slot = compiled;
+    return compiled;
+}
+
+// Push the items of a compiled program
+int hex_run_compiled(hex_context_t *ctx, hex_compiled_t *compiled)
+{
+    for (size_t i = 0; i < compiled->count; i++)
+    {
+        hex_item_t *item = compiled->items[i];
+        if (item->type == HEX_TYPE_NATIVE_SYMBOL || item->type == HEX_TYPE_USER_SYMBOL)
+        {
+            // Symbols are never stored on the stack, no copy is needed
+            if (hex_push(ctx, item) != 0)
+            {
+                hex_error(ctx, "[interpret] Unable to push: %s", item->token->value);
+                print_stack_trace(ctx);
+                return 1;
+            }
+            continue;
+        }
+        hex_item_t *copy = hex_copy_item(ctx, item);
+        if (!copy || hex_push(ctx, copy) != 0)
+        {
+            HEX_FREE(ctx, copy);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void hex_eval_cache_destroy(hex_context_t *ctx)
+{
+    for (size_t i = 0; i < HEX_EVAL_CACHE_SIZE; i++)
+    {
+        hex_release_compiled(ctx, ctx->eval_cache[i]);
+        ctx->eval_cache[i] = NULL;
+    }
+}
+
+/* File: src/utils.c */
+#line 1 "src/utils.c"
+#ifndef HEX_H
+#include "hex.h"
+#endif
+
+////////////////////////////////////////
+// Helper Functions                   //
+////////////////////////////////////////
+
+#if defined(__EMSCRIPTEN__)
+#include <emscripten.h>
+
+EM_ASYNC_JS(char *, em_fgets, (const char *buf, size_t bufsize), {
+    return await new Promise(function(resolve, reject) {
+               if (Module.pending_lines.length > 0)
+               {
+                   resolve(Module.pending_lines.shift());
+               }
+               else
+               {
+                   Module.pending_fgets.push(resolve);
+               }
+           })
+        .then(function(s) {
+            // convert JS string to WASM string
+            let l = s.length + 1;
+            if (l >= bufsize)
+            {
+                // truncate
+                l = bufsize - 1;
+            }
+            Module.stringToUTF8(s.slice(0, l), buf, l);
+            return buf;
+        });
+});
+
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// AVX2 code is compiled for a target attribute and only used if the CPU supports it
+#if defined(__SSE2__) && defined(__GNUC__) && !defined(__EMSCRIPTEN__)
+#define HEX_AVX2_DISPATCH
+#include <immintrin.h>
+#endif
+
+void hex_rpad(const char *str, int total_length)
+{
+    int len = strlen(str);
+    printf("%s", str);
+    for (int i = len; i < total_length; i++)
+    {
+        printf(" ");
+    }
+}
+void hex_lpad(const char *str, int total_length)
+{
+    int len = strlen(str);
+    for (int i = len; i < total_length; i++)
+    {
+        printf(" ");
+    }
+    printf("%s", str);
+}
+
+// Integer conversion: digits are written two at a time from tables of digit pairs,
+// backwards into a buffer provided by the caller, and parsed through a table of digit
+// values. Results wrap around like 32-bit arithmetic.
+
+static const char hex_decimal_pairs[] =
+    "00010203040506070809101112131415161718192021222324"
+    "25262728293031323334353637383940414243444546474849"
+    "50515253545556575859606162636465666768697071727374"
+    "75767778798081828384858687888990919293949596979899";
+
+static const char hex_hex_pairs[] =
+    "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+// Value of each hexadecimal digit plus one, or 0 for other bytes
+static const uint8_t hex_digit_values[256] = {
+    ['0'] = 1, ['1'] = 2, ['2'] = 3, ['3'] = 4, ['4'] = 5, ['5'] = 6, ['6'] = 7, ['7'] = 8, ['8'] = 9, ['9'] = 10,
+    ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16};
+
+// Write the hexadecimal digits of value (lowercase, without prefix) so that they end
+// right before end, and return where they start
+char *hex_format_hex(uint32_t value, char *end)
+{
+    char *p = end;
+    while (value >= 0x10)
+    {
+        p -= 2;
+        memcpy(p, hex_hex_pairs + (value & 0xff) * 2, 2);
+        value >>= 8;
+    }
+    if (value > 0 || p == end)
+    {
+        *--p = hex_hex_pairs[value * 2 + 1];
+    }
+    return p;
+}
+
+// Write the decimal digits of value, with a minus sign if negative, so that they end
+// right before end, and return where they start
+char *hex_format_decimal(int32_t value, char *end)
+{
+    char *p = end;
+    uint32_t n = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+    while (n >= 100)
+    {
+        p -= 2;
+        memcpy(p, hex_decimal_pairs + (n % 100) * 2, 2);
+        n /= 100;
+    }
+    if (n >= 10)
+    {
+        p -= 2;
+        memcpy(p, hex_decimal_pairs + n * 2, 2);
+    }
+    else
+    {
+        *--p = (char)('0' + n);
+    }
+    if (value < 0)
+    {
+        *--p = '-';
+    }
+    return p;
+}
+
+// Parse the run of hexadecimal digits at the start of text; end is set past the run
+uint32_t hex_parse_hex_digits(const char *text, const char **end)
+{
+    const uint8_t *p = (const uint8_t *)text;
+    uint32_t value = 0;
+    for (; hex_digit_values[*p]; p++)
+    {
+        value = (value << 4) | (uint32_t)(hex_digit_values[*p] - 1);
+    }
+    *end = (const char *)p;
+    return value;
+}
+
+// Parse the run of decimal digits at the start of text; end is set past the run
+uint32_t hex_parse_decimal_digits(const char *text, const char **end)
+{
+    const char *p = text;
+    uint32_t value = 0;
+    while (isdigit((unsigned char)p[0]) && isdigit((unsigned char)p[1]))
+    {
+        value = value * 100 + (uint32_t)((p[0] - '0') * 10 + (p[1] - '0'));
+        p += 2;
+    }
+    if (isdigit((unsigned char)*p))
+    {
+        value = value * 10 + (uint32_t)(*p++ - '0');
+    }
+    *end = p;
+    return value;
+}
+
+// Parse an integer like strtol does: leading whitespace, an optional sign and the
+// digits in base 16 (optionally prefixed with 0x) or 10, ignoring what follows them
+int32_t hex_parse_number(const char *text, int base)
+{
+    while (isspace((unsigned char)*text))
+    {
+        text++;
+    }
+    int negative = *text == '-';
+    if (*text == '-' || *text == '+')
+    {
+        text++;
+    }
+    if (base == 16 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X') && hex_digit_values[(uint8_t)text[2]])
+    {
+        text += 2;
+    }
+    const char *end;
+    uint32_t value = base == 16 ? hex_parse_hex_digits(text, &end) : hex_parse_decimal_digits(text, &end);
+    return (int32_t)(negative ? 0u - value : value);
+}
+
+void hex_encode_length(uint8_t **bytecode, size_t *size, size_t length)
+{
+    while (length >= 0x80)
+    {
+        (*bytecode)[*size] = (length & 0x7F) | 0x80;
+        length >>= 7;
+        (*size)++;
+    }
+    (*bytecode)[*size] = length & 0x7F;
+    (*size)++;
+}
+
+int hex_is_binary(const uint8_t *data, size_t size)
+{
+    const double binary_threshold = 0.1; // 10% of bytes being non-printable
+    size_t non_printable_count = 0;
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(31);
+    const __m128i del = _mm_set1_epi8(127);
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(data + i));
+        // Bytes with the high bit set are negative, so they fall outside of the printable range
+        __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(block, space), _mm_cmplt_epi8(block, del));
+        printable = _mm_or_si128(printable, _mm_cmpeq_epi8(block, _mm_set1_epi8(9)));
+        printable = _mm_or_si128(printable, _mm_cmpeq_epi8(block, _mm_set1_epi8(10)));
+        printable = _mm_or_si128(printable, _mm_cmpeq_epi8(block, _mm_set1_epi8(13)));
+        unsigned int mask = ~(unsigned int)_mm_movemask_epi8(printable) & 0xffff;
+        for (; mask != 0; mask &= mask - 1)
+        {
+            non_printable_count++;
+        }
+        if ((double)non_printable_count / size > binary_threshold)
+        {
+            return 1;
+        }
+    }
+#endif
+    for (; i < size; i++)
+    {
+        uint8_t byte = data[i];
+        // Check if the byte is a printable ASCII character or a common control character.
+        if (!((byte >= 32 && byte <= 126) || byte == 9 || byte == 10 || byte == 13))
+        {
+            non_printable_count++;
+        }
+        // Early exit if the threshold is exceeded.
+        if ((double)non_printable_count / size > binary_threshold)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int hex_is_plain(char c)
+{
+    return c >= 0x20 && c < 0x7f && c != '\\' && c != '"';
+}
+
+#if defined(HEX_AVX2_DISPATCH)
+__attribute__((target("avx2"))) static size_t hex_plain_span_avx2(const char *data, size_t size)
+{
+    const __m256i space = _mm256_set1_epi8(0x20);
+    const __m256i del = _mm256_set1_epi8(0x7f);
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i quote = _mm256_set1_epi8('"');
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(data + i));
+        // Bytes with the high bit set are negative, so they compare lower than a space like control characters
+        __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpgt_epi8(space, block), _mm256_cmpeq_epi8(block, del)),
+                                          _mm256_or_si256(_mm256_cmpeq_epi8(block, backslash), _mm256_cmpeq_epi8(block, quote)));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(special);
+        if (mask != 0)
+        {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+    return i;
+}
+#endif
+
+// Length of the run at the start of data made of printable ASCII characters other
+// than a backslash and a double quote, which can be copied without being escaped.
+// With SSE2 16 bytes are checked at a time, and 32 with AVX2 if the CPU supports it.
+size_t hex_plain_span(const char *data, size_t size)
+{
+    size_t i = 0;
+#if defined(HEX_AVX2_DISPATCH)
+    static int avx2 = -1;
+    if (avx2 < 0)
+    {
+        avx2 = __builtin_cpu_supports("avx2") != 0;
+    }
+    if (avx2)
+    {
+        i = hex_plain_span_avx2(data, size);
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i del = _mm_set1_epi8(0x7f);
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i quote = _mm_set1_epi8('"');
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmplt_epi8(block, space), _mm_cmpeq_epi8(block, del)),
+                                       _mm_or_si128(_mm_cmpeq_epi8(block, backslash), _mm_cmpeq_epi8(block, quote)));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(special);
+        if (mask != 0)
+        {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+#endif
+    while (i < size && hex_is_plain(data[i]))
+    {
+        i++;
+    }
+    return i;
+}
+
+// Find the first occurrence of needle in haystack, comparing raw bytes.
+// Candidate positions are those where both the first and the last byte of the
+// needle match; with SSE2 they are found 16 positions at a time.
+const char *hex_find(const char *haystack, size_t haystack_size, const char *needle, size_t needle_size)
+{
+    if (needle_size == 0)
+    {
+        return haystack;
+    }
+    if (needle_size > haystack_size)
+    {
+        return NULL;
+    }
+    if (needle_size == 1)
+    {
+        return memchr(haystack, needle[0], haystack_size);
+    }
+    size_t last = haystack_size - needle_size; // Last possible start of a match
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i first_byte = _mm_set1_epi8(needle[0]);
+    const __m128i last_byte = _mm_set1_epi8(needle[needle_size - 1]);
+    for (; i + 15 <= last; i += 16)
+    {
+        __m128i block_first = _mm_loadu_si128((const __m128i *)(haystack + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i *)(haystack + i + needle_size - 1));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first_byte), _mm_cmpeq_epi8(block_last, last_byte)));
+        while (mask != 0)
+        {
+            unsigned int bit = (unsigned int)__builtin_ctz(mask);
+            if (memcmp(haystack + i + bit + 1, needle + 1, needle_size - 2) == 0)
+            {
+                return haystack + i + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    while (i <= last)
+    {
+        const char *candidate = memchr(haystack + i, needle[0], last - i + 1);
+        if (candidate == NULL)
+        {
+            return NULL;
+        }
+        if (memcmp(candidate + 1, needle + 1, needle_size - 1) == 0)
+        {
+            return candidate;
+        }
+        i = (size_t)(candidate - haystack) + 1;
+    }
+    return NULL;
+}
+
+// Shift an integer left by a count of bits: counts outside 0 to 31 shift all the bits out
+int32_t hex_shift_left(int32_t value, int32_t count)
+{
+    return count < 0 || count > 31 ? 0 : (int32_t)((uint32_t)value << count);
+}
+
+// Shift an integer right by a count of bits, keeping its sign: counts outside 0 to 31
+// shift all the bits out, leaving $ffffffff for negative integers and $0 otherwise
+int32_t hex_shift_right(int32_t value, int32_t count)
+{
+    return count < 0 || count > 31 ? (value < 0 ? -1 : 0) : value >> count;
+}
+
+#if defined(__SSE2__)
+// Load four elements of an operand; an operand with a zero step repeats its only element
+static inline __m128i hex_vector_load(const int32_t *values, size_t step, size_t i)
+{
+    return step ? _mm_loadu_si128((const __m128i *)(values + i)) : _mm_set1_epi32(values[0]);
+}
+
+#define HEX_VECTOR_SSE2(expr)                                    \
+    for (; i + 4 <= size; i += 4)                                \
+    {                                                            \
+        __m128i a = hex_vector_load(left, left_step, i);         \
+        __m128i b = hex_vector_load(right, right_step, i);       \
+        _mm_storeu_si128((__m128i *)(out + i), (expr));          \
+    }
+#endif
+
+#define HEX_VECTOR_LOOP(expr)                \
+    for (; i < size; i++)                    \
+    {                                        \
+        int32_t a = left[i * left_step];     \
+        int32_t b = right[i * right_step];   \
+        out[i] = (expr);                     \
+    }
+
+// Apply the integer operation of an opcode to each pair of elements of two vectors.
+// An operand with a zero step is a single integer, paired with every element of the
+// other one. Comparisons produce $1 or $0, like their scalar counterparts; with SSE2,
+// four elements are processed at a time (except for multiplications and shifts).
+// Returns 1 if the opcode is not an elementwise operation.
+int hex_vector_apply(hex_opcode_t op, int32_t *out, const int32_t *left, size_t left_step, const int32_t *right, size_t right_step, size_t size)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i one = _mm_set1_epi32(1);
+    switch (op)
+    {
+    case HEX_OP_ADD:
+        HEX_VECTOR_SSE2(_mm_add_epi32(a, b));
+        break;
+    case HEX_OP_SUBTRACT:
+        HEX_VECTOR_SSE2(_mm_sub_epi32(a, b));
+        break;
+    case HEX_OP_BITAND:
+        HEX_VECTOR_SSE2(_mm_and_si128(a, b));
+        break;
+    case HEX_OP_BITOR:
+        HEX_VECTOR_SSE2(_mm_or_si128(a, b));
+        break;
+    case HEX_OP_BITXOR:
+        HEX_VECTOR_SSE2(_mm_xor_si128(a, b));
+        break;
+    case HEX_OP_EQUAL:
+        HEX_VECTOR_SSE2(_mm_and_si128(_mm_cmpeq_epi32(a, b), one));
+        break;
+    case HEX_OP_NOTEQUAL:
+        HEX_VECTOR_SSE2(_mm_add_epi32(_mm_cmpeq_epi32(a, b), one));
+        break;
+    case HEX_OP_GREATER:
+        HEX_VECTOR_SSE2(_mm_and_si128(_mm_cmpgt_epi32(a, b), one));
+        break;
+    case HEX_OP_LESS:
+        HEX_VECTOR_SSE2(_mm_and_si128(_mm_cmplt_epi32(a, b), one));
+        break;
+    case HEX_OP_GREATEREQUAL:
+        HEX_VECTOR_SSE2(_mm_add_epi32(_mm_cmplt_epi32(a, b), one));
+        break;
+    case HEX_OP_LESSEQUAL:
+        HEX_VECTOR_SSE2(_mm_add_epi32(_mm_cmpgt_epi32(a, b), one));
+        break;
+    default:
+        break;
+    }
+#endif
+    switch (op)
+    {
+    case HEX_OP_ADD:
+        HEX_VECTOR_LOOP((int32_t)((uint32_t)a + (uint32_t)b));
+        break;
+    case HEX_OP_SUBTRACT:
+        HEX_VECTOR_LOOP((int32_t)((uint32_t)a - (uint32_t)b));
+        break;
+    case HEX_OP_MULTIPLY:
+        HEX_VECTOR_LOOP((int32_t)((uint32_t)a * (uint32_t)b));
+        break;
+    case HEX_OP_BITAND:
+        HEX_VECTOR_LOOP(a & b);
+        break;
+    case HEX_OP_BITOR:
+        HEX_VECTOR_LOOP(a | b);
+        break;
+    case HEX_OP_BITXOR:
+        HEX_VECTOR_LOOP(a ^ b);
+        break;
+    case HEX_OP_SHL:
+        HEX_VECTOR_LOOP(hex_shift_left(a, b));
+        break;
+    case HEX_OP_SHR:
+        HEX_VECTOR_LOOP(hex_shift_right(a, b));
+        break;
+    case HEX_OP_EQUAL:
+        HEX_VECTOR_LOOP(a == b);
+        break;
+    case HEX_OP_NOTEQUAL:
+        HEX_VECTOR_LOOP(a != b);
+        break;
+    case HEX_OP_GREATER:
+        HEX_VECTOR_LOOP(a > b);
+        break;
+    case HEX_OP_LESS:
+        HEX_VECTOR_LOOP(a < b);
+        break;
+    case HEX_OP_GREATEREQUAL:
+        HEX_VECTOR_LOOP(a >= b);
+        break;
+    case HEX_OP_LESSEQUAL:
+        HEX_VECTOR_LOOP(a <= b);
+        break;
+    default:
+        return 1;
+    }
+    return 0;
+}
+
+static inline int32_t hex_vector_combine(hex_opcode_t op, int32_t result, int32_t value)
+{
+    switch (op)
+    {
+    case HEX_OP_MIN:
+        return value < result ? value : result;
+    case HEX_OP_MAX:
+        return value > result ? value : result;
+    default:
+        return (int32_t)((uint32_t)result + (uint32_t)value);
+    }
+}
+
+// Reduce a vector to the sum (HEX_OP_SUM), the minimum (HEX_OP_MIN) or the maximum
+// (HEX_OP_MAX) of its elements; the latter two require at least one element.
+int32_t hex_vector_reduce(hex_opcode_t op, const int32_t *values, size_t size)
+{
+    size_t i = 0;
+    int32_t result = op == HEX_OP_SUM ? 0 : values[0];
+#if defined(__SSE2__)
+    if (size >= 8)
+    {
+        __m128i acc = op == HEX_OP_SUM ? _mm_setzero_si128() : _mm_loadu_si128((const __m128i *)values);
+        i = op == HEX_OP_SUM ? 0 : 4;
+        for (; i + 4 <= size; i += 4)
+        {
+            __m128i block = _mm_loadu_si128((const __m128i *)(values + i));
+            if (op == HEX_OP_SUM)
+            {
+                acc = _mm_add_epi32(acc, block);
+            }
+            else
+            {
+                __m128i mask = op == HEX_OP_MIN ? _mm_cmplt_epi32(block, acc) : _mm_cmpgt_epi32(block, acc);
+                acc = _mm_or_si128(_mm_and_si128(mask, block), _mm_andnot_si128(mask, acc));
+            }
+        }
+        int32_t lanes[4];
+        _mm_storeu_si128((__m128i *)lanes, acc);
+        for (int k = 0; k < 4; k++)
+        {
+            result = hex_vector_combine(op, result, lanes[k]);
+        }
+    }
+#endif
+    for (; i < size; i++)
+    {
+        result = hex_vector_combine(op, result, values[i]);
+    }
+    return result;
+}
+
+void hex_print_item(FILE *stream, hex_item_t *item)
+{
+    hex_output_t out;
+    hex_output_init(&out, stream);
+    hex_output_item(&out, item, 0);
+    hex_output_flush(&out);
+}
+
+// Convert the contents of a text file to a string, normalizing line endings to \n
+char *hex_bytes_to_string(const uint8_t *bytes, size_t size, size_t *length)
+{
+    char *str = (char *)malloc(size + 1);
+    if (!str)
+    {
+        return NULL; // Allocation failed
+    }
+
+    char *ptr = str;
+    size_t i = 0;
+    while (i < size)
+    {
+        // Copy the run up to the next carriage return as it is
+        const uint8_t *cr = memchr(bytes + i, '\r', size - i);
+        size_t run = (cr ? (size_t)(cr - bytes) : size) - i;
+        memcpy(ptr, bytes + i, run);
+        ptr += run;
+        i += run;
+        if (!cr)
+        {
+            break;
+        }
+        if (i + 1 < size && bytes[i + 1] == '\n')
+        {
+            i++; // Skip the '\n' part of the '\r\n' sequence
+        }
+        *ptr++ = '\n';
+        i++;
+    }
+    *ptr = '\0';
+    *length = ptr - str;
+    return str;
+}
+
+char *hex_process_string(const char *value)
+{
+    size_t len = strlen(value);
+    char *processed_str = (char *)malloc(len + 1);
+    if (!processed_str)
+    {
+        return NULL;
+    }
+
+    char *dst = processed_str;
+    const char *src = value;
+    const char *end = value + len;
+    while (src < end)
+    {
+        // Copy the run up to the next backslash as it is
+        const char *backslash = memchr(src, '\\', end - src);
+        size_t run = (backslash ? backslash : end) - src;
+        memcpy(dst, src, run);
+        dst += run;
+        src += run;
+        if (!backslash || src + 1 == end)
+        {
+            break;
+        }
+        src++;
+        switch (*src)
+        {
+        case 'n':
+            *dst++ = '\n';
+            break;
+        case 't':
+            *dst++ = '\t';
+            break;
+        case 'r':
+            *dst++ = '\r';
+            break;
+        case 'b':
+            *dst++ = '\b';
+            break;
+        case 'f':
+            *dst++ = '\f';
+            break;
+        case 'v':
+            *dst++ = '\v';
+            break;
+        case '\"':
+            *dst++ = '\"';
+            break;
+        case '\\':
+            *dst++ = '\\';
+            break;
+        default:
+            *dst++ = '\\';
+            *dst++ = *src;
+            break;
+        }
+        src++;
+    }
+    if (src < end)
+    {
+        *dst++ = *src; // Trailing backslash
+    }
+    *dst = '\0';
+    return processed_str;
+}
+
+size_t hex_min_bytes_to_encode_integer(int32_t value)
+{
+    // If value is negative, we need to return 4 bytes because we must preserve the sign bits.
+    if (value < 0)
+    {
+        return 4;
+    }
+
+    // For positive values, check the minimal number of bytes needed.
+    for (int bytes = 1; bytes <= 4; bytes++)
+    {
+        int32_t mask = (1 << (bytes * 8)) - 1;
+        int32_t truncated_value = value & mask;
+
+        // If the truncated value is equal to the original, this is the minimal byte size
+        if (truncated_value == value)
+        {
+            return bytes;
+        }
+    }
+
+    return 4; // Default to 4 bytes if no smaller size is found.
+}
+
+char *hex_unescape_string(const char *input)
+{
+    size_t len = strlen(input);
+    char *unescaped = (char *)malloc(len + 1);
+    if (!unescaped)
+    {
+        return NULL;
+    }
+
+    size_t j = 0;
+    size_t i = 0;
+    while (i < len)
+    {
+        // Copy the run up to the next backslash as it is
+        const char *backslash = memchr(input + i, '\\', len - i);
+        size_t run = (backslash ? (size_t)(backslash - input) : len) - i;
+        memcpy(unescaped + j, input + i, run);
+        j += run;
+        i += run;
+        if (!backslash)
+        {
+            break;
+        }
+        char c = i + 1 < len ? input[i + 1] : '\0';
+        switch (c)
+        {
+        case 'n':
+            c = '\n';
+            break;
+        case 't':
+            c = '\t';
+            break;
+        case 'r':
+            c = '\r';
+            break;
+        case '\\':
+        case '\"':
+        case '\'':
+            break;
+        case 'v':
+            c = '\v';
+            break;
+        case 'f':
+            c = '\f';
+            break;
+        case 'a':
+            c = '\a';
+            break;
+        case 'b':
+            c = '\b';
+            break;
+        default:
+            // Not an escape sequence: the backslash is kept
+            unescaped[j++] = input[i++];
+            continue;
+        }
+        unescaped[j++] = c;
+        i += 2;
+    }
+    unescaped[j] = '\0'; // Null-terminate the string
+    return unescaped;
+}
+
+#ifdef _WIN32
+#include <windows.h>
+#include <sysinfoapi.h>
+
+void get_unix_timestamp_sec_usec(int32_t result[2])
+{
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+
+    ULARGE_INTEGER uli;
+    uli.LowPart = ft.dwLowDateTime;
+    uli.HighPart = ft.dwHighDateTime;
+
+    const uint64_t EPOCH_DIFFERENCE_100NS = 116444736000000000ULL;
+    uint64_t timestamp_100ns = uli.QuadPart - EPOCH_DIFFERENCE_100NS;
+
+    uint64_t total_microseconds = timestamp_100ns / 10;
+
+    result[0] = (int32_t)(total_microseconds / 1000000); // seconds
+    result[1] = (int32_t)(total_microseconds % 1000000); // microseconds
+}
+
+#else
+#include <sys/time.h>
+
+void get_unix_timestamp_sec_usec(int32_t result[2])
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    result[0] = (int32_t)tv.tv_sec;  // seconds
+    result[1] = (int32_t)tv.tv_usec; // microseconds
+}
+#endif
+
+void hex_destroy(hex_context_t *ctx)
+{
+    if (!ctx)
+        return;
+
+    // Clean up stack
+    if (ctx->stack)
+    {
+        // Free all items remaining on the stack
+        for (int i = 0; i <= ctx->stack->top; i++)
+        {
+            if (ctx->stack->entries[i])
+            {
+                hex_free_item(ctx, ctx->stack->entries[i]);
+                ctx->stack->entries[i] = NULL;
+            }
+        }
+        if (ctx->stack->entries)
+        {
+            free(ctx->stack->entries);
+        }
+        free(ctx->stack);
+    }
+
+    hex_eval_cache_destroy(ctx);
+    hex_literal_pool_destroy(ctx);
+    hex_memo_destroy(ctx);
+
+    hex_flush_output(ctx);
+
+    // Close file handles left open
+    for (int i = 3; i < HEX_MAX_OPEN_FILES; i++)
+    {
+        if (ctx->files[i])
+        {
+            fclose(ctx->files[i]);
+            ctx->files[i] = NULL;
+        }
+    }
+
+    // Clean up registry
+    if (ctx->registry)
+    {
+        hex_registry_destroy(ctx);
+    }
+
+    // Clean up stack trace
+    if (ctx->stack_trace)
+    {
+        if (ctx->stack_trace->entries)
+        {
+            for (int i = 0; i < HEX_STACK_TRACE_SIZE; i++)
+            {
+                if (ctx->stack_trace->entries[i])
+                {
+                    hex_free_token(ctx->stack_trace->entries[i]);
+                }
+            }
+            free(ctx->stack_trace->entries);
+        }
+        free(ctx->stack_trace);
+    }
+
+    // Clean up symbol table
+    hex_symboltable_destroy(ctx->symbol_table);
+
+    // Clean up docs
+    if (ctx->docs)
+    {
+        if (ctx->docs->entries)
+        {
+            free(ctx->docs->entries);
+        }
+        free(ctx->docs);
+    }
+
+    // Clean up settings
+    if (ctx->settings)
+    {
+        free(ctx->settings);
+    }
+
+    free(ctx);
+}
+
+/* File: src/symbols.c */
+#line 1 "src/symbols.c"
+#ifndef HEX_H
+#include "hex.h"
+#endif
+
+////////////////////////////////////////
+// Native Symbol Implementations      //
+////////////////////////////////////////
+
+// Definition symbols
+
+int hex_symbol_store(hex_context_t *ctx)
+{
+    HEX_POP(ctx, name);
+    HEX_POP(ctx, value);
+
+    if (value->type == HEX_TYPE_QUOTATION)
+    {
+        value->is_operator = 0;
+    }
+    if (hex_set_symbol(ctx, name->data.str_value, value, 0) != 0)
+    {
+        hex_error(ctx, "[symbol :] Failed to store symbol '%s'", name->data.str_value);
+        HEX_FREE(ctx, name);
+        HEX_FREE(ctx, value);
+        return 1;
+    }
+    // Success: registry takes ownership of 'value'. Free name only.
+    HEX_FREE(ctx, name);
+    return 0;
+}
+
+int hex_symbol_define(hex_context_t *ctx)
+{
+    HEX_POP(ctx, name);
+    HEX_POP(ctx, value);
+
+    if (value->type == HEX_TYPE_QUOTATION)
+    {
+        value->is_operator = 1;
+    }
 
-    hex_debug(ctx, ">> PUSHQT[03]: <end> (items: %zu)", n_items);
+    if (hex_set_symbol(ctx, name->data.str_value, value, 0) != 0)
+    {
+        hex_error(ctx, "[symbol ::] Failed to store symbol '%s'", name->data.str_value);
+        HEX_FREE(ctx, name);
+        HEX_FREE(ctx, value);
+        return 1;
+    }
+    // Success: registry now owns 'value'; free only the name item.
+    HEX_FREE(ctx, name);
     return 0;
 }
 
-int hex_interpret_bytecode(hex_context_t *ctx, uint8_t *bytecode, size_t size, const char *filename)
+int hex_symbol_free(hex_context_t *ctx)
 {
-    size_t bytecode_size = size;
-    size_t position = bytecode_size;
-    uint8_t header[8];
-    if (size < 8)
+    HEX_POP(ctx, item);
+    if (hex_valid_native_symbol(ctx, item->data.str_value))
     {
-        hex_error(ctx, "[interpret bytecode header] Bytecode size too small to contain a header");
+        hex_error(ctx, "[symbol #] Cannot free native symbol '%s'", item->data.str_value);
+        HEX_FREE(ctx, item);
         return 1;
     }
-    memcpy(header, bytecode, 8);
-    int symbol_table_size = hex_validate_header(header);
-    hex_debug(ctx, "[Hex Bytecode eXecutable File - version: %d - symbols: %d]", header[4], symbol_table_size);
-    if (symbol_table_size < 0)
+    if (hex_delete_symbol(ctx, item->data.str_value) != 0)
     {
-        hex_error(ctx, "[interpret bytecode header] Invalid bytecode header");
+        hex_error(ctx, "[symbol #] Symbol not found: %s", item->data.str_value);
+        HEX_FREE(ctx, item);
         return 1;
     }
-    bytecode += 8;
-    size -= 8;
-    // Extract the symbol table
-    if (symbol_table_size > 0)
-    {
-        if (hex_decode_bytecode_symboltable(ctx, &bytecode, &size, symbol_table_size) != 0)
-        {
-            hex_error(ctx, "[interpret bytecode symbol table] Failed to decode the symbol table");
-            return 1;
-        }
-    }
-    // Debug: Print all symbols in the symbol table
-    hex_debug(ctx, "--- Symbol Table Start ---");
-    for (size_t i = 0; i < ctx->symbol_table->count; i++)
+    // Success: free the popped symbol name item
+    HEX_FREE(ctx, item);
+    return 0;
+}
+
+int hex_symbol_symbols(hex_context_t *ctx)
+{
+    // Allocate memory for the quotation
+    hex_item_t **quotation = (hex_item_t **)calloc(ctx->registry->size, sizeof(hex_item_t *));
+    if (!quotation)
     {
-        hex_debug(ctx, "%03d: %s", i, ctx->symbol_table->symbols[i]);
+        hex_error(ctx, "[symbol symbols] Memory allocation failed for quotation");
+        return 1;
     }
-    hex_debug(ctx, "---  Symbol Table End  ---");
-    while (size > 0)
-    {
-        position = bytecode_size - size;
-        uint8_t opcode = *bytecode;
-        hex_debug(ctx, "-- [%08d] OPCODE: %02x", position, opcode);
-        bytecode++;
-        size--;
 
-        HEX_ALLOC(item);
-        switch (opcode)
+    size_t quotation_size = 0;
+
+    // Iterate through each bucket in the hash table
+    for (size_t i = 0; i < ctx->registry->bucket_count; i++)
+    {
+        hex_registry_entry_t *entry = ctx->registry->buckets[i];
+        while (entry != NULL)
         {
-        case HEX_OP_PUSHIN:
-            if (hex_interpret_bytecode_integer(ctx, &bytecode, &size, item) != 0)
-            {
-                HEX_FREE(ctx, item);
-                return 1;
-            }
-            break;
-        case HEX_OP_PUSHST:
-            if (hex_interpret_bytecode_string(ctx, &bytecode, &size, item) != 0)
-            {
-                HEX_FREE(ctx, item);
-                return 1;
-            }
-            break;
-        case HEX_OP_LOOKUP:
-            if (hex_interpret_bytecode_user_symbol(ctx, &bytecode, &size, position, filename, item) != 0)
+            // Build a new string item using constructor for consistency
+            hex_item_t *item = hex_string_item(ctx, entry->key);
+            if (!item)
             {
-                HEX_FREE(ctx, item);
+                hex_error(ctx, "[symbol symbols] Failed to allocate string item");
+                for (size_t j = 0; j < quotation_size; j++)
+                {
+                    hex_free_item(ctx, quotation[j]);
+                }
+                free(quotation);
                 return 1;
             }
-            break;
-        case HEX_OP_PUSHQT:
+            quotation[quotation_size++] = item; // ownership transferred to quotation
 
-            if (hex_interpret_bytecode_quotation(ctx, &bytecode, &size, position, filename, item) != 0)
-            {
-                HEX_FREE(ctx, item);
-                return 1;
-            }
-            break;
-        default:
-            if (hex_interpret_bytecode_native_symbol(ctx, opcode, position, filename, item) != 0)
-            {
-                HEX_FREE(ctx, item);
-                return 1;
-            }
-            break;
+            // Move to the next entry in the bucket
+            entry = entry->next;
         }
-        if (hex_push(ctx, item) != 0)
+    }
+
+    // Push the quotation onto the stack
+    if (hex_push_quotation(ctx, quotation, quotation_size) != 0)
+    {
+        hex_error(ctx, "[symbol symbols] Failed to push quotation onto the stack");
+        for (size_t j = 0; j < quotation_size; j++)
         {
-            HEX_FREE(ctx, item);
-            return 1;
+            hex_free_item(ctx, quotation[j]);
         }
+        free(quotation);
+        return 1;
     }
+
+    // Successfully pushed quotation
     return 0;
 }
 
-void hex_header(hex_context_t *ctx, uint8_t header[8])
+int hex_symbol_type(hex_context_t *ctx)
 {
-    header[0] = 0x01;
-    header[1] = 'h';
-    header[2] = 'e';
-    header[3] = 'x';
-    header[4] = 0x01; // version
-    uint16_t symbol_table_size = (uint16_t)ctx->symbol_table->count;
-    header[5] = symbol_table_size & 0xFF;
-    header[6] = (symbol_table_size >> 8) & 0xFF;
-    header[7] = 0x02;
+    HEX_POP(ctx, item);
+    int result = hex_push_string(ctx, hex_type(item->type));
+    HEX_FREE(ctx, item);
+    return result;
 }
 
-int hex_validate_header(uint8_t header[8])
+// Evaluation symbols
+
+// Push an item moved out of a quotation: literals are owned by the stack once pushed,
+// while symbols are evaluated and then freed
+static int hex_push_moved(hex_context_t *ctx, hex_item_t *item)
 {
-    if (header[0] != 0x01 || header[1] != 'h' || header[2] != 'e' || header[3] != 'x' || header[4] != 0x01 || header[7] != 0x02)
+    int symbol = item->type == HEX_TYPE_NATIVE_SYMBOL || item->type == HEX_TYPE_USER_SYMBOL;
+    int result = hex_push(ctx, item);
+    if (symbol || result != 0)
     {
-        return -1;
+        HEX_FREE(ctx, item);
     }
-    uint16_t symbol_table_size = header[5] | (header[6] << 8);
-    return symbol_table_size;
+    return result;
 }
 
-/* File: src/interpreter.c */
-#line 1 "src/interpreter.c"
-#ifndef HEX_H
-#include "hex.h"
-#endif
-
-////////////////////////////////////////
-// Hex Interpreter Implementation     //
-////////////////////////////////////////
-
-hex_context_t *hex_init()
+// Dequote a quotation that remains owned by the caller, so that it can be applied
+// repeatedly: only its literals are copied, while its symbols are evaluated in place
+static int hex_apply(hex_context_t *ctx, hex_item_t *quotation)
 {
-    hex_context_t *context = malloc(sizeof(hex_context_t));
-    if (!context)
-        return NULL;
-
-    context->argc = 0;
-    context->argv = NULL;
-    context->registry = hex_registry_create();
-    context->docs = malloc(sizeof(hex_doc_dictionary_t));
-    if (context->docs)
-    {
-        context->docs->entries = malloc(HEX_NATIVE_SYMBOLS * sizeof(hex_doc_entry_t));
-        context->docs->size = 0;
-    }
-    context->stack = malloc(sizeof(hex_stack_t));
-    if (context->stack)
+    for (size_t i = 0; i < quotation->quotation_size; i++)
     {
-        context->stack->entries = malloc(HEX_STACK_SIZE * sizeof(hex_item_t *));
-        context->stack->top = -1;
-        context->stack->capacity = HEX_STACK_SIZE;
-        // Initialize all entries to NULL
-        for (int i = 0; i < HEX_STACK_SIZE; i++)
+        hex_item_t *item = quotation->data.quotation_value[i];
+        if (item->type == HEX_TYPE_NATIVE_SYMBOL || item->type == HEX_TYPE_USER_SYMBOL)
         {
-            context->stack->entries[i] = NULL;
+            if (hex_push(ctx, item) != 0)
+            {
+                return 1;
+            }
+            continue;
         }
-    }
-    context->stack_trace = malloc(sizeof(hex_stack_trace_t));
-    if (context->stack_trace)
-    {
-        context->stack_trace->entries = malloc(HEX_STACK_TRACE_SIZE * sizeof(hex_token_t *));
-        context->stack_trace->start = 0;
-        context->stack_trace->size = 0;
-        // Initialize all entries to NULL
-        for (int i = 0; i < HEX_STACK_TRACE_SIZE; i++)
+        hex_item_t *copy = hex_copy_item(ctx, item);
+        if (!copy || hex_push_moved(ctx, copy) != 0)
         {
-            context->stack_trace->entries[i] = NULL;
+            return 1;
         }
     }
-    context->settings = malloc(sizeof(hex_settings_t));
-    if (context->settings)
-    {
-        context->settings->debugging_enabled = 0;
-        context->settings->errors_enabled = 1;
-        context->settings->stack_trace_enabled = 1;
-    }
-    context->symbol_table = malloc(sizeof(hex_symbol_table_t));
-    if (context->symbol_table)
+    return 0;
+}
+
+int hex_symbol_i(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
+    for (size_t i = 0; i < item->quotation_size; i++)
     {
-        context->symbol_table->count = 0;
-        context->symbol_table->symbols = malloc(HEX_MAX_USER_SYMBOLS * sizeof(char *));
-        // Initialize all symbols to NULL
-        for (int i = 0; i < HEX_MAX_USER_SYMBOLS; i++)
+        hex_item_t *copy = hex_copy_item(ctx, item->data.quotation_value[i]);
+        if (!copy || hex_push(ctx, copy) != 0)
         {
-            context->symbol_table->symbols[i] = NULL;
+            if (copy)
+            {
+                hex_free_item(ctx, copy);
+            }
+            HEX_FREE(ctx, item);
+            return 1;
         }
     }
-    return context;
+    HEX_FREE(ctx, item); // free original quotation (no aliasing remains)
+    return 0;
 }
 
-int hex_interpret(hex_context_t *ctx, const char *code, const char *filename, int line, int column)
+// evaluate a string, a bytecode buffer or a quotation of bytes
+int hex_symbol_eval(hex_context_t *ctx)
 {
-
-    const char *input = code;
-    hex_file_position_t position = {filename, line, column};
-    hex_token_t *token = hex_next_token(ctx, &input, &position);
-
-    while (token != NULL && token->type != HEX_TOKEN_INVALID)
+    HEX_POP(ctx, file);
+    HEX_POP(ctx, item);
+    if (item->type == HEX_TYPE_STRING)
     {
-        int result = 0;
-        
-        if (token->type == HEX_TOKEN_INTEGER)
-        {
-            result = hex_push_integer(ctx, hex_parse_integer(token->value));
-        }
-        else if (token->type == HEX_TOKEN_STRING)
-        {
-            result = hex_push_string(ctx, token->value);
-        }
-        else if (token->type == HEX_TOKEN_SYMBOL)
+        // Programs are parsed once and then retrieved from the eval cache
+        hex_compiled_t *compiled = hex_get_compiled(ctx, (const uint8_t *)item->data.str_value, item->str_size, 0, file->data.str_value);
+        int result;
+        if (compiled)
         {
-            if (token->position && filename)
-            {
-                if (token->position->filename)
-                {
-                    free((void *)token->position->filename);
-                }
-                token->position->filename = strdup(filename);
-            }
-            result = hex_push_symbol(ctx, token);
-            // hex_push_symbol copies the token (from Patch 2), so we free the original
+            result = hex_run_compiled(ctx, compiled);
+            hex_release_compiled(ctx, compiled);
         }
-        else if (token->type == HEX_TOKEN_QUOTATION_END)
+        else
         {
-            hex_error(ctx, "(%d,%d) Unexpected end of quotation", position.line, position.column);
-            result = 1;
+            result = hex_interpret(ctx, item->data.str_value, file->data.str_value, 1, 1);
         }
-        else if (token->type == HEX_TOKEN_QUOTATION_START)
+        HEX_FREE(ctx, item);
+        HEX_FREE(ctx, file);
+        return result;
+    }
+    else
+    {
+        // Buffers are evaluated directly, quotations of bytes are packed first
+        uint8_t *bytecode = item->data.buffer_value;
+        size_t size = item->str_size;
+        uint8_t *packed = NULL;
+        if (item->type == HEX_TYPE_QUOTATION)
         {
-            hex_item_t *quotationItem = (hex_item_t *)malloc(sizeof(hex_item_t));
-            if (!quotationItem)
+            for (size_t i = 0; i < item->quotation_size; i++)
             {
-                hex_error(ctx, "(%d,%d) Failed to allocate memory for quotation", position.line, position.column);
-                result = 1;
+                if (item->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
+                {
+                    hex_error(ctx, "[symbol !] Quotation must contain only integers");
+                    HEX_FREE(ctx, item);
+                    HEX_FREE(ctx, file);
+                    return 1;
+                }
             }
-            else if (hex_parse_quotation(ctx, &input, quotationItem, &position) != 0)
+            packed = (uint8_t *)malloc(item->quotation_size * sizeof(uint8_t));
+            if (!packed)
             {
-                hex_error(ctx, "(%d,%d) Failed to parse quotation", position.line, position.column);
-                free(quotationItem);
-                result = 1;
+                hex_error(ctx, "[symbol !] Memory allocation failed");
+                HEX_FREE(ctx, item);
+                HEX_FREE(ctx, file);
+                return 1;
             }
-            else
+            for (size_t i = 0; i < item->quotation_size; i++)
             {
-                result = hex_push_quotation(ctx, quotationItem->data.quotation_value, quotationItem->quotation_size);
-                // Don't free quotationItem here as its content is now owned by the stack
-                free(quotationItem); // Only free the wrapper, not the contents
+                packed[i] = (uint8_t)item->data.quotation_value[i]->data.int_value;
             }
+            bytecode = packed;
+            size = item->quotation_size;
         }
-
-        if (result != 0)
+        // Bytecode images are decoded once and then retrieved from the eval cache
+        hex_compiled_t *compiled = hex_get_compiled(ctx, bytecode, size, 1, file->data.str_value);
+        if (compiled)
         {
-            hex_error(ctx, "[interpret] Unable to push: %s", token->value);
-            hex_free_token(token);
-            print_stack_trace(ctx);
+            int result = hex_run_compiled(ctx, compiled);
+            hex_release_compiled(ctx, compiled);
+            free(packed);
+            HEX_FREE(ctx, item);
+            HEX_FREE(ctx, file);
             return result;
         }
-
-        // Always free the token after processing since no function consumes it
-        // All push functions copy the token data they need, so we own the original
-        hex_free_token(token);
-
-        token = hex_next_token(ctx, &input, &position);
+        // Sandbox: save current table pointer; create an overlay to mutate
+        hex_symbol_table_t *original_table = ctx->symbol_table;
+        hex_symbol_table_t *overlay = hex_symboltable_overlay(ctx);
+        if (!overlay)
+        {
+            free(packed);
+            HEX_FREE(ctx, item);
+            HEX_FREE(ctx, file);
+            return 1;
+        }
+        ctx->symbol_table = overlay;
+        int result = hex_interpret_bytecode(ctx, bytecode, size, file->data.str_value);
+        // Destroy mutated overlay and restore original
+        hex_symboltable_destroy(ctx->symbol_table);
+        ctx->symbol_table = original_table;
+        free(packed);
+        HEX_FREE(ctx, item);
+        HEX_FREE(ctx, file);
+        return result;
     }
-    if (token != NULL && token->type == HEX_TOKEN_INVALID)
+}
+
+int hex_symbol_debug(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
+    ctx->settings->debugging_enabled = 1;
+    for (size_t i = 0; i < item->quotation_size; i++)
     {
-        token->position->filename = strdup(filename);
-        add_to_stack_trace(ctx, token);
-        print_stack_trace(ctx);
-        hex_free_token(token); // Make sure to free the invalid token too
-        return 1;
+        hex_item_t *copy = hex_copy_item(ctx, item->data.quotation_value[i]);
+        if (!copy || hex_push(ctx, copy) != 0)
+        {
+            if (copy)
+            {
+                hex_free_item(ctx, copy);
+            }
+            HEX_FREE(ctx, item);
+            ctx->settings->debugging_enabled = 0;
+            return 1;
+        }
     }
+    HEX_FREE(ctx, item);
+    ctx->settings->debugging_enabled = 0;
     return 0;
 }
 
-/* File: src/utils.c */
-#line 1 "src/utils.c"
-#ifndef HEX_H
-#include "hex.h"
-#endif
-
-////////////////////////////////////////
-// Helper Functions                   //
-////////////////////////////////////////
-
-#if defined(__EMSCRIPTEN__)
-#include <emscripten.h>
-
-EM_ASYNC_JS(char *, em_fgets, (const char *buf, size_t bufsize), {
-    return await new Promise(function(resolve, reject) {
-               if (Module.pending_lines.length > 0)
-               {
-                   resolve(Module.pending_lines.shift());
-               }
-               else
-               {
-                   Module.pending_fgets.push(resolve);
-               }
-           })
-        .then(function(s) {
-            // convert JS string to WASM string
-            let l = s.length + 1;
-            if (l >= bufsize)
-            {
-                // truncate
-                l = bufsize - 1;
-            }
-            Module.stringToUTF8(s.slice(0, l), buf, l);
-            return buf;
-        });
-});
+// IO Symbols
 
-#endif
+int hex_symbol_puts(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
+    hex_output_item(&ctx->out, item, 1);
+    hex_output_char(&ctx->out, '\n');
+    HEX_FREE(ctx, item);
+    return 0;
+}
 
-void hex_rpad(const char *str, int total_length)
+int hex_symbol_warn(hex_context_t *ctx)
 {
-    int len = strlen(str);
-    printf("%s", str);
-    for (int i = len; i < total_length; i++)
-    {
-        printf(" ");
-    }
+    HEX_POP(ctx, item);
+    hex_output_item(&ctx->err, item, 1);
+    hex_output_char(&ctx->err, '\n');
+    HEX_FREE(ctx, item);
+    return 0;
 }
-void hex_lpad(const char *str, int total_length)
+
+int hex_symbol_print(hex_context_t *ctx)
 {
-    int len = strlen(str);
-    for (int i = len; i < total_length; i++)
-    {
-        printf(" ");
-    }
-    printf("%s", str);
+    HEX_POP(ctx, item);
+    hex_output_item(&ctx->out, item, 1);
+    HEX_FREE(ctx, item);
+    return 0;
 }
 
-char *hex_itoa(int num, int base)
+int hex_symbol_gets(hex_context_t *ctx)
 {
-    static char str[20];
-    int i = 0;
+    char input[HEX_STDIN_BUFFER_SIZE]; // Buffer to store the input (adjust size if needed)
+    char *p = input;
+    hex_flush_output(ctx);
+#if defined(__EMSCRIPTEN__)
+    p = em_fgets(input, 1024);
+#else
+    p = fgets(input, sizeof(input), stdin);
+#endif
 
-    // Handle 0 explicitly, otherwise empty string is printed
-    if (num == 0)
+    if (p != NULL)
     {
-        str[i++] = '0';
-        str[i] = '\0';
-        return str;
-    }
+        // Strip the newline character at the end of the string
+        input[strcspn(input, "\n")] = '\0';
 
-    // Process each digit
-    while (num != 0)
-    {
-        int rem = num % base;
-        str[i++] = (rem > 9) ? (rem - 10) + 'a' : rem + '0';
-        num = num / base;
+        // Push the input string onto the stack
+        return hex_push_string(ctx, input);
     }
-
-    str[i] = '\0'; // Null-terminate string
-
-    // Reverse the string
-    int start = 0;
-    int end = i - 1;
-    while (start < end)
+    else
     {
-        char temp = str[start];
-        str[start] = str[end];
-        str[end] = temp;
-        start++;
-        end--;
+        hex_error(ctx, "[symbol gets] Failed to read input");
+        return 1;
     }
-
-    return str;
 }
 
-char *hex_itoa_dec(int num)
+// Integer operators work in place: the dispatcher guarantees that the topmost
+// items are integers, so the topmost operand is dropped and the result
+// overwrites the one below it.
+static hex_item_t *hex_integer_operands(hex_context_t *ctx, int32_t *right)
 {
-    return hex_itoa(num, 10);
+    hex_stack_t *stack = ctx->stack;
+    hex_item_t *top = stack->entries[stack->top];
+    *right = top->data.int_value;
+    HEX_FREE(ctx, top);
+    stack->entries[stack->top--] = NULL;
+    return stack->entries[stack->top];
 }
 
-char *hex_itoa_hex(int num)
+static int hex_integer_operands_available(hex_context_t *ctx)
 {
-    return hex_itoa(num, 16);
+    hex_stack_t *stack = ctx->stack;
+    return stack->top >= 1 && stack->entries[stack->top]->type == HEX_TYPE_INTEGER && stack->entries[stack->top - 1]->type == HEX_TYPE_INTEGER;
 }
 
-void hex_raw_print_item(FILE *stream, hex_item_t item)
+static int hex_vector_operands_available(hex_context_t *ctx)
 {
-    switch (item.type)
+    hex_stack_t *stack = ctx->stack;
+    if (stack->top < 1)
     {
-    case HEX_TYPE_INTEGER:
-        fprintf(stream, "$%x", item.data.int_value);
-        break;
-    case HEX_TYPE_STRING:
-        fprintf(stream, "%s", item.data.str_value);
-        break;
-    case HEX_TYPE_USER_SYMBOL:
-    case HEX_TYPE_NATIVE_SYMBOL:
-        fprintf(stream, "%s", item.token->value);
-        break;
-    case HEX_TYPE_QUOTATION:
-        fprintf(stream, "(");
-        for (size_t i = 0; i < item.quotation_size; i++)
-        {
-            if (i > 0)
-            {
-                fprintf(stream, " ");
-            }
-            hex_print_item(stream, item.data.quotation_value[i]);
-        }
-        fprintf(stream, ")");
-        break;
-
-    case HEX_TYPE_INVALID:
-        fprintf(stream, "<invalid>");
-        break;
-    default:
-        fprintf(stream, "<unknown:%d>", item.type);
-        break;
+        return 0;
     }
+    hex_item_type_t a = stack->entries[stack->top - 1]->type;
+    hex_item_type_t b = stack->entries[stack->top]->type;
+    return (a == HEX_TYPE_VECTOR && (b == HEX_TYPE_VECTOR || b == HEX_TYPE_INTEGER)) ||
+           (b == HEX_TYPE_VECTOR && a == HEX_TYPE_INTEGER);
 }
 
-void hex_encode_length(uint8_t **bytecode, size_t *size, size_t length)
+// Apply an operator elementwise to a vector and an integer, or to two vectors of the
+// same length. The result is written in place into a vector operand, which is owned
+// by the calling native.
+static int hex_vector_operation(hex_context_t *ctx, hex_opcode_t op, const char *symbol)
 {
-    while (length >= 0x80)
+    HEX_POP(ctx, b);
+    HEX_POP(ctx, a);
+    int a_vector = a->type == HEX_TYPE_VECTOR;
+    int b_vector = b->type == HEX_TYPE_VECTOR;
+    if (a_vector && b_vector && a->quotation_size != b->quotation_size)
     {
-        (*bytecode)[*size] = (length & 0x7F) | 0x80;
-        length >>= 7;
-        (*size)++;
+        hex_error(ctx, "[symbol %s] Vectors must have the same length", symbol);
+        HEX_FREE(ctx, a);
+        HEX_FREE(ctx, b);
+        return 1;
     }
-    (*bytecode)[*size] = length & 0x7F;
-    (*size)++;
-}
-
-int hex_is_binary(const uint8_t *data, size_t size)
-{
-    const double binary_threshold = 0.1; // 10% of bytes being non-printable
-    size_t non_printable_count = 0;
-    for (size_t i = 0; i < size; i++)
+    hex_item_t *target = a_vector ? a : b;
+    hex_item_t *other = a_vector ? b : a;
+    hex_vector_apply(op, target->data.vector_value,
+                     a_vector ? a->data.vector_value : &a->data.int_value, a_vector,
+                     b_vector ? b->data.vector_value : &b->data.int_value, b_vector,
+                     target->quotation_size);
+    HEX_FREE(ctx, other);
+    if (HEX_PUSH(ctx, target) != 0)
     {
-        uint8_t byte = data[i];
-        // Check if the byte is a printable ASCII character or a common control character.
-        if (!((byte >= 32 && byte <= 126) || byte == 9 || byte == 10 || byte == 13))
-        {
-            non_printable_count++;
-        }
-        // Early exit if the threshold is exceeded.
-        if ((double)non_printable_count / size > binary_threshold)
-        {
-            return 1;
-        }
+        HEX_FREE(ctx, target);
+        return 1;
     }
     return 0;
 }
 
-void hex_print_string(FILE *stream, char *value)
+static int hex_division_by_zero(hex_context_t *ctx, const char *symbol)
 {
-    fprintf(stream, "\"");
-    for (char *c = value; *c != '\0'; c++)
+    if (ctx->stack->entries[ctx->stack->top]->data.int_value != 0)
     {
-        switch (*c)
-        {
-        case '\n':
-            fprintf(stream, "\\n");
-            break;
-        case '\t':
-            fprintf(stream, "\\t");
-            break;
-        case '\r':
-            fprintf(stream, "\\r");
-            break;
-        case '\b':
-            fprintf(stream, "\\b");
-            break;
-        case '\f':
-            fprintf(stream, "\\f");
-            break;
-        case '\v':
-            fprintf(stream, "\\v");
-            break;
-        case '\\':
-            fprintf(stream, "\\\\");
-            break;
-        case '\"':
-            fprintf(stream, "\\\"");
-            break;
-        default:
-            fputc(*c, stream);
-            break;
-        }
+        return 0;
     }
-    fprintf(stream, "\"");
-}
-
-void hex_print_item(FILE *stream, hex_item_t *item)
-{
-    switch (item->type)
-    {
-    case HEX_TYPE_INTEGER:
-        fprintf(stream, "$%x", item->data.int_value);
-        break;
-
-    case HEX_TYPE_STRING:
-        hex_print_string(stream, item->data.str_value);
-        break;
-
-    case HEX_TYPE_USER_SYMBOL:
-    case HEX_TYPE_NATIVE_SYMBOL:
-        fprintf(stream, "%s", item->token->value);
-        break;
-
-    case HEX_TYPE_QUOTATION:
-        fprintf(stream, "(");
-        for (size_t i = 0; i < item->quotation_size; i++)
-        {
-            if (i > 0)
-            {
-                fprintf(stream, " ");
-            }
-            hex_print_item(stream, item->data.quotation_value[i]);
-        }
-        fprintf(stream, ")");
-        break;
+    hex_error(ctx, "[symbol %s] Division by zero", symbol);
+    HEX_POP(ctx, b);
+    HEX_POP(ctx, a);
+    HEX_FREE(ctx, a);
+    HEX_FREE(ctx, b);
+    return 1;
+}
 
-    case HEX_TYPE_INVALID:
-        fprintf(stream, "<invalid>");
-        break;
-    default:
-        fprintf(stream, "<unknown:%d>", item->type);
-        break;
+// Mathematical symbols
+int hex_symbol_add(hex_context_t *ctx)
+{
+    if (!hex_integer_operands_available(ctx))
+    {
+        return hex_vector_operation(ctx, HEX_OP_ADD, "+");
     }
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value += b;
+    return 0;
 }
 
-char *hex_bytes_to_string(const uint8_t *bytes, size_t size)
+int hex_symbol_subtract(hex_context_t *ctx)
 {
-    char *str = (char *)malloc(size * 6 + 1); // Allocate enough space for worst case (\uXXXX format)
-    if (!str)
+    if (!hex_integer_operands_available(ctx))
     {
-        return NULL; // Allocation failed
+        return hex_vector_operation(ctx, HEX_OP_SUBTRACT, "-");
     }
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value -= b;
+    return 0;
+}
 
-    char *ptr = str;
-    for (size_t i = 0; i < size; i++)
+int hex_symbol_multiply(hex_context_t *ctx)
+{
+    if (!hex_integer_operands_available(ctx))
     {
-        uint8_t byte = bytes[i];
-        switch (byte)
-        {
-        case '\n':
-            *ptr++ = '\\';
-            *ptr++ = 'n';
-            break;
-        case '\t':
-            *ptr++ = '\\';
-            *ptr++ = 't';
-            break;
-        case '\r':
-            if (i + 1 < size && bytes[i + 1] == '\n')
-            {
-                i++; // Skip the '\n' part of the '\r\n' sequence
-            }
-            *ptr++ = '\\';
-            *ptr++ = 'n';
-            break;
-        case '\b':
-            *ptr++ = '\\';
-            *ptr++ = 'b';
-            break;
-        case '\f':
-            *ptr++ = '\\';
-            *ptr++ = 'f';
-            break;
-        case '\v':
-            *ptr++ = '\\';
-            *ptr++ = 'v';
-            break;
-        case '\\':
-            *ptr++ = '\\';
-            break;
-        case '\"':
-            *ptr++ = '\\';
-            *ptr++ = '\"';
-            break;
-        default:
-            *ptr++ = byte;
-            break;
-        }
+        return hex_vector_operation(ctx, HEX_OP_MULTIPLY, "*");
     }
-    *ptr = '\0';
-    return str;
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value *= b;
+    return 0;
 }
 
-char *hex_process_string(const char *value)
+int hex_symbol_divide(hex_context_t *ctx)
 {
-    int len = strlen(value);
-    char *processed_str = (char *)malloc(len + 1);
-    if (!processed_str)
+    if (hex_division_by_zero(ctx, "/"))
     {
-        return NULL;
+        return 1;
     }
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value /= b;
+    return 0;
+}
 
-    char *dst = processed_str;
-    const char *src = value;
-    while (*src)
+int hex_symbol_modulo(hex_context_t *ctx)
+{
+    if (hex_division_by_zero(ctx, "%"))
     {
-        if (*src == '\\' && *(src + 1))
-        {
-            src++;
-            switch (*src)
-            {
-            case 'n':
-                *dst++ = '\n';
-                break;
-            case 't':
-                *dst++ = '\t';
-                break;
-            case 'r':
-                *dst++ = '\r';
-                break;
-            case 'b':
-                *dst++ = '\b';
-                break;
-            case 'f':
-                *dst++ = '\f';
-                break;
-            case 'v':
-                *dst++ = '\v';
-                break;
-            case '\"':
-                *dst++ = '\"';
-                break;
-            default:
-                *dst++ = '\\';
-                *dst++ = *src;
-                break;
-            }
-        }
-        else
-        {
-            *dst++ = *src;
-        }
-        src++;
+        return 1;
     }
-    *dst = '\0';
-    return processed_str;
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value %= b;
+    return 0;
 }
 
-size_t hex_min_bytes_to_encode_integer(int32_t value)
+// Bit symbols
+
+int hex_symbol_bitand(hex_context_t *ctx)
 {
-    // If value is negative, we need to return 4 bytes because we must preserve the sign bits.
-    if (value < 0)
+    if (!hex_integer_operands_available(ctx))
     {
-        return 4;
+        return hex_vector_operation(ctx, HEX_OP_BITAND, "&");
     }
+    int32_t right;
+    hex_item_t *left = hex_integer_operands(ctx, &right);
+    left->data.int_value &= right;
+    return 0;
+}
 
-    // For positive values, check the minimal number of bytes needed.
-    for (int bytes = 1; bytes <= 4; bytes++)
+int hex_symbol_bitor(hex_context_t *ctx)
+{
+    if (!hex_integer_operands_available(ctx))
     {
-        int32_t mask = (1 << (bytes * 8)) - 1;
-        int32_t truncated_value = value & mask;
-
-        // If the truncated value is equal to the original, this is the minimal byte size
-        if (truncated_value == value)
-        {
-            return bytes;
-        }
+        return hex_vector_operation(ctx, HEX_OP_BITOR, "|");
     }
-
-    return 4; // Default to 4 bytes if no smaller size is found.
+    int32_t right;
+    hex_item_t *left = hex_integer_operands(ctx, &right);
+    left->data.int_value |= right;
+    return 0;
 }
 
-char *hex_unescape_string(const char *input)
+int hex_symbol_bitxor(hex_context_t *ctx)
 {
-    size_t len = strlen(input);
-    char *unescaped = (char *)malloc(len + 1);
-
-    size_t j = 0;
-    for (size_t i = 0; i < len; i++)
+    if (!hex_integer_operands_available(ctx))
     {
-        if (input[i] == '\\' && i + 1 < len)
-        {
-            switch (input[i + 1])
-            {
-            case 'n':
-                unescaped[j++] = '\n';
-                i++;
-                break;
-            case 't':
-                unescaped[j++] = '\t';
-                i++;
-                break;
-            case 'r':
-                unescaped[j++] = '\r';
-                i++;
-                break;
-            case '\\':
-                unescaped[j++] = '\\';
-                i++;
-                break;
-            case '\"':
-                unescaped[j++] = '\"';
-                i++;
-                break;
-            case '\'':
-                unescaped[j++] = '\'';
-                i++;
-                break;
-            case 'v':
-                unescaped[j++] = '\v';
-                i++;
-                break;
-            case 'f':
-                unescaped[j++] = '\f';
-                i++;
-                break;
-            case 'a':
-                unescaped[j++] = '\a';
-                i++;
-                break;
-            case 'b':
-                unescaped[j++] = '\b';
-                i++;
-                break;
-            default:
-                unescaped[j++] = input[i];
-            }
-        }
-        else
-        {
-            unescaped[j++] = input[i];
-        }
+        return hex_vector_operation(ctx, HEX_OP_BITXOR, "^");
     }
-    unescaped[j] = '\0'; // Null-terminate the string
-    return unescaped;
+    int32_t right;
+    hex_item_t *left = hex_integer_operands(ctx, &right);
+    left->data.int_value ^= right;
+    return 0;
 }
 
-#ifdef _WIN32
-#include <windows.h>
-#include <sysinfoapi.h>
-
-void get_unix_timestamp_sec_usec(int32_t result[2])
+int hex_symbol_shiftleft(hex_context_t *ctx)
 {
-    FILETIME ft;
-    GetSystemTimeAsFileTime(&ft);
+    if (!hex_integer_operands_available(ctx))
+    {
+        return hex_vector_operation(ctx, HEX_OP_SHL, "<<");
+    }
+    int32_t right;
+    hex_item_t *left = hex_integer_operands(ctx, &right);
+    left->data.int_value = hex_shift_left(left->data.int_value, right);
+    return 0;
+}
 
-    ULARGE_INTEGER uli;
-    uli.LowPart = ft.dwLowDateTime;
-    uli.HighPart = ft.dwHighDateTime;
+int hex_symbol_shiftright(hex_context_t *ctx)
+{
+    if (!hex_integer_operands_available(ctx))
+    {
+        return hex_vector_operation(ctx, HEX_OP_SHR, ">>");
+    }
+    int32_t right;
+    hex_item_t *left = hex_integer_operands(ctx, &right);
+    left->data.int_value = hex_shift_right(left->data.int_value, right);
+    return 0;
+}
 
-    const uint64_t EPOCH_DIFFERENCE_100NS = 116444736000000000ULL;
-    uint64_t timestamp_100ns = uli.QuadPart - EPOCH_DIFFERENCE_100NS;
+int hex_symbol_bitnot(hex_context_t *ctx)
+{
+    hex_item_t *item = ctx->stack->entries[ctx->stack->top];
+    item->data.int_value = ~item->data.int_value;
+    return 0;
+}
 
-    uint64_t total_microseconds = timestamp_100ns / 10;
+// Conversion symbols
 
-    result[0] = (int32_t)(total_microseconds / 1000000); // seconds
-    result[1] = (int32_t)(total_microseconds % 1000000); // microseconds
+int hex_symbol_int(hex_context_t *ctx)
+{
+    HEX_POP(ctx, a);
+    int result = hex_push_integer(ctx, hex_parse_number(a->data.str_value, 16));
+    HEX_FREE(ctx, a);
+    return result;
 }
 
-#else
-#include <sys/time.h>
+int hex_symbol_str(hex_context_t *ctx)
+{
+    HEX_POP(ctx, a);
+    char text[HEX_INTEGER_TEXT_SIZE];
+    char *end = text + sizeof(text);
+    char *start = hex_format_hex((uint32_t)a->data.int_value, end);
+    HEX_FREE(ctx, a);
+    hex_item_t *item = hex_string_bytes_item(ctx, start, end - start);
+    if (!item || HEX_PUSH(ctx, item) != 0)
+    {
+        HEX_FREE(ctx, item);
+        return 1;
+    }
+    return 0;
+}
 
-void get_unix_timestamp_sec_usec(int32_t result[2])
+int hex_symbol_dec(hex_context_t *ctx)
 {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    result[0] = (int32_t)tv.tv_sec;  // seconds
-    result[1] = (int32_t)tv.tv_usec; // microseconds
+    HEX_POP(ctx, a);
+    char text[HEX_INTEGER_TEXT_SIZE];
+    char *end = text + sizeof(text);
+    char *start = hex_format_decimal(a->data.int_value, end);
+    HEX_FREE(ctx, a);
+    hex_item_t *item = hex_string_bytes_item(ctx, start, end - start);
+    if (!item || HEX_PUSH(ctx, item) != 0)
+    {
+        HEX_FREE(ctx, item);
+        return 1;
+    }
+    return 0;
 }
-#endif
 
-void hex_destroy(hex_context_t *ctx)
+int hex_symbol_hex(hex_context_t *ctx)
 {
-    if (!ctx)
-        return;
+    HEX_POP(ctx, item);
+    int result = hex_push_integer(ctx, hex_parse_number(item->data.str_value, 10));
+    HEX_FREE(ctx, item);
+    return result;
+}
 
-    // Clean up stack
-    if (ctx->stack)
+// Parse a string of integers separated by whitespace into a vector, in one pass.
+// Integers are decimal, or hexadecimal if prefixed with $, and may be negative.
+int hex_symbol_ints(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
+    const char *p = item->data.str_value;
+    const char *end = p + item->str_size;
+    // Each integer takes at least two bytes, including its separator
+    int32_t *values = (int32_t *)malloc((item->str_size / 2 + 1) * sizeof(int32_t));
+    if (!values)
     {
-        // Free all items remaining on the stack
-        for (int i = 0; i <= ctx->stack->top; i++)
+        hex_error(ctx, "[symbol ints] Memory allocation failed");
+        HEX_FREE(ctx, item);
+        return 1;
+    }
+    size_t count = 0;
+    while (1)
+    {
+        while (p < end && isspace((unsigned char)*p))
         {
-            if (ctx->stack->entries[i])
-            {
-                hex_free_item(ctx, ctx->stack->entries[i]);
-                ctx->stack->entries[i] = NULL;
-            }
+            p++;
         }
-        if (ctx->stack->entries)
+        if (p == end)
         {
-            free(ctx->stack->entries);
+            break;
         }
-        free(ctx->stack);
-    }
-
-    // Clean up registry
-    if (ctx->registry)
-    {
-        hex_registry_destroy(ctx);
-    }
-
-    // Clean up stack trace
-    if (ctx->stack_trace)
-    {
-        if (ctx->stack_trace->entries)
+        const char *start = p;
+        int negative = *p == '-';
+        if (negative)
         {
-            for (int i = 0; i < HEX_STACK_TRACE_SIZE; i++)
-            {
-                if (ctx->stack_trace->entries[i])
-                {
-                    hex_free_token(ctx->stack_trace->entries[i]);
-                }
-            }
-            free(ctx->stack_trace->entries);
+            p++;
         }
-        free(ctx->stack_trace);
-    }
-
-    // Clean up symbol table
-    if (ctx->symbol_table)
-    {
-        if (ctx->symbol_table->symbols)
+        const char *digits = *p == '$' ? p + 1 : p;
+        uint32_t value = *p == '$' ? hex_parse_hex_digits(digits, &p) : hex_parse_decimal_digits(digits, &p);
+        if (p == digits || (p < end && !isspace((unsigned char)*p)))
         {
-            for (int i = 0; i < ctx->symbol_table->count && i < HEX_MAX_USER_SYMBOLS; i++)
+            char token[32];
+            size_t size = 0;
+            while (start + size < end && !isspace((unsigned char)start[size]) && size < sizeof(token) - 1)
             {
-                if (ctx->symbol_table->symbols[i])
-                {
-                    free(ctx->symbol_table->symbols[i]);
-                }
+                token[size] = start[size];
+                size++;
             }
-            free(ctx->symbol_table->symbols);
+            token[size] = '\0';
+            hex_error(ctx, "[symbol ints] Invalid integer: %s", token);
+            free(values);
+            HEX_FREE(ctx, item);
+            return 1;
         }
-        free(ctx->symbol_table);
+        values[count++] = (int32_t)(negative ? 0u - value : value);
     }
+    HEX_FREE(ctx, item);
+    return hex_push_vector(ctx, values, count);
+}
 
-    // Clean up docs
-    if (ctx->docs)
+int hex_symbol_ord(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
+    if (item->str_size > 1)
     {
-        if (ctx->docs->entries)
-        {
-            free(ctx->docs->entries);
-        }
-        free(ctx->docs);
+        int result = hex_push_integer(ctx, -1);
+        HEX_FREE(ctx, item);
+        return result;
     }
-
-    // Clean up settings
-    if (ctx->settings)
+    unsigned char *str = (unsigned char *)item->data.str_value;
+    int result;
+    if (str[0] < 128)
     {
-        free(ctx->settings);
+        result = hex_push_integer(ctx, str[0]);
     }
-
-    free(ctx);
+    else
+    {
+        result = hex_push_integer(ctx, -1);
+    }
+    HEX_FREE(ctx, item);
+    return result;
 }
 
-/* File: src/symbols.c */
-#line 1 "src/symbols.c"
-#ifndef HEX_H
-#include "hex.h"
-#endif
-
-////////////////////////////////////////
-// Native Symbol Implementations      //
-////////////////////////////////////////
+int hex_symbol_chr(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
+    int result;
+    if (item->data.int_value >= 0 && item->data.int_value < 128)
+    {
+        char str[2] = {(char)item->data.int_value, '\0'};
+        result = hex_push_string(ctx, str);
+    }
+    else
+    {
+        result = hex_push_string(ctx, "");
+    }
+    HEX_FREE(ctx, item);
+    return result;
+}
 
-// Definition symbols
+// Comparison symbols
 
-int hex_symbol_store(hex_context_t *ctx)
+// Items are compared by value; hashes are only used to tell unequal items apart
+// when they have already been computed for both
+int hex_equal(hex_item_t *a, hex_item_t *b)
 {
-    HEX_POP(ctx, name);
-    ;
-    if (name->type == HEX_TYPE_INVALID)
+    if (a->type == HEX_TYPE_INVALID || b->type == HEX_TYPE_INVALID)
     {
-        HEX_FREE(ctx, name);
-        return 1;
+        return 0;
     }
-    HEX_POP(ctx, value);
-    ;
-    if (value->type == HEX_TYPE_INVALID)
+    if (a->type == HEX_TYPE_NATIVE_SYMBOL || a->type == HEX_TYPE_USER_SYMBOL)
     {
-        HEX_FREE(ctx, name);
-        HEX_FREE(ctx, value);
-        return 1;
+        if (b->type != HEX_TYPE_NATIVE_SYMBOL && b->type != HEX_TYPE_USER_SYMBOL)
+            return 0;
+        return (strcmp(a->token->value, b->token->value) == 0);
     }
-    if (name->type != HEX_TYPE_STRING)
+    if (a->type != b->type)
     {
-        hex_error(ctx, "[symbol :] Symbol name must be a string");
-        HEX_FREE(ctx, name);
-        HEX_FREE(ctx, value);
-        return 1;
+        return 0;
     }
-
-    if (value->type == HEX_TYPE_QUOTATION)
+    if (a->type == HEX_TYPE_INTEGER)
     {
-        value->is_operator = 0;
+        return a->data.int_value == b->data.int_value;
     }
-    if (hex_set_symbol(ctx, name->data.str_value, value, 0) != 0)
+    if ((a->type == HEX_TYPE_STRING || a->type == HEX_TYPE_BUFFER || a->type == HEX_TYPE_VECTOR) && a->hash && b->hash && a->hash != b->hash)
     {
-        hex_error(ctx, "[symbol :] Failed to store symbol '%s'", name->data.str_value);
-        HEX_FREE(ctx, name);
-        HEX_FREE(ctx, value);
-        return 1;
+        return 0;
     }
-    // Success: registry takes ownership of 'value'. Free name only.
-    HEX_FREE(ctx, name);
-    return 0;
-}
-
-int hex_symbol_define(hex_context_t *ctx)
-{
-    HEX_POP(ctx, name);
-    ;
-    if (name->type == HEX_TYPE_INVALID)
+    if (a->type == HEX_TYPE_STRING)
     {
-        HEX_FREE(ctx, name);
-        return 1;
+        return a->str_size == b->str_size && (a->data.str_value == b->data.str_value || memcmp(a->data.str_value, b->data.str_value, a->str_size) == 0);
     }
-    HEX_POP(ctx, value);
-    ;
-    if (value->type == HEX_TYPE_INVALID)
+    if (a->type == HEX_TYPE_BUFFER)
     {
-        HEX_FREE(ctx, name);
-        HEX_FREE(ctx, value);
-        return 1;
+        return a->str_size == b->str_size && memcmp(a->data.buffer_value, b->data.buffer_value, a->str_size) == 0;
     }
-
-    if (name->type != HEX_TYPE_STRING)
+    if (a->type == HEX_TYPE_VECTOR)
     {
-        hex_error(ctx, "[symbol ::] Symbol name must be a string");
-        HEX_FREE(ctx, name);
-        HEX_FREE(ctx, value);
-        return 1;
+        return a->quotation_size == b->quotation_size && memcmp(a->data.vector_value, b->data.vector_value, a->quotation_size * sizeof(int32_t)) == 0;
     }
-
-    if (value->type == HEX_TYPE_QUOTATION)
+    if (a->type == HEX_TYPE_SEQUENCE)
     {
-        value->is_operator = 1;
+        // Sequences are only equal to their copies
+        return a->data.seq_value == b->data.seq_value;
     }
-
-    if (hex_set_symbol(ctx, name->data.str_value, value, 0) != 0)
+    if (a->type == HEX_TYPE_DICTIONARY)
     {
-        hex_error(ctx, "[symbol ::] Failed to store symbol '%s'", name->data.str_value);
-        HEX_FREE(ctx, name);
-        HEX_FREE(ctx, value);
+        const hex_dict_t *da = a->data.dict_value;
+        const hex_dict_t *db = b->data.dict_value;
+        if (da == db)
+        {
+            return 1;
+        }
+        if (da->size != db->size)
+        {
+            return 0;
+        }
+        // Dictionaries with the same keys and values are equal, regardless of key order
+        for (size_t i = 0; i < da->count; i++)
+        {
+            if (!da->entries[i].key)
+            {
+                continue;
+            }
+            hex_item_t *value = hex_dict_get(db, da->entries[i].key);
+            if (!value || !hex_equal(da->entries[i].value, value))
+            {
+                return 0;
+            }
+        }
         return 1;
     }
-    // Success: registry now owns 'value'; free only the name item.
-    HEX_FREE(ctx, name);
+    if (a->type == HEX_TYPE_QUOTATION)
+    {
+        if (a->quotation_size != b->quotation_size)
+        {
+            return 0;
+        }
+        else if (a->data.quotation_value == b->data.quotation_value)
+        {
+            return 1; // Copies sharing their items
+        }
+        else if (a->share && b->share && a->share->hash && b->share->hash && a->share->hash != b->share->hash)
+        {
+            return 0;
+        }
+        else
+        {
+            for (size_t i = 0; i < a->quotation_size; i++)
+            {
+                if (!hex_equal(a->data.quotation_value[i], b->data.quotation_value[i]))
+                {
+                    return 0;
+                }
+            }
+            return 1;
+        }
+    }
     return 0;
 }
 
-int hex_symbol_free(hex_context_t *ctx)
+// Compare two strings byte by byte, the shorter one first if it is a prefix of the other
+static int hex_compare_strings(hex_item_t *a, hex_item_t *b)
 {
-    HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    if (item->type != HEX_TYPE_STRING)
-    {
-        HEX_FREE(ctx, item);
-        hex_error(ctx, "[symbol #] Symbol name must be a string");
-        return 1;
-    }
-    if (hex_valid_native_symbol(ctx, item->data.str_value))
+    size_t min_size = a->str_size < b->str_size ? a->str_size : b->str_size;
+    int cmp = memcmp(a->data.str_value, b->data.str_value, min_size);
+    if (cmp != 0)
     {
-        hex_error(ctx, "[symbol #] Cannot free native symbol '%s'", item->data.str_value);
-        HEX_FREE(ctx, item);
-        return 1;
+        return cmp;
     }
-    if (hex_delete_symbol(ctx, item->data.str_value) != 0)
+    return (a->str_size > b->str_size) - (a->str_size < b->str_size);
+}
+
+static int hex_is_type_symbol(hex_item_t *item)
+{
+    if (item->type == HEX_TYPE_USER_SYMBOL || item->type == HEX_TYPE_NATIVE_SYMBOL)
     {
-        hex_error(ctx, "[symbol #] Symbol not found: %s", item->data.str_value);
-        HEX_FREE(ctx, item);
         return 1;
     }
-    // Success: free the popped symbol name item
-    HEX_FREE(ctx, item);
     return 0;
 }
 
-int hex_symbol_symbols(hex_context_t *ctx)
+static int hex_greater(hex_context_t *ctx, hex_item_t *a, hex_item_t *b, const char *symbol)
 {
-    // Allocate memory for the quotation
-    hex_item_t **quotation = (hex_item_t **)calloc(ctx->registry->size, sizeof(hex_item_t *));
-    if (!quotation)
+    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
     {
-        hex_error(ctx, "[symbol symbols] Memory allocation failed for quotation");
-        return 1;
+        return a->data.int_value > b->data.int_value;
     }
-
-    size_t quotation_size = 0;
-
-    // Iterate through each bucket in the hash table
-    for (size_t i = 0; i < ctx->registry->bucket_count; i++)
+    else if (a->type == HEX_TYPE_STRING && b->type == HEX_TYPE_STRING)
     {
-        hex_registry_entry_t *entry = ctx->registry->buckets[i];
-        while (entry != NULL)
+        return hex_compare_strings(a, b) > 0;
+    }
+    else if (a->type == HEX_TYPE_QUOTATION && b->type == HEX_TYPE_QUOTATION)
+    {
+        // Compare quotations lexicographically
+        size_t min_size = a->quotation_size < b->quotation_size ? a->quotation_size : b->quotation_size;
+        int is_greater = 0;
+
+        for (size_t i = 0; i < min_size; i++)
         {
-            // Build a new string item using constructor for consistency
-            hex_item_t *item = hex_string_item(ctx, entry->key);
-            if (!item)
+            hex_item_t *it_a = a->data.quotation_value[i];
+            hex_item_t *it_b = b->data.quotation_value[i];
+
+            // Perform element-wise comparison
+            if (it_a->type != it_b->type && !(hex_is_type_symbol(it_a) && hex_is_type_symbol(it_b)))
             {
-                hex_error(ctx, "[symbol symbols] Failed to allocate string item");
-                for (size_t j = 0; j < quotation_size; j++)
+                // Mismatched types, return false
+                return 0;
+            }
+
+            if (it_a->type == HEX_TYPE_INTEGER)
+            {
+                if (it_a->data.int_value != it_b->data.int_value)
                 {
-                    hex_free_item(ctx, quotation[j]);
+                    is_greater = it_a->data.int_value > it_b->data.int_value;
+                    break;
                 }
-                free(quotation);
-                return 1;
             }
-            quotation[quotation_size++] = item; // ownership transferred to quotation
-
-            // Move to the next entry in the bucket
-            entry = entry->next;
+            else if (it_a->type == HEX_TYPE_STRING)
+            {
+                int cmp = hex_compare_strings(it_a, it_b);
+                if (cmp != 0)
+                {
+                    is_greater = cmp > 0;
+                    break;
+                }
+            }
+            else if (hex_is_type_symbol(it_a))
+            {
+                int cmp = strcmp(it_a->token->value, it_b->token->value);
+                if (cmp != 0)
+                {
+                    is_greater = cmp > 0;
+                    break;
+                }
+            }
+            else
+            {
+                // Mismatched types, return false
+                return 0;
+            }
         }
-    }
 
-    // Push the quotation onto the stack
-    if (hex_push_quotation(ctx, quotation, quotation_size) != 0)
-    {
-        hex_error(ctx, "[symbol symbols] Failed to push quotation onto the stack");
-        for (size_t j = 0; j < quotation_size; j++)
+        if (!is_greater)
         {
-            hex_free_item(ctx, quotation[j]);
+            // If all compared elements are equal, compare sizes
+            return a->quotation_size > b->quotation_size;
         }
-        free(quotation);
-        return 1;
+        return is_greater;
+    }
+    else
+    {
+        hex_error(ctx, "[symbol %s] Two integers, two strings, or two quotations required", symbol);
+        return -1;
     }
-
-    // Successfully pushed quotation
-    return 0;
 }
 
-int hex_symbol_type(hex_context_t *ctx)
+int hex_symbol_equal(hex_context_t *ctx)
 {
-    HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
+    if (hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, item);
-        return 1;
+        int32_t b;
+        hex_item_t *a = hex_integer_operands(ctx, &b);
+        a->data.int_value = a->data.int_value == b;
+        return 0;
     }
-    int result = hex_push_string(ctx, hex_type(item->type));
-    HEX_FREE(ctx, item);
+    HEX_POP(ctx, b);
+    HEX_POP(ctx, a);
+    // Items of different types are never equal
+    int result = hex_push_integer(ctx, hex_equal(a, b));
+    HEX_FREE(ctx, a);
+    HEX_FREE(ctx, b);
     return result;
 }
 
-// Evaluation symbols
+int hex_symbol_notequal(hex_context_t *ctx)
+{
+    if (hex_integer_operands_available(ctx))
+    {
+        int32_t b;
+        hex_item_t *a = hex_integer_operands(ctx, &b);
+        a->data.int_value = a->data.int_value != b;
+        return 0;
+    }
+    HEX_POP(ctx, b);
+    HEX_POP(ctx, a);
+    // Items of different types are never equal
+    int result = hex_push_integer(ctx, !hex_equal(a, b));
+    HEX_FREE(ctx, a);
+    HEX_FREE(ctx, b);
+    return result;
+}
 
-int hex_symbol_i(hex_context_t *ctx)
+int hex_symbol_greater(hex_context_t *ctx)
 {
-    HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
+    if (hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, item);
-        return 1;
+        int32_t b;
+        hex_item_t *a = hex_integer_operands(ctx, &b);
+        a->data.int_value = a->data.int_value > b;
+        return 0;
     }
-    if (item->type != HEX_TYPE_QUOTATION)
+    if (hex_vector_operands_available(ctx))
     {
-        hex_error(ctx, "[symbol .] Quotation required", hex_type(item->type));
-        HEX_FREE(ctx, item);
-        return 1;
+        return hex_vector_operation(ctx, HEX_OP_GREATER, ">");
     }
-    for (size_t i = 0; i < item->quotation_size; i++)
+    HEX_POP(ctx, b);
+    HEX_POP(ctx, a);
+    int greater = hex_greater(ctx, a, b, ">");
+    if (greater < 0)
     {
-        hex_item_t *copy = hex_copy_item(ctx, item->data.quotation_value[i]);
-        if (!copy || hex_push(ctx, copy) != 0)
-        {
-            if (copy)
-            {
-                hex_free_item(ctx, copy);
-            }
-            HEX_FREE(ctx, item);
-            return 1;
-        }
+        HEX_FREE(ctx, a);
+        HEX_FREE(ctx, b);
+        return 1;
     }
-    HEX_FREE(ctx, item); // free original quotation (no aliasing remains)
-    return 0;
+    int result = hex_push_integer(ctx, greater);
+    HEX_FREE(ctx, a);
+    HEX_FREE(ctx, b);
+    return result;
 }
 
-// evaluate a string or bytecode array
-int hex_symbol_eval(hex_context_t *ctx)
+int hex_symbol_less(hex_context_t *ctx)
 {
-    HEX_POP(ctx, file);
-    HEX_POP(ctx, item);
-    if (file->type == HEX_TYPE_INVALID)
+    if (hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, file);
-        return 1;
+        int32_t b;
+        hex_item_t *a = hex_integer_operands(ctx, &b);
+        a->data.int_value = a->data.int_value < b;
+        return 0;
     }
-    if (file->type != HEX_TYPE_STRING)
+    if (hex_vector_operands_available(ctx))
     {
-        hex_error(ctx, "[symbol !] File name or scope identifier required");
-        HEX_FREE(ctx, file);
-        return 1;
+        return hex_vector_operation(ctx, HEX_OP_LESS, "<");
     }
-    if (item->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, b);
+    HEX_POP(ctx, a);
+    int greater = hex_greater(ctx, b, a, "<");
+    if (greater < 0)
     {
-        HEX_FREE(ctx, item);
-        HEX_FREE(ctx, file);
+        HEX_FREE(ctx, a);
+        HEX_FREE(ctx, b);
         return 1;
     }
-    if (item->type == HEX_TYPE_STRING)
+    int result = hex_push_integer(ctx, greater);
+    HEX_FREE(ctx, a);
+    HEX_FREE(ctx, b);
+    return result;
+}
+
+int hex_symbol_greaterequal(hex_context_t *ctx)
+{
+    if (hex_integer_operands_available(ctx))
     {
-        int result = hex_interpret(ctx, item->data.str_value, file->data.str_value, 1, 1);
-        HEX_FREE(ctx, item);
-        HEX_FREE(ctx, file);
-        return result;
+        int32_t b;
+        hex_item_t *a = hex_integer_operands(ctx, &b);
+        a->data.int_value = a->data.int_value >= b;
+        return 0;
     }
-    else if (item->type == HEX_TYPE_QUOTATION)
+    if (hex_vector_operands_available(ctx))
     {
-        for (size_t i = 0; i < item->quotation_size; i++)
-        {
-            if (item->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
-            {
-                hex_error(ctx, "[symbol !] Quotation must contain only integers");
-                HEX_FREE(ctx, item);
-                HEX_FREE(ctx, file);
-                return 1;
-            }
-        }
-        uint8_t *bytecode = (uint8_t *)malloc(item->quotation_size * sizeof(uint8_t));
-        if (!bytecode)
-        {
-            hex_error(ctx, "[symbol !] Memory allocation failed");
-            HEX_FREE(ctx, item);
-            HEX_FREE(ctx, file);
-            return 1;
-        }
-        for (size_t i = 0; i < item->quotation_size; i++)
-        {
-            bytecode[i] = (uint8_t)item->data.quotation_value[i]->data.int_value;
-        }
-        // Sandbox: save current table pointer; create a working copy to mutate
-        hex_symbol_table_t *original_table = ctx->symbol_table;
-        hex_symbol_table_t *working_copy = hex_symboltable_copy(ctx);
-        if (!working_copy)
-        {
-            free(bytecode);
-            HEX_FREE(ctx, item);
-            HEX_FREE(ctx, file);
-            return 1;
-        }
-        ctx->symbol_table = working_copy;
-        int result = hex_interpret_bytecode(ctx, bytecode, item->quotation_size, file->data.str_value);
-        // Destroy mutated working copy and restore original
-        hex_symboltable_destroy(ctx->symbol_table);
-        ctx->symbol_table = original_table;
-        free(bytecode);
-        HEX_FREE(ctx, item);
-        HEX_FREE(ctx, file);
-        return result;
+        return hex_vector_operation(ctx, HEX_OP_GREATEREQUAL, ">=");
     }
-    else
+    HEX_POP(ctx, b);
+    HEX_POP(ctx, a);
+    int greater = hex_greater(ctx, a, b, ">");
+    if (greater < 0)
     {
-        hex_error(ctx, "[symbol !] String or a quotation of integers required");
-        HEX_FREE(ctx, item);
-        HEX_FREE(ctx, file);
+        HEX_FREE(ctx, a);
+        HEX_FREE(ctx, b);
         return 1;
     }
+    int result = hex_push_integer(ctx, greater || hex_equal(a, b));
+    HEX_FREE(ctx, a);
+    HEX_FREE(ctx, b);
+    return result;
 }
 
-int hex_symbol_debug(hex_context_t *ctx)
+int hex_symbol_lessequal(hex_context_t *ctx)
 {
-    HEX_POP(ctx, item);
-    if (item->type == HEX_TYPE_INVALID)
+    if (hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, item);
-        return 1;
+        int32_t b;
+        hex_item_t *a = hex_integer_operands(ctx, &b);
+        a->data.int_value = a->data.int_value <= b;
+        return 0;
     }
-    if (item->type != HEX_TYPE_QUOTATION)
+    if (hex_vector_operands_available(ctx))
     {
-        hex_error(ctx, "[symbol debug] Quotation required", hex_type(item->type));
-        HEX_FREE(ctx, item);
-        return 1;
+        return hex_vector_operation(ctx, HEX_OP_LESSEQUAL, "<=");
     }
-    ctx->settings->debugging_enabled = 1;
-    for (size_t i = 0; i < item->quotation_size; i++)
+    HEX_POP(ctx, b);
+    HEX_POP(ctx, a);
+    int greater = hex_greater(ctx, b, a, "<");
+    if (greater < 0)
     {
-        hex_item_t *copy = hex_copy_item(ctx, item->data.quotation_value[i]);
-        if (!copy || hex_push(ctx, copy) != 0)
-        {
-            if (copy)
-            {
-                hex_free_item(ctx, copy);
-            }
-            HEX_FREE(ctx, item);
-            ctx->settings->debugging_enabled = 0;
-            return 1;
-        }
+        HEX_FREE(ctx, a);
+        HEX_FREE(ctx, b);
+        return 1;
     }
-    HEX_FREE(ctx, item);
-    ctx->settings->debugging_enabled = 0;
-    return 0;
+    int result = hex_push_integer(ctx, greater || hex_equal(a, b));
+    HEX_FREE(ctx, a);
+    HEX_FREE(ctx, b);
+    return result;
 }
 
-// IO Symbols
+// Boolean symbols
 
-int hex_symbol_puts(hex_context_t *ctx)
+int hex_symbol_and(hex_context_t *ctx)
 {
-    HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    hex_raw_print_item(stdout, *item);
-    printf("\n");
-    HEX_FREE(ctx, item);
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value = a->data.int_value && b;
     return 0;
 }
 
-int hex_symbol_warn(hex_context_t *ctx)
+int hex_symbol_or(hex_context_t *ctx)
 {
-    HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    hex_raw_print_item(stderr, *item);
-    printf("\n");
-    HEX_FREE(ctx, item);
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value = a->data.int_value || b;
     return 0;
 }
 
-int hex_symbol_print(hex_context_t *ctx)
+int hex_symbol_not(hex_context_t *ctx)
 {
-    HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    hex_raw_print_item(stdout, *item);
-    fflush(stdout);
-    HEX_FREE(ctx, item);
+    hex_item_t *a = ctx->stack->entries[ctx->stack->top];
+    a->data.int_value = !a->data.int_value;
     return 0;
 }
 
-int hex_symbol_gets(hex_context_t *ctx)
+int hex_symbol_xor(hex_context_t *ctx)
 {
-    char input[HEX_STDIN_BUFFER_SIZE]; // Buffer to store the input (adjust size if needed)
-    char *p = input;
-#if defined(__EMSCRIPTEN__)
-    p = em_fgets(input, 1024);
-#else
-    p = fgets(input, sizeof(input), stdin);
-#endif
-
-    if (p != NULL)
-    {
-        // Strip the newline character at the end of the string
-        input[strcspn(input, "\n")] = '\0';
-
-        // Push the input string onto the stack
-        return hex_push_string(ctx, input);
-    }
-    else
-    {
-        hex_error(ctx, "[symbol gets] Failed to read input");
-        return 1;
-    }
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value ^= b;
+    return 0;
 }
 
-// Mathematical symbols
-int hex_symbol_add(hex_context_t *ctx)
+// Quotation and String (List) Symbols
+
+// Make room for a string of the given size in a string or buffer item, growing its storage geometrically.
+// The shared bytes of a string are only grown in place if the string can append to them.
+static int hex_string_reserve(hex_item_t *item, size_t size)
 {
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
+    size_t capacity = item->str_capacity > item->str_size + 1 ? item->str_capacity : item->str_size + 1;
+    hex_share_t *share = item->share;
+    int shared = share && share->refs > 1;
+    if (shared && (share->refs - share->stored > 1 || item->str_size != share->used))
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        // Other items read the bytes after the string
+        capacity = item->str_size + 1;
     }
-    HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    else if (size + 1 <= capacity)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        return 0;
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
+    capacity *= 2;
+    if (capacity < size + 1)
     {
-        int result = hex_push_integer(ctx, a->data.int_value + b->data.int_value);
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return result;
+        capacity = size + 1;
     }
-    hex_error(ctx, "[symbol +] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
-}
-
-int hex_symbol_subtract(hex_context_t *ctx)
-{
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
+    if (!shared)
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        char *buffer = (char *)realloc(item->data.str_value, capacity);
+        if (!buffer)
+        {
+            return 1;
+        }
+        item->data.str_value = buffer;
+        item->str_capacity = capacity;
+        return 0;
     }
-    HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    char *buffer = (char *)malloc(capacity);
+    if (!buffer)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
         return 1;
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
-    {
-        int result = hex_push_integer(ctx, a->data.int_value - b->data.int_value);
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return result;
-    }
-    hex_error(ctx, "[symbol -] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
+    memcpy(buffer, item->data.str_value, item->str_size);
+    buffer[item->str_size] = '\0';
+    share->refs--;
+    item->share = NULL;
+    item->data.str_value = buffer;
+    item->str_capacity = capacity;
+    return 0;
 }
 
-int hex_symbol_multiply(hex_context_t *ctx)
+// Make room for the given number of items in a quotation, growing its storage geometrically
+static int hex_quotation_reserve(hex_item_t *item, size_t size)
 {
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
+    size_t capacity = item->quotation_capacity > item->quotation_size ? item->quotation_capacity : item->quotation_size;
+    if (size <= capacity)
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        return 0;
     }
-    HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    capacity *= 2;
+    if (capacity < size)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        capacity = size;
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
+    hex_item_t **items = (hex_item_t **)realloc(item->data.quotation_value, capacity * sizeof(hex_item_t *));
+    if (!items)
     {
-        int result = hex_push_integer(ctx, a->data.int_value * b->data.int_value);
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return result;
+        return 1;
     }
-    hex_error(ctx, "[symbol *] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
+    item->data.quotation_value = items;
+    item->quotation_capacity = capacity;
+    return 0;
 }
 
-int hex_symbol_divide(hex_context_t *ctx)
+// Push a quotation that was edited in place, freeing it on failure
+static int hex_push_edited(hex_context_t *ctx, hex_item_t *list)
 {
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, b);
-        return 1;
-    }
-    HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    if (HEX_PUSH(ctx, list) != 0)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
+        HEX_FREE(ctx, list);
         return 1;
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
+    return 0;
+}
+
+// Check if the items of a quotation or the bytes of a string are shared with other items
+static int hex_is_shared(const hex_item_t *list)
+{
+    return list->share && list->share->refs > 1;
+}
+
+// Take an item out of a quotation popped by a native, copying it if the items are shared
+static hex_item_t *hex_take_item(hex_context_t *ctx, hex_item_t *list, size_t i)
+{
+    hex_item_t *item = list->data.quotation_value[i];
+    if (hex_is_shared(list))
     {
-        if (b->data.int_value == 0)
-        {
-            hex_error(ctx, "[symbol /] Division by zero");
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
-            return 1;
-        }
-        int result = hex_push_integer(ctx, a->data.int_value / b->data.int_value);
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return result;
+        return hex_copy_item(ctx, item);
     }
-    hex_error(ctx, "[symbol /] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
+    list->data.quotation_value[i] = NULL;
+    return item;
 }
 
-int hex_symbol_modulo(hex_context_t *ctx)
+// Get a quotation popped by a native ready to be edited in place, freeing the operands on failure
+static int hex_edit_list(hex_context_t *ctx, const char *symbol, hex_item_t *list, hex_item_t *item)
 {
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
+    if (hex_quotation_unshare(ctx, list) != 0)
     {
-        HEX_FREE(ctx, b);
+        hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
+        HEX_FREE(ctx, list);
+        HEX_FREE(ctx, item);
         return 1;
     }
-    HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    return 0;
+}
+
+int hex_symbol_cat(hex_context_t *ctx)
+{
+    HEX_POP(ctx, value);
+    HEX_POP(ctx, list);
+    if (list->type == HEX_TYPE_QUOTATION && value->type == HEX_TYPE_QUOTATION)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        // Append in place: both quotations are owned by this native, so the items of the
+        // second one are moved to the end of the first one, which grows geometrically.
+        if (hex_quotation_unshare(ctx, list) != 0 || hex_quotation_unshare(ctx, value) != 0 ||
+            hex_quotation_reserve(list, list->quotation_size + value->quotation_size) != 0)
+        {
+            hex_error(ctx, "[symbol cat] Memory allocation failed");
+            HEX_FREE(ctx, list);
+            HEX_FREE(ctx, value);
+            return 1;
+        }
+        memcpy(list->data.quotation_value + list->quotation_size, value->data.quotation_value, value->quotation_size * sizeof(hex_item_t *));
+        list->quotation_size += value->quotation_size;
+        value->quotation_size = 0;
+        HEX_FREE(ctx, value);
+        return hex_push_edited(ctx, list);
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
+    else if (list->type == HEX_TYPE_STRING && value->type == HEX_TYPE_STRING)
     {
-        if (b->data.int_value == 0)
+        // Append in place: the first string is owned by this native, and its buffer
+        // grows geometrically, so repeated cat builds a string in amortized linear time.
+        // The buffer is still appended to when it is shared with the value of a symbol
+        // the string was pushed from, so that "s" : round trips do not copy it.
+        if (hex_string_reserve(list, list->str_size + value->str_size) != 0)
         {
-            hex_error(ctx, "[symbol %%] Division by zero");
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
+            hex_error(ctx, "[symbol cat] Memory allocation failed");
+            HEX_FREE(ctx, list);
+            HEX_FREE(ctx, value);
             return 1;
         }
-        int result = hex_push_integer(ctx, a->data.int_value % b->data.int_value);
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return result;
+        memcpy(list->data.str_value + list->str_size, value->data.str_value, value->str_size);
+        list->str_size += value->str_size;
+        list->data.str_value[list->str_size] = '\0';
+        if (list->share)
+        {
+            list->share->used = list->str_size;
+        }
+        HEX_FREE(ctx, value);
+        if (HEX_PUSH(ctx, list) != 0)
+        {
+            HEX_FREE(ctx, list);
+            return 1;
+        }
+        return 0;
     }
-    hex_error(ctx, "[symbol %%] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
-}
-
-// Bit symbols
-
-int hex_symbol_bitand(hex_context_t *ctx)
-{
-    HEX_POP(ctx, right);
-    ;
-    if (right->type == HEX_TYPE_INVALID)
+    else if (list->type == HEX_TYPE_BUFFER && value->type == HEX_TYPE_BUFFER)
     {
-        HEX_FREE(ctx, right);
-        return 1;
+        if (hex_string_reserve(list, list->str_size + value->str_size) != 0)
+        {
+            hex_error(ctx, "[symbol cat] Memory allocation failed");
+            HEX_FREE(ctx, list);
+            HEX_FREE(ctx, value);
+            return 1;
+        }
+        memcpy(list->data.buffer_value + list->str_size, value->data.buffer_value, value->str_size);
+        list->str_size += value->str_size;
+        HEX_FREE(ctx, value);
+        if (HEX_PUSH(ctx, list) != 0)
+        {
+            HEX_FREE(ctx, list);
+            return 1;
+        }
+        return 0;
     }
-    HEX_POP(ctx, left);
-    ;
-    if (left->type == HEX_TYPE_INVALID)
+    else if (list->type == HEX_TYPE_VECTOR && value->type == HEX_TYPE_VECTOR)
     {
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return 1;
+        size_t size = list->quotation_size + value->quotation_size;
+        int32_t *values = (int32_t *)realloc(list->data.vector_value, size > 0 ? size * sizeof(int32_t) : 1);
+        if (!values)
+        {
+            hex_error(ctx, "[symbol cat] Memory allocation failed");
+            HEX_FREE(ctx, list);
+            HEX_FREE(ctx, value);
+            return 1;
+        }
+        memcpy(values + list->quotation_size, value->data.vector_value, value->quotation_size * sizeof(int32_t));
+        list->data.vector_value = values;
+        list->quotation_size = size;
+        HEX_FREE(ctx, value);
+        if (HEX_PUSH(ctx, list) != 0)
+        {
+            HEX_FREE(ctx, list);
+            return 1;
+        }
+        return 0;
     }
-    if (left->type == HEX_TYPE_INTEGER && right->type == HEX_TYPE_INTEGER)
+    else
     {
-        int result = hex_push_integer(ctx, left->data.int_value & right->data.int_value);
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return result;
+        hex_error(ctx, "[symbol cat] Two quotations or two strings required");
+        HEX_FREE(ctx, list);
+        HEX_FREE(ctx, value);
+        return 1;
     }
-    hex_error(ctx, "[symbol &] Two integers required");
-    HEX_FREE(ctx, left);
-    HEX_FREE(ctx, right);
-    return 1;
 }
 
-int hex_symbol_bitor(hex_context_t *ctx)
+int hex_symbol_len(hex_context_t *ctx)
 {
-    HEX_POP(ctx, right);
-    ;
-    if (right->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, item);
+    int result = 0;
+    if (item->type == HEX_TYPE_QUOTATION || item->type == HEX_TYPE_VECTOR)
     {
-        HEX_FREE(ctx, right);
-        return 1;
+        result = hex_push_integer(ctx, item->quotation_size);
     }
-    HEX_POP(ctx, left);
-    ;
-    if (left->type == HEX_TYPE_INVALID)
+    else if (item->type == HEX_TYPE_DICTIONARY)
     {
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return 1;
+        result = hex_push_integer(ctx, item->data.dict_value->size);
     }
-    if (left->type == HEX_TYPE_INTEGER && right->type == HEX_TYPE_INTEGER)
+    else
     {
-        int result = hex_push_integer(ctx, left->data.int_value | right->data.int_value);
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return result;
+        result = hex_push_integer(ctx, item->str_size);
     }
-    hex_error(ctx, "[symbol |] Two integers required");
-    HEX_FREE(ctx, left);
-    HEX_FREE(ctx, right);
-    return 1;
+    HEX_FREE(ctx, item);
+    return result;
 }
 
-int hex_symbol_bitxor(hex_context_t *ctx)
+int hex_symbol_get(hex_context_t *ctx)
 {
-    HEX_POP(ctx, right);
-    if (right->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, index);
+    HEX_POP(ctx, list);
+    int result = 0;
+    if (list->type == HEX_TYPE_DICTIONARY)
     {
-        HEX_FREE(ctx, right);
-        return 1;
+        // Dictionaries are indexed by key
+        hex_item_t *value = NULL;
+        if (index->type == HEX_TYPE_INTEGER || index->type == HEX_TYPE_STRING)
+        {
+            value = hex_dict_get(list->data.dict_value, index);
+        }
+        if (!value)
+        {
+            hex_error(ctx, "[symbol get] Key not found");
+            result = 1;
+        }
+        else
+        {
+            value = hex_copy_item(ctx, value);
+            result = value ? HEX_PUSH(ctx, value) : 1;
+            if (value && result != 0)
+            {
+                HEX_FREE(ctx, value);
+            }
+        }
+        HEX_FREE(ctx, list);
+        HEX_FREE(ctx, index);
+        return result;
     }
-    HEX_POP(ctx, left);
-    if (left->type == HEX_TYPE_INVALID)
+    if (index->type != HEX_TYPE_INTEGER)
     {
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
+        hex_error(ctx, "[symbol get] Index must be an integer");
+        HEX_FREE(ctx, list);
+        HEX_FREE(ctx, index);
         return 1;
     }
-    if (left->type == HEX_TYPE_INTEGER && right->type == HEX_TYPE_INTEGER)
+    // The list is owned by this native: its storage is reused for the result instead of copied
+    if (list->type == HEX_TYPE_QUOTATION)
     {
-        int result = hex_push_integer(ctx, left->data.int_value ^ right->data.int_value);
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return result;
+        if (index->data.int_value < 0 || (size_t)index->data.int_value >= list->quotation_size)
+        {
+            hex_error(ctx, "[symbol get] Index out of range");
+            result = 1;
+        }
+        else
+        {
+            hex_item_t *element = hex_take_item(ctx, list, index->data.int_value);
+            result = element ? HEX_PUSH(ctx, element) : 1;
+            if (result != 0)
+            {
+                HEX_FREE(ctx, element);
+            }
+        }
+        HEX_FREE(ctx, list);
     }
-    hex_error(ctx, "[symbol ^] Two integers required");
-    HEX_FREE(ctx, left);
-    HEX_FREE(ctx, right);
-    return 1;
-}
-
-int hex_symbol_shiftleft(hex_context_t *ctx)
-{
-    HEX_POP(ctx, right);
-    ;
-    if (right->type == HEX_TYPE_INVALID)
+    else if (list->type == HEX_TYPE_BUFFER)
     {
-        HEX_FREE(ctx, right);
-        return 1;
+        if (index->data.int_value < 0 || (size_t)index->data.int_value >= list->str_size)
+        {
+            hex_error(ctx, "[symbol get] Index out of range");
+            result = 1;
+        }
+        else
+        {
+            result = hex_push_integer(ctx, list->data.buffer_value[index->data.int_value]);
+        }
+        HEX_FREE(ctx, list);
     }
-    HEX_POP(ctx, left);
-    ;
-    if (left->type == HEX_TYPE_INVALID)
+    else if (list->type == HEX_TYPE_VECTOR)
     {
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return 1;
+        if (index->data.int_value < 0 || (size_t)index->data.int_value >= list->quotation_size)
+        {
+            hex_error(ctx, "[symbol get] Index out of range");
+            result = 1;
+        }
+        else
+        {
+            result = hex_push_integer(ctx, list->data.vector_value[index->data.int_value]);
+        }
+        HEX_FREE(ctx, list);
     }
-    if (left->type == HEX_TYPE_INTEGER && right->type == HEX_TYPE_INTEGER)
+    else
     {
-        int result = hex_push_integer(ctx, left->data.int_value << right->data.int_value);
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return result;
+        if (index->data.int_value < 0 || (size_t)index->data.int_value >= list->str_size)
+        {
+            hex_error(ctx, "[symbol get] Index out of range");
+            HEX_FREE(ctx, list);
+            result = 1;
+        }
+        else if (hex_is_shared(list))
+        {
+            // The bytes of the string are read by other items: the character is copied
+            hex_item_t *item = hex_string_bytes_item(ctx, list->data.str_value + index->data.int_value, 1);
+            result = item ? HEX_PUSH(ctx, item) : 1;
+            if (item && result != 0)
+            {
+                HEX_FREE(ctx, item);
+            }
+            HEX_FREE(ctx, list);
+        }
+        else
+        {
+            // The buffer of the string is reused for the character, but shrunk if it is
+            // large, so that the result does not keep the whole allocation alive
+            hex_string_unshare(list);
+            size_t capacity = list->str_capacity > list->str_size + 1 ? list->str_capacity : list->str_size + 1;
+            list->data.str_value[0] = list->data.str_value[index->data.int_value];
+            list->data.str_value[1] = '\0';
+            list->str_size = 1;
+            list->str_capacity = capacity;
+            if (capacity > 16)
+            {
+                char *str = (char *)realloc(list->data.str_value, 2);
+                if (str)
+                {
+                    list->data.str_value = str;
+                    list->str_capacity = 0;
+                }
+            }
+            result = HEX_PUSH(ctx, list);
+            if (result != 0)
+            {
+                HEX_FREE(ctx, list);
+            }
+        }
     }
-    hex_error(ctx, "[symbol <<] Two integers required");
-    HEX_FREE(ctx, left);
-    HEX_FREE(ctx, right);
-    return 1;
+    HEX_FREE(ctx, index);
+    return result;
 }
 
-int hex_symbol_shiftright(hex_context_t *ctx)
+int hex_symbol_index(hex_context_t *ctx)
 {
-    HEX_POP(ctx, right);
-    ;
-    if (right->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, item);
+    HEX_POP(ctx, list);
+    int result = -1;
+    if (list->type == HEX_TYPE_QUOTATION)
     {
-        HEX_FREE(ctx, right);
-        return 1;
+        result = hex_quotation_find(list, item);
     }
-    HEX_POP(ctx, left);
-    ;
-    if (left->type == HEX_TYPE_INVALID)
+    else if (list->type == HEX_TYPE_BUFFER)
     {
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return 1;
+        const uint8_t *ptr = NULL;
+        if (item->type == HEX_TYPE_INTEGER && item->data.int_value >= 0 && item->data.int_value <= 0xff)
+        {
+            ptr = (const uint8_t *)memchr(list->data.buffer_value, item->data.int_value, list->str_size);
+        }
+        if (ptr)
+        {
+            result = ptr - list->data.buffer_value;
+        }
     }
-    if (left->type == HEX_TYPE_INTEGER && right->type == HEX_TYPE_INTEGER)
+    else if (list->type == HEX_TYPE_VECTOR)
     {
-        int result = hex_push_integer(ctx, left->data.int_value >> right->data.int_value);
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return result;
+        if (item->type == HEX_TYPE_INTEGER)
+        {
+            for (size_t i = 0; i < list->quotation_size; i++)
+            {
+                if (list->data.vector_value[i] == item->data.int_value)
+                {
+                    result = i;
+                    break;
+                }
+            }
+        }
     }
-    hex_error(ctx, "[symbol >>] Two integers required");
-    HEX_FREE(ctx, left);
-    HEX_FREE(ctx, right);
-    return 1;
+    else
+    {
+        const char *ptr = hex_find(list->data.str_value, list->str_size, item->data.str_value, item->str_size);
+        if (ptr)
+        {
+            result = ptr - list->data.str_value;
+        }
+    }
+    HEX_FREE(ctx, list);
+    HEX_FREE(ctx, item);
+    return hex_push_integer(ctx, result);
 }
 
-int hex_symbol_bitnot(hex_context_t *ctx)
+// List editing symbols work in place on the quotation they pop, which is owned by the
+// native: items are moved, never copied, and the quotation grows geometrically. Items
+// shared with other quotation items are copied first.
+
+// Insert an item at an index from 0 to the size of a quotation, taking ownership of the item
+static int hex_insert_item(hex_context_t *ctx, const char *symbol, hex_item_t *list, hex_item_t *item, size_t index)
 {
-    HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
+    if (hex_quotation_unshare(ctx, list) != 0 || hex_quotation_reserve(list, list->quotation_size + 1) != 0)
     {
+        hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
+        HEX_FREE(ctx, list);
         HEX_FREE(ctx, item);
         return 1;
     }
-    if (item->type == HEX_TYPE_INTEGER)
+    hex_item_t **items = list->data.quotation_value;
+    memmove(items + index + 1, items + index, (list->quotation_size - index) * sizeof(hex_item_t *));
+    items[index] = item;
+    list->quotation_size++;
+    return hex_push_edited(ctx, list);
+}
+
+// Check that an index is within a quotation (or at its end, if allowed), freeing the operands otherwise
+static int hex_list_index(hex_context_t *ctx, const char *symbol, hex_item_t *list, hex_item_t *item, hex_item_t *index, int end)
+{
+    int32_t i = index->data.int_value;
+    if (i < 0 || (size_t)i > list->quotation_size || ((size_t)i == list->quotation_size && !end))
     {
-        int result = hex_push_integer(ctx, ~item->data.int_value);
+        hex_error(ctx, "[symbol %s] Index out of bounds", symbol);
+        HEX_FREE(ctx, list);
         HEX_FREE(ctx, item);
-        return result;
+        HEX_FREE(ctx, index);
+        return -1;
     }
-    hex_error(ctx, "[symbol ~] Integer required");
-    HEX_FREE(ctx, item);
-    return 1;
+    HEX_FREE(ctx, index);
+    return i;
 }
 
-// Conversion symbols
+int hex_symbol_push(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
+    HEX_POP(ctx, list);
+    return hex_insert_item(ctx, "push", list, item, list->quotation_size);
+}
 
-int hex_symbol_int(hex_context_t *ctx)
+int hex_symbol_pop(hex_context_t *ctx)
 {
-    HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, list);
+    if (hex_edit_list(ctx, "pop", list, NULL) != 0)
     {
-        HEX_FREE(ctx, a);
         return 1;
     }
-    if (a->type == HEX_TYPE_STRING)
+    if (list->quotation_size > 0)
     {
-        int result = hex_push_integer(ctx, strtol(a->data.str_value, NULL, 16));
-        HEX_FREE(ctx, a);
-        return result;
+        list->quotation_size--;
+        HEX_FREE(ctx, list->data.quotation_value[list->quotation_size]);
+        list->data.quotation_value[list->quotation_size] = NULL;
     }
-    hex_error(ctx, "[symbol int] String representing a hexadecimal integer required");
-    HEX_FREE(ctx, a);
-    return 1;
+    return hex_push_edited(ctx, list);
 }
 
-int hex_symbol_str(hex_context_t *ctx)
+int hex_symbol_ins(hex_context_t *ctx)
 {
-    HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, index);
+    HEX_POP(ctx, item);
+    HEX_POP(ctx, list);
+    int i = hex_list_index(ctx, "ins", list, item, index, 1);
+    if (i < 0)
     {
-        HEX_FREE(ctx, a);
         return 1;
     }
-    if (a->type == HEX_TYPE_INTEGER)
-    {
-        int result = hex_push_string(ctx, hex_itoa_hex(a->data.int_value));
-        HEX_FREE(ctx, a);
-        return result;
-    }
-    hex_error(ctx, "[symbol str] Integer required");
-    HEX_FREE(ctx, a);
-    return 1;
+    return hex_insert_item(ctx, "ins", list, item, i);
 }
 
-int hex_symbol_dec(hex_context_t *ctx)
+int hex_symbol_rem(hex_context_t *ctx)
 {
-    HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, index);
+    HEX_POP(ctx, list);
+    int i = hex_list_index(ctx, "rem", list, NULL, index, 0);
+    if (i < 0 || hex_edit_list(ctx, "rem", list, NULL) != 0)
     {
-        HEX_FREE(ctx, a);
         return 1;
     }
-    if (a->type == HEX_TYPE_INTEGER)
-    {
-        char buffer[32];
-        snprintf(buffer, sizeof(buffer), "%d", a->data.int_value);
-        int result = hex_push_string(ctx, buffer);
-        HEX_FREE(ctx, a);
-        return result;
-    }
-    hex_error(ctx, "[symbol dec] Integer required");
-    HEX_FREE(ctx, a);
-    return 1;
+    hex_item_t **items = list->data.quotation_value;
+    HEX_FREE(ctx, items[i]);
+    memmove(items + i, items + i + 1, (list->quotation_size - i - 1) * sizeof(hex_item_t *));
+    list->quotation_size--;
+    return hex_push_edited(ctx, list);
 }
 
-int hex_symbol_hex(hex_context_t *ctx)
+int hex_symbol_set(hex_context_t *ctx)
 {
+    HEX_POP(ctx, index);
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, list);
+    int i = hex_list_index(ctx, "set", list, item, index, 0);
+    if (i < 0 || hex_edit_list(ctx, "set", list, item) != 0)
     {
-        HEX_FREE(ctx, item);
         return 1;
     }
-    if (item->type == HEX_TYPE_STRING)
-    {
-        int result = hex_push_integer(ctx, strtol(item->data.str_value, NULL, 10));
-        HEX_FREE(ctx, item);
-        return result;
-    }
-    hex_error(ctx, "[symbol hex] String representing a decimal integer required");
-    HEX_FREE(ctx, item);
-    return 1;
+    HEX_FREE(ctx, list->data.quotation_value[i]);
+    list->data.quotation_value[i] = item;
+    return hex_push_edited(ctx, list);
 }
 
-int hex_symbol_ord(hex_context_t *ctx)
+int hex_symbol_reverse(hex_context_t *ctx)
 {
-    HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, list);
+    if (hex_edit_list(ctx, "reverse", list, NULL) != 0)
     {
-        HEX_FREE(ctx, item);
         return 1;
     }
-    if (item->type == HEX_TYPE_STRING)
+    hex_item_t **items = list->data.quotation_value;
+    for (size_t i = 0, j = list->quotation_size; i + 1 < j; i++, j--)
     {
-        if (strlen(item->data.str_value) > 1)
-        {
-            int result = hex_push_integer(ctx, -1);
-            HEX_FREE(ctx, item);
-            return result;
-        }
-        unsigned char *str = (unsigned char *)item->data.str_value;
-        int result;
-        if (str[0] < 128)
-        {
-            result = hex_push_integer(ctx, str[0]);
-        }
-        else
-        {
-            result = hex_push_integer(ctx, -1);
-        }
-        HEX_FREE(ctx, item);
-        return result;
+        hex_item_t *item = items[i];
+        items[i] = items[j - 1];
+        items[j - 1] = item;
     }
-    hex_error(ctx, "[symbol ord] String required");
-    HEX_FREE(ctx, item);
-    return 1;
+    return hex_push_edited(ctx, list);
 }
 
-int hex_symbol_chr(hex_context_t *ctx)
+int hex_symbol_uncons(hex_context_t *ctx)
 {
-    HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, list);
+    if (list->quotation_size == 0)
     {
-        HEX_FREE(ctx, item);
+        hex_error(ctx, "[symbol uncons] Quotation must not be empty");
+        HEX_FREE(ctx, list);
         return 1;
     }
-    if (item->type == HEX_TYPE_INTEGER)
+    if (hex_edit_list(ctx, "uncons", list, NULL) != 0)
     {
-        int result;
-        if (item->data.int_value >= 0 && item->data.int_value < 128)
-        {
-            char str[2] = {(char)item->data.int_value, '\0'};
-            result = hex_push_string(ctx, str);
-        }
-        else
-        {
-            result = hex_push_string(ctx, "");
-        }
-        HEX_FREE(ctx, item);
-        return result;
+        return 1;
     }
-    hex_error(ctx, "[symbol chr] Integer required");
-    HEX_FREE(ctx, item);
-    return 1;
+    hex_item_t **items = list->data.quotation_value;
+    hex_item_t *first = items[0];
+    memmove(items, items + 1, (list->quotation_size - 1) * sizeof(hex_item_t *));
+    list->quotation_size--;
+    if (HEX_PUSH(ctx, first) != 0)
+    {
+        HEX_FREE(ctx, first);
+        HEX_FREE(ctx, list);
+        return 1;
+    }
+    return hex_push_edited(ctx, list);
 }
 
-// Comparison symbols
+int hex_symbol_swons(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
+    HEX_POP(ctx, list);
+    return hex_insert_item(ctx, "swons", list, item, 0);
+}
+// String symbols
 
-static int hex_equal(hex_item_t *a, hex_item_t *b)
+int hex_symbol_join(hex_context_t *ctx)
 {
-    if (a->type == HEX_TYPE_INVALID || b->type == HEX_TYPE_INVALID)
-    {
-        return 0;
-    }
-    if (a->type == HEX_TYPE_NATIVE_SYMBOL || a->type == HEX_TYPE_USER_SYMBOL)
-    {
-        if (b->type != HEX_TYPE_NATIVE_SYMBOL && b->type != HEX_TYPE_USER_SYMBOL)
-            return 0;
-        return (strcmp(a->token->value, b->token->value) == 0);
-    }
-    if (a->type != b->type)
-    {
-        return 0;
-    }
-    if (a->type == HEX_TYPE_INTEGER)
-    {
-        return a->data.int_value == b->data.int_value;
-    }
-    if (a->type == HEX_TYPE_STRING)
+    HEX_POP(ctx, separator);
+    HEX_POP(ctx, list);
+    int result = 0;
+    size_t length = 0;
+    for (size_t i = 0; i < list->quotation_size; i++)
     {
-        return (strcmp(a->data.str_value, b->data.str_value) == 0);
+        if (list->data.quotation_value[i]->type == HEX_TYPE_STRING)
+        {
+            length += list->data.quotation_value[i]->str_size;
+        }
+        else
+        {
+            hex_error(ctx, "[symbol join] Quotation must contain only strings");
+            HEX_FREE(ctx, list);
+            HEX_FREE(ctx, separator);
+            return 1;
+        }
     }
-    if (a->type == HEX_TYPE_QUOTATION)
+    if (result == 0)
     {
-        if (a->quotation_size != b->quotation_size)
+        if (list->quotation_size > 0)
         {
-            return 0;
+            length += (list->quotation_size - 1) * separator->str_size;
         }
-        else
+        char *newStr = (char *)malloc(length + 1);
+        if (!newStr)
         {
-            for (size_t i = 0; i < a->quotation_size; i++)
+            hex_error(ctx, "[symbol join] Memory allocation failed");
+            HEX_FREE(ctx, list);
+            HEX_FREE(ctx, separator);
+            return 1;
+        }
+        char *dst = newStr;
+        for (size_t i = 0; i < list->quotation_size; i++)
+        {
+            hex_item_t *element = list->data.quotation_value[i];
+            memcpy(dst, element->data.str_value, element->str_size);
+            dst += element->str_size;
+            if (i < list->quotation_size - 1)
             {
-                if (!hex_equal(a->data.quotation_value[i], b->data.quotation_value[i]))
-                {
-                    return 0;
-                }
+                memcpy(dst, separator->data.str_value, separator->str_size);
+                dst += separator->str_size;
             }
-            return 1;
         }
+        *dst = '\0';
+        result = hex_push_string_buffer(ctx, newStr, length);
     }
-    return 0;
+    if (result != 0)
+    {
+        HEX_FREE(ctx, list);
+        HEX_FREE(ctx, separator);
+    }
+    return result;
 }
 
-static int hex_is_type_symbol(hex_item_t *item)
+// Find the end of the piece of str starting at start, and where the next piece starts
+static size_t hex_split_piece(hex_item_t *str, hex_item_t *separator, size_t start, size_t *next)
 {
-    if (item->type == HEX_TYPE_USER_SYMBOL || item->type == HEX_TYPE_NATIVE_SYMBOL)
+    if (separator->str_size == 0)
     {
-        return 1;
+        // Separator is an empty string: split into individual characters
+        *next = start + 1;
+        return start + 1;
     }
-    return 0;
+    const char *match = hex_find(str->data.str_value + start, str->str_size - start, separator->data.str_value, separator->str_size);
+    if (!match)
+    {
+        *next = str->str_size;
+        return str->str_size;
+    }
+    size_t end = match - str->data.str_value;
+    *next = end + separator->str_size;
+    return end;
 }
 
-static int hex_greater(hex_context_t *ctx, hex_item_t *a, hex_item_t *b, char *symbol)
+int hex_symbol_split(hex_context_t *ctx)
 {
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
+    HEX_POP(ctx, separator);
+    HEX_POP(ctx, str);
+    int result = 0;
+    // Count the (non-empty) pieces first, so that the quotation is allocated once
+    size_t size = 0;
+    size_t next;
+    for (size_t start = 0; start < str->str_size; start = next)
     {
-        return a->data.int_value > b->data.int_value;
+        if (hex_split_piece(str, separator, start, &next) > start)
+        {
+            size++;
+        }
     }
-    else if (a->type == HEX_TYPE_STRING && b->type == HEX_TYPE_STRING)
+    hex_item_t **quotation = (hex_item_t **)calloc(size > 0 ? size : 1, sizeof(hex_item_t *));
+    if (!quotation)
     {
-        return strcmp(a->data.str_value, b->data.str_value) > 0;
+        hex_error(ctx, "[symbol split] Memory allocation failed");
+        result = 1;
     }
-    else if (a->type == HEX_TYPE_QUOTATION && b->type == HEX_TYPE_QUOTATION)
+    else
     {
-        // Compare quotations lexicographically
-        size_t min_size = a->quotation_size < b->quotation_size ? a->quotation_size : b->quotation_size;
-        int is_greater = 0;
-
-        for (size_t i = 0; i < min_size; i++)
+        size_t i = 0;
+        for (size_t start = 0; start < str->str_size && result == 0; start = next)
         {
-            hex_item_t *it_a = a->data.quotation_value[i];
-            hex_item_t *it_b = b->data.quotation_value[i];
-
-            // Perform element-wise comparison
-            if (it_a->type != it_b->type && !(hex_is_type_symbol(it_a) && hex_is_type_symbol(it_b)))
-            {
-                // Mismatched types, return false
-                return 0;
-            }
-
-            if (it_a->type == HEX_TYPE_INTEGER)
-            {
-                if (it_a->data.int_value != it_b->data.int_value)
-                {
-                    is_greater = it_a->data.int_value > it_b->data.int_value;
-                    break;
-                }
-            }
-            else if (it_a->type == HEX_TYPE_STRING)
-            {
-                int cmp = strcmp(it_a->data.str_value, it_b->data.str_value);
-                if (cmp != 0)
-                {
-                    is_greater = cmp > 0;
-                    break;
-                }
-            }
-            else if (hex_is_type_symbol(it_a))
+            size_t end = hex_split_piece(str, separator, start, &next);
+            if (end > start)
             {
-                int cmp = strcmp(it_a->token->value, it_b->token->value);
-                if (cmp != 0)
+                quotation[i] = hex_string_bytes_item(ctx, str->data.str_value + start, end - start);
+                if (!quotation[i])
                 {
-                    is_greater = cmp > 0;
+                    result = 1;
                     break;
                 }
-            }
-            else
-            {
-                // Mismatched types, return false
-                return 0;
+                i++;
             }
         }
-
-        if (!is_greater)
+        if (result == 0)
         {
-            // If all compared elements are equal, compare sizes
-            return a->quotation_size > b->quotation_size;
+            result = hex_push_quotation(ctx, quotation, size);
         }
-        return is_greater;
-    }
-    else
-    {
-        hex_error(ctx, "[symbol %s] Two integers, two strings, or two quotations required", symbol);
-        return -1;
-    }
-}
-
-int hex_symbol_equal(hex_context_t *ctx)
-{
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, b);
-        return 1;
-    }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
-    }
-    if ((a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER) || (a->type == HEX_TYPE_STRING && b->type == HEX_TYPE_STRING) || (a->type == HEX_TYPE_QUOTATION && b->type == HEX_TYPE_QUOTATION))
-    {
-        int result = hex_push_integer(ctx, hex_equal(a, b));
-        if (result != 0)
+        else
         {
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
+            hex_free_list(ctx, quotation, size);
         }
-        return result;
-    }
-    // Different types => false
-    int result = hex_push_integer(ctx, 0);
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
+    }
+    HEX_FREE(ctx, str);
+    HEX_FREE(ctx, separator);
     return result;
 }
 
-int hex_symbol_notequal(hex_context_t *ctx)
+// Slice a buffer from the start index to the end index, both included
+static int hex_buffer_slice(hex_context_t *ctx, hex_item_t *buffer, hex_item_t *start, hex_item_t *end)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, b);
-        return 1;
-    }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    int32_t first = start->data.int_value;
+    int32_t last = end->data.int_value;
+    if (first < 0 || last < 0 || (size_t)last >= buffer->str_size)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
+        hex_error(ctx, "[symbol sub] Index out of bounds");
         return 1;
     }
-    if ((a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER) || (a->type == HEX_TYPE_STRING && b->type == HEX_TYPE_STRING) || (a->type == HEX_TYPE_QUOTATION && b->type == HEX_TYPE_QUOTATION))
+    size_t size = first <= last ? (size_t)(last - first + 1) : 0;
+    memmove(buffer->data.buffer_value, buffer->data.buffer_value + first, size);
+    buffer->str_size = size;
+    return 0;
+}
+
+int hex_symbol_sub(hex_context_t *ctx)
+{
+    HEX_POP(ctx, replacement);
+    HEX_POP(ctx, search);
+    HEX_POP(ctx, list);
+    int result = 0;
+    if (list->type == HEX_TYPE_BUFFER || search->type != HEX_TYPE_STRING || replacement->type != HEX_TYPE_STRING)
     {
-        int result = hex_push_integer(ctx, !hex_equal(a, b));
+        // The buffer is owned by this native: it is sliced in place
+        if (list->type != HEX_TYPE_BUFFER || search->type != HEX_TYPE_INTEGER || replacement->type != HEX_TYPE_INTEGER)
+        {
+            hex_error(ctx, "[symbol sub] Three strings or a buffer and two integers required");
+            result = 1;
+        }
+        else
+        {
+            result = hex_buffer_slice(ctx, list, search, replacement);
+        }
+        if (result == 0)
+        {
+            result = HEX_PUSH(ctx, list);
+        }
         if (result != 0)
         {
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
+            HEX_FREE(ctx, list);
         }
+        HEX_FREE(ctx, search);
+        HEX_FREE(ctx, replacement);
         return result;
     }
-    // Different types => true
-    int result = hex_push_integer(ctx, 1);
-    if (result != 0)
+    // The string is owned by this native: the replacement is done in its own buffer
+    if (hex_string_unshare(list) != 0)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
+        hex_error(ctx, "[symbol sub] Memory allocation failed");
+        HEX_FREE(ctx, list);
+        HEX_FREE(ctx, search);
+        HEX_FREE(ctx, replacement);
+        return 1;
     }
-    return result;
-}
-
-int hex_symbol_greater(hex_context_t *ctx)
-{
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
+    const char *ptr = hex_find(list->data.str_value, list->str_size, search->data.str_value, search->str_size);
+    if (ptr)
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        size_t prefixLen = ptr - list->data.str_value;
+        size_t findLen = search->str_size;
+        size_t replaceLen = replacement->str_size;
+        size_t suffixLen = list->str_size - prefixLen - findLen;
+        if (hex_string_reserve(list, list->str_size - findLen + replaceLen) != 0)
+        {
+            hex_error(ctx, "[symbol sub] Memory allocation failed");
+            result = 1;
+        }
+        else
+        {
+            char *dst = list->data.str_value + prefixLen;
+            memmove(dst + replaceLen, dst + findLen, suffixLen + 1);
+            memcpy(dst, replacement->data.str_value, replaceLen);
+            list->str_size = prefixLen + replaceLen + suffixLen;
+        }
     }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    if (result == 0)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        result = HEX_PUSH(ctx, list);
     }
-    hex_item_t *pa = a;
-    hex_item_t *pb = b;
-    int result = hex_push_integer(ctx, hex_greater(ctx, pa, pb, ">"));
     if (result != 0)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
+        HEX_FREE(ctx, list);
     }
+    HEX_FREE(ctx, search);
+    HEX_FREE(ctx, replacement);
     return result;
 }
 
-int hex_symbol_less(hex_context_t *ctx)
+int hex_symbol_gsub(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, replacement);
+    HEX_POP(ctx, search);
+    HEX_POP(ctx, str);
+    int result = 0;
+    const char *data = str->data.str_value;
+    const char *end = data + str->str_size;
+    // Count the occurrences first, so that the result is written into a single buffer
+    size_t count = 0;
+    if (search->str_size > 0)
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        for (const char *ptr = data; (ptr = hex_find(ptr, end - ptr, search->data.str_value, search->str_size)); ptr += search->str_size)
+        {
+            count++;
+        }
     }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    if (count == 0)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        result = HEX_PUSH(ctx, str);
+        if (result != 0)
+        {
+            HEX_FREE(ctx, str);
+        }
+        HEX_FREE(ctx, search);
+        HEX_FREE(ctx, replacement);
+        return result;
     }
-    hex_item_t *pa = a;
-    hex_item_t *pb = b;
-    int result = hex_push_integer(ctx, hex_greater(ctx, pb, pa, "<"));
-    if (result != 0)
+    size_t size = str->str_size - count * search->str_size + count * replacement->str_size;
+    char *buffer = (char *)malloc(size + 1);
+    if (!buffer)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
+        hex_error(ctx, "[symbol gsub] Memory allocation failed");
+        result = 1;
+    }
+    else
+    {
+        char *dst = buffer;
+        const char *src = data;
+        const char *match;
+        while ((match = hex_find(src, end - src, search->data.str_value, search->str_size)))
+        {
+            memcpy(dst, src, match - src);
+            dst += match - src;
+            memcpy(dst, replacement->data.str_value, replacement->str_size);
+            dst += replacement->str_size;
+            src = match + search->str_size;
+        }
+        memcpy(dst, src, end - src);
+        dst += end - src;
+        *dst = '\0';
+        result = hex_push_string_buffer(ctx, buffer, size);
     }
+    HEX_FREE(ctx, str);
+    HEX_FREE(ctx, search);
+    HEX_FREE(ctx, replacement);
     return result;
 }
 
-int hex_symbol_greaterequal(hex_context_t *ctx)
+// Return the index of the ${0} to ${9} placeholder at the start of str, or -1
+static int hex_fmt_placeholder(const char *str, size_t size, size_t count)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, b);
-        return 1;
-    }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
-    }
-    hex_item_t *pa = a;
-    hex_item_t *pb = b;
-    int result = hex_push_integer(ctx, hex_greater(ctx, pa, pb, ">") || hex_equal(a, b));
-    if (result != 0)
+    if (size < 4 || str[0] != '$' || str[1] != '{' || str[3] != '}' || str[2] < '0' || str[2] > '9')
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
+        return -1;
     }
-    return result;
+    int index = str[2] - '0';
+    return (size_t)index < count ? index : -1;
 }
 
-int hex_symbol_lessequal(hex_context_t *ctx)
+int hex_symbol_fmt(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, list);
+    HEX_POP(ctx, str);
+    int result = 0;
+    if (list->quotation_size > 10)
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        hex_error(ctx, "[symbol fmt] Only a maximum of 10 placeholders are supported");
+        result = 1;
     }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    // User symbols are pushed, as they were by the former definition of fmt in utils.hex,
+    // and replaced by the string they push
+    hex_item_t *values[10] = {NULL};
+    hex_item_t *pushed[10] = {NULL};
+    for (size_t i = 0; result == 0 && i < list->quotation_size; i++)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        hex_item_t *item = list->data.quotation_value[i];
+        values[i] = item;
+        if (item->type == HEX_TYPE_USER_SYMBOL)
+        {
+            int top = ctx->stack->top;
+            if (hex_push(ctx, item) != 0)
+            {
+                result = 1;
+            }
+            else if (ctx->stack->top != top + 1 || ctx->stack->entries[ctx->stack->top]->type != HEX_TYPE_STRING)
+            {
+                hex_error(ctx, "[symbol fmt] Symbol must push a string: %s", item->token->value);
+                result = 1;
+            }
+            else
+            {
+                pushed[i] = hex_pop(ctx);
+                values[i] = pushed[i];
+            }
+        }
+        else if (item->type != HEX_TYPE_STRING)
+        {
+            hex_error(ctx, "[symbol fmt] Quotation must contain only strings");
+            result = 1;
+        }
     }
-    hex_item_t *pa = a;
-    hex_item_t *pb = b;
-    int result = hex_push_integer(ctx, hex_greater(ctx, pb, pa, "<") || hex_equal(a, b));
-    if (result != 0)
+    if (result == 0)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
+        const char *data = str->data.str_value;
+        // Compute the size of the result first, so that it is written into a single buffer
+        size_t size = 0;
+        for (size_t i = 0; i < str->str_size;)
+        {
+            int index = hex_fmt_placeholder(data + i, str->str_size - i, list->quotation_size);
+            size += index < 0 ? 1 : values[index]->str_size;
+            i += index < 0 ? 1 : 4;
+        }
+        char *buffer = (char *)malloc(size + 1);
+        if (!buffer)
+        {
+            hex_error(ctx, "[symbol fmt] Memory allocation failed");
+            result = 1;
+        }
+        else
+        {
+            char *dst = buffer;
+            for (size_t i = 0; i < str->str_size;)
+            {
+                int index = hex_fmt_placeholder(data + i, str->str_size - i, list->quotation_size);
+                if (index < 0)
+                {
+                    *dst++ = data[i++];
+                }
+                else
+                {
+                    memcpy(dst, values[index]->data.str_value, values[index]->str_size);
+                    dst += values[index]->str_size;
+                    i += 4;
+                }
+            }
+            *dst = '\0';
+            result = hex_push_string_buffer(ctx, buffer, size);
+        }
     }
+    for (size_t i = 0; i < 10; i++)
+    {
+        HEX_FREE(ctx, pushed[i]);
+    }
+    HEX_FREE(ctx, str);
+    HEX_FREE(ctx, list);
     return result;
 }
 
-// Boolean symbols
+int hex_symbol_begins(hex_context_t *ctx)
+{
+    HEX_POP(ctx, prefix);
+    HEX_POP(ctx, str);
+    int result = prefix->str_size <= str->str_size && memcmp(str->data.str_value, prefix->data.str_value, prefix->str_size) == 0;
+    HEX_FREE(ctx, str);
+    HEX_FREE(ctx, prefix);
+    return hex_push_integer(ctx, result);
+}
 
-int hex_symbol_and(hex_context_t *ctx)
+int hex_symbol_ends(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, b);
-        return 1;
-    }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, suffix);
+    HEX_POP(ctx, str);
+    int result = suffix->str_size <= str->str_size && memcmp(str->data.str_value + str->str_size - suffix->str_size, suffix->data.str_value, suffix->str_size) == 0;
+    HEX_FREE(ctx, str);
+    HEX_FREE(ctx, suffix);
+    return hex_push_integer(ctx, result);
+}
+
+// Vector symbols
+
+// Copy the integers of a quotation into a new array
+static int32_t *hex_quotation_integers(hex_context_t *ctx, const char *symbol, hex_item_t *list)
+{
+    int32_t *values = (int32_t *)malloc(list->quotation_size > 0 ? list->quotation_size * sizeof(int32_t) : 1);
+    if (!values)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
+        return NULL;
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
+    for (size_t i = 0; i < list->quotation_size; i++)
     {
-        int result = hex_push_integer(ctx, a->data.int_value && b->data.int_value);
-        if (result != 0)
+        if (list->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
         {
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
+            hex_error(ctx, "[symbol %s] Quotation must contain only integers", symbol);
+            free(values);
+            return NULL;
         }
-        return result;
+        values[i] = list->data.quotation_value[i]->data.int_value;
     }
-    hex_error(ctx, "[symbol and] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
+    return values;
 }
 
-int hex_symbol_or(hex_context_t *ctx)
+int hex_symbol_vec(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, item);
+    if (item->type == HEX_TYPE_VECTOR)
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        if (HEX_PUSH(ctx, item) != 0)
+        {
+            HEX_FREE(ctx, item);
+            return 1;
+        }
+        return 0;
     }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    int32_t *values = NULL;
+    size_t size = 0;
+    if (item->type == HEX_TYPE_QUOTATION)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        values = hex_quotation_integers(ctx, "vec", item);
+        size = item->quotation_size;
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
+    else if (item->str_size % 4 != 0)
     {
-        int result = hex_push_integer(ctx, a->data.int_value || b->data.int_value);
-        if (result != 0)
+        hex_error(ctx, "[symbol vec] Buffer size must be a multiple of 4");
+    }
+    else
+    {
+        // Buffers contain 32-bit little-endian integers
+        size = item->str_size / 4;
+        values = (int32_t *)malloc(size > 0 ? size * sizeof(int32_t) : 1);
+        if (!values)
         {
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
+            hex_error(ctx, "[symbol vec] Memory allocation failed");
+        }
+        else
+        {
+            const uint8_t *bytes = item->data.buffer_value;
+            for (size_t i = 0; i < size; i++)
+            {
+                values[i] = (int32_t)((uint32_t)bytes[i * 4] | (uint32_t)bytes[i * 4 + 1] << 8 |
+                                      (uint32_t)bytes[i * 4 + 2] << 16 | (uint32_t)bytes[i * 4 + 3] << 24);
+            }
         }
-        return result;
     }
-    hex_error(ctx, "[symbol or] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
+    HEX_FREE(ctx, item);
+    if (!values)
+    {
+        return 1;
+    }
+    return hex_push_vector(ctx, values, size);
 }
 
-int hex_symbol_not(hex_context_t *ctx)
+// Find the minimum or maximum item of a quotation of comparable items, moving it out of the
+// quotation, or copying it if the items are shared
+static int hex_quotation_extreme(hex_context_t *ctx, hex_opcode_t op, const char *symbol, hex_item_t *list)
 {
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    size_t found = 0;
+    for (size_t i = 1; i < list->quotation_size; i++)
+    {
+        hex_item_t *a = list->data.quotation_value[i];
+        hex_item_t *b = list->data.quotation_value[found];
+        int greater = op == HEX_OP_MAX ? hex_greater(ctx, a, b, symbol) : hex_greater(ctx, b, a, symbol);
+        if (greater < 0)
+        {
+            return 1;
+        }
+        if (greater)
+        {
+            found = i;
+        }
+    }
+    hex_item_t *item = hex_take_item(ctx, list, found);
+    if (!item)
     {
-        HEX_FREE(ctx, a);
         return 1;
     }
-    if (a->type == HEX_TYPE_INTEGER)
+    if (HEX_PUSH(ctx, item) != 0)
     {
-        int result = hex_push_integer(ctx, !a->data.int_value);
-        if (result != 0)
-        {
-            HEX_FREE(ctx, a);
-        }
-        return result;
+        HEX_FREE(ctx, item);
+        return 1;
     }
-    hex_error(ctx, "[symbol not] Integer required");
-    HEX_FREE(ctx, a);
-    return 1;
+    return 0;
 }
 
-int hex_symbol_xor(hex_context_t *ctx)
+static int hex_vector_reduction(hex_context_t *ctx, hex_opcode_t op, const char *symbol)
 {
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, item);
+    const int32_t *values = item->data.vector_value;
+    int32_t *copy = NULL;
+    if (item->quotation_size == 0 && op != HEX_OP_SUM)
     {
-        HEX_FREE(ctx, b);
+        hex_error(ctx, "[symbol %s] Vector or quotation must not be empty", symbol);
+        HEX_FREE(ctx, item);
         return 1;
     }
-    HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    if (item->type == HEX_TYPE_QUOTATION && op != HEX_OP_SUM)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        // Quotations of other items than integers are compared like by > and <
+        for (size_t i = 0; i < item->quotation_size; i++)
+        {
+            if (item->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
+            {
+                int result = hex_quotation_extreme(ctx, op, symbol, item);
+                HEX_FREE(ctx, item);
+                return result;
+            }
+        }
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
+    if (item->type == HEX_TYPE_QUOTATION)
     {
-        int result = hex_push_integer(ctx, a->data.int_value ^ b->data.int_value);
-        if (result != 0)
+        copy = hex_quotation_integers(ctx, symbol, item);
+        if (!copy)
         {
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
+            HEX_FREE(ctx, item);
+            return 1;
         }
-        return result;
+        values = copy;
     }
-    hex_error(ctx, "[symbol xor] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
+    int32_t value = hex_vector_reduce(op, values, item->quotation_size);
+    free(copy);
+    HEX_FREE(ctx, item);
+    return hex_push_integer(ctx, value);
 }
 
-// Quotation and String (List) Symbols
-int hex_symbol_cat(hex_context_t *ctx)
+int hex_symbol_sum(hex_context_t *ctx)
+{
+    return hex_vector_reduction(ctx, HEX_OP_SUM, "sum");
+}
+
+int hex_symbol_min(hex_context_t *ctx)
+{
+    return hex_vector_reduction(ctx, HEX_OP_MIN, "min");
+}
+
+int hex_symbol_max(hex_context_t *ctx)
+{
+    return hex_vector_reduction(ctx, HEX_OP_MAX, "max");
+}
+
+// Dictionary symbols
+
+// Build a dictionary from a quotation of key/value pairs, moving the items out of the quotation,
+// or copying them if they are shared
+int hex_symbol_dict(hex_context_t *ctx)
 {
-    HEX_POP(ctx, value);
-    if (value->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, value);
-        return 1; // Failed to pop value
-    }
     HEX_POP(ctx, list);
-    ;
-    if (list->type == HEX_TYPE_INVALID)
+    hex_dict_t *dict = hex_dict_create();
+    if (!dict)
     {
+        hex_error(ctx, "[symbol dict] Memory allocation failed");
         HEX_FREE(ctx, list);
-        HEX_FREE(ctx, value);
-        return 1; // Failed to pop list
+        return 1;
     }
-    // Strategy: produce a fresh result (deep copies) and consume both inputs.
-    // This avoids aliasing between the original quotations and the new one.
-    if (list->type == HEX_TYPE_QUOTATION && value->type == HEX_TYPE_QUOTATION)
+    for (size_t i = 0; i < list->quotation_size; i++)
     {
-        size_t new_size = list->quotation_size + value->quotation_size;
-        hex_item_t **items = (hex_item_t **)calloc(new_size, sizeof(hex_item_t *));
-        if (!items)
+        hex_item_t *pair = list->data.quotation_value[i];
+        if (pair->type != HEX_TYPE_QUOTATION || pair->quotation_size != 2)
         {
-            hex_error(ctx, "[symbol cat] Memory allocation failed");
+            hex_error(ctx, "[symbol dict] Quotation of key/value pairs required");
+            hex_dict_release(ctx, dict);
             HEX_FREE(ctx, list);
-            HEX_FREE(ctx, value);
             return 1;
         }
-        size_t k = 0;
-        for (size_t i = 0; i < list->quotation_size; i++)
+        hex_item_t *key = pair->data.quotation_value[0];
+        hex_item_t *value = pair->data.quotation_value[1];
+        if (key->type != HEX_TYPE_INTEGER && key->type != HEX_TYPE_STRING)
         {
-            items[k] = hex_copy_item(ctx, list->data.quotation_value[i]);
-            if (!items[k])
-            {
-                hex_error(ctx, "[symbol cat] Failed to copy element");
-                hex_free_list(ctx, items, k);
-                HEX_FREE(ctx, list);
-                HEX_FREE(ctx, value);
-                return 1;
-            }
-            k++;
+            hex_error(ctx, "[symbol dict] Key must be a string or an integer");
+            hex_dict_release(ctx, dict);
+            HEX_FREE(ctx, list);
+            return 1;
+        }
+        int shared = hex_is_shared(list) || hex_is_shared(pair);
+        if (shared)
+        {
+            key = hex_copy_item(ctx, key);
+            value = key ? hex_copy_item(ctx, value) : NULL;
         }
-        for (size_t i = 0; i < value->quotation_size; i++)
+        if (!key || !value || hex_dict_put(ctx, dict, key, value) != 0)
         {
-            items[k] = hex_copy_item(ctx, value->data.quotation_value[i]);
-            if (!items[k])
+            hex_error(ctx, "[symbol dict] Memory allocation failed");
+            if (shared)
             {
-                hex_error(ctx, "[symbol cat] Failed to copy element");
-                hex_free_list(ctx, items, k);
-                HEX_FREE(ctx, list);
+                HEX_FREE(ctx, key);
                 HEX_FREE(ctx, value);
-                return 1;
             }
-            k++;
-        }
-        if (hex_push_quotation(ctx, items, new_size) != 0)
-        {
-            hex_free_list(ctx, items, new_size);
-            HEX_FREE(ctx, list);
-            HEX_FREE(ctx, value);
-            return 1;
-        }
-        // Ownership of items array & its elements transferred; DO NOT free(items)
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, value);
-        return 0;
-    }
-    else if (list->type == HEX_TYPE_STRING && value->type == HEX_TYPE_STRING)
-    {
-        size_t new_len = strlen(list->data.str_value) + strlen(value->data.str_value) + 1;
-        char *buf = (char *)malloc(new_len);
-        if (!buf)
-        {
-            hex_error(ctx, "[symbol cat] Memory allocation failed");
+            hex_dict_release(ctx, dict);
             HEX_FREE(ctx, list);
-            HEX_FREE(ctx, value);
             return 1;
         }
-        strcpy(buf, list->data.str_value);
-        strcat(buf, value->data.str_value);
-        if (hex_push_string(ctx, buf) != 0)
+        if (!shared)
         {
-            free(buf);
-            HEX_FREE(ctx, list);
-            HEX_FREE(ctx, value);
-            return 1;
+            pair->data.quotation_value[0] = NULL;
+            pair->data.quotation_value[1] = NULL;
+            pair->quotation_size = 0;
         }
-        free(buf); // temporary buffer
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, value);
-        return 0;
-    }
-    else
-    {
-        hex_error(ctx, "[symbol cat] Two quotations or two strings required");
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, value);
-        return 1;
     }
+    HEX_FREE(ctx, list);
+    return hex_push_dict(ctx, dict);
 }
 
-int hex_symbol_len(hex_context_t *ctx)
+int hex_symbol_put(hex_context_t *ctx)
 {
+    HEX_POP(ctx, value);
+    HEX_POP(ctx, key);
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
+    // The dictionary is modified in place, unless other items share it
+    hex_dict_t *dict = hex_dict_unshare(ctx, item->data.dict_value);
+    if (!dict || hex_dict_put(ctx, dict, key, value) != 0)
     {
+        hex_error(ctx, "[symbol put] Memory allocation failed");
         HEX_FREE(ctx, item);
+        HEX_FREE(ctx, key);
+        HEX_FREE(ctx, value);
         return 1;
     }
-    int result = 0;
-    if (item->type == HEX_TYPE_QUOTATION)
-    {
-        result = hex_push_integer(ctx, item->quotation_size);
-    }
-    else if (item->type == HEX_TYPE_STRING)
-    {
-        result = hex_push_integer(ctx, strlen(item->data.str_value));
-    }
-    else
-    {
-        hex_error(ctx, "[symbol len] Quotation or string required");
-        result = 1;
-    }
-    if (result != 0)
+    item->data.dict_value = dict;
+    if (HEX_PUSH(ctx, item) != 0)
     {
         HEX_FREE(ctx, item);
+        return 1;
     }
-    return result;
+    return 0;
 }
 
-int hex_symbol_get(hex_context_t *ctx)
+int hex_symbol_has(hex_context_t *ctx)
 {
-    HEX_POP(ctx, index);
-    if (index->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, index);
-        return 1;
-    }
-    HEX_POP(ctx, list);
-    if (list->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, index);
-        return 1;
-    }
+    HEX_POP(ctx, key);
+    HEX_POP(ctx, item);
+    int found = hex_dict_get(item->data.dict_value, key) != NULL;
+    HEX_FREE(ctx, item);
+    HEX_FREE(ctx, key);
+    return hex_push_integer(ctx, found);
+}
+
+int hex_symbol_del(hex_context_t *ctx)
+{
+    HEX_POP(ctx, key);
+    HEX_POP(ctx, item);
     int result = 0;
-    hex_item_t *copy = NULL;
-    if (list->type == HEX_TYPE_QUOTATION)
-    {
-        if (index->type != HEX_TYPE_INTEGER)
-        {
-            hex_error(ctx, "[symbol get] Index must be an integer");
-            result = 1;
-        }
-        else if (index->data.int_value < 0 || (size_t)index->data.int_value >= list->quotation_size)
-        {
-            hex_error(ctx, "[symbol get] Index out of range");
-            result = 1;
-        }
-        else
-        {
-            copy = hex_copy_item(ctx, list->data.quotation_value[index->data.int_value]);
-            result = hex_push(ctx, copy);
-        }
-    }
-    else if (list->type == HEX_TYPE_STRING)
+    if (hex_dict_get(item->data.dict_value, key))
     {
-        if (index->type != HEX_TYPE_INTEGER)
+        hex_dict_t *dict = hex_dict_unshare(ctx, item->data.dict_value);
+        if (!dict)
         {
-            hex_error(ctx, "[symbol get] Index must be an integer");
-            result = 1;
-        }
-        else if (index->data.int_value < 0 || index->data.int_value >= (int)strlen(list->data.str_value))
-        {
-            hex_error(ctx, "[symbol get] Index out of range");
+            hex_error(ctx, "[symbol del] Memory allocation failed");
             result = 1;
         }
         else
         {
-            char str[2] = {list->data.str_value[index->data.int_value], '\0'};
-            copy = hex_string_item(ctx, str);
-            result = hex_push(ctx, copy);
+            hex_dict_delete(ctx, dict, key);
+            item->data.dict_value = dict;
         }
     }
-    else
+    HEX_FREE(ctx, key);
+    if (result == 0)
     {
-        hex_error(ctx, "[symbol get] Quotation or string required");
-        result = 1;
+        result = HEX_PUSH(ctx, item);
     }
     if (result != 0)
     {
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, index);
+        HEX_FREE(ctx, item);
     }
     return result;
 }
 
-int hex_symbol_index(hex_context_t *ctx)
+// List the keys of a dictionary in insertion order
+int hex_symbol_keys(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    HEX_POP(ctx, list);
-    if (list->type == HEX_TYPE_INVALID)
+    hex_dict_t *dict = item->data.dict_value;
+    hex_item_t **quotation = (hex_item_t **)malloc((dict->size > 0 ? dict->size : 1) * sizeof(hex_item_t *));
+    if (!quotation)
     {
-        HEX_FREE(ctx, list);
+        hex_error(ctx, "[symbol keys] Memory allocation failed");
         HEX_FREE(ctx, item);
         return 1;
     }
-    int result = -1;
-    if (list->type == HEX_TYPE_QUOTATION)
+    size_t size = 0;
+    for (size_t i = 0; i < dict->count; i++)
     {
-        for (size_t i = 0; i < list->quotation_size; i++)
+        if (!dict->entries[i].key)
         {
-            if (hex_equal(list->data.quotation_value[i], item))
-            {
-                result = i;
-                break;
-            }
+            continue;
         }
-    }
-    else if (list->type == HEX_TYPE_STRING)
-    {
-        char *ptr = strstr(list->data.str_value, item->data.str_value);
-        if (ptr)
+        quotation[size] = hex_copy_item(ctx, dict->entries[i].key);
+        if (!quotation[size])
         {
-            result = ptr - list->data.str_value;
+            for (size_t j = 0; j < size; j++)
+            {
+                HEX_FREE(ctx, quotation[j]);
+            }
+            free(quotation);
+            HEX_FREE(ctx, item);
+            return 1;
         }
+        size++;
     }
-    else
-    {
-        hex_error(ctx, "[symbol index] Quotation or string required");
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    return hex_push_integer(ctx, result);
+    HEX_FREE(ctx, item);
+    return hex_push_quotation(ctx, quotation, size);
 }
 
-// String symbols
+// Sequence symbols
 
-int hex_symbol_join(hex_context_t *ctx)
+// Read the next line of a file, without its line terminator: returns 1 and sets item
+// if there is one, 0 at the end of the file, and -1 on error
+static int hex_read_line(hex_context_t *ctx, const char *symbol, FILE *file, hex_item_t **item)
 {
-    HEX_POP(ctx, separator);
-    if (separator->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, separator);
-        return 1;
-    }
-    HEX_POP(ctx, list);
-    if (list->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, separator);
-        return 1;
-    }
-    int result = 0;
-    if (list->type == HEX_TYPE_QUOTATION && separator->type == HEX_TYPE_STRING)
+    // Bytes are read one at a time from the stream buffer, so that NUL bytes are kept,
+    // and appended to the line a chunk at a time
+    char chunk[1024];
+    hex_item_t *line = NULL;
+    int c = 0;
+    while (c != '\n' && c != EOF)
     {
-        int length = 0;
-        for (size_t i = 0; i < list->quotation_size; i++)
+        size_t size = 0;
+        while (size < sizeof(chunk) && (c = HEX_GETC(file)) != EOF)
         {
-            if (list->data.quotation_value[i]->type == HEX_TYPE_STRING)
-            {
-                length += strlen(list->data.quotation_value[i]->data.str_value);
-            }
-            else
+            chunk[size++] = (char)c;
+            if (c == '\n')
             {
-                hex_error(ctx, "[symbol join] Quotation must contain only strings");
-                HEX_FREE(ctx, list);
-                HEX_FREE(ctx, separator);
-                return 1;
+                break;
             }
         }
-        if (result == 0)
+        if (size == 0)
+        {
+            break;
+        }
+        if (!line)
         {
-            length += (list->quotation_size - 1) * strlen(separator->data.str_value);
-            char *newStr = (char *)malloc(length + 1);
-            if (!newStr)
+            line = hex_string_bytes_item(ctx, chunk, size);
+            if (!line)
             {
-                hex_error(ctx, "[symbol join] Memory allocation failed");
-                HEX_FREE(ctx, list);
-                HEX_FREE(ctx, separator);
-                return 1;
+                return -1;
             }
-            newStr[0] = '\0';
-            for (size_t i = 0; i < list->quotation_size; i++)
+        }
+        else
+        {
+            if (hex_string_reserve(line, line->str_size + size) != 0)
             {
-                strcat(newStr, list->data.quotation_value[i]->data.str_value);
-                if (i < list->quotation_size - 1)
-                {
-                    strcat(newStr, separator->data.str_value);
-                }
+                hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
+                HEX_FREE(ctx, line);
+                return -1;
             }
-            result = hex_push_string(ctx, newStr);
+            memcpy(line->data.str_value + line->str_size, chunk, size);
+            line->str_size += size;
+            line->data.str_value[line->str_size] = '\0';
         }
     }
-    else
+    if (!line)
     {
-        hex_error(ctx, "[symbol join] Quotation and string required");
-        result = 1;
+        if (ferror(file))
+        {
+            hex_error(ctx, "[symbol %s] Could not read file", symbol);
+            return -1;
+        }
+        return 0;
     }
-    if (result != 0)
+    char *str = line->data.str_value;
+    if (line->str_size > 0 && str[line->str_size - 1] == '\n')
     {
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, separator);
+        line->str_size--;
+        if (line->str_size > 0 && str[line->str_size - 1] == '\r')
+        {
+            line->str_size--;
+        }
+        str[line->str_size] = '\0';
     }
-    return result;
+    *item = line;
+    return 1;
 }
 
-int hex_symbol_split(hex_context_t *ctx)
+// Read the next line of the file of a sequence, closing the file at its end
+static int hex_seq_line(hex_context_t *ctx, hex_seq_t *seq, hex_item_t **item)
 {
-    HEX_POP(ctx, separator);
-    if (separator->type == HEX_TYPE_INVALID)
+    if (!seq->file)
     {
-        HEX_FREE(ctx, separator);
-        return 1;
+        return 0;
     }
-    HEX_POP(ctx, str);
-    if (str->type == HEX_TYPE_INVALID)
+    int result = hex_read_line(ctx, "lines", seq->file, item);
+    if (result <= 0)
     {
-        HEX_FREE(ctx, str);
-        HEX_FREE(ctx, separator);
-        return 1;
+        fclose(seq->file);
+        seq->file = NULL;
     }
-    int result = 0;
-    if (str->type == HEX_TYPE_STRING && separator->type == HEX_TYPE_STRING)
+    return result;
+}
+
+// Produce the next item of a sequence: returns 1 and sets item if there is one,
+// 0 at the end of the sequence, and -1 on error
+static int hex_seq_next(hex_context_t *ctx, hex_seq_t *seq, hex_item_t **item)
+{
+    switch (seq->kind)
     {
-        if (strlen(separator->data.str_value) == 0)
+    case HEX_SEQ_RANGE:
+        if (seq->current >= seq->end)
         {
-            // Separator is an empty string: split into individual characters
-            size_t size = strlen(str->data.str_value);
-            hex_item_t **quotation = (hex_item_t **)calloc(size, sizeof(hex_item_t *));
-            if (!quotation)
-            {
-                hex_error(ctx, "[symbol split] Memory allocation failed");
-                result = 1;
-            }
-            else
+            return 0;
+        }
+        *item = hex_integer_item(ctx, seq->current++);
+        return *item ? 1 : -1;
+
+    case HEX_SEQ_LINES:
+        return hex_seq_line(ctx, seq, item);
+
+    case HEX_SEQ_PIECES:
+        while (seq->position < seq->string->str_size)
+        {
+            size_t start = seq->position;
+            size_t end = hex_split_piece(seq->string, seq->separator, start, &seq->position);
+            if (end > start)
             {
-                for (size_t i = 0; i < size; i++)
-                {
-                    quotation[i] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-                    if (!quotation[i])
-                    {
-                        hex_error(ctx, "[symbol split] Memory allocation failed");
-                        result = 1;
-                        break;
-                    }
-                    quotation[i]->type = HEX_TYPE_STRING;
-                    quotation[i]->data.str_value = (char *)malloc(2); // Allocate 2 bytes: 1 for the character and 1 for null terminator
-                    if (!quotation[i]->data.str_value)
-                    {
-                        hex_error(ctx, "[symbol split] Memory allocation failed");
-                        result = 1;
-                        break;
-                    }
-                    quotation[i]->data.str_value[0] = str->data.str_value[i]; // Copy the single character
-                    quotation[i]->data.str_value[1] = '\0';                   // Null-terminate the string
-                }
-                if (result == 0)
-                {
-                    result = hex_push_quotation(ctx, quotation, size);
-                }
+                *item = hex_string_bytes_item(ctx, seq->string->data.str_value + start, end - start);
+                return *item ? 1 : -1;
             }
         }
-        else
+        return 0;
+
+    case HEX_SEQ_MAP:
+    {
+        int result = hex_seq_next(ctx, seq->source, item);
+        if (result <= 0)
+        {
+            return result;
+        }
+        int top = ctx->stack->top;
+        if (hex_push_moved(ctx, *item) != 0 || hex_apply(ctx, seq->action) != 0)
+        {
+            return -1;
+        }
+        if (ctx->stack->top != top + 1)
+        {
+            hex_error(ctx, "[symbol map] Quotation must push one item for each sequence item");
+            return -1;
+        }
+        *item = hex_pop(ctx);
+        return 1;
+    }
+
+    case HEX_SEQ_FILTER:
+        while (1)
         {
-            // Separator is not empty: split as usual
-            char *token = strtok(str->data.str_value, separator->data.str_value);
-            size_t capacity = 2;
-            size_t size = 0;
-            hex_item_t **quotation = (hex_item_t **)calloc(capacity, sizeof(hex_item_t *));
-            if (!quotation)
+            int result = hex_seq_next(ctx, seq->source, item);
+            if (result <= 0)
             {
-                hex_error(ctx, "[symbol split] Memory allocation failed");
-                result = 1;
+                return result;
             }
-            else
+            int top = ctx->stack->top;
+            hex_item_t *copy = hex_copy_item(ctx, *item);
+            if (!copy || hex_push_moved(ctx, copy) != 0 || hex_apply(ctx, seq->action) != 0)
             {
-                while (token)
-                {
-                    if (size >= capacity)
-                    {
-                        capacity *= 2;
-                        hex_item_t **tmp = (hex_item_t **)realloc(quotation, capacity * sizeof(hex_item_t *));
-                        if (!tmp)
-                        {
-                            hex_error(ctx, "[symbol split] Memory allocation failed");
-                            result = 1;
-                            break;
-                        }
-                        quotation = tmp;
-                        if (!quotation)
-                        {
-                            hex_error(ctx, "[symbol split] Memory allocation failed");
-                            result = 1;
-                            break;
-                        }
-                    }
-                    quotation[size] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-                    quotation[size]->type = HEX_TYPE_STRING;
-                    quotation[size]->data.str_value = strdup(token);
-                    size++;
-                    token = strtok(NULL, separator->data.str_value);
-                }
-                if (result == 0)
-                {
-                    result = hex_push_quotation(ctx, quotation, size);
-                }
+                HEX_FREE(ctx, *item);
+                return -1;
+            }
+            if (ctx->stack->top != top + 1 || ctx->stack->entries[ctx->stack->top]->type != HEX_TYPE_INTEGER)
+            {
+                hex_error(ctx, "[symbol filter] Quotation must push an integer for each item");
+                HEX_FREE(ctx, *item);
+                return -1;
+            }
+            hex_item_t *condition = hex_pop(ctx);
+            int keep = condition->data.int_value > 0;
+            HEX_FREE(ctx, condition);
+            if (keep)
+            {
+                return 1;
             }
+            HEX_FREE(ctx, *item);
         }
     }
-    else
+    return 0;
+}
+
+// Add a map or filter stage to a sequence item, which is owned by the calling native
+// and updated in place, taking ownership of the quotation
+static int hex_seq_stage(hex_context_t *ctx, hex_seq_kind_t kind, hex_item_t *list, hex_item_t *action)
+{
+    hex_seq_t *stage = hex_seq_create(kind);
+    if (!stage)
     {
-        hex_error(ctx, "[symbol split] Two strings required");
-        result = 1;
+        hex_error(ctx, "[symbol %s] Memory allocation failed", kind == HEX_SEQ_MAP ? "map" : "filter");
+        HEX_FREE(ctx, list);
+        HEX_FREE(ctx, action);
+        return 1;
     }
-    if (result != 0)
+    stage->source = list->data.seq_value;
+    stage->action = action;
+    list->data.seq_value = stage;
+    if (HEX_PUSH(ctx, list) != 0)
     {
-        HEX_FREE(ctx, str);
-        HEX_FREE(ctx, separator);
+        HEX_FREE(ctx, list);
+        return 1;
     }
-    return result;
+    return 0;
 }
 
-int hex_symbol_sub(hex_context_t *ctx)
+int hex_symbol_seq(hex_context_t *ctx)
 {
-    HEX_POP(ctx, replacement);
-    if (replacement->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, end);
+    HEX_POP(ctx, start);
+    hex_seq_t *seq = hex_seq_create(HEX_SEQ_RANGE);
+    if (seq)
     {
-        HEX_FREE(ctx, replacement);
+        seq->current = start->data.int_value;
+        seq->end = end->data.int_value;
+    }
+    HEX_FREE(ctx, start);
+    HEX_FREE(ctx, end);
+    if (!seq)
+    {
+        hex_error(ctx, "[symbol seq] Memory allocation failed");
         return 1;
     }
-    HEX_POP(ctx, search);
-    if (search->type == HEX_TYPE_INVALID)
+    return hex_push_seq(ctx, seq);
+}
+
+int hex_symbol_lines(hex_context_t *ctx)
+{
+    HEX_POP(ctx, filename);
+    FILE *file = fopen(filename->data.str_value, "r");
+    if (!file)
     {
-        HEX_FREE(ctx, search);
-        HEX_FREE(ctx, replacement);
+        hex_error(ctx, "[symbol lines] Could not open file for reading: %s", filename->data.str_value);
+        HEX_FREE(ctx, filename);
+        return 1;
+    }
+    HEX_FREE(ctx, filename);
+    hex_seq_t *seq = hex_seq_create(HEX_SEQ_LINES);
+    if (!seq)
+    {
+        hex_error(ctx, "[symbol lines] Memory allocation failed");
+        fclose(file);
+        return 1;
+    }
+    seq->file = file;
+    return hex_push_seq(ctx, seq);
+}
+
+int hex_symbol_pieces(hex_context_t *ctx)
+{
+    HEX_POP(ctx, separator);
+    HEX_POP(ctx, str);
+    hex_seq_t *seq = hex_seq_create(HEX_SEQ_PIECES);
+    if (!seq)
+    {
+        hex_error(ctx, "[symbol pieces] Memory allocation failed");
+        HEX_FREE(ctx, str);
+        HEX_FREE(ctx, separator);
         return 1;
     }
+    seq->string = str;
+    seq->separator = separator;
+    return hex_push_seq(ctx, seq);
+}
+
+// Consume up to the given number of items of a sequence into a quotation
+int hex_symbol_take(hex_context_t *ctx)
+{
+    HEX_POP(ctx, count);
     HEX_POP(ctx, list);
-    if (list->type == HEX_TYPE_INVALID)
+    int32_t limit = count->data.int_value;
+    HEX_FREE(ctx, count);
+    hex_item_t *result = hex_quotation_item(ctx, NULL, 0);
+    if (!result)
     {
         HEX_FREE(ctx, list);
-        HEX_FREE(ctx, search);
-        HEX_FREE(ctx, replacement);
         return 1;
     }
-    int result = 0;
-    if (list->type == HEX_TYPE_STRING && search->type == HEX_TYPE_STRING && replacement->type == HEX_TYPE_STRING)
+    for (int32_t i = 0; i < limit; i++)
     {
-        char *str = list->data.str_value;
-        char *find = search->data.str_value;
-        char *replace = replacement->data.str_value;
-        char *ptr = strstr(str, find);
-        if (ptr)
+        hex_item_t *item = NULL;
+        int next = hex_seq_next(ctx, list->data.seq_value, &item);
+        if (next == 0)
         {
-            int findLen = strlen(find);
-            int replaceLen = strlen(replace);
-            int newLen = strlen(str) - findLen + replaceLen + 1;
-            char *newStr = (char *)malloc(newLen);
-            if (!newStr)
-            {
-                hex_error(ctx, "[symbol sub] Memory allocation failed");
-                result = 1;
-            }
-            else
-            {
-                strncpy(newStr, str, ptr - str);
-                strcpy(newStr + (ptr - str), replace);
-                strcpy(newStr + (ptr - str) + replaceLen, ptr + findLen);
-                result = hex_push_string(ctx, newStr);
-            }
+            break;
         }
-        else
+        if (next < 0 || hex_quotation_reserve(result, result->quotation_size + 1) != 0)
         {
-            result = hex_push_string(ctx, str);
+            if (next > 0)
+            {
+                hex_error(ctx, "[symbol take] Memory allocation failed");
+                HEX_FREE(ctx, item);
+            }
+            HEX_FREE(ctx, result);
+            HEX_FREE(ctx, list);
+            return 1;
         }
+        result->data.quotation_value[result->quotation_size++] = item;
     }
-    else
-    {
-        hex_error(ctx, "[symbol sub] Three strings required");
-        result = 1;
-    }
-    if (result != 0)
-    {
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, search);
-        HEX_FREE(ctx, replacement);
-    }
-    return result;
+    HEX_FREE(ctx, list);
+    return hex_push_edited(ctx, result);
 }
 
 // File symbols
@@ -5852,239 +9575,370 @@ int hex_symbol_sub(hex_context_t *ctx)
 int hex_symbol_read(hex_context_t *ctx)
 {
     HEX_POP(ctx, filename);
-    ;
-    if (filename->type == HEX_TYPE_INVALID)
+    int result = 0;
+    FILE *file = fopen(filename->data.str_value, "rb");
+    if (!file)
     {
-        HEX_FREE(ctx, filename);
-        return 1;
+        hex_error(ctx, "[symbol read] Could not open file for reading: %s", filename->data.str_value);
+        result = 1;
     }
-    int result = 0;
-    if (filename->type == HEX_TYPE_STRING)
+    else
     {
-        FILE *file = fopen(filename->data.str_value, "rb");
-        if (!file)
+        fseek(file, 0, SEEK_END);
+        long length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        uint8_t *buffer = (uint8_t *)malloc(length > 0 ? length : 1);
+        if (!buffer)
         {
-            hex_error(ctx, "[symbol read] Could not open file for reading: %s", filename->data.str_value);
+            hex_error(ctx, "[symbol read] Memory allocation failed");
             result = 1;
         }
         else
         {
-            fseek(file, 0, SEEK_END);
-            long length = ftell(file);
-            fseek(file, 0, SEEK_SET);
-
-            uint8_t *buffer = (uint8_t *)malloc(length);
-            if (!buffer)
+            size_t bytesRead = fread(buffer, 1, length, file);
+            if (hex_is_binary(buffer, bytesRead))
             {
-                hex_error(ctx, "[symbol read] Memory allocation failed");
-                result = 1;
+                // Binary files are returned as a buffer that takes over the bytes read
+                result = hex_push_buffer(ctx, buffer, bytesRead);
+                buffer = NULL;
             }
             else
             {
-                size_t bytesRead = fread(buffer, 1, length, file);
-                if (hex_is_binary(buffer, bytesRead))
+                size_t str_size;
+                char *str = hex_bytes_to_string(buffer, bytesRead, &str_size);
+                if (!str)
                 {
-                    hex_item_t **quotation = (hex_item_t **)calloc(bytesRead, sizeof(hex_item_t *));
-                    if (!quotation)
-                    {
-                        hex_error(ctx, "[symbol read] Memory allocation failed");
-                        result = 1;
-                    }
-                    else
-                    {
-                        for (size_t i = 0; i < bytesRead; i++)
-                        {
-                            quotation[i] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-                            quotation[i]->type = HEX_TYPE_INTEGER;
-                            quotation[i]->data.int_value = buffer[i];
-                        }
-                        result = hex_push_quotation(ctx, quotation, bytesRead);
-                    }
+                    hex_error(ctx, "[symbol read] Memory allocation failed");
+                    result = 1;
                 }
                 else
                 {
-                    char *str = hex_bytes_to_string(buffer, bytesRead);
-                    if (!str)
-                    {
-                        hex_error(ctx, "[symbol read] Memory allocation failed");
-                        result = 1;
-                    }
-                    else
-                    {
-                        hex_item_t *item = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-                        item->type = HEX_TYPE_STRING;
-                        item->data.str_value = hex_process_string(str);
-                        result = HEX_PUSH(ctx, item);
-                    }
+                    result = hex_push_string_buffer(ctx, str, str_size);
                 }
             }
-            fclose(file);
+            free(buffer);
         }
+        fclose(file);
     }
-    else
+    HEX_FREE(ctx, filename);
+    return result;
+}
+
+// Write a string, a buffer, a vector or a quotation of bytes to a stream with a single fwrite
+static int hex_write_data(hex_context_t *ctx, const char *symbol, hex_item_t *data, FILE *file)
+{
+    const void *bytes = data->data.str_value;
+    size_t size = data->str_size;
+    uint8_t *packed = NULL;
+    if (data->type == HEX_TYPE_QUOTATION)
     {
-        hex_error(ctx, "[symbol read] String required");
-        result = 1;
+        packed = (uint8_t *)malloc(data->quotation_size > 0 ? data->quotation_size : 1);
+        if (!packed)
+        {
+            hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
+            return 1;
+        }
+        for (size_t i = 0; i < data->quotation_size; i++)
+        {
+            if (data->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
+            {
+                hex_error(ctx, "[symbol %s] Quotation must contain only integers", symbol);
+                free(packed);
+                return 1;
+            }
+            packed[i] = (uint8_t)data->data.quotation_value[i]->data.int_value;
+        }
+        bytes = packed;
+        size = data->quotation_size;
     }
-    if (result != 0)
+    else if (data->type == HEX_TYPE_BUFFER)
     {
-        HEX_FREE(ctx, filename);
+        bytes = data->data.buffer_value;
+    }
+    else if (data->type == HEX_TYPE_VECTOR)
+    {
+        // Vectors are written as 32-bit little-endian integers
+        size = data->quotation_size * 4;
+        packed = (uint8_t *)malloc(size > 0 ? size : 1);
+        if (!packed)
+        {
+            hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
+            return 1;
+        }
+        for (size_t i = 0; i < data->quotation_size; i++)
+        {
+            uint32_t value = (uint32_t)data->data.vector_value[i];
+            packed[i * 4] = value & 0xff;
+            packed[i * 4 + 1] = (value >> 8) & 0xff;
+            packed[i * 4 + 2] = (value >> 16) & 0xff;
+            packed[i * 4 + 3] = (value >> 24) & 0xff;
+        }
+        bytes = packed;
+    }
+    int result = 0;
+    if (fwrite(bytes, 1, size, file) != size)
+    {
+        hex_error(ctx, "[symbol %s] Could not write to file", symbol);
+        result = 1;
     }
+    free(packed);
     return result;
 }
 
-int hex_symbol_write(hex_context_t *ctx)
+static int hex_write_file(hex_context_t *ctx, const char *symbol, const char *action, hex_item_t *data, const char *filename, const char *mode)
 {
-    HEX_POP(ctx, filename);
-    if (filename->type == HEX_TYPE_INVALID)
+    FILE *file = fopen(filename, mode);
+    if (!file)
     {
-        HEX_FREE(ctx, filename);
+        hex_error(ctx, "[symbol %s] Could not open file for %s: %s", symbol, action, filename);
         return 1;
     }
+    int result = hex_write_data(ctx, symbol, data, file);
+    fclose(file);
+    return result;
+}
+
+// Get the stream of an open file handle
+static FILE *hex_file_stream(hex_context_t *ctx, const char *symbol, hex_item_t *handle)
+{
+    int32_t i = handle->data.int_value;
+    if (i < 0 || i >= HEX_MAX_OPEN_FILES || !ctx->files[i])
+    {
+        hex_error(ctx, "[symbol %s] Invalid file handle", symbol);
+        return NULL;
+    }
+    // Output buffered by puts, print and warn goes first
+    if (i == 0)
+    {
+        hex_flush_output(ctx);
+    }
+    else if (i == 1)
+    {
+        hex_output_flush(&ctx->out);
+    }
+    else if (i == 2)
+    {
+        hex_output_flush(&ctx->err);
+    }
+    return ctx->files[i];
+}
+
+int hex_symbol_write(hex_context_t *ctx)
+{
+    HEX_POP(ctx, filename);
     HEX_POP(ctx, data);
-    if (data->type == HEX_TYPE_INVALID)
+    if (filename->type == HEX_TYPE_INTEGER)
     {
+        // Write to an open file handle, through its buffer
+        FILE *file = hex_file_stream(ctx, "write", filename);
+        int result = file ? hex_write_data(ctx, "write", data, file) : 1;
         HEX_FREE(ctx, data);
         HEX_FREE(ctx, filename);
-        return 1;
+        return result;
     }
-    int result = 0;
-    if (filename->type == HEX_TYPE_STRING)
+    int result = hex_write_file(ctx, "write", "writing", data, filename->data.str_value, data->type == HEX_TYPE_STRING ? "w" : "wb");
+    HEX_FREE(ctx, data);
+    HEX_FREE(ctx, filename);
+    return result;
+}
+
+int hex_symbol_append(hex_context_t *ctx)
+{
+    HEX_POP(ctx, filename);
+    HEX_POP(ctx, data);
+    int result = hex_write_file(ctx, "append", "appending", data, filename->data.str_value, data->type == HEX_TYPE_STRING ? "a" : "ab");
+    HEX_FREE(ctx, data);
+    HEX_FREE(ctx, filename);
+    return result;
+}
+
+// Open a file and store its stream in the first free slot of the handle table
+int hex_symbol_open(hex_context_t *ctx)
+{
+    HEX_POP(ctx, mode);
+    HEX_POP(ctx, filename);
+    const char *modes[] = {"r", "rb", "w", "wb", "a", "ab"};
+    const char *file_mode = NULL;
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i += 2)
     {
-        if (data->type == HEX_TYPE_STRING)
+        if (strcmp(mode->data.str_value, modes[i]) == 0)
         {
-            FILE *file = fopen(filename->data.str_value, "w");
-            if (file)
-            {
-                fputs(data->data.str_value, file);
-                fclose(file);
-                result = 0;
-            }
-            else
-            {
-                hex_error(ctx, "[symbol write] Could not open file for writing: %s", filename->data.str_value);
-                result = 1;
-            }
+            file_mode = modes[i + 1];
         }
-        else if (data->type == HEX_TYPE_QUOTATION)
+    }
+    int handle = 3;
+    while (handle < HEX_MAX_OPEN_FILES && ctx->files[handle])
+    {
+        handle++;
+    }
+    int result = 1;
+    if (!file_mode)
+    {
+        hex_error(ctx, "[symbol open] Invalid mode: %s", mode->data.str_value);
+    }
+    else if (handle == HEX_MAX_OPEN_FILES)
+    {
+        hex_error(ctx, "[symbol open] Too many open files");
+    }
+    else
+    {
+        FILE *file = fopen(filename->data.str_value, file_mode);
+        if (!file)
         {
-            FILE *file = fopen(filename->data.str_value, "wb");
-            if (file)
-            {
-                for (size_t i = 0; i < data->quotation_size; i++)
-                {
-                    if (data->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
-                    {
-                        hex_error(ctx, "[symbol write] Quotation must contain only integers");
-                        result = 1;
-                        break;
-                    }
-                    uint8_t byte = (uint8_t)data->data.quotation_value[i]->data.int_value;
-                    fwrite(&byte, 1, 1, file);
-                }
-                fclose(file);
-                result = 0;
-            }
-            else
-            {
-                hex_error(ctx, "[symbol write] Could not open file for writing: %s", filename->data.str_value);
-                result = 1;
-            }
+            hex_error(ctx, "[symbol open] Could not open file: %s", filename->data.str_value);
         }
         else
         {
-            hex_error(ctx, "[symbol write] String or quotation of integers required");
-            result = 1;
+            setvbuf(file, NULL, _IOFBF, HEX_FILE_BUFFER_SIZE);
+            ctx->files[handle] = file;
+            result = hex_push_integer(ctx, handle);
         }
     }
-    else
+    HEX_FREE(ctx, mode);
+    HEX_FREE(ctx, filename);
+    return result;
+}
+
+int hex_symbol_close(hex_context_t *ctx)
+{
+    HEX_POP(ctx, handle);
+    int32_t i = handle->data.int_value;
+    HEX_FREE(ctx, handle);
+    if (i < 3 || i >= HEX_MAX_OPEN_FILES || !ctx->files[i])
     {
-        hex_error(ctx, "[symbol write] String required");
-        result = 1;
+        hex_error(ctx, "[symbol close] Invalid file handle");
+        return 1;
     }
+    int result = fclose(ctx->files[i]);
+    ctx->files[i] = NULL;
     if (result != 0)
     {
-        HEX_FREE(ctx, data);
-        HEX_FREE(ctx, filename);
+        hex_error(ctx, "[symbol close] Could not write to file");
+        return 1;
     }
-    return result;
+    return 0;
 }
 
-int hex_symbol_append(hex_context_t *ctx)
+int hex_symbol_flush(hex_context_t *ctx)
 {
-    HEX_POP(ctx, filename);
-    if (filename->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, handle);
+    FILE *file = hex_file_stream(ctx, "flush", handle);
+    HEX_FREE(ctx, handle);
+    if (!file)
     {
-        HEX_FREE(ctx, filename);
         return 1;
     }
-    HEX_POP(ctx, data);
-    if (data->type == HEX_TYPE_INVALID)
+    if (fflush(file) != 0)
     {
-        HEX_FREE(ctx, data);
-        HEX_FREE(ctx, filename);
+        hex_error(ctx, "[symbol flush] Could not write to file");
         return 1;
     }
-    int result = 0;
-    if (filename->type == HEX_TYPE_STRING)
+    return 0;
+}
+
+int hex_symbol_readl(hex_context_t *ctx)
+{
+    HEX_POP(ctx, handle);
+    FILE *file = hex_file_stream(ctx, "readl", handle);
+    HEX_FREE(ctx, handle);
+    if (!file)
     {
-        if (data->type == HEX_TYPE_STRING)
-        {
-            FILE *file = fopen(filename->data.str_value, "a");
-            if (file)
-            {
-                fputs(data->data.str_value, file);
-                fclose(file);
-                result = 0;
-            }
-            else
-            {
-                hex_error(ctx, "[symbol append] Could not open file for appending: %s", filename->data.str_value);
-                result = 1;
-            }
-        }
-        else if (data->type == HEX_TYPE_QUOTATION)
+        return 1;
+    }
+    hex_item_t *line = NULL;
+    int result = hex_read_line(ctx, "readl", file, &line);
+    if (result < 0)
+    {
+        return 1;
+    }
+    if (result == 0)
+    {
+        // 0x0 is pushed at the end of the file, unlike an empty line
+        return hex_push_integer(ctx, 0);
+    }
+    if (HEX_PUSH(ctx, line) != 0)
+    {
+        HEX_FREE(ctx, line);
+        return 1;
+    }
+    return 0;
+}
+
+int hex_symbol_readb(hex_context_t *ctx)
+{
+    HEX_POP(ctx, count);
+    HEX_POP(ctx, handle);
+    FILE *file = hex_file_stream(ctx, "readb", handle);
+    size_t size = count->data.int_value > 0 ? (size_t)count->data.int_value : 0;
+    HEX_FREE(ctx, handle);
+    HEX_FREE(ctx, count);
+    if (!file)
+    {
+        return 1;
+    }
+    // The buffer grows as chunks are read, so that a large count does not allocate
+    // more than the bytes actually available
+    size_t capacity = size < HEX_READ_CHUNK ? size : HEX_READ_CHUNK;
+    uint8_t *data = (uint8_t *)malloc(capacity > 0 ? capacity : 1);
+    if (!data)
+    {
+        hex_error(ctx, "[symbol readb] Memory allocation failed");
+        return 1;
+    }
+    size_t read = 0;
+    while (read < size)
+    {
+        if (read == capacity)
         {
-            FILE *file = fopen(filename->data.str_value, "ab");
-            if (file)
-            {
-                for (size_t i = 0; i < data->quotation_size; i++)
-                {
-                    if (data->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
-                    {
-                        hex_error(ctx, "[symbol append] Quotation must contain only integers");
-                        result = 1;
-                        break;
-                    }
-                    uint8_t byte = (uint8_t)data->data.quotation_value[i]->data.int_value;
-                    fwrite(&byte, 1, 1, file);
-                }
-                fclose(file);
-                result = 0;
-            }
-            else
+            capacity = capacity * 2 < size ? capacity * 2 : size;
+            uint8_t *grown = (uint8_t *)realloc(data, capacity);
+            if (!grown)
             {
-                hex_error(ctx, "[symbol append] Could not open file for appending: %s", filename->data.str_value);
-                result = 1;
+                hex_error(ctx, "[symbol readb] Memory allocation failed");
+                free(data);
+                return 1;
             }
+            data = grown;
         }
-        else
+        size_t chunk = capacity - read < HEX_READ_CHUNK ? capacity - read : HEX_READ_CHUNK;
+        size_t bytes = fread(data + read, 1, chunk, file);
+        read += bytes;
+        if (bytes < chunk)
         {
-            hex_error(ctx, "[symbol append] String or quotation of integers required");
-            result = 1;
+            break;
         }
     }
-    else
+    if (read < size && ferror(file))
     {
-        hex_error(ctx, "[symbol append] String required");
-        result = 1;
+        hex_error(ctx, "[symbol readb] Could not read file");
+        free(data);
+        return 1;
     }
-    if (result != 0)
+    if (read < capacity && read > 0)
     {
-        HEX_FREE(ctx, data);
-        HEX_FREE(ctx, filename);
+        uint8_t *shrunk = (uint8_t *)realloc(data, read);
+        data = shrunk ? shrunk : data;
     }
-    return result;
+    return hex_push_buffer(ctx, data, read);
+}
+
+int hex_symbol_eof(hex_context_t *ctx)
+{
+    HEX_POP(ctx, handle);
+    FILE *file = hex_file_stream(ctx, "eof", handle);
+    HEX_FREE(ctx, handle);
+    if (!file)
+    {
+        return 1;
+    }
+    // Peek at the next byte, as the end-of-file indicator is only set by a read
+    int c = fgetc(file);
+    if (c != EOF)
+    {
+        ungetc(c, file);
+    }
+    return hex_push_integer(ctx, c == EOF);
 }
 
 // Shell symbols
@@ -6104,6 +9958,7 @@ int hex_symbol_args(hex_context_t *ctx)
             quotation[i] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
             quotation[i]->type = HEX_TYPE_STRING;
             quotation[i]->data.str_value = strdup(ctx->argv[i]);
+            quotation[i]->str_size = strlen(ctx->argv[i]);
         }
         if (hex_push_quotation(ctx, quotation, ctx->argc) != 0)
         {
@@ -6117,19 +9972,8 @@ int hex_symbol_args(hex_context_t *ctx)
 int hex_symbol_exit(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    if (item->type != HEX_TYPE_INTEGER)
-    {
-        hex_error(ctx, "[symbol exit] Integer required");
-        HEX_FREE(ctx, item);
-        return 1;
-    }
     int exit_status = item->data.int_value;
+    hex_flush_output(ctx);
     exit(exit_status);
     return 0; // This line will never be reached, but it's here to satisfy the return type
 }
@@ -6137,39 +9981,17 @@ int hex_symbol_exit(hex_context_t *ctx)
 int hex_symbol_exec(hex_context_t *ctx)
 {
     HEX_POP(ctx, command);
-    if (command->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, command);
-        return 1;
-    }
     int result = 0;
-    if (command->type == HEX_TYPE_STRING)
-    {
-        int status = system(command->data.str_value);
-        result = hex_push_integer(ctx, status);
-    }
-    else
-    {
-        hex_error(ctx, "[symbol exec] String required");
-        result = 1;
-    }
+    hex_flush_output(ctx);
+    int status = system(command->data.str_value);
+    result = hex_push_integer(ctx, status);
     return result;
 }
 
 int hex_symbol_run(hex_context_t *ctx)
 {
     HEX_POP(ctx, command);
-    if (command->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, command);
-        return 1;
-    }
-    if (command->type != HEX_TYPE_STRING)
-    {
-        hex_error(ctx, "[symbol run] String required");
-        HEX_FREE(ctx, command);
-        return 1;
-    }
+    hex_flush_output(ctx);
 
     size_t output_len = 0, output_cap = 4096;
     size_t error_len = 0, error_cap = 4096;
@@ -6276,523 +10098,1044 @@ int hex_symbol_run(hex_context_t *ctx)
     int stderr_pipe[2];
     if (pipe(stdout_pipe) != 0 || pipe(stderr_pipe) != 0)
     {
-        hex_error(ctx, "[symbol run] Failed to create pipes");
-        free(output);
-        free(error_buf);
-        HEX_FREE(ctx, command);
+        hex_error(ctx, "[symbol run] Failed to create pipes");
+        free(output);
+        free(error_buf);
+        HEX_FREE(ctx, command);
+        return 1;
+    }
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        hex_error(ctx, "[symbol run] Failed to fork process");
+        free(output);
+        free(error_buf);
+        HEX_FREE(ctx, command);
+        return 1;
+    }
+    else if (pid == 0)
+    {
+        // Child process
+        close(stdout_pipe[0]);
+        close(stderr_pipe[0]);
+        dup2(stdout_pipe[1], STDOUT_FILENO);
+        dup2(stderr_pipe[1], STDERR_FILENO);
+        execl("/bin/sh", "sh", "-c", command->data.str_value, (char *)NULL);
+        exit(1);
+    }
+    else
+    {
+        // Parent process
+        close(stdout_pipe[1]);
+        close(stderr_pipe[1]);
+
+        // Read stdout
+        FILE *stdout_fp = fdopen(stdout_pipe[0], "r");
+        char path[1035];
+        while (fgets(path, sizeof(path), stdout_fp) != NULL)
+        {
+            size_t chunk_len = strlen(path);
+            RUN_APPEND(output, output_len, output_cap, path, chunk_len);
+        }
+        fclose(stdout_fp);
+
+        // Read stderr
+        FILE *stderr_fp = fdopen(stderr_pipe[0], "r");
+        while (fgets(path, sizeof(path), stderr_fp) != NULL)
+        {
+            size_t chunk_len = strlen(path);
+            RUN_APPEND(error_buf, error_len, error_cap, path, chunk_len);
+        }
+        fclose(stderr_fp);
+
+        // Wait for child process to finish and get the return code
+        int status;
+        waitpid(pid, &status, 0);
+        return_code = WEXITSTATUS(status);
+    }
+#endif
+#undef RUN_APPEND
+
+    if (!output || !error_buf)
+    {
+        free(output);
+        free(error_buf);
+        hex_error(ctx, "[symbol run] Memory allocation failed while reading output");
+        HEX_FREE(ctx, command);
+        return 1;
+    }
+
+    // Push the return code, output, and error as a quotation
+    hex_item_t **quotation = (hex_item_t **)calloc(3, sizeof(hex_item_t *));
+    quotation[0] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
+    quotation[0]->type = HEX_TYPE_INTEGER;
+    quotation[0]->data.int_value = return_code;
+
+    quotation[1] = hex_string_buffer_item(ctx, output, output_len);      // transfer ownership
+    quotation[2] = hex_string_buffer_item(ctx, error_buf, error_len);    // transfer ownership
+
+    HEX_FREE(ctx, command);
+    return hex_push_quotation(ctx, quotation, 3);
+}
+
+// Control flow symbols
+
+int hex_symbol_if(hex_context_t *ctx)
+{
+    HEX_POP(ctx, elseBlock);
+    HEX_POP(ctx, thenBlock);
+    HEX_POP(ctx, condition);
+
+    for (size_t i = 0; i < condition->quotation_size; i++)
+    {
+        hex_item_t *copy = hex_copy_item(ctx, condition->data.quotation_value[i]);
+        if (!copy || hex_push(ctx, copy) != 0)
+        {
+            if (copy)
+                hex_free_item(ctx, copy);
+            HEX_FREE(ctx, condition);
+            HEX_FREE(ctx, thenBlock);
+            HEX_FREE(ctx, elseBlock);
+            return 1;
+        }
+    }
+    HEX_POP(ctx, evalResult);
+    if (evalResult->type == HEX_TYPE_INTEGER && evalResult->data.int_value > 0)
+    {
+        for (size_t i = 0; i < thenBlock->quotation_size; i++)
+        {
+            hex_item_t *copy = hex_copy_item(ctx, thenBlock->data.quotation_value[i]);
+            if (!copy || hex_push(ctx, copy) != 0)
+            {
+                if (copy)
+                    hex_free_item(ctx, copy);
+                HEX_FREE(ctx, condition);
+                HEX_FREE(ctx, thenBlock);
+                HEX_FREE(ctx, elseBlock);
+                HEX_FREE(ctx, evalResult);
+                return 1;
+            }
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < elseBlock->quotation_size; i++)
+        {
+            hex_item_t *copy = hex_copy_item(ctx, elseBlock->data.quotation_value[i]);
+            if (!copy || hex_push(ctx, copy) != 0)
+            {
+                if (copy)
+                    hex_free_item(ctx, copy);
+                HEX_FREE(ctx, condition);
+                HEX_FREE(ctx, thenBlock);
+                HEX_FREE(ctx, elseBlock);
+                HEX_FREE(ctx, evalResult);
+                return 1;
+            }
+        }
+    }
+    HEX_FREE(ctx, evalResult);
+    HEX_FREE(ctx, condition);
+    HEX_FREE(ctx, thenBlock);
+    HEX_FREE(ctx, elseBlock);
+    return 0;
+}
+
+int hex_symbol_while(hex_context_t *ctx)
+{
+    HEX_POP(ctx, action);
+    HEX_POP(ctx, condition);
+
+    while (1)
+    {
+        for (size_t i = 0; i < condition->quotation_size; i++)
+        {
+            // Create a copy to avoid ownership issues
+            hex_item_t *copy = hex_copy_item(ctx, condition->data.quotation_value[i]);
+            if (!copy || hex_push(ctx, copy) != 0)
+            {
+                if (copy)
+                    hex_free_item(ctx, copy);
+                HEX_FREE(ctx, action);
+                HEX_FREE(ctx, condition);
+                return 1;
+            }
+        }
+        HEX_POP(ctx, evalResult);
+        if (evalResult->type == HEX_TYPE_INTEGER && evalResult->data.int_value == 0)
+        {
+            // Don't free evalResult here as it might be shared - let normal cleanup handle it
+            break;
+        }
+
+        hex_item_t *act = hex_copy_item(ctx, action);
+        for (size_t i = 0; i < act->quotation_size; i++)
+        {
+            // Create a copy to avoid ownership issues
+            hex_item_t *copy = hex_copy_item(ctx, act->data.quotation_value[i]);
+            if (!copy || hex_push(ctx, copy) != 0)
+            {
+                if (copy)
+                    hex_free_item(ctx, copy);
+                HEX_FREE(ctx, act);
+                HEX_FREE(ctx, action);
+                HEX_FREE(ctx, condition);
+                return 1;
+            }
+        }
+        HEX_FREE(ctx, act); // Free the temporary copy
+    }
+
+    // Clean up after successful completion
+    HEX_FREE(ctx, action);
+    HEX_FREE(ctx, condition);
+    return 0;
+}
+
+int hex_symbol_times(hex_context_t *ctx)
+{
+    HEX_POP(ctx, count);
+    HEX_POP(ctx, action);
+    int result = 0;
+    for (int32_t i = 0; i < count->data.int_value && result == 0; i++)
+    {
+        result = hex_apply(ctx, action);
+    }
+    HEX_FREE(ctx, count);
+    HEX_FREE(ctx, action);
+    return result;
+}
+
+// Apply a quotation to the given number of items, unless it was applied to equal items
+// before: the items it pushed then are pushed again instead. The quotation must not
+// depend on anything else than these items.
+int hex_symbol_memo(hex_context_t *ctx)
+{
+    HEX_POP(ctx, arity);
+    HEX_POP(ctx, action);
+    int32_t n = arity->data.int_value;
+    HEX_FREE(ctx, arity);
+    if (n < 0 || n > ctx->stack->top + 1)
+    {
+        hex_error(ctx, "[symbol memo] Invalid arity");
+        HEX_FREE(ctx, action);
+        return 1;
+    }
+    // The results are kept for a quotation of the inputs followed by the quotation applied
+    int base = ctx->stack->top - n;
+    hex_item_t **items = (hex_item_t **)calloc(n + 1, sizeof(hex_item_t *));
+    hex_item_t *key = items ? hex_quotation_item(ctx, items, n + 1) : NULL;
+    if (!key)
+    {
+        hex_error(ctx, "[symbol memo] Memory allocation failed");
+        free(items);
+        HEX_FREE(ctx, action);
+        return 1;
+    }
+    items[n] = action;
+    for (int i = 0; i < n; i++)
+    {
+        items[i] = hex_copy_item(ctx, ctx->stack->entries[base + 1 + i]);
+        if (!items[i])
+        {
+            HEX_FREE(ctx, key);
+            return 1;
+        }
+    }
+    size_t hash = hex_item_hash(key);
+    hex_item_t *outputs = hex_memo_get(ctx, key, hash);
+    if (outputs)
+    {
+        HEX_FREE(ctx, key);
+        for (int i = 0; i < n; i++)
+        {
+            HEX_FREE(ctx, hex_pop(ctx));
+        }
+        for (size_t i = 0; i < outputs->quotation_size; i++)
+        {
+            hex_item_t *copy = hex_copy_item(ctx, outputs->data.quotation_value[i]);
+            if (!copy || HEX_PUSH(ctx, copy) != 0)
+            {
+                HEX_FREE(ctx, copy);
+                return 1;
+            }
+        }
+        return 0;
+    }
+    if (hex_apply(ctx, action) != 0)
+    {
+        HEX_FREE(ctx, key);
         return 1;
     }
-
-    pid_t pid = fork();
-    if (pid == -1)
+    if (ctx->stack->top < base)
     {
-        hex_error(ctx, "[symbol run] Failed to fork process");
-        free(output);
-        free(error_buf);
-        HEX_FREE(ctx, command);
-        return 1;
+        // The quotation consumed more items than its inputs: its results are not kept
+        HEX_FREE(ctx, key);
+        return 0;
     }
-    else if (pid == 0)
+    size_t count = ctx->stack->top - base;
+    hex_item_t **results = (hex_item_t **)calloc(count > 0 ? count : 1, sizeof(hex_item_t *));
+    outputs = results ? hex_quotation_item(ctx, results, count) : NULL;
+    if (!outputs)
     {
-        // Child process
-        close(stdout_pipe[0]);
-        close(stderr_pipe[0]);
-        dup2(stdout_pipe[1], STDOUT_FILENO);
-        dup2(stderr_pipe[1], STDERR_FILENO);
-        execl("/bin/sh", "sh", "-c", command->data.str_value, (char *)NULL);
-        exit(1);
+        free(results);
     }
-    else
+    for (size_t i = 0; outputs && i < count; i++)
     {
-        // Parent process
-        close(stdout_pipe[1]);
-        close(stderr_pipe[1]);
-
-        // Read stdout
-        FILE *stdout_fp = fdopen(stdout_pipe[0], "r");
-        char path[1035];
-        while (fgets(path, sizeof(path), stdout_fp) != NULL)
+        results[i] = hex_copy_item(ctx, ctx->stack->entries[base + 1 + i]);
+        if (!results[i])
         {
-            size_t chunk_len = strlen(path);
-            RUN_APPEND(output, output_len, output_cap, path, chunk_len);
+            outputs->quotation_size = i;
+            HEX_FREE(ctx, outputs);
+            outputs = NULL;
         }
-        fclose(stdout_fp);
+    }
+    if (!outputs || hex_memo_put(ctx, key, hash, outputs) != 0)
+    {
+        hex_error(ctx, "[symbol memo] Memory allocation failed");
+        HEX_FREE(ctx, outputs);
+        HEX_FREE(ctx, key);
+        return 1;
+    }
+    return 0;
+}
 
-        // Read stderr
-        FILE *stderr_fp = fdopen(stderr_pipe[0], "r");
-        while (fgets(path, sizeof(path), stderr_fp) != NULL)
+// Push a dictionary of the number of results kept by memo, and of the lookups that
+// found results (hits), that did not (misses), and of the results evicted
+int hex_symbol_memostats(hex_context_t *ctx)
+{
+    const char *names[] = {"size", "hits", "misses", "evictions"};
+    size_t values[] = {ctx->memo.size, ctx->memo.hits, ctx->memo.misses, ctx->memo.evictions};
+    hex_dict_t *dict = hex_dict_create();
+    if (!dict)
+    {
+        hex_error(ctx, "[symbol memostats] Memory allocation failed");
+        return 1;
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        hex_item_t *key = hex_string_item(ctx, names[i]);
+        hex_item_t *value = key ? hex_integer_item(ctx, (int)values[i]) : NULL;
+        if (!value || hex_dict_put(ctx, dict, key, value) != 0)
         {
-            size_t chunk_len = strlen(path);
-            RUN_APPEND(error_buf, error_len, error_cap, path, chunk_len);
+            hex_error(ctx, "[symbol memostats] Memory allocation failed");
+            HEX_FREE(ctx, key);
+            HEX_FREE(ctx, value);
+            hex_dict_release(ctx, dict);
+            return 1;
         }
-        fclose(stderr_fp);
-
-        // Wait for child process to finish and get the return code
-        int status;
-        waitpid(pid, &status, 0);
-        return_code = WEXITSTATUS(status);
     }
-#endif
-#undef RUN_APPEND
+    return hex_push_dict(ctx, dict);
+}
 
-    if (!output || !error_buf)
+int hex_symbol_error(hex_context_t *ctx)
+{
+    char *message = strdup(hex_error_message(ctx));
+    hex_clear_error(ctx);
+    int result = hex_push_string(ctx, message);
+    free(message);
+    return result;
+}
+
+int hex_symbol_try(hex_context_t *ctx)
+{
+    HEX_POP(ctx, catch_block);
+    HEX_POP(ctx, try_block);
+
+    // Errors raised within the try block are neither printed nor formatted
+    // until they are read; the first failure unwinds straight to the catch block.
+    hex_try_frame_t frame;
+    hex_enter_try(ctx, &frame);
+    int failed = 0;
+    for (size_t i = 0; i < try_block->quotation_size; i++)
     {
-        free(output);
-        free(error_buf);
-        hex_error(ctx, "[symbol run] Memory allocation failed while reading output");
-        HEX_FREE(ctx, command);
-        return 1;
+        hex_item_t *copy = hex_copy_item(ctx, try_block->data.quotation_value[i]);
+        if (!copy || hex_push(ctx, copy) != 0)
+        {
+            if (copy)
+                hex_free_item(ctx, copy);
+            failed = 1;
+            break;
+        }
     }
+    hex_leave_try(ctx, &frame);
 
-    // Push the return code, output, and error as a quotation
-    hex_item_t **quotation = (hex_item_t **)calloc(3, sizeof(hex_item_t *));
-    quotation[0] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-    quotation[0]->type = HEX_TYPE_INTEGER;
-    quotation[0]->data.int_value = return_code;
-
-    quotation[1] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-    quotation[1]->type = HEX_TYPE_STRING;
-    quotation[1]->data.str_value = output; // transfer ownership
+    if (failed || hex_has_error(ctx))
+    {
+        if (ctx->settings->debugging_enabled)
+        {
+            hex_debug(ctx, "[symbol try] Handling error: %s", hex_error_message(ctx));
+        }
+        for (size_t i = 0; i < catch_block->quotation_size; i++)
+        {
+            hex_item_t *copy = hex_copy_item(ctx, catch_block->data.quotation_value[i]);
+            if (!copy || hex_push(ctx, copy) != 0)
+            {
+                if (copy)
+                    hex_free_item(ctx, copy);
+                HEX_FREE(ctx, catch_block);
+                HEX_FREE(ctx, try_block);
+                return 1;
+            }
+        }
+    }
 
-    quotation[2] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-    quotation[2]->type = HEX_TYPE_STRING;
-    quotation[2]->data.str_value = error_buf; // transfer ownership
+    hex_restore_error(ctx, &frame);
+    HEX_FREE(ctx, catch_block);
+    HEX_FREE(ctx, try_block);
+    return 0;
+}
 
-    HEX_FREE(ctx, command);
-    return hex_push_quotation(ctx, quotation, 3);
+int hex_symbol_throw(hex_context_t *ctx)
+{
+    HEX_POP(ctx, message);
+    hex_error(ctx, "%s", message->data.str_value);
+    HEX_FREE(ctx, message);
+    return 1;
 }
 
-// Control flow symbols
+// Quotation symbols
 
-int hex_symbol_if(hex_context_t *ctx)
+int hex_symbol_q(hex_context_t *ctx)
 {
-    HEX_POP(ctx, elseBlock);
-    ;
-    if (elseBlock->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, elseBlock);
-        return 1;
-    }
-    HEX_POP(ctx, thenBlock);
-    ;
-    if (thenBlock->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, item);
+
+    // The popped item is owned by this native, so it is moved into the quotation
+    hex_item_t *result = (hex_item_t *)calloc(1, sizeof(hex_item_t));
+    if (!result)
     {
-        HEX_FREE(ctx, thenBlock);
-        HEX_FREE(ctx, elseBlock);
+        hex_error(ctx, "[symbol '] Memory allocation failed");
+        HEX_FREE(ctx, item);
         return 1;
     }
-    HEX_POP(ctx, condition);
-    ;
-    if (condition->type == HEX_TYPE_INVALID)
+
+    result->type = HEX_TYPE_QUOTATION;
+    result->data.quotation_value = (hex_item_t **)calloc(1, sizeof(hex_item_t *));
+    if (!result->data.quotation_value)
     {
-        HEX_FREE(ctx, condition);
-        HEX_FREE(ctx, thenBlock);
-        HEX_FREE(ctx, elseBlock);
+        hex_error(ctx, "[symbol '] Memory allocation failed");
+        HEX_FREE(ctx, item);
+        HEX_FREE(ctx, result);
         return 1;
     }
 
-    if (condition->type != HEX_TYPE_QUOTATION || thenBlock->type != HEX_TYPE_QUOTATION || elseBlock->type != HEX_TYPE_QUOTATION)
+    result->data.quotation_value[0] = item;
+    result->quotation_size = 1;
+
+    if (HEX_PUSH(ctx, result) != 0)
     {
-        hex_error(ctx, "[symbol if] Three quotations required");
-        HEX_FREE(ctx, condition);
-        HEX_FREE(ctx, thenBlock);
-        HEX_FREE(ctx, elseBlock);
+        HEX_FREE(ctx, result); // will free contained copy via list free
         return 1;
     }
-    else
+    return 0;
+}
+
+// Compile a quotation made only of integers, dup, swap, drop and elementwise
+// operators into a kernel, checking that it turns one integer into one integer
+// without exceeding HEX_KERNEL_DEPTH items. Returns the number of steps, or -1 if
+// the quotation cannot be compiled.
+static int hex_kernel_compile(hex_item_t *action, hex_kernel_step_t *steps)
+{
+    int depth = 1;
+    for (size_t i = 0; i < action->quotation_size; i++)
     {
-        for (size_t i = 0; i < condition->quotation_size; i++)
+        hex_item_t *item = action->data.quotation_value[i];
+        uint8_t op = 0;
+        if (item->type == HEX_TYPE_INTEGER)
         {
-            hex_item_t *copy = hex_copy_item(ctx, condition->data.quotation_value[i]);
-            if (!copy || hex_push(ctx, copy) != 0)
+            depth++;
+        }
+        else if (item->type == HEX_TYPE_NATIVE_SYMBOL)
+        {
+            op = hex_symbol_to_opcode(item->token->value);
+            switch (op)
             {
-                if (copy)
-                    hex_free_item(ctx, copy);
-                HEX_FREE(ctx, condition);
-                HEX_FREE(ctx, thenBlock);
-                HEX_FREE(ctx, elseBlock);
-                return 1;
+            case HEX_OP_DUP:
+                depth = depth < 1 ? -1 : depth + 1;
+                break;
+            case HEX_OP_SWAP:
+                depth = depth < 2 ? -1 : depth;
+                break;
+            case HEX_OP_DROP:
+                depth = depth < 1 ? -1 : depth - 1;
+                break;
+            case HEX_OP_ADD:
+            case HEX_OP_SUBTRACT:
+            case HEX_OP_MULTIPLY:
+            case HEX_OP_BITAND:
+            case HEX_OP_BITOR:
+            case HEX_OP_BITXOR:
+            case HEX_OP_SHL:
+            case HEX_OP_SHR:
+            case HEX_OP_EQUAL:
+            case HEX_OP_NOTEQUAL:
+            case HEX_OP_GREATER:
+            case HEX_OP_LESS:
+            case HEX_OP_GREATEREQUAL:
+            case HEX_OP_LESSEQUAL:
+                depth = depth < 2 ? -1 : depth - 1;
+                break;
+            default:
+                return -1;
             }
         }
-        HEX_POP(ctx, evalResult);
-        if (evalResult->type == HEX_TYPE_INTEGER && evalResult->data.int_value > 0)
+        else
+        {
+            return -1;
+        }
+        if (depth < 0 || depth > HEX_KERNEL_DEPTH)
+        {
+            return -1;
+        }
+        steps[i].op = op;
+        steps[i].value = item->data.int_value;
+    }
+    return depth == 1 ? (int)action->quotation_size : -1;
+}
+
+// Run a compiled kernel over a vector in place, one block of elements at a time:
+// each step processes a whole block, so operators run through hex_vector_apply.
+// Items on the kernel stack are blocks of HEX_KERNEL_BLOCK elements or literals.
+static void hex_kernel_run(const hex_kernel_step_t *steps, int count, int32_t *values, size_t size)
+{
+    int32_t registers[HEX_KERNEL_DEPTH][HEX_KERNEL_BLOCK];
+    const int32_t *operands[HEX_KERNEL_DEPTH];
+    size_t operand_steps[HEX_KERNEL_DEPTH];
+    for (size_t start = 0; start < size; start += HEX_KERNEL_BLOCK)
+    {
+        size_t block = size - start < HEX_KERNEL_BLOCK ? size - start : HEX_KERNEL_BLOCK;
+        int depth = 1;
+        operands[0] = values + start;
+        operand_steps[0] = 1;
+        for (int k = 0; k < count; k++)
         {
-            for (size_t i = 0; i < thenBlock->quotation_size; i++)
+            const int32_t *operand;
+            size_t operand_step;
+            switch (steps[k].op)
+            {
+            case 0:
+                operands[depth] = &steps[k].value;
+                operand_steps[depth++] = 0;
+                break;
+            case HEX_OP_DUP:
+                operands[depth] = operands[depth - 1];
+                operand_steps[depth] = operand_steps[depth - 1];
+                depth++;
+                break;
+            case HEX_OP_SWAP:
+                operand = operands[depth - 1];
+                operand_step = operand_steps[depth - 1];
+                operands[depth - 1] = operands[depth - 2];
+                operand_steps[depth - 1] = operand_steps[depth - 2];
+                operands[depth - 2] = operand;
+                operand_steps[depth - 2] = operand_step;
+                break;
+            case HEX_OP_DROP:
+                depth--;
+                break;
+            default:
             {
-                hex_item_t *copy = hex_copy_item(ctx, thenBlock->data.quotation_value[i]);
-                if (!copy || hex_push(ctx, copy) != 0)
+                // Write the result into a register that no item below the operands refers to
+                int r = 0;
+                for (int j = 0; j < depth - 2; j++)
                 {
-                    if (copy)
-                        hex_free_item(ctx, copy);
-                    HEX_FREE(ctx, condition);
-                    HEX_FREE(ctx, thenBlock);
-                    HEX_FREE(ctx, elseBlock);
-                    HEX_FREE(ctx, evalResult);
-                    return 1;
+                    if (operands[j] == registers[r])
+                    {
+                        r++;
+                        j = -1;
+                    }
                 }
+                hex_vector_apply(steps[k].op, registers[r], operands[depth - 2], operand_steps[depth - 2], operands[depth - 1], operand_steps[depth - 1], block);
+                depth--;
+                operands[depth - 1] = registers[r];
+                operand_steps[depth - 1] = 1;
+                break;
+            }
             }
         }
-        else
+        if (operand_steps[0] == 0)
         {
-            for (size_t i = 0; i < elseBlock->quotation_size; i++)
+            for (size_t i = 0; i < block; i++)
             {
-                hex_item_t *copy = hex_copy_item(ctx, elseBlock->data.quotation_value[i]);
-                if (!copy || hex_push(ctx, copy) != 0)
-                {
-                    if (copy)
-                        hex_free_item(ctx, copy);
-                    HEX_FREE(ctx, condition);
-                    HEX_FREE(ctx, thenBlock);
-                    HEX_FREE(ctx, elseBlock);
-                    HEX_FREE(ctx, evalResult);
-                    return 1;
-                }
+                values[start + i] = operands[0][0];
             }
         }
-        HEX_FREE(ctx, evalResult);
-        HEX_FREE(ctx, condition);
-        HEX_FREE(ctx, thenBlock);
-        HEX_FREE(ctx, elseBlock);
+        else if (operands[0] != values + start)
+        {
+            memcpy(values + start, operands[0], block * sizeof(int32_t));
+        }
+    }
+}
+
+// Apply a quotation to each element of a vector, which is owned by map and updated in place
+static int hex_map_vector(hex_context_t *ctx, hex_item_t *action, hex_item_t *list)
+{
+    hex_kernel_step_t *steps = (hex_kernel_step_t *)malloc((action->quotation_size + 1) * sizeof(hex_kernel_step_t));
+    if (!steps)
+    {
+        hex_error(ctx, "[symbol map] Memory allocation failed");
+        return 1;
+    }
+    int count = hex_kernel_compile(action, steps);
+    if (count >= 0)
+    {
+        hex_kernel_run(steps, count, list->data.vector_value, list->quotation_size);
+        free(steps);
+        return 0;
+    }
+    free(steps);
+    // Other quotations are dequoted for each element, and must push one integer
+    for (size_t i = 0; i < list->quotation_size; i++)
+    {
+        int top = ctx->stack->top;
+        if (hex_push_integer(ctx, list->data.vector_value[i]) != 0 || hex_apply(ctx, action) != 0)
+        {
+            return 1;
+        }
+        if (ctx->stack->top != top + 1 || ctx->stack->entries[ctx->stack->top]->type != HEX_TYPE_INTEGER)
+        {
+            hex_error(ctx, "[symbol map] Quotation must push an integer for each vector element");
+            return 1;
+        }
+        hex_item_t *result_item = hex_pop(ctx);
+        list->data.vector_value[i] = result_item->data.int_value;
+        HEX_FREE(ctx, result_item);
     }
     return 0;
 }
 
-int hex_symbol_while(hex_context_t *ctx)
+int hex_symbol_map(hex_context_t *ctx)
 {
     HEX_POP(ctx, action);
-    ;
-    if (action->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, list);
+    if (list->type == HEX_TYPE_SEQUENCE)
+    {
+        return hex_seq_stage(ctx, HEX_SEQ_MAP, list, action);
+    }
+    if (list->type == HEX_TYPE_VECTOR)
     {
+        int result = hex_map_vector(ctx, action, list);
         HEX_FREE(ctx, action);
+        if (result == 0 && HEX_PUSH(ctx, list) == 0)
+        {
+            return 0;
+        }
+        HEX_FREE(ctx, list);
         return 1;
     }
-    HEX_POP(ctx, condition);
-    ;
-    if (condition->type == HEX_TYPE_INVALID)
+
+    // Allocate result quotation (array of element pointers)
+    hex_item_t **quotation = (hex_item_t **)calloc(list->quotation_size, sizeof(hex_item_t *));
+    if (!quotation)
+    {
+        hex_error(ctx, "[symbol map] Memory allocation failed");
+        HEX_FREE(ctx, action);
+        HEX_FREE(ctx, list);
+        return 1;
+    }
+    for (size_t i = 0; i < list->quotation_size; i++)
+    {
+        // Push a deep copy of the list element to avoid aliasing
+        hex_item_t *elem_copy = hex_copy_item(ctx, list->data.quotation_value[i]);
+        if (!elem_copy || hex_push(ctx, elem_copy) != 0)
+        {
+            if (elem_copy)
+            {
+                hex_free_item(ctx, elem_copy);
+            }
+            HEX_FREE(ctx, action);
+            HEX_FREE(ctx, list);
+            hex_free_list(ctx, quotation, i);
+            return 1;
+        }
+        // Execute action quotation: push deep copies of its elements
+        for (size_t j = 0; j < action->quotation_size; j++)
+        {
+            hex_item_t *act_elem = hex_copy_item(ctx, action->data.quotation_value[j]);
+            if (!act_elem || hex_push(ctx, act_elem) != 0)
+            {
+                if (act_elem)
+                {
+                    hex_free_item(ctx, act_elem);
+                }
+                HEX_FREE(ctx, action);
+                HEX_FREE(ctx, list);
+                hex_free_list(ctx, quotation, i);
+                return 1;
+            }
+        }
+        // Pop result of action execution, copy into result quotation, free temporary
+        hex_item_t *result_item = hex_pop(ctx);
+        quotation[i] = hex_copy_item(ctx, result_item);
+        HEX_FREE(ctx, result_item);
+        if (!quotation[i])
+        {
+            hex_error(ctx, "[symbol map] Failed to copy result item");
+            HEX_FREE(ctx, action);
+            HEX_FREE(ctx, list);
+            hex_free_list(ctx, quotation, i);
+            return 1;
+        }
+    }
+    if (hex_push_quotation(ctx, quotation, list->quotation_size) != 0)
     {
         HEX_FREE(ctx, action);
-        HEX_FREE(ctx, condition);
+        HEX_FREE(ctx, list);
+        hex_free_list(ctx, quotation, list->quotation_size);
         return 1;
     }
+    // Free consumed inputs after success
+    HEX_FREE(ctx, action);
+    HEX_FREE(ctx, list);
+
+    return 0;
+}
 
-    if (condition->type != HEX_TYPE_QUOTATION || action->type != HEX_TYPE_QUOTATION)
+// Apply a quotation to each item of a list (or sequence), moving the items out of the list
+// unless they are shared
+int hex_symbol_each(hex_context_t *ctx)
+{
+    HEX_POP(ctx, action);
+    HEX_POP(ctx, list);
+    int result = 0;
+    if (list->type == HEX_TYPE_SEQUENCE)
     {
-        hex_error(ctx, "[symbol while] Two quotations required");
+        hex_item_t *item = NULL;
+        while (result == 0 && (result = hex_seq_next(ctx, list->data.seq_value, &item)) > 0)
+        {
+            result = hex_push_moved(ctx, item);
+            if (result == 0)
+            {
+                result = hex_apply(ctx, action);
+            }
+        }
         HEX_FREE(ctx, action);
-        HEX_FREE(ctx, condition);
-        return 1;
+        HEX_FREE(ctx, list);
+        return result < 0 ? 1 : result;
     }
-    else
+    for (size_t i = 0; i < list->quotation_size && result == 0; i++)
     {
-        while (1)
+        hex_item_t *item = hex_take_item(ctx, list, i);
+        result = item ? hex_push_moved(ctx, item) : 1;
+        if (result == 0)
         {
-            for (size_t i = 0; i < condition->quotation_size; i++)
-            {
-                // Create a copy to avoid ownership issues
-                hex_item_t *copy = hex_copy_item(ctx, condition->data.quotation_value[i]);
-                if (!copy || hex_push(ctx, copy) != 0)
-                {
-                    if (copy)
-                        hex_free_item(ctx, copy);
-                    HEX_FREE(ctx, action);
-                    HEX_FREE(ctx, condition);
-                    return 1;
-                }
-            }
-            HEX_POP(ctx, evalResult);
-            if (evalResult->type == HEX_TYPE_INTEGER && evalResult->data.int_value == 0)
-            {
-                // Don't free evalResult here as it might be shared - let normal cleanup handle it
-                break;
-            }
-
-            hex_item_t *act = hex_copy_item(ctx, action);
-            for (size_t i = 0; i < act->quotation_size; i++)
-            {
-                // Create a copy to avoid ownership issues
-                hex_item_t *copy = hex_copy_item(ctx, act->data.quotation_value[i]);
-                if (!copy || hex_push(ctx, copy) != 0)
-                {
-                    if (copy)
-                        hex_free_item(ctx, copy);
-                    HEX_FREE(ctx, act);
-                    HEX_FREE(ctx, action);
-                    HEX_FREE(ctx, condition);
-                    return 1;
-                }
-            }
-            HEX_FREE(ctx, act); // Free the temporary copy
+            result = hex_apply(ctx, action);
         }
     }
-
-    // Clean up after successful completion
     HEX_FREE(ctx, action);
-    HEX_FREE(ctx, condition);
-    return 0;
-}
-
-int hex_symbol_error(hex_context_t *ctx)
-{
-
-    char *message = strdup(ctx->error);
-    ctx->error[0] = '\0';
-    int result = hex_push_string(ctx, message);
-    free(message);
+    HEX_FREE(ctx, list);
     return result;
 }
 
-int hex_symbol_try(hex_context_t *ctx)
+// Keep the items of a list for which a quotation pushes a positive integer, compacting the list in place
+int hex_symbol_filter(hex_context_t *ctx)
 {
-    HEX_POP(ctx, catch_block);
-    if (catch_block->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, action);
+    HEX_POP(ctx, list);
+    if (list->type == HEX_TYPE_SEQUENCE)
     {
-        HEX_FREE(ctx, catch_block);
-        return 1;
+        return hex_seq_stage(ctx, HEX_SEQ_FILTER, list, action);
     }
-    HEX_POP(ctx, try_block);
-    if (try_block->type == HEX_TYPE_INVALID)
+    if (hex_edit_list(ctx, "filter", list, action) != 0)
     {
-        HEX_FREE(ctx, catch_block);
-        HEX_FREE(ctx, try_block);
         return 1;
     }
-
-    if (try_block->type != HEX_TYPE_QUOTATION || catch_block->type != HEX_TYPE_QUOTATION)
+    size_t kept = 0;
+    for (size_t i = 0; i < list->quotation_size; i++)
     {
-        hex_error(ctx, "[symbol try] Two quotations required");
-        HEX_FREE(ctx, catch_block);
-        HEX_FREE(ctx, try_block);
-        return 1;
+        hex_item_t *item = list->data.quotation_value[i];
+        list->data.quotation_value[i] = NULL;
+        hex_item_t *copy = hex_copy_item(ctx, item);
+        int top = ctx->stack->top;
+        if (!copy || hex_push_moved(ctx, copy) != 0 || hex_apply(ctx, action) != 0)
+        {
+            HEX_FREE(ctx, item);
+            HEX_FREE(ctx, action);
+            HEX_FREE(ctx, list);
+            return 1;
+        }
+        if (ctx->stack->top != top + 1 || ctx->stack->entries[ctx->stack->top]->type != HEX_TYPE_INTEGER)
+        {
+            hex_error(ctx, "[symbol filter] Quotation must push an integer for each item");
+            HEX_FREE(ctx, item);
+            HEX_FREE(ctx, action);
+            HEX_FREE(ctx, list);
+            return 1;
+        }
+        hex_item_t *condition = hex_pop(ctx);
+        if (condition->data.int_value > 0)
+        {
+            list->data.quotation_value[kept++] = item;
+        }
+        else
+        {
+            HEX_FREE(ctx, item);
+        }
+        HEX_FREE(ctx, condition);
     }
-    else
+    list->quotation_size = kept;
+    HEX_FREE(ctx, action);
+    if (HEX_PUSH(ctx, list) != 0)
     {
-        char prevError[256];
-        strncpy(prevError, ctx->error, sizeof(ctx->error));
-        ctx->error[0] = '\0';
+        HEX_FREE(ctx, list);
+        return 1;
+    }
+    return 0;
+}
 
-        ctx->settings->errors_enabled = 0;
-        for (size_t i = 0; i < try_block->quotation_size; i++)
+// Push an initial value, then each item of a list followed by a quotation combining it with the value
+int hex_symbol_fold(hex_context_t *ctx)
+{
+    HEX_POP(ctx, action);
+    HEX_POP(ctx, initial);
+    HEX_POP(ctx, list);
+    int result = hex_push_moved(ctx, initial);
+    if (list->type == HEX_TYPE_SEQUENCE)
+    {
+        hex_item_t *item = NULL;
+        while (result == 0 && (result = hex_seq_next(ctx, list->data.seq_value, &item)) > 0)
         {
-            hex_item_t *copy = hex_copy_item(ctx, try_block->data.quotation_value[i]);
-            if (!copy || hex_push(ctx, copy) != 0)
+            result = hex_push_moved(ctx, item);
+            if (result == 0)
             {
-                if (copy)
-                    hex_free_item(ctx, copy);
-                ctx->settings->errors_enabled = 1;
-                // continue to allow catch block to handle the error
+                result = hex_apply(ctx, action);
             }
         }
-        ctx->settings->errors_enabled = 1;
-
-        if (strcmp(ctx->error, "") != 0)
+        HEX_FREE(ctx, action);
+        HEX_FREE(ctx, list);
+        return result < 0 ? 1 : result;
+    }
+    for (size_t i = 0; i < list->quotation_size && result == 0; i++)
+    {
+        hex_item_t *item = hex_take_item(ctx, list, i);
+        result = item ? hex_push_moved(ctx, item) : 1;
+        if (result == 0)
         {
-            hex_debug(ctx, "[symbol try] Handling error: %s", ctx->error);
-            for (size_t i = 0; i < catch_block->quotation_size; i++)
-            {
-                hex_item_t *copy = hex_copy_item(ctx, catch_block->data.quotation_value[i]);
-                if (!copy || hex_push(ctx, copy) != 0)
-                {
-                    if (copy)
-                        hex_free_item(ctx, copy);
-                    HEX_FREE(ctx, catch_block);
-                    HEX_FREE(ctx, try_block);
-                    return 1;
-                }
-            }
+            result = hex_apply(ctx, action);
         }
-
-        strncpy(ctx->error, prevError, sizeof(ctx->error));
-        HEX_FREE(ctx, catch_block);
-        HEX_FREE(ctx, try_block);
     }
-    return 0;
+    HEX_FREE(ctx, action);
+    HEX_FREE(ctx, list);
+    return result;
 }
 
-int hex_symbol_throw(hex_context_t *ctx)
+// Push a quotation of the integers from the first one included to the second one excluded
+int hex_symbol_range(hex_context_t *ctx)
 {
-    HEX_POP(ctx, message);
-    ;
-    if (message->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, end);
+    HEX_POP(ctx, start);
+    int32_t first = start->data.int_value;
+    int32_t last = end->data.int_value;
+    HEX_FREE(ctx, start);
+    HEX_FREE(ctx, end);
+    size_t size = last > first ? (size_t)((int64_t)last - first) : 0;
+    hex_item_t **quotation = (hex_item_t **)malloc((size > 0 ? size : 1) * sizeof(hex_item_t *));
+    if (!quotation)
     {
-        HEX_FREE(ctx, message);
+        hex_error(ctx, "[symbol range] Memory allocation failed");
         return 1;
     }
-    if (message->type != HEX_TYPE_STRING)
+    for (size_t i = 0; i < size; i++)
     {
-        hex_error(ctx, "[symbol throw] String required");
-        HEX_FREE(ctx, message);
-        return 1;
+        quotation[i] = hex_integer_item(ctx, (int32_t)(first + (int64_t)i));
+        if (!quotation[i])
+        {
+            hex_free_list(ctx, quotation, i);
+            return 1;
+        }
     }
-    hex_error(ctx, message->data.str_value);
-    return 1;
+    return hex_push_quotation(ctx, quotation, size);
 }
 
-// Quotation symbols
-
-int hex_symbol_q(hex_context_t *ctx)
+// Decide whether item a must be placed after item b: returns 1 if it must, 0 if not, -1 on error.
+// Without a comparator, items are integers or strings (checked by the caller) in ascending order;
+// otherwise the comparator is applied to copies of both items and must push an integer.
+static int hex_sort_after(hex_context_t *ctx, const char *symbol, hex_item_t *a, hex_item_t *b, hex_item_t *comparator)
 {
-    HEX_POP(ctx, item);
-    if (item->type == HEX_TYPE_INVALID)
+    if (!comparator)
     {
-        HEX_FREE(ctx, item);
-        return 1;
+        if (a->type == HEX_TYPE_INTEGER)
+        {
+            return a->data.int_value > b->data.int_value;
+        }
+        return hex_compare_strings(a, b) > 0;
     }
-
-    // Deep copy the popped item to avoid aliasing its internal pointers.
-    hex_item_t *copy = hex_copy_item(ctx, item);
-    if (!copy)
+    int top = ctx->stack->top;
+    hex_item_t *copy_a = hex_copy_item(ctx, a);
+    if (!copy_a || hex_push(ctx, copy_a) != 0)
     {
-        hex_error(ctx, "[symbol '] Failed to copy item");
-        HEX_FREE(ctx, item);
-        return 1;
+        HEX_FREE(ctx, copy_a);
+        return -1;
     }
-
-    hex_item_t *result = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-    if (!result)
+    hex_item_t *copy_b = hex_copy_item(ctx, b);
+    if (!copy_b || hex_push(ctx, copy_b) != 0)
     {
-        hex_error(ctx, "[symbol '] Memory allocation failed");
-        HEX_FREE(ctx, item);
-        HEX_FREE(ctx, copy);
-        return 1;
+        HEX_FREE(ctx, copy_b);
+        return -1;
     }
-
-    result->type = HEX_TYPE_QUOTATION;
-    result->data.quotation_value = (hex_item_t **)calloc(1, sizeof(hex_item_t *));
-    if (!result->data.quotation_value)
+    if (hex_apply(ctx, comparator) != 0)
     {
-        hex_error(ctx, "[symbol '] Memory allocation failed");
-        HEX_FREE(ctx, item);
-        HEX_FREE(ctx, copy);
-        HEX_FREE(ctx, result);
-        return 1;
+        return -1;
     }
-
-    result->data.quotation_value[0] = copy;
-    result->quotation_size = 1;
-
-    // Original item no longer needed (we pushed a deep copy)
-    HEX_FREE(ctx, item);
-
-    if (HEX_PUSH(ctx, result) != 0)
+    if (ctx->stack->top != top + 1 || ctx->stack->entries[ctx->stack->top]->type != HEX_TYPE_INTEGER)
     {
-        HEX_FREE(ctx, result); // will free contained copy via list free
-        return 1;
+        hex_error(ctx, "[symbol %s] Quotation must push an integer for each pair of items", symbol);
+        return -1;
     }
-    return 0;
+    hex_item_t *result = hex_pop(ctx);
+    int after = result->data.int_value != 0;
+    HEX_FREE(ctx, result);
+    return after;
 }
 
-int hex_symbol_map(hex_context_t *ctx)
+// Sort items in place with a stable merge sort: runs of HEX_SORT_RUN items are sorted by
+// insertion, then merged pairwise, skipping merges of runs that are already in order.
+// Items are moved, never copied. Returns 0 on success, 1 on error.
+static int hex_sort_items(hex_context_t *ctx, const char *symbol, hex_item_t **items, size_t size, hex_item_t *comparator)
 {
-    HEX_POP(ctx, action);
-    ;
-    if (action->type == HEX_TYPE_INVALID)
+    for (size_t start = 0; start < size; start += HEX_SORT_RUN)
     {
-        HEX_FREE(ctx, action);
-        return 1;
+        size_t end = start + HEX_SORT_RUN < size ? start + HEX_SORT_RUN : size;
+        for (size_t i = start + 1; i < end; i++)
+        {
+            hex_item_t *item = items[i];
+            size_t j = i;
+            while (j > start)
+            {
+                int after = hex_sort_after(ctx, symbol, items[j - 1], item, comparator);
+                if (after < 0)
+                {
+                    items[j] = item;
+                    return 1;
+                }
+                if (!after)
+                {
+                    break;
+                }
+                items[j] = items[j - 1];
+                j--;
+            }
+            items[j] = item;
+        }
     }
-    HEX_POP(ctx, list);
-    ;
-    if (list->type == HEX_TYPE_INVALID)
+    if (size <= HEX_SORT_RUN)
     {
-        HEX_FREE(ctx, action);
-        HEX_FREE(ctx, list);
-        return 1;
+        return 0;
     }
-
-    if (list->type != HEX_TYPE_QUOTATION || action->type != HEX_TYPE_QUOTATION)
+    hex_item_t **buffer = (hex_item_t **)malloc(size * sizeof(hex_item_t *));
+    if (!buffer)
     {
-        hex_error(ctx, "[symbol map] Two quotations required");
-        HEX_FREE(ctx, action);
-        HEX_FREE(ctx, list);
+        hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
         return 1;
     }
-    else
+    for (size_t width = HEX_SORT_RUN; width < size; width *= 2)
     {
-        // Allocate result quotation (array of element pointers)
-        hex_item_t **quotation = (hex_item_t **)calloc(list->quotation_size, sizeof(hex_item_t *));
-        if (!quotation)
-        {
-            hex_error(ctx, "[symbol map] Memory allocation failed");
-            HEX_FREE(ctx, action);
-            HEX_FREE(ctx, list);
-            return 1;
-        }
-        for (size_t i = 0; i < list->quotation_size; i++)
+        for (size_t start = 0; start + width < size; start += 2 * width)
         {
-            // Push a deep copy of the list element to avoid aliasing
-            hex_item_t *elem_copy = hex_copy_item(ctx, list->data.quotation_value[i]);
-            if (!elem_copy || hex_push(ctx, elem_copy) != 0)
+            size_t mid = start + width;
+            size_t end = mid + width < size ? mid + width : size;
+            int after = hex_sort_after(ctx, symbol, items[mid - 1], items[mid], comparator);
+            if (after <= 0)
             {
-                if (elem_copy)
+                if (after < 0)
                 {
-                    hex_free_item(ctx, elem_copy);
+                    free(buffer);
+                    return 1;
                 }
-                HEX_FREE(ctx, action);
-                HEX_FREE(ctx, list);
-                hex_free_list(ctx, quotation, i);
-                return 1;
+                continue;
             }
-            // Execute action quotation: push deep copies of its elements
-            for (size_t j = 0; j < action->quotation_size; j++)
+            // Merge the left run (moved to the buffer) and the right run back into items
+            memcpy(buffer, items + start, width * sizeof(hex_item_t *));
+            size_t i = 0, j = mid, k = start;
+            while (i < width && j < end)
             {
-                hex_item_t *act_elem = hex_copy_item(ctx, action->data.quotation_value[j]);
-                if (!act_elem || hex_push(ctx, act_elem) != 0)
+                after = hex_sort_after(ctx, symbol, buffer[i], items[j], comparator);
+                if (after < 0)
                 {
-                    if (act_elem)
-                    {
-                        hex_free_item(ctx, act_elem);
-                    }
-                    HEX_FREE(ctx, action);
-                    HEX_FREE(ctx, list);
-                    hex_free_list(ctx, quotation, i);
+                    // Put the remaining items back so that none of them is lost
+                    memmove(items + k, buffer + i, (width - i) * sizeof(hex_item_t *));
+                    free(buffer);
                     return 1;
                 }
+                items[k++] = after ? items[j++] : buffer[i++];
             }
-            // Pop result of action execution, copy into result quotation, free temporary
-            hex_item_t *result_item = hex_pop(ctx);
-            quotation[i] = hex_copy_item(ctx, result_item);
-            HEX_FREE(ctx, result_item);
-            if (!quotation[i])
+            memcpy(items + k, buffer + i, (width - i) * sizeof(hex_item_t *));
+        }
+    }
+    free(buffer);
+    return 0;
+}
+
+static int hex_compare_integers(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *)a;
+    int32_t y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+int hex_symbol_sort(hex_context_t *ctx)
+{
+    HEX_POP(ctx, list);
+    if (list->type == HEX_TYPE_VECTOR)
+    {
+        qsort(list->data.vector_value, list->quotation_size, sizeof(int32_t), hex_compare_integers);
+    }
+    else
+    {
+        // All items must be integers, or all strings, so that comparing them cannot fail
+        for (size_t i = 0; i < list->quotation_size; i++)
+        {
+            hex_item_t *item = list->data.quotation_value[i];
+            if ((item->type != HEX_TYPE_INTEGER && item->type != HEX_TYPE_STRING) ||
+                item->type != list->data.quotation_value[0]->type)
             {
-                hex_error(ctx, "[symbol map] Failed to copy result item");
-                HEX_FREE(ctx, action);
+                hex_error(ctx, "[symbol sort] Quotation of integers or strings required");
                 HEX_FREE(ctx, list);
-                hex_free_list(ctx, quotation, i);
                 return 1;
             }
         }
-        if (hex_push_quotation(ctx, quotation, list->quotation_size) != 0)
+        if (hex_edit_list(ctx, "sort", list, NULL) != 0)
+        {
+            return 1;
+        }
+        if (hex_sort_items(ctx, "sort", list->data.quotation_value, list->quotation_size, NULL) != 0)
         {
-            HEX_FREE(ctx, action);
             HEX_FREE(ctx, list);
-            hex_free_list(ctx, quotation, list->quotation_size);
             return 1;
         }
-        // Free consumed inputs after success
-        HEX_FREE(ctx, action);
+    }
+    if (HEX_PUSH(ctx, list) != 0)
+    {
         HEX_FREE(ctx, list);
+        return 1;
     }
-
     return 0;
 }
 
-// Stack manipulation symbols
-int hex_symbol_swap(hex_context_t *ctx)
+int hex_symbol_sortby(hex_context_t *ctx)
 {
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, comparator);
+    HEX_POP(ctx, list);
+    if (hex_edit_list(ctx, "sortby", list, comparator) != 0)
     {
-        HEX_FREE(ctx, a);
         return 1;
     }
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
+    int result = hex_sort_items(ctx, "sortby", list->data.quotation_value, list->quotation_size, comparator);
+    HEX_FREE(ctx, comparator);
+    if (result == 0 && HEX_PUSH(ctx, list) == 0)
     {
-        HEX_FREE(ctx, b);
-        HEX_FREE(ctx, a);
-        return 1;
+        return 0;
     }
+    HEX_FREE(ctx, list);
+    return 1;
+}
+
+// Stack manipulation symbols
+int hex_symbol_swap(hex_context_t *ctx)
+{
+    HEX_POP(ctx, a);
+    HEX_POP(ctx, b);
     if (HEX_PUSH(ctx, a) != 0)
     {
         HEX_FREE(ctx, a);
@@ -6811,12 +11154,6 @@ int hex_symbol_swap(hex_context_t *ctx)
 int hex_symbol_dup(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
     hex_item_t *copy = hex_copy_item(ctx, item);
     if (!copy)
     {
@@ -6876,10 +11213,7 @@ int hex_symbol_stack(hex_context_t *ctx)
 int hex_symbol_drop(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    if (item != NULL)
-    {
-        HEX_FREE(ctx, item);
-    }
+    HEX_FREE(ctx, item);
     return 0;
 }
 
@@ -6908,72 +11242,123 @@ int hex_symbol_timestamp(hex_context_t *ctx)
 // Native Symbol Registration         //
 ////////////////////////////////////////
 
+// Signatures of all native symbols. The dispatcher checks the stack depth and
+// the operand types before calling a native, so natives can pop their
+// operands without validating them again.
+static const hex_native_t hex_natives[] = {
+    {":", hex_symbol_store, 2, {HEX_ARG_ANY, HEX_ARG_STRING}, {NULL, "Symbol name must be a string"}},
+    {"::", hex_symbol_define, 2, {HEX_ARG_ANY, HEX_ARG_STRING}, {NULL, "Symbol name must be a string"}},
+    {"#", hex_symbol_free, 1, {HEX_ARG_STRING}, {"Symbol name must be a string"}},
+    {"symbols", hex_symbol_symbols, 0, {0}, {NULL}},
+    {"type", hex_symbol_type, 1, {HEX_ARG_ANY}, {NULL}},
+    {".", hex_symbol_i, 1, {HEX_ARG_QUOTATION}, {"Quotation required"}},
+    {"!", hex_symbol_eval, 2, {HEX_ARG_STRING | HEX_ARG_QUOTATION | HEX_ARG_BUFFER, HEX_ARG_STRING}, {"String, buffer or a quotation of integers required", "File name or scope identifier required"}},
+    {"puts", hex_symbol_puts, 1, {HEX_ARG_ANY}, {NULL}},
+    {"warn", hex_symbol_warn, 1, {HEX_ARG_ANY}, {NULL}},
+    {"print", hex_symbol_print, 1, {HEX_ARG_ANY}, {NULL}},
+    {"gets", hex_symbol_gets, 0, {0}, {NULL}},
+    {"+", hex_symbol_add, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"-", hex_symbol_subtract, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"*", hex_symbol_multiply, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"/", hex_symbol_divide, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"%", hex_symbol_modulo, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"&", hex_symbol_bitand, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"|", hex_symbol_bitor, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"^", hex_symbol_bitxor, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"~", hex_symbol_bitnot, 1, {HEX_ARG_INTEGER}, {"Integer required"}},
+    {"<<", hex_symbol_shiftleft, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {">>", hex_symbol_shiftright, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"int", hex_symbol_int, 1, {HEX_ARG_STRING}, {"String representing a hexadecimal integer required"}},
+    {"str", hex_symbol_str, 1, {HEX_ARG_INTEGER}, {"Integer required"}},
+    {"dec", hex_symbol_dec, 1, {HEX_ARG_INTEGER}, {"Integer required"}},
+    {"hex", hex_symbol_hex, 1, {HEX_ARG_STRING}, {"String representing a decimal integer required"}},
+    {"ints", hex_symbol_ints, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"chr", hex_symbol_chr, 1, {HEX_ARG_INTEGER}, {"Integer required"}},
+    {"ord", hex_symbol_ord, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"==", hex_symbol_equal, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {"!=", hex_symbol_notequal, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {">", hex_symbol_greater, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {"<", hex_symbol_less, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {">=", hex_symbol_greaterequal, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {"<=", hex_symbol_lessequal, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {"and", hex_symbol_and, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"or", hex_symbol_or, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"not", hex_symbol_not, 1, {HEX_ARG_INTEGER}, {"Integer required"}},
+    {"xor", hex_symbol_xor, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"cat", hex_symbol_cat, 2, {HEX_ARG_QUOTATION | HEX_ARG_STRING | HEX_ARG_BUFFER | HEX_ARG_VECTOR, HEX_ARG_QUOTATION | HEX_ARG_STRING | HEX_ARG_BUFFER | HEX_ARG_VECTOR}, {"Two quotations or two strings required", "Two quotations or two strings required"}},
+    {"len", hex_symbol_len, 1, {HEX_ARG_QUOTATION | HEX_ARG_STRING | HEX_ARG_BUFFER | HEX_ARG_VECTOR | HEX_ARG_DICTIONARY}, {"Quotation or string required"}},
+    {"get", hex_symbol_get, 2, {HEX_ARG_QUOTATION | HEX_ARG_STRING | HEX_ARG_BUFFER | HEX_ARG_VECTOR | HEX_ARG_DICTIONARY, HEX_ARG_INTEGER | HEX_ARG_STRING}, {"Quotation or string required", "Index must be an integer"}},
+    {"push", hex_symbol_push, 2, {HEX_ARG_QUOTATION, HEX_ARG_ANY}, {"Quotation required", NULL}},
+    {"pop", hex_symbol_pop, 1, {HEX_ARG_QUOTATION}, {"Quotation required"}},
+    {"ins", hex_symbol_ins, 3, {HEX_ARG_QUOTATION, HEX_ARG_ANY, HEX_ARG_INTEGER}, {"Quotation required", NULL, "Index must be an integer"}},
+    {"rem", hex_symbol_rem, 2, {HEX_ARG_QUOTATION, HEX_ARG_INTEGER}, {"Quotation required", "Index must be an integer"}},
+    {"set", hex_symbol_set, 3, {HEX_ARG_QUOTATION, HEX_ARG_ANY, HEX_ARG_INTEGER}, {"Quotation required", NULL, "Index must be an integer"}},
+    {"reverse", hex_symbol_reverse, 1, {HEX_ARG_QUOTATION}, {"Quotation required"}},
+    {"uncons", hex_symbol_uncons, 1, {HEX_ARG_QUOTATION}, {"Quotation required"}},
+    {"swons", hex_symbol_swons, 2, {HEX_ARG_QUOTATION, HEX_ARG_ANY}, {"Quotation required", NULL}},
+    {"index", hex_symbol_index, 2, {HEX_ARG_QUOTATION | HEX_ARG_STRING | HEX_ARG_BUFFER | HEX_ARG_VECTOR, HEX_ARG_ANY}, {"Quotation or string required", NULL}},
+    {"join", hex_symbol_join, 2, {HEX_ARG_QUOTATION, HEX_ARG_STRING}, {"Quotation and string required", "Quotation and string required"}},
+    {"split", hex_symbol_split, 2, {HEX_ARG_STRING, HEX_ARG_STRING}, {"Two strings required", "Two strings required"}},
+    {"sub", hex_symbol_sub, 3, {HEX_ARG_STRING | HEX_ARG_BUFFER, HEX_ARG_STRING | HEX_ARG_INTEGER, HEX_ARG_STRING | HEX_ARG_INTEGER}, {"String or buffer required", "String or integer required", "String or integer required"}},
+    {"gsub", hex_symbol_gsub, 3, {HEX_ARG_STRING, HEX_ARG_STRING, HEX_ARG_STRING}, {"Three strings required", "Three strings required", "Three strings required"}},
+    {"fmt", hex_symbol_fmt, 2, {HEX_ARG_STRING, HEX_ARG_QUOTATION}, {"String and quotation required", "String and quotation required"}},
+    {"begins", hex_symbol_begins, 2, {HEX_ARG_STRING, HEX_ARG_STRING}, {"Two strings required", "Two strings required"}},
+    {"ends", hex_symbol_ends, 2, {HEX_ARG_STRING, HEX_ARG_STRING}, {"Two strings required", "Two strings required"}},
+    {"vec", hex_symbol_vec, 1, {HEX_ARG_QUOTATION | HEX_ARG_BUFFER | HEX_ARG_VECTOR}, {"Quotation of integers or buffer required"}},
+    {"sum", hex_symbol_sum, 1, {HEX_ARG_QUOTATION | HEX_ARG_VECTOR}, {"Vector or quotation of integers required"}},
+    {"min", hex_symbol_min, 1, {HEX_ARG_QUOTATION | HEX_ARG_VECTOR}, {"Vector or quotation required"}},
+    {"max", hex_symbol_max, 1, {HEX_ARG_QUOTATION | HEX_ARG_VECTOR}, {"Vector or quotation required"}},
+    {"dict", hex_symbol_dict, 1, {HEX_ARG_QUOTATION}, {"Quotation required"}},
+    {"put", hex_symbol_put, 3, {HEX_ARG_DICTIONARY, HEX_ARG_INTEGER | HEX_ARG_STRING, HEX_ARG_ANY}, {"Dictionary required", "Key must be a string or an integer", NULL}},
+    {"has", hex_symbol_has, 2, {HEX_ARG_DICTIONARY, HEX_ARG_INTEGER | HEX_ARG_STRING}, {"Dictionary required", "Key must be a string or an integer"}},
+    {"del", hex_symbol_del, 2, {HEX_ARG_DICTIONARY, HEX_ARG_INTEGER | HEX_ARG_STRING}, {"Dictionary required", "Key must be a string or an integer"}},
+    {"keys", hex_symbol_keys, 1, {HEX_ARG_DICTIONARY}, {"Dictionary required"}},
+    {"seq", hex_symbol_seq, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"lines", hex_symbol_lines, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"pieces", hex_symbol_pieces, 2, {HEX_ARG_STRING, HEX_ARG_STRING}, {"Two strings required", "Two strings required"}},
+    {"take", hex_symbol_take, 2, {HEX_ARG_SEQUENCE, HEX_ARG_INTEGER}, {"Sequence required", "Integer required"}},
+    {"read", hex_symbol_read, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"write", hex_symbol_write, 2, {HEX_ARG_STRING | HEX_ARG_QUOTATION | HEX_ARG_BUFFER | HEX_ARG_VECTOR, HEX_ARG_STRING | HEX_ARG_INTEGER}, {"String or quotation of integers required", "String or file handle required"}},
+    {"append", hex_symbol_append, 2, {HEX_ARG_STRING | HEX_ARG_QUOTATION | HEX_ARG_BUFFER | HEX_ARG_VECTOR, HEX_ARG_STRING}, {"String or quotation of integers required", "String required"}},
+    {"open", hex_symbol_open, 2, {HEX_ARG_STRING, HEX_ARG_STRING}, {"Two strings required", "Two strings required"}},
+    {"close", hex_symbol_close, 1, {HEX_ARG_INTEGER}, {"File handle required"}},
+    {"flush", hex_symbol_flush, 1, {HEX_ARG_INTEGER}, {"File handle required"}},
+    {"readl", hex_symbol_readl, 1, {HEX_ARG_INTEGER}, {"File handle required"}},
+    {"readb", hex_symbol_readb, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"File handle required", "Integer required"}},
+    {"eof", hex_symbol_eof, 1, {HEX_ARG_INTEGER}, {"File handle required"}},
+    {"args", hex_symbol_args, 0, {0}, {NULL}},
+    {"exit", hex_symbol_exit, 1, {HEX_ARG_INTEGER}, {"Integer required"}},
+    {"exec", hex_symbol_exec, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"run", hex_symbol_run, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"if", hex_symbol_if, 3, {HEX_ARG_QUOTATION, HEX_ARG_QUOTATION, HEX_ARG_QUOTATION}, {"Three quotations required", "Three quotations required", "Three quotations required"}},
+    {"while", hex_symbol_while, 2, {HEX_ARG_QUOTATION, HEX_ARG_QUOTATION}, {"Two quotations required", "Two quotations required"}},
+    {"times", hex_symbol_times, 2, {HEX_ARG_QUOTATION, HEX_ARG_INTEGER}, {"Quotation and integer required", "Quotation and integer required"}},
+    {"memo", hex_symbol_memo, 2, {HEX_ARG_QUOTATION, HEX_ARG_INTEGER}, {"Quotation and integer required", "Quotation and integer required"}},
+    {"memostats", hex_symbol_memostats, 0, {0}, {NULL}},
+    {"error", hex_symbol_error, 0, {0}, {NULL}},
+    {"try", hex_symbol_try, 2, {HEX_ARG_QUOTATION, HEX_ARG_QUOTATION}, {"Two quotations required", "Two quotations required"}},
+    {"throw", hex_symbol_throw, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"'", hex_symbol_q, 1, {HEX_ARG_ANY}, {NULL}},
+    {"map", hex_symbol_map, 2, {HEX_ARG_QUOTATION | HEX_ARG_VECTOR | HEX_ARG_SEQUENCE, HEX_ARG_QUOTATION}, {"Two quotations required", "Two quotations required"}},
+    {"each", hex_symbol_each, 2, {HEX_ARG_QUOTATION | HEX_ARG_SEQUENCE, HEX_ARG_QUOTATION}, {"Two quotations required", "Two quotations required"}},
+    {"filter", hex_symbol_filter, 2, {HEX_ARG_QUOTATION | HEX_ARG_SEQUENCE, HEX_ARG_QUOTATION}, {"Two quotations required", "Two quotations required"}},
+    {"fold", hex_symbol_fold, 3, {HEX_ARG_QUOTATION | HEX_ARG_SEQUENCE, HEX_ARG_ANY, HEX_ARG_QUOTATION}, {"Quotation required", NULL, "Quotation required"}},
+    {"range", hex_symbol_range, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"sort", hex_symbol_sort, 1, {HEX_ARG_QUOTATION | HEX_ARG_VECTOR}, {"Quotation or vector required"}},
+    {"sortby", hex_symbol_sortby, 2, {HEX_ARG_QUOTATION, HEX_ARG_QUOTATION}, {"Two quotations required", "Two quotations required"}},
+    {"swap", hex_symbol_swap, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {"dup", hex_symbol_dup, 1, {HEX_ARG_ANY}, {NULL}},
+    {"stack", hex_symbol_stack, 0, {0}, {NULL}},
+    {"drop", hex_symbol_drop, 1, {HEX_ARG_ANY}, {NULL}},
+    {"timestamp", hex_symbol_timestamp, 0, {0}, {NULL}},
+};
+
 void hex_register_symbols(hex_context_t *ctx)
 {
-    hex_set_native_symbol(ctx, ":", hex_symbol_store);
-    hex_set_native_symbol(ctx, "::", hex_symbol_define);
-    hex_set_native_symbol(ctx, "#", hex_symbol_free);
-    hex_set_native_symbol(ctx, "symbols", hex_symbol_symbols);
-    hex_set_native_symbol(ctx, "type", hex_symbol_type);
-    hex_set_native_symbol(ctx, ".", hex_symbol_i);
-    hex_set_native_symbol(ctx, "!", hex_symbol_eval);
-    hex_set_native_symbol(ctx, "puts", hex_symbol_puts);
-    hex_set_native_symbol(ctx, "warn", hex_symbol_warn);
-    hex_set_native_symbol(ctx, "print", hex_symbol_print);
-    hex_set_native_symbol(ctx, "gets", hex_symbol_gets);
-    hex_set_native_symbol(ctx, "+", hex_symbol_add);
-    hex_set_native_symbol(ctx, "-", hex_symbol_subtract);
-    hex_set_native_symbol(ctx, "*", hex_symbol_multiply);
-    hex_set_native_symbol(ctx, "/", hex_symbol_divide);
-    hex_set_native_symbol(ctx, "%", hex_symbol_modulo);
-    hex_set_native_symbol(ctx, "&", hex_symbol_bitand);
-    hex_set_native_symbol(ctx, "|", hex_symbol_bitor);
-    hex_set_native_symbol(ctx, "^", hex_symbol_bitxor);
-    hex_set_native_symbol(ctx, "~", hex_symbol_bitnot);
-    hex_set_native_symbol(ctx, "<<", hex_symbol_shiftleft);
-    hex_set_native_symbol(ctx, ">>", hex_symbol_shiftright);
-    hex_set_native_symbol(ctx, "int", hex_symbol_int);
-    hex_set_native_symbol(ctx, "str", hex_symbol_str);
-    hex_set_native_symbol(ctx, "dec", hex_symbol_dec);
-    hex_set_native_symbol(ctx, "hex", hex_symbol_hex);
-    hex_set_native_symbol(ctx, "chr", hex_symbol_chr);
-    hex_set_native_symbol(ctx, "ord", hex_symbol_ord);
-    hex_set_native_symbol(ctx, "==", hex_symbol_equal);
-    hex_set_native_symbol(ctx, "!=", hex_symbol_notequal);
-    hex_set_native_symbol(ctx, ">", hex_symbol_greater);
-    hex_set_native_symbol(ctx, "<", hex_symbol_less);
-    hex_set_native_symbol(ctx, ">=", hex_symbol_greaterequal);
-    hex_set_native_symbol(ctx, "<=", hex_symbol_lessequal);
-    hex_set_native_symbol(ctx, "and", hex_symbol_and);
-    hex_set_native_symbol(ctx, "or", hex_symbol_or);
-    hex_set_native_symbol(ctx, "not", hex_symbol_not);
-    hex_set_native_symbol(ctx, "xor", hex_symbol_xor);
-    hex_set_native_symbol(ctx, "cat", hex_symbol_cat);
-    hex_set_native_symbol(ctx, "len", hex_symbol_len);
-    hex_set_native_symbol(ctx, "get", hex_symbol_get);
-    hex_set_native_symbol(ctx, "index", hex_symbol_index);
-    hex_set_native_symbol(ctx, "join", hex_symbol_join);
-    hex_set_native_symbol(ctx, "split", hex_symbol_split);
-    hex_set_native_symbol(ctx, "sub", hex_symbol_sub);
-    hex_set_native_symbol(ctx, "read", hex_symbol_read);
-    hex_set_native_symbol(ctx, "write", hex_symbol_write);
-    hex_set_native_symbol(ctx, "append", hex_symbol_append);
-    hex_set_native_symbol(ctx, "args", hex_symbol_args);
-    hex_set_native_symbol(ctx, "exit", hex_symbol_exit);
-    hex_set_native_symbol(ctx, "exec", hex_symbol_exec);
-    hex_set_native_symbol(ctx, "run", hex_symbol_run);
-    hex_set_native_symbol(ctx, "if", hex_symbol_if);
-    hex_set_native_symbol(ctx, "while", hex_symbol_while);
-    hex_set_native_symbol(ctx, "error", hex_symbol_error);
-    hex_set_native_symbol(ctx, "try", hex_symbol_try);
-    hex_set_native_symbol(ctx, "throw", hex_symbol_throw);
-    hex_set_native_symbol(ctx, "'", hex_symbol_q);
-    hex_set_native_symbol(ctx, "map", hex_symbol_map);
-    hex_set_native_symbol(ctx, "swap", hex_symbol_swap);
-    hex_set_native_symbol(ctx, "dup", hex_symbol_dup);
-    hex_set_native_symbol(ctx, "stack", hex_symbol_stack);
-    hex_set_native_symbol(ctx, "drop", hex_symbol_drop);
-    hex_set_native_symbol(ctx, "timestamp", hex_symbol_timestamp);
+    for (size_t i = 0; i < sizeof(hex_natives) / sizeof(hex_natives[0]); i++)
+    {
+        hex_set_native_symbol(ctx, &hex_natives[i]);
+    }
 }
 
 /* File: src/main.c */
@@ -7087,6 +11472,7 @@ static void prompt()
 static void do_repl(void *v_ctx)
 {
     hex_context_t *ctx = (hex_context_t *)v_ctx;
+    hex_flush_output(ctx);
     prompt();
     char line[HEX_STDIN_BUFFER_SIZE];
     char *p = line;
@@ -7104,10 +11490,10 @@ static void do_repl(void *v_ctx)
     // Print the top item of the stack
     if (ctx->stack->top >= 0)
     {
-        hex_print_item(stdout, ctx->stack->entries[ctx->stack->top]);
-        // hex_print_item(stdout, HEX_STACK[HEX_TOP]);
-        printf("\n");
+        hex_output_item(&ctx->out, ctx->stack->entries[ctx->stack->top], 0);
+        hex_output_char(&ctx->out, '\n');
     }
+    hex_flush_output(ctx);
     return;
 }
 
@@ -7117,9 +11503,11 @@ static int do_repl(void *v_ctx)
 {
     hex_context_t *ctx = (hex_context_t *)v_ctx;
     char line[1024];
+    hex_check_interrupt(ctx);
     prompt();
     if (fgets(line, sizeof(line), stdin) == NULL)
     {
+        hex_check_interrupt(ctx);
         printf("\n"); // Handle EOF (Ctrl+D)
         return 1;
     }
@@ -7131,8 +11519,8 @@ static int do_repl(void *v_ctx)
     // Print the top item of the stack
     if (ctx->stack->top >= 0)
     {
-        hex_print_item(stdout, ctx->stack->entries[ctx->stack->top]);
-        printf("\n");
+        hex_output_item(&ctx->out, ctx->stack->entries[ctx->stack->top], 0);
+        hex_output_char(&ctx->out, '\n');
     }
     return 0;
 }
@@ -7167,9 +11555,24 @@ void hex_repl(hex_context_t *ctx)
 #endif
 }
 
+volatile sig_atomic_t hex_interrupted = 0;
+
 void hex_handle_sigint(int sig)
 {
     (void)sig; // Suppress unused warning
+    // Outputs cannot be flushed safely here: the interpreter exits at its next push,
+    // and the REPL once the read of its input is interrupted
+    hex_interrupted = 1;
+}
+
+// Exit if Ctrl+C was pressed, flushing the buffered outputs of the context first
+void hex_check_interrupt(hex_context_t *ctx)
+{
+    if (!hex_interrupted)
+    {
+        return;
+    }
+    hex_flush_output(ctx);
     printf("\n");
     exit(0);
 }
@@ -7228,7 +11631,7 @@ void hex_print_docs(hex_doc_dictionary_t *docs)
            "  hex is a minimalist, slightly-esoteric, concatenative programming language that supports\n"
            "  only integers, strings, symbols, and quotations (lists).\n"
            "\n"
-           "  It uses a stack-based execution model and provides 64 native symbols for stack\n"
+           "  It uses a stack-based execution model and provides 105 native symbols for stack\n"
            "  manipulation, arithmetic operations, control flow, reading and writing\n"
            "  (standard input/output/error and files), executing external processes, and more.\n"
            "\n"
@@ -7328,7 +11731,16 @@ int hex_interpret_file(hex_context_t *ctx, const char *file)
 int main(int argc, char *argv[])
 {
     // Register SIGINT (Ctrl+C) signal handler
+#ifdef _WIN32
     signal(SIGINT, hex_handle_sigint);
+#else
+    // Without SA_RESTART, so that a blocking read of the REPL returns when it is interrupted
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = hex_handle_sigint;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+#endif
 
     // Initialize the context
     hex_context_t *ctx = hex_init();
@@ -14,9 +14,11 @@
 #include <windows.h>
 #include <io.h>
 int isatty(int fd);
+#define HEX_GETC(file) _getc_nolock(file)
 #else
 #include <unistd.h>
 #include <sys/wait.h>
+#define HEX_GETC(file) getc_unlocked(file) // Streams are only used by the interpreter thread
 #endif
 
 // Constants
@@ -26,8 +28,25 @@ int isatty(int fd);
 #define HEX_REGISTRY_SIZE 4096
 #define HEX_STACK_SIZE 256
 #define HEX_STACK_TRACE_SIZE 16
-#define HEX_NATIVE_SYMBOLS 64
+#define HEX_NATIVE_SYMBOLS 128
 #define HEX_MAX_SYMBOL_LENGTH 256
+#define HEX_ERROR_SIZE 256
+#define HEX_MAX_ERROR_ARGS 8
+#define HEX_MAX_NATIVE_ARITY 3
+#define HEX_EVAL_CACHE_SIZE 64
+#define HEX_KERNEL_DEPTH 8
+#define HEX_KERNEL_BLOCK 256
+#define HEX_DICT_INITIAL_SLOTS 8
+#define HEX_SORT_RUN 16
+#define HEX_INDEX_MIN_SIZE 32 // Quotations with fewer items are always scanned by index
+#define HEX_INDEX_LOOKUPS 4   // Lookups in the same quotation items before they are indexed
+#define HEX_MAX_OPEN_FILES 64
+#define HEX_FILE_BUFFER_SIZE 65536
+#define HEX_READ_CHUNK 65536 // Bytes read at a time by readb, which grows its buffer as they arrive
+#define HEX_OUTPUT_BUFFER_SIZE 8192
+#define HEX_MEMO_SIZE 4096    // Results kept by memo, beyond which the least recently used one is evicted
+#define HEX_MEMO_BUCKETS 8192 // Buckets of the memo table, a power of 2
+#define HEX_INTEGER_TEXT_SIZE 12 // "-2147483648", or "$" and 8 hexadecimal digits, and a terminator
 #define HEX_MAX_USER_SYMBOLS (HEX_REGISTRY_SIZE - HEX_NATIVE_SYMBOLS)
 
 // Type Definitions
@@ -36,11 +55,25 @@ typedef enum hex_item_type_t
     HEX_TYPE_INTEGER,
     HEX_TYPE_STRING,
     HEX_TYPE_QUOTATION,
+    HEX_TYPE_BUFFER,
+    HEX_TYPE_VECTOR,
+    HEX_TYPE_DICTIONARY,
+    HEX_TYPE_SEQUENCE,
     HEX_TYPE_NATIVE_SYMBOL,
     HEX_TYPE_USER_SYMBOL,
     HEX_TYPE_INVALID
 } hex_item_type_t;
 
+// Type masks used in native symbol signatures
+#define HEX_ARG_INTEGER (1 << HEX_TYPE_INTEGER)
+#define HEX_ARG_STRING (1 << HEX_TYPE_STRING)
+#define HEX_ARG_QUOTATION (1 << HEX_TYPE_QUOTATION)
+#define HEX_ARG_BUFFER (1 << HEX_TYPE_BUFFER)
+#define HEX_ARG_VECTOR (1 << HEX_TYPE_VECTOR)
+#define HEX_ARG_DICTIONARY (1 << HEX_TYPE_DICTIONARY)
+#define HEX_ARG_SEQUENCE (1 << HEX_TYPE_SEQUENCE)
+#define HEX_ARG_ANY (HEX_ARG_INTEGER | HEX_ARG_STRING | HEX_ARG_QUOTATION | HEX_ARG_BUFFER | HEX_ARG_VECTOR | HEX_ARG_DICTIONARY | HEX_ARG_SEQUENCE)
+
 typedef enum hex_token_type_t
 {
     HEX_TOKEN_INTEGER,
@@ -69,6 +102,35 @@ typedef struct hex_token_t
 
 typedef struct hex_context_t hex_context_t;
 
+// Native symbol signature, checked by the dispatcher before the native is called.
+// Operands are listed from the deepest to the topmost stack item.
+typedef struct hex_native_t
+{
+    const char *name;
+    int (*fn)(hex_context_t *);
+    int arity;
+    int types[HEX_MAX_NATIVE_ARITY];          // Accepted types of each operand (HEX_ARG_* masks)
+    const char *errors[HEX_MAX_NATIVE_ARITY]; // Error raised if an operand does not match its mask
+} hex_native_t;
+
+// Copies of a quotation item share its items, which are copied before being
+// modified if they have other references. The structural hash of the items is
+// cached with them, and so is a hash index of the items once they are looked up
+// repeatedly. Copies of a string item share its bytes the same way, except that a
+// string may append to them in place if it ends where they are used up and its
+// other references are held by the registry: those only see a prefix of the bytes,
+// and are copied again when read (see hex_copy_item).
+typedef struct hex_share_t
+{
+    int refs;           // References held by quotation or string items
+    int stored;         // References held by registry values (strings only)
+    size_t used;        // Bytes written before the terminator (strings only)
+    size_t hash;        // Structural hash of the items, 0 if not computed yet
+    size_t lookups;     // Lookups in the items so far
+    size_t *index;      // Position of an item plus one, 0 for an empty slot; NULL if not built yet
+    size_t index_slots; // Slots of the index, a power of 2
+} hex_share_t;
+
 typedef struct hex_item_t
 {
     hex_item_type_t type;
@@ -76,14 +138,70 @@ typedef struct hex_item_t
     {
         int32_t int_value;
         char *str_value;
-        int (*fn_value)(hex_context_t *);
+        uint8_t *buffer_value;
+        int32_t *vector_value;
+        struct hex_dict_t *dict_value;
+        struct hex_seq_t *seq_value;
+        const hex_native_t *native_value;
         struct hex_item_t **quotation_value;
     } data;
     int is_operator;
     hex_token_t *token;    // Token containing stack information (valid for HEX_TYPE_NATIVE_SYMBOL and HEX_TYPE_USER_SYMBOL)
-    size_t quotation_size; // Size of the quotation (valid for HEX_TYPE_QUOTATION)
+    size_t quotation_size; // Number of items (valid for HEX_TYPE_QUOTATION and HEX_TYPE_VECTOR)
+    size_t quotation_capacity; // Items allocated, if more than quotation_size (valid for HEX_TYPE_QUOTATION)
+    size_t str_size;       // Length in bytes, without the terminator of strings (valid for HEX_TYPE_STRING and HEX_TYPE_BUFFER)
+    size_t str_capacity;   // Bytes allocated, if more than str_size + 1 (valid for HEX_TYPE_STRING and HEX_TYPE_BUFFER)
+    hex_share_t *share;    // Shared state of the items, NULL if not shared yet (valid for HEX_TYPE_QUOTATION and HEX_TYPE_STRING)
+    size_t hash;           // Structural hash, 0 if not computed yet (valid for HEX_TYPE_STRING, HEX_TYPE_BUFFER and HEX_TYPE_VECTOR)
 } hex_item_t;
 
+// Entry of a dictionary
+typedef struct hex_dict_entry_t
+{
+    size_t hash;
+    hex_item_t *key; // NULL if the entry was deleted
+    hex_item_t *value;
+} hex_dict_entry_t;
+
+// Dictionaries keep their entries in insertion order, and find them through an
+// open addressing table of entry indexes. Copies of a dictionary item share the
+// dictionary, which is copied before being modified if it has other references.
+typedef struct hex_dict_t
+{
+    int refs; // References held by dictionary items
+    hex_dict_entry_t *entries;
+    size_t count;      // Entries used, including deleted ones
+    size_t capacity;   // Entries allocated
+    size_t size;       // Entries not deleted
+    size_t *slots;     // Index of an entry plus one, 0 for an empty slot
+    size_t slot_count; // Number of slots, a power of two
+} hex_dict_t;
+
+typedef enum hex_seq_kind_t
+{
+    HEX_SEQ_RANGE,  // Integers from current to end (excluded)
+    HEX_SEQ_LINES,  // Lines of a file
+    HEX_SEQ_PIECES, // Pieces of a string split by a separator
+    HEX_SEQ_MAP,    // Items of a source sequence with a quotation applied to them
+    HEX_SEQ_FILTER  // Items of a source sequence for which a quotation pushes a positive integer
+} hex_seq_kind_t;
+
+// Sequences produce their items one at a time, when they are consumed. Copies of a
+// sequence item share the sequence, and so its position: a sequence is consumed once.
+typedef struct hex_seq_t
+{
+    int refs; // References held by sequence items
+    hex_seq_kind_t kind;
+    int32_t current;          // Next integer (HEX_SEQ_RANGE)
+    int32_t end;              // First integer excluded (HEX_SEQ_RANGE)
+    FILE *file;               // File being read, NULL once closed (HEX_SEQ_LINES)
+    hex_item_t *string;       // String being split (HEX_SEQ_PIECES)
+    hex_item_t *separator;    // Separator (HEX_SEQ_PIECES)
+    size_t position;          // Start of the next piece (HEX_SEQ_PIECES)
+    struct hex_seq_t *source; // Source sequence (HEX_SEQ_MAP and HEX_SEQ_FILTER)
+    hex_item_t *action;       // Quotation applied to each item (HEX_SEQ_MAP and HEX_SEQ_FILTER)
+} hex_seq_t;
+
 typedef struct hex_stack_trace_t
 {
     hex_token_t **entries;
@@ -131,14 +249,110 @@ typedef struct hex_settings_t
     int debugging_enabled;
     int errors_enabled;
     int stack_trace_enabled;
+    int hash_consing_enabled; // Share the items of identical quotation literals decoded from bytecode
 } hex_settings_t;
 
+typedef struct hex_error_arg_t
+{
+    char conversion; // printf conversion character (d, i, u, x, c or s)
+    char modifier;   // Length modifier (l, z or 0)
+    union
+    {
+        long long_value;
+        size_t size_value;
+        size_t string_offset; // Offset of the captured string in hex_deferred_error_t.strings
+    } value;
+} hex_error_arg_t;
+
+// Error raised while a try frame is active: arguments are captured and the
+// message is only formatted if it is actually read.
+typedef struct hex_deferred_error_t
+{
+    const char *format; // NULL when no error is pending
+    hex_error_arg_t args[HEX_MAX_ERROR_ARGS];
+    size_t count;
+    char strings[HEX_ERROR_SIZE];
+    size_t strings_size;
+} hex_deferred_error_t;
+
+// Handler stack entry, allocated on the C stack by the try symbol
+typedef struct hex_try_frame_t
+{
+    struct hex_try_frame_t *previous;
+    int has_error;                      // Whether an error was set when the frame was entered
+    char error[HEX_ERROR_SIZE];         // Formatted error saved on entry (if any)
+    hex_deferred_error_t pending_error; // Deferred error saved on entry (if any)
+} hex_try_frame_t;
+
 typedef struct hex_symbol_table_t
 {
-    char **symbols;
-    uint16_t count;
+    char **symbols;                    // Symbols added on top of the parent
+    size_t capacity;                   // Allocated slots in symbols
+    uint16_t base;                     // Indexes below base belong to the parent
+    uint16_t count;                    // Total number of visible symbols
+    struct hex_symbol_table_t *parent; // Table this one is an overlay of (if any)
 } hex_symbol_table_t;
 
+// Program evaluated by !, parsed or decoded once and kept in the eval cache
+typedef struct hex_compiled_t
+{
+    int refs;     // References held by the cache and by running evaluations
+    size_t hash;  // Hash of the code and of the scope name
+    int bytecode; // Whether the code is a bytecode image
+    char *scope;
+    uint8_t *code;
+    size_t code_size;
+    hex_item_t **items; // Items pushed when the program is run
+    size_t count;
+} hex_compiled_t;
+
+// Step of a quotation compiled by map into a kernel over blocks of vector elements
+typedef struct hex_kernel_step_t
+{
+    uint8_t op;    // Opcode of a native symbol, or 0 for an integer literal
+    int32_t value; // Value of an integer literal
+} hex_kernel_step_t;
+
+// Buffer of the output written to stdout or stderr (see output.c)
+typedef struct hex_output_t
+{
+    FILE *stream;
+    int line_buffered; // Flush at each newline, if the stream is a terminal
+    size_t size;
+    char data[HEX_OUTPUT_BUFFER_SIZE];
+} hex_output_t;
+
+// Distinct quotation literals decoded from bytecode, whose items are shared by
+// identical literals (see vm.c)
+typedef struct hex_literal_pool_t
+{
+    hex_item_t **slots; // Open addressing table, NULL for an empty slot
+    size_t count;
+    size_t capacity;
+} hex_literal_pool_t;
+
+// Outputs of a quotation applied by memo to some inputs (see memo.c)
+typedef struct hex_memo_entry_t
+{
+    size_t hash;
+    hex_item_t *key;                // Quotation of the inputs followed by the quotation applied
+    hex_item_t *outputs;            // Quotation of the items pushed
+    struct hex_memo_entry_t *next;  // Next entry in the same bucket
+    struct hex_memo_entry_t *newer; // Entry used after this one
+    struct hex_memo_entry_t *older; // Entry used before this one
+} hex_memo_entry_t;
+
+typedef struct hex_memo_t
+{
+    hex_memo_entry_t **buckets; // NULL until a result is kept
+    hex_memo_entry_t *newest;
+    hex_memo_entry_t *oldest;
+    size_t size;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+} hex_memo_t;
+
 typedef struct hex_context_t
 {
     hex_stack_t *stack;
@@ -148,7 +362,15 @@ typedef struct hex_context_t
     hex_doc_dictionary_t *docs;
     hex_symbol_table_t *symbol_table;
     int hashbang;
-    char error[256];
+    char error[HEX_ERROR_SIZE];
+    hex_deferred_error_t pending_error;
+    hex_try_frame_t *try_frame;
+    hex_compiled_t *eval_cache[HEX_EVAL_CACHE_SIZE];
+    FILE *files[HEX_MAX_OPEN_FILES]; // Streams of file handles; 0, 1 and 2 are stdin, stdout and stderr
+    hex_output_t out;
+    hex_output_t err;
+    hex_literal_pool_t literals;
+    hex_memo_t memo;
     int argc;
     char **argv;
 } hex_context_t;
@@ -239,6 +461,57 @@ typedef enum hex_opcode_t
     HEX_OP_RUN = 0x4e,
     HEX_OP_TIMESTAMP = 0x4f,
 
+    HEX_OP_GSUB = 0x50,
+    HEX_OP_FMT = 0x51,
+    HEX_OP_BEGINS = 0x52,
+    HEX_OP_ENDS = 0x53,
+
+    HEX_OP_VEC = 0x54,
+    HEX_OP_SUM = 0x55,
+    HEX_OP_MIN = 0x56,
+    HEX_OP_MAX = 0x57,
+
+    HEX_OP_DICT = 0x58,
+    HEX_OP_PUT = 0x59,
+    HEX_OP_HAS = 0x5a,
+    HEX_OP_DEL = 0x5b,
+    HEX_OP_KEYS = 0x5c,
+
+    HEX_OP_SORT = 0x5d,
+    HEX_OP_SORTBY = 0x5e,
+
+    HEX_OP_EACH = 0x5f,
+    HEX_OP_FILTER = 0x60,
+    HEX_OP_FOLD = 0x61,
+    HEX_OP_TIMES = 0x62,
+    HEX_OP_RANGE = 0x63,
+
+    HEX_OP_PUSH = 0x64,
+    HEX_OP_POP = 0x65,
+    HEX_OP_INS = 0x66,
+    HEX_OP_REM = 0x67,
+    HEX_OP_SET = 0x68,
+    HEX_OP_REVERSE = 0x69,
+    HEX_OP_UNCONS = 0x6a,
+    HEX_OP_SWONS = 0x6b,
+
+    HEX_OP_SEQ = 0x6c,
+    HEX_OP_LINES = 0x6d,
+    HEX_OP_PIECES = 0x6e,
+    HEX_OP_TAKE = 0x6f,
+
+    HEX_OP_OPEN = 0x70,
+    HEX_OP_CLOSE = 0x71,
+    HEX_OP_FLUSH = 0x72,
+    HEX_OP_READL = 0x73,
+    HEX_OP_READB = 0x74,
+    HEX_OP_EOF = 0x75,
+
+    HEX_OP_INTS = 0x76,
+
+    HEX_OP_MEMO = 0x77,
+    HEX_OP_MEMOSTATS = 0x78,
+
 } hex_opcode_t;
 
 // Help System
@@ -260,12 +533,19 @@ void hex_registry_destroy(hex_context_t *ctx);
 int hex_valid_user_symbol(hex_context_t *ctx, const char *symbol);
 int hex_valid_native_symbol(hex_context_t *ctx, const char *symbol);
 int hex_set_symbol(hex_context_t *ctx, const char *key, hex_item_t *value, int native);
-void hex_set_native_symbol(hex_context_t *ctx, const char *name, int (*func)(hex_context_t *));
+void hex_set_native_symbol(hex_context_t *ctx, const hex_native_t *native);
 int hex_get_symbol(hex_context_t *ctx, const char *key, hex_item_t *result);
+const hex_native_t *hex_get_native_symbol(hex_context_t *ctx, const char *key);
 int hex_delete_symbol(hex_context_t *ctx, const char *key);
 
 // Errors and debugging
 void hex_error(hex_context_t *ctx, const char *format, ...);
+const char *hex_error_message(hex_context_t *ctx);
+int hex_has_error(hex_context_t *ctx);
+void hex_clear_error(hex_context_t *ctx);
+void hex_enter_try(hex_context_t *ctx, hex_try_frame_t *frame);
+void hex_leave_try(hex_context_t *ctx, hex_try_frame_t *frame);
+void hex_restore_error(hex_context_t *ctx, hex_try_frame_t *frame);
 void hex_debug(hex_context_t *ctx, const char *format, ...);
 void hex_debug_item(hex_context_t *ctx, const char *message, hex_item_t *item);
 void hex_print_item(FILE *stream, hex_item_t *item);
@@ -274,14 +554,26 @@ void print_stack_trace(hex_context_t *ctx);
 
 // Item constructors
 hex_item_t *hex_string_item(hex_context_t *ctx, const char *value);
+hex_item_t *hex_string_literal_item(hex_context_t *ctx, const char *value);
+hex_item_t *hex_string_buffer_item(hex_context_t *ctx, char *buffer, size_t size);
+hex_item_t *hex_string_bytes_item(hex_context_t *ctx, const char *value, size_t size);
 hex_item_t *hex_integer_item(hex_context_t *ctx, int value);
 hex_item_t *hex_quotation_item(hex_context_t *ctx, hex_item_t **quotation, size_t size);
+hex_item_t *hex_buffer_item(hex_context_t *ctx, uint8_t *data, size_t size);
+hex_item_t *hex_vector_item(hex_context_t *ctx, int32_t *values, size_t size);
+hex_item_t *hex_dict_item(hex_context_t *ctx, hex_dict_t *dict);
+hex_item_t *hex_seq_item(hex_context_t *ctx, hex_seq_t *seq);
 
 // Stack management
 int hex_push(hex_context_t *ctx, hex_item_t *item);
 int hex_push_integer(hex_context_t *ctx, int value);
 int hex_push_string(hex_context_t *ctx, const char *value);
+int hex_push_string_buffer(hex_context_t *ctx, char *buffer, size_t size);
 int hex_push_quotation(hex_context_t *ctx, hex_item_t **quotation, size_t size);
+int hex_push_buffer(hex_context_t *ctx, uint8_t *data, size_t size);
+int hex_push_vector(hex_context_t *ctx, int32_t *values, size_t size);
+int hex_push_dict(hex_context_t *ctx, hex_dict_t *dict);
+int hex_push_seq(hex_context_t *ctx, hex_seq_t *seq);
 int hex_push_symbol(hex_context_t *ctx, hex_token_t *token);
 hex_item_t *hex_pop(hex_context_t *ctx);
 void hex_free_item(hex_context_t *ctx, hex_item_t *item);
@@ -289,25 +581,45 @@ void hex_free_list(hex_context_t *ctx, hex_item_t **quotation, size_t size);
 void hex_free_token(hex_token_t *token);
 hex_item_t *hex_copy_item(hex_context_t *ctx, const hex_item_t *item);
 hex_token_t *hex_copy_token(hex_context_t *ctx, const hex_token_t *token);
+int hex_quotation_unshare(hex_context_t *ctx, hex_item_t *item);
+int hex_string_unshare(hex_item_t *item);
+int hex_string_store(hex_item_t *item);
+void hex_string_unstore(hex_item_t *item);
+size_t hex_item_hash(hex_item_t *item);
+int hex_quotation_find(hex_item_t *list, hex_item_t *item);
+int hex_equal(hex_item_t *a, hex_item_t *b);
 
 // Parser and interpreter
 hex_token_t *hex_next_token(hex_context_t *ctx, const char **input, hex_file_position_t *position);
 int32_t hex_parse_integer(const char *hex_str);
 int hex_parse_quotation(hex_context_t *ctx, const char **input, hex_item_t *result, hex_file_position_t *position);
 int hex_interpret(hex_context_t *ctx, const char *code, const char *filename, int line, int column);
+int hex_compile(hex_context_t *ctx, const char *code, const char *filename, hex_item_t ***items, size_t *count);
+
+// Eval cache
+hex_compiled_t *hex_get_compiled(hex_context_t *ctx, const uint8_t *code, size_t size, int bytecode, const char *scope);
+int hex_run_compiled(hex_context_t *ctx, hex_compiled_t *compiled);
+void hex_release_compiled(hex_context_t *ctx, hex_compiled_t *compiled);
+void hex_eval_cache_destroy(hex_context_t *ctx);
 
 // Utils
-char *hex_itoa(int num, int base);
-char *hex_itoa_dec(int num);
-char *hex_itoa_hex(int num);
-void hex_raw_print_item(FILE *stream, hex_item_t item);
+char *hex_format_hex(uint32_t value, char *end);
+char *hex_format_decimal(int32_t value, char *end);
+uint32_t hex_parse_hex_digits(const char *text, const char **end);
+uint32_t hex_parse_decimal_digits(const char *text, const char **end);
+int32_t hex_parse_number(const char *text, int base);
 char *hex_type(hex_item_type_t type);
 void hex_rpad(const char *str, int total_length);
 void hex_lpad(const char *str, int total_length);
 void hex_encode_length(uint8_t **bytecode, size_t *size, size_t length);
 int hex_is_binary(const uint8_t *data, size_t size);
-void hex_print_string(FILE *stream, char *value);
-char *hex_bytes_to_string(const uint8_t *bytes, size_t size);
+size_t hex_plain_span(const char *data, size_t size);
+const char *hex_find(const char *haystack, size_t haystack_size, const char *needle, size_t needle_size);
+int32_t hex_shift_left(int32_t value, int32_t count);
+int32_t hex_shift_right(int32_t value, int32_t count);
+int hex_vector_apply(hex_opcode_t op, int32_t *out, const int32_t *left, size_t left_step, const int32_t *right, size_t right_step, size_t size);
+int32_t hex_vector_reduce(hex_opcode_t op, const int32_t *values, size_t size);
+char *hex_bytes_to_string(const uint8_t *bytes, size_t size, size_t *length);
 char *hex_process_string(const char *value);
 size_t hex_min_bytes_to_encode_integer(int32_t value);
 char *hex_unescape_string(const char *input);
@@ -339,6 +651,7 @@ int hex_symbol_int(hex_context_t *ctx);
 int hex_symbol_str(hex_context_t *ctx);
 int hex_symbol_dec(hex_context_t *ctx);
 int hex_symbol_hex(hex_context_t *ctx);
+int hex_symbol_ints(hex_context_t *ctx);
 int hex_symbol_equal(hex_context_t *ctx);
 int hex_symbol_notequal(hex_context_t *ctx);
 int hex_symbol_greater(hex_context_t *ctx);
@@ -354,12 +667,43 @@ int hex_symbol_slice(hex_context_t *ctx);
 int hex_symbol_len(hex_context_t *ctx);
 int hex_symbol_get(hex_context_t *ctx);
 int hex_symbol_index(hex_context_t *ctx);
+int hex_symbol_push(hex_context_t *ctx);
+int hex_symbol_pop(hex_context_t *ctx);
+int hex_symbol_ins(hex_context_t *ctx);
+int hex_symbol_rem(hex_context_t *ctx);
+int hex_symbol_set(hex_context_t *ctx);
+int hex_symbol_reverse(hex_context_t *ctx);
+int hex_symbol_uncons(hex_context_t *ctx);
+int hex_symbol_swons(hex_context_t *ctx);
 int hex_symbol_join(hex_context_t *ctx);
 int hex_symbol_split(hex_context_t *ctx);
 int hex_symbol_sub(hex_context_t *ctx);
+int hex_symbol_gsub(hex_context_t *ctx);
+int hex_symbol_fmt(hex_context_t *ctx);
+int hex_symbol_begins(hex_context_t *ctx);
+int hex_symbol_ends(hex_context_t *ctx);
+int hex_symbol_vec(hex_context_t *ctx);
+int hex_symbol_sum(hex_context_t *ctx);
+int hex_symbol_min(hex_context_t *ctx);
+int hex_symbol_max(hex_context_t *ctx);
+int hex_symbol_dict(hex_context_t *ctx);
+int hex_symbol_put(hex_context_t *ctx);
+int hex_symbol_has(hex_context_t *ctx);
+int hex_symbol_del(hex_context_t *ctx);
+int hex_symbol_keys(hex_context_t *ctx);
+int hex_symbol_seq(hex_context_t *ctx);
+int hex_symbol_lines(hex_context_t *ctx);
+int hex_symbol_pieces(hex_context_t *ctx);
+int hex_symbol_take(hex_context_t *ctx);
 int hex_symbol_read(hex_context_t *ctx);
 int hex_symbol_write(hex_context_t *ctx);
 int hex_symbol_append(hex_context_t *ctx);
+int hex_symbol_open(hex_context_t *ctx);
+int hex_symbol_close(hex_context_t *ctx);
+int hex_symbol_flush(hex_context_t *ctx);
+int hex_symbol_readl(hex_context_t *ctx);
+int hex_symbol_readb(hex_context_t *ctx);
+int hex_symbol_eof(hex_context_t *ctx);
 int hex_symbol_args(hex_context_t *ctx);
 int hex_symbol_exit(hex_context_t *ctx);
 int hex_symbol_exec(hex_context_t *ctx);
@@ -367,11 +711,20 @@ int hex_symbol_run(hex_context_t *ctx);
 int hex_symbol_if(hex_context_t *ctx);
 int hex_symbol_when(hex_context_t *ctx);
 int hex_symbol_while(hex_context_t *ctx);
+int hex_symbol_times(hex_context_t *ctx);
+int hex_symbol_memo(hex_context_t *ctx);
+int hex_symbol_memostats(hex_context_t *ctx);
 int hex_symbol_error(hex_context_t *ctx);
 int hex_symbol_try(hex_context_t *ctx);
 int hex_symbol_throw(hex_context_t *ctx);
 int hex_symbol_q(hex_context_t *ctx);
 int hex_symbol_map(hex_context_t *ctx);
+int hex_symbol_each(hex_context_t *ctx);
+int hex_symbol_filter(hex_context_t *ctx);
+int hex_symbol_fold(hex_context_t *ctx);
+int hex_symbol_range(hex_context_t *ctx);
+int hex_symbol_sort(hex_context_t *ctx);
+int hex_symbol_sortby(hex_context_t *ctx);
 int hex_symbol_swap(hex_context_t *ctx);
 int hex_symbol_dup(hex_context_t *ctx);
 int hex_symbol_stack(hex_context_t *ctx);
@@ -395,6 +748,8 @@ int hex_interpret_bytecode_native_symbol(hex_context_t *ctx, uint8_t opcode, siz
 int hex_interpret_bytecode_user_symbol(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t position, const char *filename, hex_item_t *result);
 int hex_interpret_bytecode_quotation(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t position, const char *filename, hex_item_t *result);
 int hex_interpret_bytecode(hex_context_t *ctx, uint8_t *bytecode, size_t size, const char *filename);
+void hex_literal_pool_destroy(hex_context_t *ctx);
+int hex_compile_bytecode(hex_context_t *ctx, uint8_t *bytecode, size_t size, const char *filename, hex_item_t ***items, size_t *count);
 void hex_header(hex_context_t *ctx, uint8_t header[8]);
 int hex_validate_header(uint8_t header[8]);
 
@@ -404,9 +759,38 @@ int hex_symboltable_get_index(hex_context_t *ctx, const char *symbol);
 char *hex_symboltable_get_value(hex_context_t *ctx, uint16_t index);
 int hex_decode_bytecode_symboltable(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t count);
 uint8_t *hex_encode_bytecode_symboltable(hex_context_t *ctx, size_t *out_size);
-hex_symbol_table_t *hex_symboltable_copy(hex_context_t *ctx);
+hex_symbol_table_t *hex_symboltable_create(hex_symbol_table_t *parent);
+hex_symbol_table_t *hex_symboltable_overlay(hex_context_t *ctx);
 void hex_symboltable_destroy(hex_symbol_table_t *table);
 
+// Dictionaries
+hex_dict_t *hex_dict_create(void);
+void hex_dict_release(hex_context_t *ctx, hex_dict_t *dict);
+hex_dict_t *hex_dict_copy(hex_context_t *ctx, const hex_dict_t *dict);
+hex_dict_t *hex_dict_unshare(hex_context_t *ctx, hex_dict_t *dict);
+hex_item_t *hex_dict_get(const hex_dict_t *dict, const hex_item_t *key);
+int hex_dict_put(hex_context_t *ctx, hex_dict_t *dict, hex_item_t *key, hex_item_t *value);
+int hex_dict_delete(hex_context_t *ctx, hex_dict_t *dict, const hex_item_t *key);
+
+// Output
+void hex_output_init(hex_output_t *out, FILE *stream);
+int hex_output_flush(hex_output_t *out);
+void hex_output_write(hex_output_t *out, const char *data, size_t size);
+void hex_output_char(hex_output_t *out, char c);
+void hex_output_integer(hex_output_t *out, int32_t value);
+void hex_output_string(hex_output_t *out, const char *value, size_t size);
+void hex_output_item(hex_output_t *out, hex_item_t *item, int raw);
+void hex_flush_output(hex_context_t *ctx);
+
+// Sequences
+hex_seq_t *hex_seq_create(hex_seq_kind_t kind);
+void hex_seq_release(hex_context_t *ctx, hex_seq_t *seq);
+
+// Memoization
+hex_item_t *hex_memo_get(hex_context_t *ctx, hex_item_t *key, size_t hash);
+int hex_memo_put(hex_context_t *ctx, hex_item_t *key, size_t hash, hex_item_t *outputs);
+void hex_memo_destroy(hex_context_t *ctx);
+
 // REPL and initialization
 void hex_register_symbols(hex_context_t *ctx);
 hex_context_t *hex_init();
@@ -414,6 +798,8 @@ void hex_destroy(hex_context_t *ctx);
 void hex_repl(hex_context_t *ctx);
 void hex_process_stdin(hex_context_t *ctx);
 void hex_handle_sigint(int sig);
+void hex_check_interrupt(hex_context_t *ctx);
+extern volatile sig_atomic_t hex_interrupted; // Set by hex_handle_sigint on Ctrl+C
 int hex_write_bytecode_file(hex_context_t *ctx, char *filename, uint8_t *bytecode, size_t size);
 int hex_interpret_file(hex_context_t *ctx, const char *file);
 char *hex_read_file(hex_context_t *ctx, const char *filename);
@@ -422,6 +808,6 @@ char *hex_read_file(hex_context_t *ctx, const char *filename);
 #define HEX_POP(ctx, x) hex_item_t *x = hex_pop(ctx)
 #define HEX_FREE(ctx, x) hex_free_item(ctx, x)
 #define HEX_PUSH(ctx, x) hex_push(ctx, x)
-#define HEX_ALLOC(x) hex_item_t *x = (hex_item_t *)malloc(sizeof(hex_item_t));
+#define HEX_ALLOC(x) hex_item_t *x = (hex_item_t *)calloc(1, sizeof(hex_item_t));
 
 #endif // HEX_H
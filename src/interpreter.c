@@ -45,24 +45,27 @@ hex_context_t *hex_init()
             context->stack_trace->entries[i] = NULL;
         }
     }
+    context->error[0] = '\0';
+    context->pending_error.format = NULL;
+    context->try_frame = NULL;
+    memset(context->eval_cache, 0, sizeof(context->eval_cache));
+    memset(context->files, 0, sizeof(context->files));
+    memset(&context->literals, 0, sizeof(context->literals));
+    memset(&context->memo, 0, sizeof(context->memo));
+    context->files[0] = stdin;
+    context->files[1] = stdout;
+    context->files[2] = stderr;
+    hex_output_init(&context->out, stdout);
+    hex_output_init(&context->err, stderr);
     context->settings = malloc(sizeof(hex_settings_t));
     if (context->settings)
     {
         context->settings->debugging_enabled = 0;
         context->settings->errors_enabled = 1;
         context->settings->stack_trace_enabled = 1;
+        context->settings->hash_consing_enabled = 1;
     }
-    context->symbol_table = malloc(sizeof(hex_symbol_table_t));
-    if (context->symbol_table)
-    {
-        context->symbol_table->count = 0;
-        context->symbol_table->symbols = malloc(HEX_MAX_USER_SYMBOLS * sizeof(char *));
-        // Initialize all symbols to NULL
-        for (int i = 0; i < HEX_MAX_USER_SYMBOLS; i++)
-        {
-            context->symbol_table->symbols[i] = NULL;
-        }
-    }
+    context->symbol_table = hex_symboltable_create(NULL);
     return context;
 }
 
@@ -83,7 +86,8 @@ int hex_interpret(hex_context_t *ctx, const char *code, const char *filename, in
         }
         else if (token->type == HEX_TOKEN_STRING)
         {
-            result = hex_push_string(ctx, token->value);
+            hex_item_t *item = hex_string_literal_item(ctx, token->value);
+            result = item ? HEX_PUSH(ctx, item) : 1;
         }
         else if (token->type == HEX_TOKEN_SYMBOL)
         {
@@ -149,3 +153,227 @@ int hex_interpret(hex_context_t *ctx, const char *code, const char *filename, in
     }
     return 0;
 }
+
+// Parse a whole program into the list of items it pushes, without executing it
+int hex_compile(hex_context_t *ctx, const char *code, const char *filename, hex_item_t ***items, size_t *count)
+{
+    const char *input = code;
+    hex_file_position_t position = {filename, 1, 1};
+    size_t capacity = 16;
+    size_t n = 0;
+    hex_item_t **list = malloc(capacity * sizeof(hex_item_t *));
+    if (!list)
+    {
+        hex_error(ctx, "[compile] Memory allocation failed");
+        return 1;
+    }
+    hex_token_t *token = hex_next_token(ctx, &input, &position);
+    while (token != NULL && token->type != HEX_TOKEN_INVALID)
+    {
+        hex_item_t *item = NULL;
+        if (token->type == HEX_TOKEN_INTEGER)
+        {
+            item = hex_integer_item(ctx, hex_parse_integer(token->value));
+        }
+        else if (token->type == HEX_TOKEN_STRING)
+        {
+            item = hex_string_literal_item(ctx, token->value);
+        }
+        else if (token->type == HEX_TOKEN_SYMBOL)
+        {
+            if (token->position && filename)
+            {
+                if (token->position->filename)
+                {
+                    free((void *)token->position->filename);
+                }
+                token->position->filename = strdup(filename);
+            }
+            item = hex_symbol_item(ctx, token);
+        }
+        else if (token->type == HEX_TOKEN_QUOTATION_START)
+        {
+            item = (hex_item_t *)calloc(1, sizeof(hex_item_t));
+            if (item && hex_parse_quotation(ctx, &input, item, &position) != 0)
+            {
+                free(item);
+                item = NULL;
+            }
+        }
+        hex_free_token(token);
+        if (item != NULL && n >= capacity)
+        {
+            capacity *= 2;
+            hex_item_t **tmp = realloc(list, capacity * sizeof(hex_item_t *));
+            if (!tmp)
+            {
+                hex_free_item(ctx, item);
+                item = NULL;
+            }
+            else
+            {
+                list = tmp;
+            }
+        }
+        if (item == NULL)
+        {
+            hex_free_list(ctx, list, n);
+            return 1;
+        }
+        list[n++] = item;
+        token = hex_next_token(ctx, &input, &position);
+    }
+    if (token != NULL)
+    {
+        hex_free_token(token);
+        hex_free_list(ctx, list, n);
+        return 1;
+    }
+    *items = list;
+    *count = n;
+    return 0;
+}
+
+////////////////////////////////////////
+// Eval Cache                         //
+////////////////////////////////////////
+
+static size_t hex_eval_hash(const uint8_t *code, size_t size, const char *scope)
+{
+    size_t hash = 5381;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = ((hash << 5) + hash) + code[i];
+    }
+    while (*scope)
+    {
+        hash = ((hash << 5) + hash) + (unsigned char)(*scope);
+        scope++;
+    }
+    return hash;
+}
+
+void hex_release_compiled(hex_context_t *ctx, hex_compiled_t *compiled)
+{
+    if (compiled == NULL || --compiled->refs > 0)
+    {
+        return;
+    }
+    hex_free_list(ctx, compiled->items, compiled->count);
+    free(compiled->scope);
+    free(compiled->code);
+    free(compiled);
+}
+
+// Return the compiled form of a program evaluated by !, compiling it on a cache miss.
+// Programs that cannot be compiled as a whole (e.g. because of a syntax error) are not
+// cached: NULL is returned and the caller falls back to the streaming interpreter.
+hex_compiled_t *hex_get_compiled(hex_context_t *ctx, const uint8_t *code, size_t size, int bytecode, const char *scope)
+{
+    size_t hash = hex_eval_hash(code, size, scope);
+    hex_compiled_t **slot = &ctx->eval_cache[hash % HEX_EVAL_CACHE_SIZE];
+    hex_compiled_t *compiled = *slot;
+    if (compiled && compiled->hash == hash && compiled->bytecode == bytecode && compiled->code_size == size &&
+        strcmp(compiled->scope, scope) == 0 && memcmp(compiled->code, code, size) == 0)
+    {
+        compiled->refs++;
+        return compiled;
+    }
+
+    compiled = calloc(1, sizeof(hex_compiled_t));
+    if (!compiled)
+    {
+        return NULL;
+    }
+    compiled->code = malloc(size + 1);
+    compiled->scope = strdup(scope);
+    if (!compiled->code || !compiled->scope)
+    {
+        free(compiled->code);
+        free(compiled->scope);
+        free(compiled);
+        return NULL;
+    }
+    memcpy(compiled->code, code, size);
+    compiled->code[size] = '\0';
+    compiled->code_size = size;
+    compiled->hash = hash;
+    compiled->bytecode = bytecode;
+
+    // Compilation errors are reported by the fallback path, if at all
+    hex_try_frame_t frame;
+    hex_enter_try(ctx, &frame);
+    int result;
+    if (bytecode)
+    {
+        // Decoding replaces the symbol table: work on an overlay
+        hex_symbol_table_t *original_table = ctx->symbol_table;
+        hex_symbol_table_t *overlay = hex_symboltable_overlay(ctx);
+        if (overlay)
+        {
+            ctx->symbol_table = overlay;
+            result = hex_compile_bytecode(ctx, compiled->code, size, scope, &compiled->items, &compiled->count);
+            hex_symboltable_destroy(overlay);
+            ctx->symbol_table = original_table;
+        }
+        else
+        {
+            result = 1;
+        }
+    }
+    else
+    {
+        result = hex_compile(ctx, (const char *)compiled->code, scope, &compiled->items, &compiled->count);
+    }
+    hex_leave_try(ctx, &frame);
+    hex_restore_error(ctx, &frame);
+    if (result != 0)
+    {
+        free(compiled->code);
+        free(compiled->scope);
+        free(compiled);
+        return NULL;
+    }
+
+    // The cache holds one reference, the caller another
+    compiled->refs = 2;
+    hex_release_compiled(ctx, *slot);
+    *slot = compiled;
+    return compiled;
+}
+
+// Push the items of a compiled program
+int hex_run_compiled(hex_context_t *ctx, hex_compiled_t *compiled)
+{
+    for (size_t i = 0; i < compiled->count; i++)
+    {
+        hex_item_t *item = compiled->items[i];
+        if (item->type == HEX_TYPE_NATIVE_SYMBOL || item->type == HEX_TYPE_USER_SYMBOL)
+        {
+            // Symbols are never stored on the stack, no copy is needed
+            if (hex_push(ctx, item) != 0)
+            {
+                hex_error(ctx, "[interpret] Unable to push: %s", item->token->value);
+                print_stack_trace(ctx);
+                return 1;
+            }
+            continue;
+        }
+        hex_item_t *copy = hex_copy_item(ctx, item);
+        if (!copy || hex_push(ctx, copy) != 0)
+        {
+            HEX_FREE(ctx, copy);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void hex_eval_cache_destroy(hex_context_t *ctx)
+{
+    for (size_t i = 0; i < HEX_EVAL_CACHE_SIZE; i++)
+    {
+        hex_release_compiled(ctx, ctx->eval_cache[i]);
+        ctx->eval_cache[i] = NULL;
+    }
+}
@@ -107,6 +107,7 @@ static void prompt()
 static void do_repl(void *v_ctx)
 {
     hex_context_t *ctx = (hex_context_t *)v_ctx;
+    hex_flush_output(ctx);
     prompt();
     char line[HEX_STDIN_BUFFER_SIZE];
     char *p = line;
@@ -124,10 +125,10 @@ static void do_repl(void *v_ctx)
     // Print the top item of the stack
     if (ctx->stack->top >= 0)
     {
-        hex_print_item(stdout, ctx->stack->entries[ctx->stack->top]);
-        // hex_print_item(stdout, HEX_STACK[HEX_TOP]);
-        printf("\n");
+        hex_output_item(&ctx->out, ctx->stack->entries[ctx->stack->top], 0);
+        hex_output_char(&ctx->out, '\n');
     }
+    hex_flush_output(ctx);
     return;
 }
 
@@ -137,9 +138,11 @@ static int do_repl(void *v_ctx)
 {
     hex_context_t *ctx = (hex_context_t *)v_ctx;
     char line[1024];
+    hex_check_interrupt(ctx);
     prompt();
     if (fgets(line, sizeof(line), stdin) == NULL)
     {
+        hex_check_interrupt(ctx);
         printf("\n"); // Handle EOF (Ctrl+D)
         return 1;
     }
@@ -151,8 +154,8 @@ static int do_repl(void *v_ctx)
     // Print the top item of the stack
     if (ctx->stack->top >= 0)
     {
-        hex_print_item(stdout, ctx->stack->entries[ctx->stack->top]);
-        printf("\n");
+        hex_output_item(&ctx->out, ctx->stack->entries[ctx->stack->top], 0);
+        hex_output_char(&ctx->out, '\n');
     }
     return 0;
 }
@@ -187,9 +190,24 @@ void hex_repl(hex_context_t *ctx)
 #endif
 }
 
+volatile sig_atomic_t hex_interrupted = 0;
+
 void hex_handle_sigint(int sig)
 {
     (void)sig; // Suppress unused warning
+    // Outputs cannot be flushed safely here: the interpreter exits at its next push,
+    // and the REPL once the read of its input is interrupted
+    hex_interrupted = 1;
+}
+
+// Exit if Ctrl+C was pressed, flushing the buffered outputs of the context first
+void hex_check_interrupt(hex_context_t *ctx)
+{
+    if (!hex_interrupted)
+    {
+        return;
+    }
+    hex_flush_output(ctx);
     printf("\n");
     exit(0);
 }
@@ -248,7 +266,7 @@ void hex_print_docs(hex_doc_dictionary_t *docs)
            "  hex is a minimalist, slightly-esoteric, concatenative programming language that supports\n"
            "  only integers, strings, symbols, and quotations (lists).\n"
            "\n"
-           "  It uses a stack-based execution model and provides 64 native symbols for stack\n"
+           "  It uses a stack-based execution model and provides 105 native symbols for stack\n"
            "  manipulation, arithmetic operations, control flow, reading and writing\n"
            "  (standard input/output/error and files), executing external processes, and more.\n"
            "\n"
@@ -348,7 +366,16 @@ int hex_interpret_file(hex_context_t *ctx, const char *file)
 int main(int argc, char *argv[])
 {
     // Register SIGINT (Ctrl+C) signal handler
+#ifdef _WIN32
     signal(SIGINT, hex_handle_sigint);
+#else
+    // Without SA_RESTART, so that a blocking read of the REPL returns when it is interrupted
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = hex_handle_sigint;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+#endif
 
     // Initialize the context
     hex_context_t *ctx = hex_init();
@@ -0,0 +1,126 @@
+#ifndef HEX_H
+#include "hex.h"
+#endif
+
+// Results of the quotations applied by memo are kept in a hash table with chained
+// buckets, keyed by a quotation of the inputs followed by the quotation applied.
+// Entries are also linked from the most to the least recently used, so that the
+// least recently used one is evicted once the table holds HEX_MEMO_SIZE of them.
+
+static void hex_memo_unlink(hex_memo_t *memo, hex_memo_entry_t *entry)
+{
+    if (entry->newer)
+    {
+        entry->newer->older = entry->older;
+    }
+    else
+    {
+        memo->newest = entry->older;
+    }
+    if (entry->older)
+    {
+        entry->older->newer = entry->newer;
+    }
+    else
+    {
+        memo->oldest = entry->newer;
+    }
+    entry->newer = NULL;
+    entry->older = NULL;
+}
+
+static void hex_memo_link(hex_memo_t *memo, hex_memo_entry_t *entry)
+{
+    entry->older = memo->newest;
+    if (memo->newest)
+    {
+        memo->newest->newer = entry;
+    }
+    memo->newest = entry;
+    if (!memo->oldest)
+    {
+        memo->oldest = entry;
+    }
+}
+
+static void hex_memo_free_entry(hex_context_t *ctx, hex_memo_entry_t *entry)
+{
+    HEX_FREE(ctx, entry->key);
+    HEX_FREE(ctx, entry->outputs);
+    free(entry);
+}
+
+// Get the outputs kept for a key, still owned by the cache, or NULL if there are none
+hex_item_t *hex_memo_get(hex_context_t *ctx, hex_item_t *key, size_t hash)
+{
+    hex_memo_t *memo = &ctx->memo;
+    if (memo->buckets)
+    {
+        for (hex_memo_entry_t *entry = memo->buckets[hash & (HEX_MEMO_BUCKETS - 1)]; entry; entry = entry->next)
+        {
+            if (entry->hash == hash && hex_equal(entry->key, key))
+            {
+                hex_memo_unlink(memo, entry);
+                hex_memo_link(memo, entry);
+                memo->hits++;
+                return entry->outputs;
+            }
+        }
+    }
+    memo->misses++;
+    return NULL;
+}
+
+// Keep the outputs of a key, taking ownership of both items if successful
+int hex_memo_put(hex_context_t *ctx, hex_item_t *key, size_t hash, hex_item_t *outputs)
+{
+    hex_memo_t *memo = &ctx->memo;
+    if (!memo->buckets)
+    {
+        memo->buckets = (hex_memo_entry_t **)calloc(HEX_MEMO_BUCKETS, sizeof(hex_memo_entry_t *));
+        if (!memo->buckets)
+        {
+            return 1;
+        }
+    }
+    hex_memo_entry_t *entry = (hex_memo_entry_t *)calloc(1, sizeof(hex_memo_entry_t));
+    if (!entry)
+    {
+        return 1;
+    }
+    if (memo->size == HEX_MEMO_SIZE)
+    {
+        hex_memo_entry_t *oldest = memo->oldest;
+        hex_memo_entry_t **link = &memo->buckets[oldest->hash & (HEX_MEMO_BUCKETS - 1)];
+        while (*link != oldest)
+        {
+            link = &(*link)->next;
+        }
+        *link = oldest->next;
+        hex_memo_unlink(memo, oldest);
+        hex_memo_free_entry(ctx, oldest);
+        memo->size--;
+        memo->evictions++;
+    }
+    entry->hash = hash;
+    entry->key = key;
+    entry->outputs = outputs;
+    entry->next = memo->buckets[hash & (HEX_MEMO_BUCKETS - 1)];
+    memo->buckets[hash & (HEX_MEMO_BUCKETS - 1)] = entry;
+    hex_memo_link(memo, entry);
+    memo->size++;
+    return 0;
+}
+
+void hex_memo_destroy(hex_context_t *ctx)
+{
+    hex_memo_t *memo = &ctx->memo;
+    while (memo->oldest)
+    {
+        hex_memo_entry_t *entry = memo->oldest;
+        hex_memo_unlink(memo, entry);
+        hex_memo_free_entry(ctx, entry);
+    }
+    free(memo->buckets);
+    memset(memo, 0, sizeof(hex_memo_t));
+}
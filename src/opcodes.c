@@ -261,6 +261,170 @@ uint8_t hex_symbol_to_opcode(const char *symbol)
     {
         return HEX_OP_TIMESTAMP;
     }
+    else if (strcmp(symbol, "gsub") == 0)
+    {
+        return HEX_OP_GSUB;
+    }
+    else if (strcmp(symbol, "fmt") == 0)
+    {
+        return HEX_OP_FMT;
+    }
+    else if (strcmp(symbol, "begins") == 0)
+    {
+        return HEX_OP_BEGINS;
+    }
+    else if (strcmp(symbol, "ends") == 0)
+    {
+        return HEX_OP_ENDS;
+    }
+    else if (strcmp(symbol, "vec") == 0)
+    {
+        return HEX_OP_VEC;
+    }
+    else if (strcmp(symbol, "sum") == 0)
+    {
+        return HEX_OP_SUM;
+    }
+    else if (strcmp(symbol, "min") == 0)
+    {
+        return HEX_OP_MIN;
+    }
+    else if (strcmp(symbol, "max") == 0)
+    {
+        return HEX_OP_MAX;
+    }
+    else if (strcmp(symbol, "dict") == 0)
+    {
+        return HEX_OP_DICT;
+    }
+    else if (strcmp(symbol, "put") == 0)
+    {
+        return HEX_OP_PUT;
+    }
+    else if (strcmp(symbol, "has") == 0)
+    {
+        return HEX_OP_HAS;
+    }
+    else if (strcmp(symbol, "del") == 0)
+    {
+        return HEX_OP_DEL;
+    }
+    else if (strcmp(symbol, "keys") == 0)
+    {
+        return HEX_OP_KEYS;
+    }
+    else if (strcmp(symbol, "sort") == 0)
+    {
+        return HEX_OP_SORT;
+    }
+    else if (strcmp(symbol, "sortby") == 0)
+    {
+        return HEX_OP_SORTBY;
+    }
+    else if (strcmp(symbol, "each") == 0)
+    {
+        return HEX_OP_EACH;
+    }
+    else if (strcmp(symbol, "filter") == 0)
+    {
+        return HEX_OP_FILTER;
+    }
+    else if (strcmp(symbol, "fold") == 0)
+    {
+        return HEX_OP_FOLD;
+    }
+    else if (strcmp(symbol, "times") == 0)
+    {
+        return HEX_OP_TIMES;
+    }
+    else if (strcmp(symbol, "range") == 0)
+    {
+        return HEX_OP_RANGE;
+    }
+    else if (strcmp(symbol, "push") == 0)
+    {
+        return HEX_OP_PUSH;
+    }
+    else if (strcmp(symbol, "pop") == 0)
+    {
+        return HEX_OP_POP;
+    }
+    else if (strcmp(symbol, "ins") == 0)
+    {
+        return HEX_OP_INS;
+    }
+    else if (strcmp(symbol, "rem") == 0)
+    {
+        return HEX_OP_REM;
+    }
+    else if (strcmp(symbol, "set") == 0)
+    {
+        return HEX_OP_SET;
+    }
+    else if (strcmp(symbol, "reverse") == 0)
+    {
+        return HEX_OP_REVERSE;
+    }
+    else if (strcmp(symbol, "uncons") == 0)
+    {
+        return HEX_OP_UNCONS;
+    }
+    else if (strcmp(symbol, "swons") == 0)
+    {
+        return HEX_OP_SWONS;
+    }
+    else if (strcmp(symbol, "seq") == 0)
+    {
+        return HEX_OP_SEQ;
+    }
+    else if (strcmp(symbol, "lines") == 0)
+    {
+        return HEX_OP_LINES;
+    }
+    else if (strcmp(symbol, "pieces") == 0)
+    {
+        return HEX_OP_PIECES;
+    }
+    else if (strcmp(symbol, "take") == 0)
+    {
+        return HEX_OP_TAKE;
+    }
+    else if (strcmp(symbol, "open") == 0)
+    {
+        return HEX_OP_OPEN;
+    }
+    else if (strcmp(symbol, "close") == 0)
+    {
+        return HEX_OP_CLOSE;
+    }
+    else if (strcmp(symbol, "flush") == 0)
+    {
+        return HEX_OP_FLUSH;
+    }
+    else if (strcmp(symbol, "readl") == 0)
+    {
+        return HEX_OP_READL;
+    }
+    else if (strcmp(symbol, "readb") == 0)
+    {
+        return HEX_OP_READB;
+    }
+    else if (strcmp(symbol, "eof") == 0)
+    {
+        return HEX_OP_EOF;
+    }
+    else if (strcmp(symbol, "ints") == 0)
+    {
+        return HEX_OP_INTS;
+    }
+    else if (strcmp(symbol, "memo") == 0)
+    {
+        return HEX_OP_MEMO;
+    }
+    else if (strcmp(symbol, "memostats") == 0)
+    {
+        return HEX_OP_MEMOSTATS;
+    }
     return 0;
 }
 
@@ -396,6 +560,88 @@ const char *hex_opcode_to_symbol(uint8_t opcode)
         return "run";
     case HEX_OP_TIMESTAMP:
         return "timestamp";
+    case HEX_OP_GSUB:
+        return "gsub";
+    case HEX_OP_FMT:
+        return "fmt";
+    case HEX_OP_BEGINS:
+        return "begins";
+    case HEX_OP_ENDS:
+        return "ends";
+    case HEX_OP_VEC:
+        return "vec";
+    case HEX_OP_SUM:
+        return "sum";
+    case HEX_OP_MIN:
+        return "min";
+    case HEX_OP_MAX:
+        return "max";
+    case HEX_OP_DICT:
+        return "dict";
+    case HEX_OP_PUT:
+        return "put";
+    case HEX_OP_HAS:
+        return "has";
+    case HEX_OP_DEL:
+        return "del";
+    case HEX_OP_KEYS:
+        return "keys";
+    case HEX_OP_SORT:
+        return "sort";
+    case HEX_OP_SORTBY:
+        return "sortby";
+    case HEX_OP_EACH:
+        return "each";
+    case HEX_OP_FILTER:
+        return "filter";
+    case HEX_OP_FOLD:
+        return "fold";
+    case HEX_OP_TIMES:
+        return "times";
+    case HEX_OP_RANGE:
+        return "range";
+    case HEX_OP_PUSH:
+        return "push";
+    case HEX_OP_POP:
+        return "pop";
+    case HEX_OP_INS:
+        return "ins";
+    case HEX_OP_REM:
+        return "rem";
+    case HEX_OP_SET:
+        return "set";
+    case HEX_OP_REVERSE:
+        return "reverse";
+    case HEX_OP_UNCONS:
+        return "uncons";
+    case HEX_OP_SWONS:
+        return "swons";
+    case HEX_OP_SEQ:
+        return "seq";
+    case HEX_OP_LINES:
+        return "lines";
+    case HEX_OP_PIECES:
+        return "pieces";
+    case HEX_OP_TAKE:
+        return "take";
+    case HEX_OP_OPEN:
+        return "open";
+    case HEX_OP_CLOSE:
+        return "close";
+    case HEX_OP_FLUSH:
+        return "flush";
+    case HEX_OP_READL:
+        return "readl";
+    case HEX_OP_READB:
+        return "readb";
+    case HEX_OP_EOF:
+        return "eof";
+    case HEX_OP_INTS:
+        return "ints";
+    case HEX_OP_MEMO:
+        return "memo";
+    case HEX_OP_MEMOSTATS:
+        return "memostats";
     default:
         return NULL;
     }
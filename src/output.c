@@ -0,0 +1,247 @@
+#ifndef HEX_H
+#include "hex.h"
+#endif
+
+// Output written by puts, print and warn is collected in a buffer per stream and
+// written with a single fwrite when the buffer is full or flushed: explicitly,
+// before reading from stdin, before running other programs, before errors are
+// printed and when the program exits. Output to a terminal is also flushed at
+// each newline.
+
+void hex_output_init(hex_output_t *out, FILE *stream)
+{
+    out->stream = stream;
+    out->size = 0;
+    out->line_buffered = isatty(fileno(stream));
+}
+
+// Write the buffered output to the stream, without flushing the stream itself
+static int hex_output_drain(hex_output_t *out)
+{
+    size_t size = out->size;
+    out->size = 0;
+    return size > 0 && fwrite(out->data, 1, size, out->stream) != size;
+}
+
+int hex_output_flush(hex_output_t *out)
+{
+    int result = hex_output_drain(out);
+    if (fflush(out->stream) != 0)
+    {
+        result = 1;
+    }
+    return result;
+}
+
+void hex_output_write(hex_output_t *out, const char *data, size_t size)
+{
+    if (out->size + size > HEX_OUTPUT_BUFFER_SIZE)
+    {
+        hex_output_drain(out);
+    }
+    if (size >= HEX_OUTPUT_BUFFER_SIZE)
+    {
+        fwrite(data, 1, size, out->stream);
+    }
+    else
+    {
+        memcpy(out->data + out->size, data, size);
+        out->size += size;
+    }
+    if (out->line_buffered && memchr(data, '\n', size))
+    {
+        hex_output_flush(out);
+    }
+}
+
+void hex_output_char(hex_output_t *out, char c)
+{
+    if (out->size == HEX_OUTPUT_BUFFER_SIZE)
+    {
+        hex_output_drain(out);
+    }
+    out->data[out->size++] = c;
+    if (c == '\n' && out->line_buffered)
+    {
+        hex_output_flush(out);
+    }
+}
+
+// Write an integer in hex notation ($ followed by hexadecimal digits, like printf's %x)
+void hex_output_integer(hex_output_t *out, int32_t value)
+{
+    char text[HEX_INTEGER_TEXT_SIZE];
+    char *start = hex_format_hex((uint32_t)value, text + sizeof(text));
+    *--start = '$';
+    hex_output_write(out, start, text + sizeof(text) - start);
+}
+
+// Write a string as a string literal, copying the runs of characters that do not
+// need to be escaped in bulk
+void hex_output_string(hex_output_t *out, const char *value, size_t size)
+{
+    hex_output_char(out, '"');
+    size_t i = 0;
+    while (i < size)
+    {
+        size_t run = hex_plain_span(value + i, size - i);
+        hex_output_write(out, value + i, run);
+        i += run;
+        if (i == size)
+        {
+            break;
+        }
+        const char *escape = NULL;
+        switch (value[i])
+        {
+        case '\n':
+            escape = "\\n";
+            break;
+        case '\t':
+            escape = "\\t";
+            break;
+        case '\r':
+            escape = "\\r";
+            break;
+        case '\b':
+            escape = "\\b";
+            break;
+        case '\f':
+            escape = "\\f";
+            break;
+        case '\v':
+            escape = "\\v";
+            break;
+        case '\\':
+            escape = "\\\\";
+            break;
+        case '\"':
+            escape = "\\\"";
+            break;
+        }
+        if (escape)
+        {
+            hex_output_write(out, escape, 2);
+        }
+        else
+        {
+            hex_output_char(out, value[i]); // Other control characters and non-ASCII bytes
+        }
+        i++;
+    }
+    hex_output_char(out, '"');
+}
+
+// Write an item in its literal form; if raw is set, a string is written as is
+void hex_output_item(hex_output_t *out, hex_item_t *item, int raw)
+{
+    switch (item->type)
+    {
+    case HEX_TYPE_INTEGER:
+        hex_output_integer(out, item->data.int_value);
+        break;
+
+    case HEX_TYPE_STRING:
+        if (raw)
+        {
+            hex_output_write(out, item->data.str_value, item->str_size);
+        }
+        else
+        {
+            hex_output_string(out, item->data.str_value, item->str_size);
+        }
+        break;
+
+    case HEX_TYPE_USER_SYMBOL:
+    case HEX_TYPE_NATIVE_SYMBOL:
+        hex_output_write(out, item->token->value, strlen(item->token->value));
+        break;
+
+    case HEX_TYPE_QUOTATION:
+        hex_output_char(out, '(');
+        for (size_t i = 0; i < item->quotation_size; i++)
+        {
+            if (i > 0)
+            {
+                hex_output_char(out, ' ');
+            }
+            hex_output_item(out, item->data.quotation_value[i], 0);
+        }
+        hex_output_char(out, ')');
+        break;
+
+    case HEX_TYPE_BUFFER:
+        // Buffers are written like a quotation of their bytes
+        hex_output_char(out, '(');
+        for (size_t i = 0; i < item->str_size; i++)
+        {
+            if (i > 0)
+            {
+                hex_output_char(out, ' ');
+            }
+            hex_output_integer(out, item->data.buffer_value[i]);
+        }
+        hex_output_char(out, ')');
+        break;
+
+    case HEX_TYPE_VECTOR:
+        // Vectors are written like a quotation of their integers
+        hex_output_char(out, '(');
+        for (size_t i = 0; i < item->quotation_size; i++)
+        {
+            if (i > 0)
+            {
+                hex_output_char(out, ' ');
+            }
+            hex_output_integer(out, item->data.vector_value[i]);
+        }
+        hex_output_char(out, ')');
+        break;
+
+    case HEX_TYPE_DICTIONARY:
+    {
+        // Dictionaries are written like a quotation of key and value pairs, in insertion order
+        const hex_dict_t *dict = item->data.dict_value;
+        int first = 1;
+        hex_output_char(out, '(');
+        for (size_t i = 0; i < dict->count; i++)
+        {
+            if (!dict->entries[i].key)
+            {
+                continue;
+            }
+            hex_output_write(out, first ? "(" : " (", first ? 1 : 2);
+            hex_output_item(out, dict->entries[i].key, 0);
+            hex_output_char(out, ' ');
+            hex_output_item(out, dict->entries[i].value, 0);
+            hex_output_char(out, ')');
+            first = 0;
+        }
+        hex_output_char(out, ')');
+        break;
+    }
+
+    case HEX_TYPE_SEQUENCE:
+        hex_output_write(out, "<sequence>", 10);
+        break;
+
+    case HEX_TYPE_INVALID:
+        hex_output_write(out, "<invalid>", 9);
+        break;
+
+    default:
+    {
+        char text[32];
+        int size = snprintf(text, sizeof(text), "<unknown:%d>", item->type);
+        hex_output_write(out, text, (size_t)size);
+        break;
+    }
+    }
+}
+
+// Flush the standard output and error buffers of a context
+void hex_flush_output(hex_context_t *ctx)
+{
+    hex_output_flush(&ctx->out);
+    hex_output_flush(&ctx->err);
+}
@@ -112,10 +112,11 @@ hex_token_t *hex_next_token(hex_context_t *ctx, const char **input, hex_file_pos
                 len++;
                 position->column += 2;
             }
-            if (*ptr == '\\' && *(ptr + 1) == '\\')
+            else if (*ptr == '\\' && *(ptr + 1) == '\\')
             {
+                // Kept escaped in the token, expanded when the string item is created
                 ptr += 2;
-                len++;
+                len += 2;
                 position->column += 2;
             }
             else if (*ptr == '"')
@@ -250,13 +251,9 @@ int hex_valid_native_symbol(hex_context_t *ctx, const char *symbol)
 
 int32_t hex_parse_integer(const char *hex_str)
 {
-    // Skip the "$" prefix
-    const char *digits = hex_str + 1;
-    // Parse the hexadecimal string as an unsigned 32-bit integer
-    uint32_t unsigned_value = (uint32_t)strtoul(digits, NULL, 16);
-
-    // Cast the unsigned value to a signed 32-bit integer
-    return (int32_t)unsigned_value;
+    // Skip the "$" prefix and parse the digits as an unsigned 32-bit integer
+    const char *end;
+    return (int32_t)hex_parse_hex_digits(hex_str + 1, &end);
 }
 
 // Helper function to clean up quotation parsing resources
@@ -322,7 +319,7 @@ int hex_parse_quotation(hex_context_t *ctx, const char **input, hex_item_t *resu
         }
         else if (token->type == HEX_TOKEN_STRING)
         {
-            item = hex_string_item(ctx, token->value);
+            item = hex_string_literal_item(ctx, token->value);
             hex_free_token(token); // Token no longer needed for strings
             token = NULL;          // Prevent double-free in cleanup
         }
@@ -333,14 +330,13 @@ int hex_parse_quotation(hex_context_t *ctx, const char **input, hex_item_t *resu
                 item = calloc(1, sizeof(hex_item_t));
                 if (item)
                 {
-                    hex_item_t *value = calloc(1, sizeof(hex_item_t));
-                    if (hex_get_symbol(ctx, token->value, value))
+                    const hex_native_t *native = hex_get_native_symbol(ctx, token->value);
+                    if (native)
                     {
                         item->type = HEX_TYPE_NATIVE_SYMBOL;
-                        item->data.fn_value = value->data.fn_value;
+                        item->data.native_value = native;
                         item->token = token;
                         token = NULL; // Token is now owned by item, prevent double-free
-                        free(value);  // wrapper only
                     }
                     else
                     {
@@ -184,6 +184,12 @@ int hex_set_symbol(hex_context_t *ctx, const char *key, hex_item_t *value, int n
         hex_registry_resize(ctx);
     }
 
+    if (hex_string_store(value) != 0)
+    {
+        hex_error(ctx, "[set symbol] Failed to store string value for '%s'", key);
+        return 1;
+    }
+
     size_t bucket_index = hash_function(key, registry->bucket_count);
     hex_registry_entry_t *entry = registry->buckets[bucket_index];
 
@@ -195,6 +201,7 @@ int hex_set_symbol(hex_context_t *ctx, const char *key, hex_item_t *value, int n
             // Key already exists, update its value
             hex_item_t *old_value = entry->value;
             entry->value = value;          // Assign new value first
+            hex_string_unstore(old_value);
             hex_free_item(ctx, old_value); // Then free old value
             return 0;
         }
@@ -218,8 +225,9 @@ int hex_set_symbol(hex_context_t *ctx, const char *key, hex_item_t *value, int n
     return 0;
 }
 
-void hex_set_native_symbol(hex_context_t *ctx, const char *name, int (*func)(hex_context_t *))
+void hex_set_native_symbol(hex_context_t *ctx, const hex_native_t *native)
 {
+    const char *name = native->name;
     hex_item_t *func_item = calloc(1, sizeof(hex_item_t));
     if (func_item == NULL)
     {
@@ -227,7 +235,7 @@ void hex_set_native_symbol(hex_context_t *ctx, const char *name, int (*func)(hex
         return;
     }
     func_item->type = HEX_TYPE_NATIVE_SYMBOL;
-    func_item->data.fn_value = func;
+    func_item->data.native_value = native;
     // Need to create a fake token for native symbols as well.
     func_item->token = calloc(1, sizeof(hex_token_t));
     func_item->token->type = HEX_TOKEN_SYMBOL;
@@ -268,6 +276,28 @@ int hex_get_symbol(hex_context_t *ctx, const char *key, hex_item_t *result)
     return 0;
 }
 
+// Look up the signature of a native symbol without copying its registry entry
+const hex_native_t *hex_get_native_symbol(hex_context_t *ctx, const char *key)
+{
+    hex_registry_t *registry = ctx->registry;
+    size_t bucket_index = hash_function(key, registry->bucket_count);
+
+    hex_registry_entry_t *entry = registry->buckets[bucket_index];
+    while (entry != NULL)
+    {
+        if (strcmp(entry->key, key) == 0)
+        {
+            if (entry->value->type != HEX_TYPE_NATIVE_SYMBOL)
+            {
+                return NULL;
+            }
+            return entry->value->data.native_value;
+        }
+        entry = entry->next;
+    }
+    return NULL;
+}
+
 int hex_delete_symbol(hex_context_t *ctx, const char *key)
 {
     hex_registry_t *registry = ctx->registry;
@@ -291,6 +321,7 @@ int hex_delete_symbol(hex_context_t *ctx, const char *key)
             }
 
             free(entry->key);
+            hex_string_unstore(entry->value);
             hex_free_item(ctx, entry->value);
             free(entry);
             registry->size--;
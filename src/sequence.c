@@ -0,0 +1,37 @@
+#ifndef HEX_H
+#include "hex.h"
+#endif
+
+// Sequences are created by natives and advanced by them, one item at a time (see
+// the sequence symbols). This file manages their storage: a sequence keeps the
+// resources it reads from, like an open file or a string to split, until it is
+// released by the last item that references it.
+
+hex_seq_t *hex_seq_create(hex_seq_kind_t kind)
+{
+    hex_seq_t *seq = (hex_seq_t *)calloc(1, sizeof(hex_seq_t));
+    if (seq)
+    {
+        seq->refs = 1;
+        seq->kind = kind;
+    }
+    return seq;
+}
+
+// Release a reference to a sequence, freeing it and its resources with the last one
+void hex_seq_release(hex_context_t *ctx, hex_seq_t *seq)
+{
+    if (!seq || --seq->refs > 0)
+    {
+        return;
+    }
+    if (seq->file)
+    {
+        fclose(seq->file);
+    }
+    HEX_FREE(ctx, seq->string);
+    HEX_FREE(ctx, seq->separator);
+    HEX_FREE(ctx, seq->action);
+    hex_seq_release(ctx, seq->source);
+    free(seq);
+}
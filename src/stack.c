@@ -34,6 +34,39 @@ void hex_free_token(hex_token_t *token)
     free(token); // Free the token itself
 }
 
+// Check the operands of a native symbol against its signature, then call it.
+// On failure the operands are consumed, as the native itself would have done.
+static int hex_call_native(hex_context_t *ctx, const hex_native_t *native)
+{
+    hex_stack_t *stack = ctx->stack;
+    int base = stack->top - native->arity + 1;
+    int valid = 1;
+    if (base < 0)
+    {
+        hex_error(ctx, "[symbol %s] Insufficient items on the stack", native->name);
+        base = 0;
+        valid = 0;
+    }
+    for (int i = 0; valid && i < native->arity; i++)
+    {
+        if (!(native->types[i] & (1 << stack->entries[base + i]->type)))
+        {
+            hex_error(ctx, "[symbol %s] %s", native->name, native->errors[i]);
+            valid = 0;
+        }
+    }
+    if (valid)
+    {
+        return native->fn(ctx);
+    }
+    while (stack->top >= base)
+    {
+        hex_free_item(ctx, stack->entries[stack->top]);
+        stack->entries[stack->top--] = NULL;
+    }
+    return 1;
+}
+
 // Push functions
 int hex_push(hex_context_t *ctx, hex_item_t *item)
 {
@@ -42,6 +75,7 @@ int hex_push(hex_context_t *ctx, hex_item_t *item)
         hex_error(ctx, "[push] Stack overflow");
         return 1;
     }
+    hex_check_interrupt(ctx);
     hex_debug_item(ctx, "PUSH", item);
     int result = 0;
 
@@ -87,24 +121,22 @@ int hex_push(hex_context_t *ctx, hex_item_t *item)
     }
     else if (item->type == HEX_TYPE_NATIVE_SYMBOL)
     {
-        hex_item_t *value = calloc(1, sizeof(hex_item_t));
-        if (value == NULL)
+        const hex_native_t *native = item->data.native_value;
+        if (native == NULL)
         {
-            hex_error(ctx, "[push] Failed to allocate memory for value");
-            return 1;
+            native = hex_get_native_symbol(ctx, item->token->value);
         }
-        if (hex_get_symbol(ctx, item->token->value, value))
+        if (native != NULL)
         {
             add_to_stack_trace(ctx, item->token);
             hex_debug_item(ctx, "CALL", item);
-            result = value->data.fn_value(ctx);
+            result = hex_call_native(ctx, native);
         }
         else
         {
             hex_error(ctx, "[push] Undefined native symbol: %s", item->token->value);
             result = 1;
         }
-        hex_free_item(ctx, value); // Free the temporary value
     }
     else
     {
@@ -122,7 +154,28 @@ int hex_push(hex_context_t *ctx, hex_item_t *item)
     return result;
 }
 
+// Create a string item holding a copy of a runtime value, as is
 hex_item_t *hex_string_item(hex_context_t *ctx, const char *value)
+{
+    return hex_string_bytes_item(ctx, value, strlen(value));
+}
+
+// Create a string item holding a copy of the given bytes
+hex_item_t *hex_string_bytes_item(hex_context_t *ctx, const char *value, size_t size)
+{
+    char *str = malloc(size + 1);
+    if (str == NULL)
+    {
+        hex_error(ctx, "[create string] Failed to allocate memory for string");
+        return NULL;
+    }
+    memcpy(str, value, size);
+    str[size] = '\0';
+    return hex_string_buffer_item(ctx, str, size);
+}
+
+// Create a string item from the contents of a string literal, expanding escape sequences
+hex_item_t *hex_string_literal_item(hex_context_t *ctx, const char *value)
 {
     char *str = hex_process_string(value);
     if (str == NULL)
@@ -130,18 +183,26 @@ hex_item_t *hex_string_item(hex_context_t *ctx, const char *value)
         hex_error(ctx, "[create string] Failed to allocate memory for string");
         return NULL;
     }
+    return hex_string_buffer_item(ctx, str, strlen(str));
+}
+
+// Create a string item taking ownership of a NUL-terminated buffer of known size.
+// The buffer is freed if the item cannot be created.
+hex_item_t *hex_string_buffer_item(hex_context_t *ctx, char *buffer, size_t size)
+{
     hex_item_t *item = calloc(1, sizeof(hex_item_t));
     if (item == NULL)
     {
         hex_error(ctx, "[create string] Failed to allocate memory for item");
-        free(str);
+        free(buffer);
         return NULL;
     }
     item->type = HEX_TYPE_STRING;
-    item->data.str_value = str;
+    item->data.str_value = buffer;
     item->is_operator = 0;
     item->token = NULL;
     item->quotation_size = 0;
+    item->str_size = size;
     return item;
 }
 
@@ -178,6 +239,83 @@ hex_item_t *hex_quotation_item(hex_context_t *ctx, hex_item_t **quotation, size_
     return item;
 }
 
+// Create a buffer item taking ownership of an array of bytes.
+// The array is freed if the item cannot be created.
+hex_item_t *hex_buffer_item(hex_context_t *ctx, uint8_t *data, size_t size)
+{
+    hex_item_t *item = calloc(1, sizeof(hex_item_t));
+    if (item == NULL)
+    {
+        hex_error(ctx, "[create buffer] Failed to allocate memory for item");
+        free(data);
+        return NULL;
+    }
+    item->type = HEX_TYPE_BUFFER;
+    item->data.buffer_value = data;
+    item->is_operator = 0;
+    item->token = NULL;
+    item->quotation_size = 0;
+    item->str_size = size;
+    return item;
+}
+
+// Create a vector item taking ownership of an array of integers.
+// The array is freed if the item cannot be created.
+hex_item_t *hex_vector_item(hex_context_t *ctx, int32_t *values, size_t size)
+{
+    hex_item_t *item = calloc(1, sizeof(hex_item_t));
+    if (item == NULL)
+    {
+        hex_error(ctx, "[create vector] Failed to allocate memory for item");
+        free(values);
+        return NULL;
+    }
+    item->type = HEX_TYPE_VECTOR;
+    item->data.vector_value = values;
+    item->is_operator = 0;
+    item->token = NULL;
+    item->quotation_size = size;
+    return item;
+}
+
+// Create a dictionary item taking ownership of a dictionary.
+// The dictionary is destroyed if the item cannot be created.
+hex_item_t *hex_dict_item(hex_context_t *ctx, hex_dict_t *dict)
+{
+    hex_item_t *item = calloc(1, sizeof(hex_item_t));
+    if (item == NULL)
+    {
+        hex_error(ctx, "[create dictionary] Failed to allocate memory for item");
+        hex_dict_release(ctx, dict);
+        return NULL;
+    }
+    item->type = HEX_TYPE_DICTIONARY;
+    item->data.dict_value = dict;
+    item->is_operator = 0;
+    item->token = NULL;
+    item->quotation_size = 0;
+    return item;
+}
+
+// Create a sequence item taking ownership of a sequence.
+// The sequence is released if the item cannot be created.
+hex_item_t *hex_seq_item(hex_context_t *ctx, hex_seq_t *seq)
+{
+    hex_item_t *item = calloc(1, sizeof(hex_item_t));
+    if (item == NULL)
+    {
+        hex_error(ctx, "[create sequence] Failed to allocate memory for item");
+        hex_seq_release(ctx, seq);
+        return NULL;
+    }
+    item->type = HEX_TYPE_SEQUENCE;
+    item->data.seq_value = seq;
+    item->is_operator = 0;
+    item->token = NULL;
+    item->quotation_size = 0;
+    return item;
+}
+
 hex_item_t *hex_symbol_item(hex_context_t *ctx, hex_token_t *token)
 {
     hex_item_t *item = calloc(1, sizeof(hex_item_t));
@@ -187,6 +325,10 @@ hex_item_t *hex_symbol_item(hex_context_t *ctx, hex_token_t *token)
         return NULL;
     }
     item->type = hex_valid_native_symbol(ctx, token->value) ? HEX_TYPE_NATIVE_SYMBOL : HEX_TYPE_USER_SYMBOL;
+    if (item->type == HEX_TYPE_NATIVE_SYMBOL)
+    {
+        item->data.native_value = hex_get_native_symbol(ctx, token->value);
+    }
 
     // Make a copy of the token for this item to ensure clear ownership
     item->token = hex_copy_token(ctx, token);
@@ -213,6 +355,17 @@ int hex_push_string(hex_context_t *ctx, const char *value)
     return result;
 }
 
+int hex_push_string_buffer(hex_context_t *ctx, char *buffer, size_t size)
+{
+    hex_item_t *item = hex_string_buffer_item(ctx, buffer, size);
+    if (item == NULL)
+    {
+        return 1;
+    }
+    int result = HEX_PUSH(ctx, item);
+    return result;
+}
+
 int hex_push_integer(hex_context_t *ctx, int value)
 {
     hex_item_t *item = hex_integer_item(ctx, value);
@@ -235,6 +388,50 @@ int hex_push_quotation(hex_context_t *ctx, hex_item_t **quotation, size_t size)
     return result;
 }
 
+int hex_push_buffer(hex_context_t *ctx, uint8_t *data, size_t size)
+{
+    hex_item_t *item = hex_buffer_item(ctx, data, size);
+    if (item == NULL)
+    {
+        return 1;
+    }
+    int result = HEX_PUSH(ctx, item);
+    return result;
+}
+
+int hex_push_vector(hex_context_t *ctx, int32_t *values, size_t size)
+{
+    hex_item_t *item = hex_vector_item(ctx, values, size);
+    if (item == NULL)
+    {
+        return 1;
+    }
+    int result = HEX_PUSH(ctx, item);
+    return result;
+}
+
+int hex_push_dict(hex_context_t *ctx, hex_dict_t *dict)
+{
+    hex_item_t *item = hex_dict_item(ctx, dict);
+    if (item == NULL)
+    {
+        return 1;
+    }
+    int result = HEX_PUSH(ctx, item);
+    return result;
+}
+
+int hex_push_seq(hex_context_t *ctx, hex_seq_t *seq)
+{
+    hex_item_t *item = hex_seq_item(ctx, seq);
+    if (item == NULL)
+    {
+        return 1;
+    }
+    int result = HEX_PUSH(ctx, item);
+    return result;
+}
+
 int hex_push_symbol(hex_context_t *ctx, hex_token_t *token)
 {
     hex_item_t *item = hex_symbol_item(ctx, token);
@@ -271,16 +468,21 @@ hex_item_t *hex_pop(hex_context_t *ctx)
         return item;
     }
 
-    hex_item_t *orig_item = ctx->stack->entries[ctx->stack->top];
+    // Ownership of the item is transferred to the caller
+    hex_item_t *item = ctx->stack->entries[ctx->stack->top];
     ctx->stack->entries[ctx->stack->top] = NULL; // Clear the stack reference
     ctx->stack->top--;
-
-    // Copying the item to avoid ownership issues when freeing
-    hex_item_t *item = hex_copy_item(ctx, orig_item);
+    item->hash = 0; // Natives can modify the items they pop in place
     hex_debug_item(ctx, " POP", item);
     return item;
 }
 
+static void hex_share_free(hex_share_t *share)
+{
+    free(share->index);
+    free(share);
+}
+
 void hex_free_list(hex_context_t *ctx, hex_item_t **quotation, size_t size)
 {
     if (!quotation)
@@ -312,6 +514,19 @@ void hex_free_item(hex_context_t *ctx, hex_item_t *item)
     switch (item->type)
     {
     case HEX_TYPE_STRING:
+        if (item->share)
+        {
+            // The bytes are freed with the last reference to them
+            if (--item->share->refs > 0)
+            {
+                item->data.str_value = NULL;
+            }
+            else
+            {
+                hex_share_free(item->share);
+            }
+            item->share = NULL;
+        }
         if (item->data.str_value)
         {
             hex_debug_item(ctx, "FREE", item);
@@ -320,7 +535,40 @@ void hex_free_item(hex_context_t *ctx, hex_item_t *item)
         }
         break;
 
+    case HEX_TYPE_BUFFER:
+        free(item->data.buffer_value);
+        item->data.buffer_value = NULL;
+        break;
+
+    case HEX_TYPE_VECTOR:
+        free(item->data.vector_value);
+        item->data.vector_value = NULL;
+        break;
+
+    case HEX_TYPE_DICTIONARY:
+        hex_dict_release(ctx, item->data.dict_value);
+        item->data.dict_value = NULL;
+        break;
+
+    case HEX_TYPE_SEQUENCE:
+        hex_seq_release(ctx, item->data.seq_value);
+        item->data.seq_value = NULL;
+        break;
+
     case HEX_TYPE_QUOTATION:
+        if (item->share)
+        {
+            // The items are freed with the last reference to them
+            if (--item->share->refs > 0)
+            {
+                item->data.quotation_value = NULL;
+            }
+            else
+            {
+                hex_share_free(item->share);
+            }
+            item->share = NULL;
+        }
         if (item->data.quotation_value)
         {
             hex_debug(ctx, "FREE: freeing quotation (%zu items)", item->quotation_size);
@@ -477,15 +725,50 @@ hex_item_t *hex_copy_item(hex_context_t *ctx, const hex_item_t *item)
         break;
 
     case HEX_TYPE_STRING:
-        if (item->data.str_value)
+        if (item->share && item->str_size < item->share->used && item->share->refs == 1)
+        {
+            // No other item uses the bytes appended after the string any more
+            item->data.str_value[item->str_size] = '\0';
+            item->share->used = item->str_size;
+        }
+        if (item->data.str_value && (!item->share || item->str_size == item->share->used))
+        {
+            // The bytes are shared, and copied only when modified
+            if (!item->share)
+            {
+                hex_share_t *share = (hex_share_t *)calloc(1, sizeof(hex_share_t));
+                if (!share)
+                {
+                    hex_error(ctx, "[copy item] Failed to share string value");
+                    free(copy);
+                    return NULL;
+                }
+                share->refs = 1;
+                share->used = item->str_size;
+                ((hex_item_t *)item)->share = share;
+            }
+            item->share->refs++;
+            copy->share = item->share;
+            copy->data.str_value = item->data.str_value;
+            copy->str_size = item->str_size;
+            copy->str_capacity = item->str_capacity;
+            copy->hash = item->hash;
+        }
+        else if (item->data.str_value)
         {
-            copy->data.str_value = strdup(item->data.str_value); // Deep copy the string
+            // The string is a prefix of bytes appended to by another item, and is not
+            // terminated: copy it
+            copy->data.str_value = malloc(item->str_size + 1); // Deep copy the string
             if (!copy->data.str_value)
             {
                 hex_free_item(ctx, copy);
                 hex_error(ctx, "[copy item] Failed to copy string value");
                 return NULL;
             }
+            memcpy(copy->data.str_value, item->data.str_value, item->str_size);
+            copy->data.str_value[item->str_size] = '\0';
+            copy->str_size = item->str_size;
+            copy->hash = item->hash;
         }
         else
         {
@@ -493,45 +776,68 @@ hex_item_t *hex_copy_item(hex_context_t *ctx, const hex_item_t *item)
         }
         break;
 
-    case HEX_TYPE_QUOTATION:
+    case HEX_TYPE_BUFFER:
+        copy->data.buffer_value = (uint8_t *)malloc(item->str_size > 0 ? item->str_size : 1);
+        if (!copy->data.buffer_value)
+        {
+            hex_free_item(ctx, copy);
+            hex_error(ctx, "[copy item] Failed to copy buffer value");
+            return NULL;
+        }
+        memcpy(copy->data.buffer_value, item->data.buffer_value, item->str_size);
+        copy->str_size = item->str_size;
+        copy->hash = item->hash;
+        break;
+
+    case HEX_TYPE_VECTOR:
+        copy->data.vector_value = (int32_t *)malloc(item->quotation_size > 0 ? item->quotation_size * sizeof(int32_t) : 1);
+        if (!copy->data.vector_value)
+        {
+            hex_free_item(ctx, copy);
+            hex_error(ctx, "[copy item] Failed to copy vector value");
+            return NULL;
+        }
+        memcpy(copy->data.vector_value, item->data.vector_value, item->quotation_size * sizeof(int32_t));
         copy->quotation_size = item->quotation_size;
-        copy->is_operator = item->is_operator;
-        if (item->data.quotation_value)
+        copy->hash = item->hash;
+        break;
+
+    case HEX_TYPE_DICTIONARY:
+        // The dictionary is shared, and copied only when modified
+        copy->data.dict_value = item->data.dict_value;
+        copy->data.dict_value->refs++;
+        break;
+
+    case HEX_TYPE_SEQUENCE:
+        // The sequence is shared, and so is its position
+        copy->data.seq_value = item->data.seq_value;
+        copy->data.seq_value->refs++;
+        break;
+
+    case HEX_TYPE_QUOTATION:
+        // The items are shared, and copied only when modified
+        if (!item->share)
         {
-            copy->data.quotation_value = (hex_item_t **)malloc(item->quotation_size * sizeof(hex_item_t *));
-            if (!copy->data.quotation_value)
+            hex_share_t *share = (hex_share_t *)calloc(1, sizeof(hex_share_t));
+            if (!share)
             {
-                hex_error(ctx, "[copy item] Failed to allocate memory for quotation array");
-                hex_free_item(ctx, copy);
+                hex_error(ctx, "[copy item] Failed to share quotation items");
+                free(copy);
                 return NULL;
             }
-
-            for (size_t i = 0; i < item->quotation_size; ++i)
-            {
-                copy->data.quotation_value[i] = hex_copy_item(ctx, item->data.quotation_value[i]); // Recursively copy each item
-                if (!copy->data.quotation_value[i])
-                {
-                    // Cleanup on failure
-                    hex_error(ctx, "[copy item] Failed to copy quotation item");
-                    // Free already copied items
-                    for (size_t j = 0; j < i; j++)
-                    {
-                        hex_free_item(ctx, copy->data.quotation_value[j]);
-                    }
-                    free(copy->data.quotation_value);
-                    free(copy);
-                    return NULL;
-                }
-            }
-        }
-        else
-        {
-            copy->data.quotation_value = NULL;
+            share->refs = 1;
+            ((hex_item_t *)item)->share = share;
         }
+        item->share->refs++;
+        copy->share = item->share;
+        copy->data.quotation_value = item->data.quotation_value;
+        copy->quotation_size = item->quotation_size;
+        copy->quotation_capacity = item->quotation_capacity;
+        copy->is_operator = item->is_operator;
         break;
 
     case HEX_TYPE_NATIVE_SYMBOL:
-        copy->data.fn_value = item->data.fn_value; // Copy function pointer for native symbols
+        copy->data.native_value = item->data.native_value; // Signatures are static, share them
         break;
 
     case HEX_TYPE_USER_SYMBOL:
@@ -562,3 +868,286 @@ hex_item_t *hex_copy_item(hex_context_t *ctx, const hex_item_t *item)
 
     return copy;
 }
+
+// Get the items of a quotation ready to be modified in place by the holder of the
+// item, copying them if they are shared. The cached hash of the items is dropped.
+int hex_quotation_unshare(hex_context_t *ctx, hex_item_t *item)
+{
+    hex_share_t *share = item->share;
+    if (!share)
+    {
+        return 0;
+    }
+    if (share->refs > 1)
+    {
+        // The copied items share their own items in turn
+        hex_item_t **items = (hex_item_t **)malloc((item->quotation_size > 0 ? item->quotation_size : 1) * sizeof(hex_item_t *));
+        if (!items)
+        {
+            return 1;
+        }
+        for (size_t i = 0; i < item->quotation_size; i++)
+        {
+            items[i] = hex_copy_item(ctx, item->data.quotation_value[i]);
+            if (!items[i])
+            {
+                hex_free_list(ctx, items, i);
+                return 1;
+            }
+        }
+        share->refs--;
+        item->data.quotation_value = items;
+        item->quotation_capacity = 0;
+    }
+    else
+    {
+        hex_share_free(share);
+    }
+    item->share = NULL;
+    return 0;
+}
+
+// Get the bytes of a string ready to be modified in place by the holder of the
+// item, copying them if they are shared.
+int hex_string_unshare(hex_item_t *item)
+{
+    hex_share_t *share = item->share;
+    if (!share)
+    {
+        return 0;
+    }
+    if (share->refs > 1)
+    {
+        char *str = (char *)malloc(item->str_size + 1);
+        if (!str)
+        {
+            return 1;
+        }
+        memcpy(str, item->data.str_value, item->str_size);
+        str[item->str_size] = '\0';
+        share->refs--;
+        item->data.str_value = str;
+        item->str_capacity = 0;
+    }
+    else
+    {
+        hex_share_free(share);
+    }
+    item->share = NULL;
+    return 0;
+}
+
+// Count a string stored as the value of a symbol among the registry references
+// to its bytes, which never read past the end of the string.
+int hex_string_store(hex_item_t *item)
+{
+    if (item->type != HEX_TYPE_STRING || !item->data.str_value)
+    {
+        return 0;
+    }
+    if (!item->share)
+    {
+        item->share = (hex_share_t *)calloc(1, sizeof(hex_share_t));
+        if (!item->share)
+        {
+            return 1;
+        }
+        item->share->refs = 1;
+        item->share->used = item->str_size;
+    }
+    item->share->stored++;
+    return 0;
+}
+
+// Stop counting a string removed from the registry among its registry references
+void hex_string_unstore(hex_item_t *item)
+{
+    if (item->type == HEX_TYPE_STRING && item->share)
+    {
+        item->share->stored--;
+    }
+}
+
+// Structural hashes
+
+static uint32_t hex_hash_bytes(uint32_t hash, const void *data, size_t size)
+{
+    // FNV-1a
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t hex_hash_mix(uint32_t hash, uint32_t value)
+{
+    return hex_hash_bytes(hash, &value, sizeof(value));
+}
+
+// Get a hash of an item consistent with hex_equal: equal items have the same hash.
+// Hashes of strings, buffers and vectors are cached in the item, those of
+// quotations with their items. Never returns 0.
+size_t hex_item_hash(hex_item_t *item)
+{
+    uint32_t hash = 2166136261u;
+    switch (item->type)
+    {
+    case HEX_TYPE_INTEGER:
+        hash = hex_hash_mix(hex_hash_mix(hash, HEX_TYPE_INTEGER), (uint32_t)item->data.int_value);
+        break;
+
+    case HEX_TYPE_STRING:
+        if (!item->hash)
+        {
+            item->hash = hex_hash_bytes(hex_hash_mix(hash, HEX_TYPE_STRING), item->data.str_value, item->str_size) | 1;
+        }
+        return item->hash;
+
+    case HEX_TYPE_BUFFER:
+        if (!item->hash)
+        {
+            item->hash = hex_hash_bytes(hex_hash_mix(hash, HEX_TYPE_BUFFER), item->data.buffer_value, item->str_size) | 1;
+        }
+        return item->hash;
+
+    case HEX_TYPE_VECTOR:
+        if (!item->hash)
+        {
+            item->hash = hex_hash_bytes(hex_hash_mix(hash, HEX_TYPE_VECTOR), item->data.vector_value, item->quotation_size * sizeof(int32_t)) | 1;
+        }
+        return item->hash;
+
+    case HEX_TYPE_NATIVE_SYMBOL:
+    case HEX_TYPE_USER_SYMBOL:
+        // Symbols are equal if they have the same name, whatever their kind
+        hash = hex_hash_bytes(hex_hash_mix(hash, HEX_TYPE_NATIVE_SYMBOL), item->token->value, strlen(item->token->value));
+        break;
+
+    case HEX_TYPE_QUOTATION:
+    {
+        if (item->share && item->share->hash)
+        {
+            return item->share->hash;
+        }
+        hash = hex_hash_mix(hash, HEX_TYPE_QUOTATION);
+        for (size_t i = 0; i < item->quotation_size; i++)
+        {
+            hash = hex_hash_mix(hash, (uint32_t)hex_item_hash(item->data.quotation_value[i]));
+        }
+        hash |= 1;
+        if (!item->share)
+        {
+            // Not cached if the shared state cannot be allocated
+            item->share = (hex_share_t *)calloc(1, sizeof(hex_share_t));
+            if (!item->share)
+            {
+                return hash;
+            }
+            item->share->refs = 1;
+        }
+        item->share->hash = hash;
+        return hash;
+    }
+
+    case HEX_TYPE_DICTIONARY:
+    {
+        // Entries are combined regardless of their order
+        const hex_dict_t *dict = item->data.dict_value;
+        uint32_t entries = 0;
+        for (size_t i = 0; i < dict->count; i++)
+        {
+            if (dict->entries[i].key)
+            {
+                entries += hex_hash_mix((uint32_t)hex_item_hash(dict->entries[i].key), (uint32_t)hex_item_hash(dict->entries[i].value));
+            }
+        }
+        hash = hex_hash_mix(hex_hash_mix(hash, HEX_TYPE_DICTIONARY), entries);
+        break;
+    }
+
+    case HEX_TYPE_SEQUENCE:
+    {
+        // Sequences are only equal to their copies
+        uintptr_t seq = (uintptr_t)item->data.seq_value;
+        hash = hex_hash_bytes(hex_hash_mix(hash, HEX_TYPE_SEQUENCE), &seq, sizeof(seq));
+        break;
+    }
+
+    default:
+        hash = hex_hash_mix(hash, item->type);
+        break;
+    }
+    return hash ? hash : 1;
+}
+
+// Lookups in quotations
+
+// Build the hash index of the items of a quotation, in which only the first of
+// equal items is found
+static void hex_quotation_build_index(hex_item_t *list)
+{
+    size_t slots = HEX_DICT_INITIAL_SLOTS;
+    while (slots < list->quotation_size * 2)
+    {
+        slots *= 2;
+    }
+    size_t *index = (size_t *)calloc(slots, sizeof(size_t));
+    if (!index)
+    {
+        return; // The items are scanned instead
+    }
+    hex_item_t **items = list->data.quotation_value;
+    for (size_t i = 0; i < list->quotation_size; i++)
+    {
+        size_t hash = hex_item_hash(items[i]);
+        size_t j = hash & (slots - 1);
+        while (index[j] && !(hex_item_hash(items[index[j] - 1]) == hash && hex_equal(items[index[j] - 1], items[i])))
+        {
+            j = (j + 1) & (slots - 1);
+        }
+        if (!index[j])
+        {
+            index[j] = i + 1;
+        }
+    }
+    list->share->index = index;
+    list->share->index_slots = slots;
+}
+
+// Find the position of the first item of a quotation equal to an item, or -1.
+// Items shared by quotation items and looked up repeatedly are indexed, as they
+// cannot change until they are unshared, which drops the index.
+int hex_quotation_find(hex_item_t *list, hex_item_t *item)
+{
+    hex_share_t *share = list->share;
+    hex_item_t **items = list->data.quotation_value;
+    size_t hash = hex_item_hash(item);
+    if (share && !share->index && list->quotation_size >= HEX_INDEX_MIN_SIZE && ++share->lookups >= HEX_INDEX_LOOKUPS)
+    {
+        hex_quotation_build_index(list);
+    }
+    if (share && share->index)
+    {
+        for (size_t j = hash & (share->index_slots - 1); share->index[j]; j = (j + 1) & (share->index_slots - 1))
+        {
+            hex_item_t *candidate = items[share->index[j] - 1];
+            if (hex_item_hash(candidate) == hash && hex_equal(candidate, item))
+            {
+                return (int)(share->index[j] - 1);
+            }
+        }
+        return -1;
+    }
+    // Items are compared only if their hashes match
+    for (size_t i = 0; i < list->quotation_size; i++)
+    {
+        if (hex_item_hash(items[i]) == hash && hex_equal(items[i], item))
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
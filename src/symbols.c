@@ -11,27 +11,7 @@
 int hex_symbol_store(hex_context_t *ctx)
 {
     HEX_POP(ctx, name);
-    ;
-    if (name->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, name);
-        return 1;
-    }
     HEX_POP(ctx, value);
-    ;
-    if (value->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, name);
-        HEX_FREE(ctx, value);
-        return 1;
-    }
-    if (name->type != HEX_TYPE_STRING)
-    {
-        hex_error(ctx, "[symbol :] Symbol name must be a string");
-        HEX_FREE(ctx, name);
-        HEX_FREE(ctx, value);
-        return 1;
-    }
 
     if (value->type == HEX_TYPE_QUOTATION)
     {
@@ -52,28 +32,7 @@ int hex_symbol_store(hex_context_t *ctx)
 int hex_symbol_define(hex_context_t *ctx)
 {
     HEX_POP(ctx, name);
-    ;
-    if (name->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, name);
-        return 1;
-    }
     HEX_POP(ctx, value);
-    ;
-    if (value->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, name);
-        HEX_FREE(ctx, value);
-        return 1;
-    }
-
-    if (name->type != HEX_TYPE_STRING)
-    {
-        hex_error(ctx, "[symbol ::] Symbol name must be a string");
-        HEX_FREE(ctx, name);
-        HEX_FREE(ctx, value);
-        return 1;
-    }
 
     if (value->type == HEX_TYPE_QUOTATION)
     {
@@ -95,18 +54,6 @@ int hex_symbol_define(hex_context_t *ctx)
 int hex_symbol_free(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    if (item->type != HEX_TYPE_STRING)
-    {
-        HEX_FREE(ctx, item);
-        hex_error(ctx, "[symbol #] Symbol name must be a string");
-        return 1;
-    }
     if (hex_valid_native_symbol(ctx, item->data.str_value))
     {
         hex_error(ctx, "[symbol #] Cannot free native symbol '%s'", item->data.str_value);
@@ -180,12 +127,6 @@ int hex_symbol_symbols(hex_context_t *ctx)
 int hex_symbol_type(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
     int result = hex_push_string(ctx, hex_type(item->type));
     HEX_FREE(ctx, item);
     return result;
@@ -193,21 +134,46 @@ int hex_symbol_type(hex_context_t *ctx)
 
 // Evaluation symbols
 
-int hex_symbol_i(hex_context_t *ctx)
+// Push an item moved out of a quotation: literals are owned by the stack once pushed,
+// while symbols are evaluated and then freed
+static int hex_push_moved(hex_context_t *ctx, hex_item_t *item)
 {
-    HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
+    int symbol = item->type == HEX_TYPE_NATIVE_SYMBOL || item->type == HEX_TYPE_USER_SYMBOL;
+    int result = hex_push(ctx, item);
+    if (symbol || result != 0)
     {
         HEX_FREE(ctx, item);
-        return 1;
     }
-    if (item->type != HEX_TYPE_QUOTATION)
+    return result;
+}
+
+// Dequote a quotation that remains owned by the caller, so that it can be applied
+// repeatedly: only its literals are copied, while its symbols are evaluated in place
+static int hex_apply(hex_context_t *ctx, hex_item_t *quotation)
+{
+    for (size_t i = 0; i < quotation->quotation_size; i++)
     {
-        hex_error(ctx, "[symbol .] Quotation required", hex_type(item->type));
-        HEX_FREE(ctx, item);
-        return 1;
+        hex_item_t *item = quotation->data.quotation_value[i];
+        if (item->type == HEX_TYPE_NATIVE_SYMBOL || item->type == HEX_TYPE_USER_SYMBOL)
+        {
+            if (hex_push(ctx, item) != 0)
+            {
+                return 1;
+            }
+            continue;
+        }
+        hex_item_t *copy = hex_copy_item(ctx, item);
+        if (!copy || hex_push_moved(ctx, copy) != 0)
+        {
+            return 1;
+        }
     }
+    return 0;
+}
+
+int hex_symbol_i(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
     for (size_t i = 0; i < item->quotation_size; i++)
     {
         hex_item_t *copy = hex_copy_item(ctx, item->data.quotation_value[i]);
@@ -225,102 +191,98 @@ int hex_symbol_i(hex_context_t *ctx)
     return 0;
 }
 
-// evaluate a string or bytecode array
+// evaluate a string, a bytecode buffer or a quotation of bytes
 int hex_symbol_eval(hex_context_t *ctx)
 {
     HEX_POP(ctx, file);
     HEX_POP(ctx, item);
-    if (file->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, file);
-        return 1;
-    }
-    if (file->type != HEX_TYPE_STRING)
-    {
-        hex_error(ctx, "[symbol !] File name or scope identifier required");
-        HEX_FREE(ctx, file);
-        return 1;
-    }
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        HEX_FREE(ctx, file);
-        return 1;
-    }
     if (item->type == HEX_TYPE_STRING)
     {
-        int result = hex_interpret(ctx, item->data.str_value, file->data.str_value, 1, 1);
+        // Programs are parsed once and then retrieved from the eval cache
+        hex_compiled_t *compiled = hex_get_compiled(ctx, (const uint8_t *)item->data.str_value, item->str_size, 0, file->data.str_value);
+        int result;
+        if (compiled)
+        {
+            result = hex_run_compiled(ctx, compiled);
+            hex_release_compiled(ctx, compiled);
+        }
+        else
+        {
+            result = hex_interpret(ctx, item->data.str_value, file->data.str_value, 1, 1);
+        }
         HEX_FREE(ctx, item);
         HEX_FREE(ctx, file);
         return result;
     }
-    else if (item->type == HEX_TYPE_QUOTATION)
+    else
     {
-        for (size_t i = 0; i < item->quotation_size; i++)
+        // Buffers are evaluated directly, quotations of bytes are packed first
+        uint8_t *bytecode = item->data.buffer_value;
+        size_t size = item->str_size;
+        uint8_t *packed = NULL;
+        if (item->type == HEX_TYPE_QUOTATION)
         {
-            if (item->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
+            for (size_t i = 0; i < item->quotation_size; i++)
+            {
+                if (item->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
+                {
+                    hex_error(ctx, "[symbol !] Quotation must contain only integers");
+                    HEX_FREE(ctx, item);
+                    HEX_FREE(ctx, file);
+                    return 1;
+                }
+            }
+            packed = (uint8_t *)malloc(item->quotation_size * sizeof(uint8_t));
+            if (!packed)
             {
-                hex_error(ctx, "[symbol !] Quotation must contain only integers");
+                hex_error(ctx, "[symbol !] Memory allocation failed");
                 HEX_FREE(ctx, item);
                 HEX_FREE(ctx, file);
                 return 1;
             }
+            for (size_t i = 0; i < item->quotation_size; i++)
+            {
+                packed[i] = (uint8_t)item->data.quotation_value[i]->data.int_value;
+            }
+            bytecode = packed;
+            size = item->quotation_size;
         }
-        uint8_t *bytecode = (uint8_t *)malloc(item->quotation_size * sizeof(uint8_t));
-        if (!bytecode)
+        // Bytecode images are decoded once and then retrieved from the eval cache
+        hex_compiled_t *compiled = hex_get_compiled(ctx, bytecode, size, 1, file->data.str_value);
+        if (compiled)
         {
-            hex_error(ctx, "[symbol !] Memory allocation failed");
+            int result = hex_run_compiled(ctx, compiled);
+            hex_release_compiled(ctx, compiled);
+            free(packed);
             HEX_FREE(ctx, item);
             HEX_FREE(ctx, file);
-            return 1;
-        }
-        for (size_t i = 0; i < item->quotation_size; i++)
-        {
-            bytecode[i] = (uint8_t)item->data.quotation_value[i]->data.int_value;
+            return result;
         }
-        // Sandbox: save current table pointer; create a working copy to mutate
+        // Sandbox: save current table pointer; create an overlay to mutate
         hex_symbol_table_t *original_table = ctx->symbol_table;
-        hex_symbol_table_t *working_copy = hex_symboltable_copy(ctx);
-        if (!working_copy)
+        hex_symbol_table_t *overlay = hex_symboltable_overlay(ctx);
+        if (!overlay)
         {
-            free(bytecode);
+            free(packed);
             HEX_FREE(ctx, item);
             HEX_FREE(ctx, file);
             return 1;
         }
-        ctx->symbol_table = working_copy;
-        int result = hex_interpret_bytecode(ctx, bytecode, item->quotation_size, file->data.str_value);
-        // Destroy mutated working copy and restore original
+        ctx->symbol_table = overlay;
+        int result = hex_interpret_bytecode(ctx, bytecode, size, file->data.str_value);
+        // Destroy mutated overlay and restore original
         hex_symboltable_destroy(ctx->symbol_table);
         ctx->symbol_table = original_table;
-        free(bytecode);
+        free(packed);
         HEX_FREE(ctx, item);
         HEX_FREE(ctx, file);
         return result;
     }
-    else
-    {
-        hex_error(ctx, "[symbol !] String or a quotation of integers required");
-        HEX_FREE(ctx, item);
-        HEX_FREE(ctx, file);
-        return 1;
-    }
 }
 
 int hex_symbol_debug(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    if (item->type != HEX_TYPE_QUOTATION)
-    {
-        hex_error(ctx, "[symbol debug] Quotation required", hex_type(item->type));
-        HEX_FREE(ctx, item);
-        return 1;
-    }
     ctx->settings->debugging_enabled = 1;
     for (size_t i = 0; i < item->quotation_size; i++)
     {
@@ -346,14 +308,8 @@ int hex_symbol_debug(hex_context_t *ctx)
 int hex_symbol_puts(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    hex_raw_print_item(stdout, *item);
-    printf("\n");
+    hex_output_item(&ctx->out, item, 1);
+    hex_output_char(&ctx->out, '\n');
     HEX_FREE(ctx, item);
     return 0;
 }
@@ -361,14 +317,8 @@ int hex_symbol_puts(hex_context_t *ctx)
 int hex_symbol_warn(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    hex_raw_print_item(stderr, *item);
-    printf("\n");
+    hex_output_item(&ctx->err, item, 1);
+    hex_output_char(&ctx->err, '\n');
     HEX_FREE(ctx, item);
     return 0;
 }
@@ -376,14 +326,7 @@ int hex_symbol_warn(hex_context_t *ctx)
 int hex_symbol_print(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    hex_raw_print_item(stdout, *item);
-    fflush(stdout);
+    hex_output_item(&ctx->out, item, 1);
     HEX_FREE(ctx, item);
     return 0;
 }
@@ -392,6 +335,7 @@ int hex_symbol_gets(hex_context_t *ctx)
 {
     char input[HEX_STDIN_BUFFER_SIZE]; // Buffer to store the input (adjust size if needed)
     char *p = input;
+    hex_flush_output(ctx);
 #if defined(__EMSCRIPTEN__)
     p = em_fgets(input, 1024);
 #else
@@ -413,339 +357,211 @@ int hex_symbol_gets(hex_context_t *ctx)
     }
 }
 
-// Mathematical symbols
-int hex_symbol_add(hex_context_t *ctx)
+// Integer operators work in place: the dispatcher guarantees that the topmost
+// items are integers, so the topmost operand is dropped and the result
+// overwrites the one below it.
+static hex_item_t *hex_integer_operands(hex_context_t *ctx, int32_t *right)
 {
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
+    hex_stack_t *stack = ctx->stack;
+    hex_item_t *top = stack->entries[stack->top];
+    *right = top->data.int_value;
+    HEX_FREE(ctx, top);
+    stack->entries[stack->top--] = NULL;
+    return stack->entries[stack->top];
+}
+
+static int hex_integer_operands_available(hex_context_t *ctx)
+{
+    hex_stack_t *stack = ctx->stack;
+    return stack->top >= 1 && stack->entries[stack->top]->type == HEX_TYPE_INTEGER && stack->entries[stack->top - 1]->type == HEX_TYPE_INTEGER;
+}
+
+static int hex_vector_operands_available(hex_context_t *ctx)
+{
+    hex_stack_t *stack = ctx->stack;
+    if (stack->top < 1)
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        return 0;
     }
+    hex_item_type_t a = stack->entries[stack->top - 1]->type;
+    hex_item_type_t b = stack->entries[stack->top]->type;
+    return (a == HEX_TYPE_VECTOR && (b == HEX_TYPE_VECTOR || b == HEX_TYPE_INTEGER)) ||
+           (b == HEX_TYPE_VECTOR && a == HEX_TYPE_INTEGER);
+}
+
+// Apply an operator elementwise to a vector and an integer, or to two vectors of the
+// same length. The result is written in place into a vector operand, which is owned
+// by the calling native.
+static int hex_vector_operation(hex_context_t *ctx, hex_opcode_t op, const char *symbol)
+{
+    HEX_POP(ctx, b);
     HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    int a_vector = a->type == HEX_TYPE_VECTOR;
+    int b_vector = b->type == HEX_TYPE_VECTOR;
+    if (a_vector && b_vector && a->quotation_size != b->quotation_size)
     {
+        hex_error(ctx, "[symbol %s] Vectors must have the same length", symbol);
         HEX_FREE(ctx, a);
         HEX_FREE(ctx, b);
         return 1;
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
+    hex_item_t *target = a_vector ? a : b;
+    hex_item_t *other = a_vector ? b : a;
+    hex_vector_apply(op, target->data.vector_value,
+                     a_vector ? a->data.vector_value : &a->data.int_value, a_vector,
+                     b_vector ? b->data.vector_value : &b->data.int_value, b_vector,
+                     target->quotation_size);
+    HEX_FREE(ctx, other);
+    if (HEX_PUSH(ctx, target) != 0)
     {
-        int result = hex_push_integer(ctx, a->data.int_value + b->data.int_value);
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return result;
+        HEX_FREE(ctx, target);
+        return 1;
     }
-    hex_error(ctx, "[symbol +] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
+    return 0;
 }
 
-int hex_symbol_subtract(hex_context_t *ctx)
+static int hex_division_by_zero(hex_context_t *ctx, const char *symbol)
 {
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
+    if (ctx->stack->entries[ctx->stack->top]->data.int_value != 0)
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        return 0;
     }
+    hex_error(ctx, "[symbol %s] Division by zero", symbol);
+    HEX_POP(ctx, b);
     HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
-    }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
-    {
-        int result = hex_push_integer(ctx, a->data.int_value - b->data.int_value);
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return result;
-    }
-    hex_error(ctx, "[symbol -] Two integers required");
     HEX_FREE(ctx, a);
     HEX_FREE(ctx, b);
     return 1;
 }
 
-int hex_symbol_multiply(hex_context_t *ctx)
+// Mathematical symbols
+int hex_symbol_add(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
+    if (!hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        return hex_vector_operation(ctx, HEX_OP_ADD, "+");
     }
-    HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value += b;
+    return 0;
+}
+
+int hex_symbol_subtract(hex_context_t *ctx)
+{
+    if (!hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        return hex_vector_operation(ctx, HEX_OP_SUBTRACT, "-");
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value -= b;
+    return 0;
+}
+
+int hex_symbol_multiply(hex_context_t *ctx)
+{
+    if (!hex_integer_operands_available(ctx))
     {
-        int result = hex_push_integer(ctx, a->data.int_value * b->data.int_value);
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return result;
+        return hex_vector_operation(ctx, HEX_OP_MULTIPLY, "*");
     }
-    hex_error(ctx, "[symbol *] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value *= b;
+    return 0;
 }
 
 int hex_symbol_divide(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, b);
-        return 1;
-    }
-    HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    if (hex_division_by_zero(ctx, "/"))
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
         return 1;
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
-    {
-        if (b->data.int_value == 0)
-        {
-            hex_error(ctx, "[symbol /] Division by zero");
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
-            return 1;
-        }
-        int result = hex_push_integer(ctx, a->data.int_value / b->data.int_value);
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return result;
-    }
-    hex_error(ctx, "[symbol /] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value /= b;
+    return 0;
 }
 
 int hex_symbol_modulo(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
+    if (hex_division_by_zero(ctx, "%"))
     {
-        HEX_FREE(ctx, b);
-        return 1;
-    }
-    HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
         return 1;
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
-    {
-        if (b->data.int_value == 0)
-        {
-            hex_error(ctx, "[symbol %%] Division by zero");
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
-            return 1;
-        }
-        int result = hex_push_integer(ctx, a->data.int_value % b->data.int_value);
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return result;
-    }
-    hex_error(ctx, "[symbol %%] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value %= b;
+    return 0;
 }
 
 // Bit symbols
 
 int hex_symbol_bitand(hex_context_t *ctx)
 {
-    HEX_POP(ctx, right);
-    ;
-    if (right->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, right);
-        return 1;
-    }
-    HEX_POP(ctx, left);
-    ;
-    if (left->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return 1;
-    }
-    if (left->type == HEX_TYPE_INTEGER && right->type == HEX_TYPE_INTEGER)
+    if (!hex_integer_operands_available(ctx))
     {
-        int result = hex_push_integer(ctx, left->data.int_value & right->data.int_value);
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return result;
+        return hex_vector_operation(ctx, HEX_OP_BITAND, "&");
     }
-    hex_error(ctx, "[symbol &] Two integers required");
-    HEX_FREE(ctx, left);
-    HEX_FREE(ctx, right);
-    return 1;
+    int32_t right;
+    hex_item_t *left = hex_integer_operands(ctx, &right);
+    left->data.int_value &= right;
+    return 0;
 }
 
 int hex_symbol_bitor(hex_context_t *ctx)
 {
-    HEX_POP(ctx, right);
-    ;
-    if (right->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, right);
-        return 1;
-    }
-    HEX_POP(ctx, left);
-    ;
-    if (left->type == HEX_TYPE_INVALID)
+    if (!hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return 1;
-    }
-    if (left->type == HEX_TYPE_INTEGER && right->type == HEX_TYPE_INTEGER)
-    {
-        int result = hex_push_integer(ctx, left->data.int_value | right->data.int_value);
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return result;
+        return hex_vector_operation(ctx, HEX_OP_BITOR, "|");
     }
-    hex_error(ctx, "[symbol |] Two integers required");
-    HEX_FREE(ctx, left);
-    HEX_FREE(ctx, right);
-    return 1;
+    int32_t right;
+    hex_item_t *left = hex_integer_operands(ctx, &right);
+    left->data.int_value |= right;
+    return 0;
 }
 
 int hex_symbol_bitxor(hex_context_t *ctx)
 {
-    HEX_POP(ctx, right);
-    if (right->type == HEX_TYPE_INVALID)
+    if (!hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, right);
-        return 1;
+        return hex_vector_operation(ctx, HEX_OP_BITXOR, "^");
     }
-    HEX_POP(ctx, left);
-    if (left->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return 1;
-    }
-    if (left->type == HEX_TYPE_INTEGER && right->type == HEX_TYPE_INTEGER)
-    {
-        int result = hex_push_integer(ctx, left->data.int_value ^ right->data.int_value);
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return result;
-    }
-    hex_error(ctx, "[symbol ^] Two integers required");
-    HEX_FREE(ctx, left);
-    HEX_FREE(ctx, right);
-    return 1;
+    int32_t right;
+    hex_item_t *left = hex_integer_operands(ctx, &right);
+    left->data.int_value ^= right;
+    return 0;
 }
 
 int hex_symbol_shiftleft(hex_context_t *ctx)
 {
-    HEX_POP(ctx, right);
-    ;
-    if (right->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, right);
-        return 1;
-    }
-    HEX_POP(ctx, left);
-    ;
-    if (left->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return 1;
-    }
-    if (left->type == HEX_TYPE_INTEGER && right->type == HEX_TYPE_INTEGER)
+    if (!hex_integer_operands_available(ctx))
     {
-        int result = hex_push_integer(ctx, left->data.int_value << right->data.int_value);
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return result;
+        return hex_vector_operation(ctx, HEX_OP_SHL, "<<");
     }
-    hex_error(ctx, "[symbol <<] Two integers required");
-    HEX_FREE(ctx, left);
-    HEX_FREE(ctx, right);
-    return 1;
+    int32_t right;
+    hex_item_t *left = hex_integer_operands(ctx, &right);
+    left->data.int_value = hex_shift_left(left->data.int_value, right);
+    return 0;
 }
 
 int hex_symbol_shiftright(hex_context_t *ctx)
 {
-    HEX_POP(ctx, right);
-    ;
-    if (right->type == HEX_TYPE_INVALID)
+    if (!hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, right);
-        return 1;
-    }
-    HEX_POP(ctx, left);
-    ;
-    if (left->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return 1;
+        return hex_vector_operation(ctx, HEX_OP_SHR, ">>");
     }
-    if (left->type == HEX_TYPE_INTEGER && right->type == HEX_TYPE_INTEGER)
-    {
-        int result = hex_push_integer(ctx, left->data.int_value >> right->data.int_value);
-        HEX_FREE(ctx, left);
-        HEX_FREE(ctx, right);
-        return result;
-    }
-    hex_error(ctx, "[symbol >>] Two integers required");
-    HEX_FREE(ctx, left);
-    HEX_FREE(ctx, right);
-    return 1;
+    int32_t right;
+    hex_item_t *left = hex_integer_operands(ctx, &right);
+    left->data.int_value = hex_shift_right(left->data.int_value, right);
+    return 0;
 }
 
 int hex_symbol_bitnot(hex_context_t *ctx)
 {
-    HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    if (item->type == HEX_TYPE_INTEGER)
-    {
-        int result = hex_push_integer(ctx, ~item->data.int_value);
-        HEX_FREE(ctx, item);
-        return result;
-    }
-    hex_error(ctx, "[symbol ~] Integer required");
-    HEX_FREE(ctx, item);
-    return 1;
+    hex_item_t *item = ctx->stack->entries[ctx->stack->top];
+    item->data.int_value = ~item->data.int_value;
+    return 0;
 }
 
 // Conversion symbols
@@ -753,152 +569,151 @@ int hex_symbol_bitnot(hex_context_t *ctx)
 int hex_symbol_int(hex_context_t *ctx)
 {
     HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, a);
-        return 1;
-    }
-    if (a->type == HEX_TYPE_STRING)
-    {
-        int result = hex_push_integer(ctx, strtol(a->data.str_value, NULL, 16));
-        HEX_FREE(ctx, a);
-        return result;
-    }
-    hex_error(ctx, "[symbol int] String representing a hexadecimal integer required");
+    int result = hex_push_integer(ctx, hex_parse_number(a->data.str_value, 16));
     HEX_FREE(ctx, a);
-    return 1;
+    return result;
 }
 
 int hex_symbol_str(hex_context_t *ctx)
 {
     HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    char text[HEX_INTEGER_TEXT_SIZE];
+    char *end = text + sizeof(text);
+    char *start = hex_format_hex((uint32_t)a->data.int_value, end);
+    HEX_FREE(ctx, a);
+    hex_item_t *item = hex_string_bytes_item(ctx, start, end - start);
+    if (!item || HEX_PUSH(ctx, item) != 0)
     {
-        HEX_FREE(ctx, a);
+        HEX_FREE(ctx, item);
         return 1;
     }
-    if (a->type == HEX_TYPE_INTEGER)
-    {
-        int result = hex_push_string(ctx, hex_itoa_hex(a->data.int_value));
-        HEX_FREE(ctx, a);
-        return result;
-    }
-    hex_error(ctx, "[symbol str] Integer required");
-    HEX_FREE(ctx, a);
-    return 1;
+    return 0;
 }
 
 int hex_symbol_dec(hex_context_t *ctx)
 {
     HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    char text[HEX_INTEGER_TEXT_SIZE];
+    char *end = text + sizeof(text);
+    char *start = hex_format_decimal(a->data.int_value, end);
+    HEX_FREE(ctx, a);
+    hex_item_t *item = hex_string_bytes_item(ctx, start, end - start);
+    if (!item || HEX_PUSH(ctx, item) != 0)
     {
-        HEX_FREE(ctx, a);
+        HEX_FREE(ctx, item);
         return 1;
     }
-    if (a->type == HEX_TYPE_INTEGER)
-    {
-        char buffer[32];
-        snprintf(buffer, sizeof(buffer), "%d", a->data.int_value);
-        int result = hex_push_string(ctx, buffer);
-        HEX_FREE(ctx, a);
-        return result;
-    }
-    hex_error(ctx, "[symbol dec] Integer required");
-    HEX_FREE(ctx, a);
-    return 1;
+    return 0;
 }
 
 int hex_symbol_hex(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
-    if (item->type == HEX_TYPE_STRING)
-    {
-        int result = hex_push_integer(ctx, strtol(item->data.str_value, NULL, 10));
-        HEX_FREE(ctx, item);
-        return result;
-    }
-    hex_error(ctx, "[symbol hex] String representing a decimal integer required");
+    int result = hex_push_integer(ctx, hex_parse_number(item->data.str_value, 10));
     HEX_FREE(ctx, item);
-    return 1;
+    return result;
 }
 
-int hex_symbol_ord(hex_context_t *ctx)
+// Parse a string of integers separated by whitespace into a vector, in one pass.
+// Integers are decimal, or hexadecimal if prefixed with $, and may be negative.
+int hex_symbol_ints(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
+    const char *p = item->data.str_value;
+    const char *end = p + item->str_size;
+    // Each integer takes at least two bytes, including its separator
+    int32_t *values = (int32_t *)malloc((item->str_size / 2 + 1) * sizeof(int32_t));
+    if (!values)
     {
+        hex_error(ctx, "[symbol ints] Memory allocation failed");
         HEX_FREE(ctx, item);
         return 1;
     }
-    if (item->type == HEX_TYPE_STRING)
+    size_t count = 0;
+    while (1)
     {
-        if (strlen(item->data.str_value) > 1)
+        while (p < end && isspace((unsigned char)*p))
         {
-            int result = hex_push_integer(ctx, -1);
-            HEX_FREE(ctx, item);
-            return result;
+            p++;
         }
-        unsigned char *str = (unsigned char *)item->data.str_value;
-        int result;
-        if (str[0] < 128)
+        if (p == end)
         {
-            result = hex_push_integer(ctx, str[0]);
+            break;
         }
-        else
+        const char *start = p;
+        int negative = *p == '-';
+        if (negative)
+        {
+            p++;
+        }
+        const char *digits = *p == '$' ? p + 1 : p;
+        uint32_t value = *p == '$' ? hex_parse_hex_digits(digits, &p) : hex_parse_decimal_digits(digits, &p);
+        if (p == digits || (p < end && !isspace((unsigned char)*p)))
         {
-            result = hex_push_integer(ctx, -1);
+            char token[32];
+            size_t size = 0;
+            while (start + size < end && !isspace((unsigned char)start[size]) && size < sizeof(token) - 1)
+            {
+                token[size] = start[size];
+                size++;
+            }
+            token[size] = '\0';
+            hex_error(ctx, "[symbol ints] Invalid integer: %s", token);
+            free(values);
+            HEX_FREE(ctx, item);
+            return 1;
         }
+        values[count++] = (int32_t)(negative ? 0u - value : value);
+    }
+    HEX_FREE(ctx, item);
+    return hex_push_vector(ctx, values, count);
+}
+
+int hex_symbol_ord(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
+    if (item->str_size > 1)
+    {
+        int result = hex_push_integer(ctx, -1);
         HEX_FREE(ctx, item);
         return result;
     }
-    hex_error(ctx, "[symbol ord] String required");
+    unsigned char *str = (unsigned char *)item->data.str_value;
+    int result;
+    if (str[0] < 128)
+    {
+        result = hex_push_integer(ctx, str[0]);
+    }
+    else
+    {
+        result = hex_push_integer(ctx, -1);
+    }
     HEX_FREE(ctx, item);
-    return 1;
+    return result;
 }
 
 int hex_symbol_chr(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
+    int result;
+    if (item->data.int_value >= 0 && item->data.int_value < 128)
     {
-        HEX_FREE(ctx, item);
-        return 1;
+        char str[2] = {(char)item->data.int_value, '\0'};
+        result = hex_push_string(ctx, str);
     }
-    if (item->type == HEX_TYPE_INTEGER)
+    else
     {
-        int result;
-        if (item->data.int_value >= 0 && item->data.int_value < 128)
-        {
-            char str[2] = {(char)item->data.int_value, '\0'};
-            result = hex_push_string(ctx, str);
-        }
-        else
-        {
-            result = hex_push_string(ctx, "");
-        }
-        HEX_FREE(ctx, item);
-        return result;
+        result = hex_push_string(ctx, "");
     }
-    hex_error(ctx, "[symbol chr] Integer required");
     HEX_FREE(ctx, item);
-    return 1;
+    return result;
 }
 
 // Comparison symbols
 
-static int hex_equal(hex_item_t *a, hex_item_t *b)
+// Items are compared by value; hashes are only used to tell unequal items apart
+// when they have already been computed for both
+int hex_equal(hex_item_t *a, hex_item_t *b)
 {
     if (a->type == HEX_TYPE_INVALID || b->type == HEX_TYPE_INVALID)
     {
@@ -918,9 +733,53 @@ static int hex_equal(hex_item_t *a, hex_item_t *b)
     {
         return a->data.int_value == b->data.int_value;
     }
+    if ((a->type == HEX_TYPE_STRING || a->type == HEX_TYPE_BUFFER || a->type == HEX_TYPE_VECTOR) && a->hash && b->hash && a->hash != b->hash)
+    {
+        return 0;
+    }
     if (a->type == HEX_TYPE_STRING)
     {
-        return (strcmp(a->data.str_value, b->data.str_value) == 0);
+        return a->str_size == b->str_size && (a->data.str_value == b->data.str_value || memcmp(a->data.str_value, b->data.str_value, a->str_size) == 0);
+    }
+    if (a->type == HEX_TYPE_BUFFER)
+    {
+        return a->str_size == b->str_size && memcmp(a->data.buffer_value, b->data.buffer_value, a->str_size) == 0;
+    }
+    if (a->type == HEX_TYPE_VECTOR)
+    {
+        return a->quotation_size == b->quotation_size && memcmp(a->data.vector_value, b->data.vector_value, a->quotation_size * sizeof(int32_t)) == 0;
+    }
+    if (a->type == HEX_TYPE_SEQUENCE)
+    {
+        // Sequences are only equal to their copies
+        return a->data.seq_value == b->data.seq_value;
+    }
+    if (a->type == HEX_TYPE_DICTIONARY)
+    {
+        const hex_dict_t *da = a->data.dict_value;
+        const hex_dict_t *db = b->data.dict_value;
+        if (da == db)
+        {
+            return 1;
+        }
+        if (da->size != db->size)
+        {
+            return 0;
+        }
+        // Dictionaries with the same keys and values are equal, regardless of key order
+        for (size_t i = 0; i < da->count; i++)
+        {
+            if (!da->entries[i].key)
+            {
+                continue;
+            }
+            hex_item_t *value = hex_dict_get(db, da->entries[i].key);
+            if (!value || !hex_equal(da->entries[i].value, value))
+            {
+                return 0;
+            }
+        }
+        return 1;
     }
     if (a->type == HEX_TYPE_QUOTATION)
     {
@@ -928,6 +787,14 @@ static int hex_equal(hex_item_t *a, hex_item_t *b)
         {
             return 0;
         }
+        else if (a->data.quotation_value == b->data.quotation_value)
+        {
+            return 1; // Copies sharing their items
+        }
+        else if (a->share && b->share && a->share->hash && b->share->hash && a->share->hash != b->share->hash)
+        {
+            return 0;
+        }
         else
         {
             for (size_t i = 0; i < a->quotation_size; i++)
@@ -943,6 +810,18 @@ static int hex_equal(hex_item_t *a, hex_item_t *b)
     return 0;
 }
 
+// Compare two strings byte by byte, the shorter one first if it is a prefix of the other
+static int hex_compare_strings(hex_item_t *a, hex_item_t *b)
+{
+    size_t min_size = a->str_size < b->str_size ? a->str_size : b->str_size;
+    int cmp = memcmp(a->data.str_value, b->data.str_value, min_size);
+    if (cmp != 0)
+    {
+        return cmp;
+    }
+    return (a->str_size > b->str_size) - (a->str_size < b->str_size);
+}
+
 static int hex_is_type_symbol(hex_item_t *item)
 {
     if (item->type == HEX_TYPE_USER_SYMBOL || item->type == HEX_TYPE_NATIVE_SYMBOL)
@@ -952,7 +831,7 @@ static int hex_is_type_symbol(hex_item_t *item)
     return 0;
 }
 
-static int hex_greater(hex_context_t *ctx, hex_item_t *a, hex_item_t *b, char *symbol)
+static int hex_greater(hex_context_t *ctx, hex_item_t *a, hex_item_t *b, const char *symbol)
 {
     if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
     {
@@ -960,7 +839,7 @@ static int hex_greater(hex_context_t *ctx, hex_item_t *a, hex_item_t *b, char *s
     }
     else if (a->type == HEX_TYPE_STRING && b->type == HEX_TYPE_STRING)
     {
-        return strcmp(a->data.str_value, b->data.str_value) > 0;
+        return hex_compare_strings(a, b) > 0;
     }
     else if (a->type == HEX_TYPE_QUOTATION && b->type == HEX_TYPE_QUOTATION)
     {
@@ -990,7 +869,7 @@ static int hex_greater(hex_context_t *ctx, hex_item_t *a, hex_item_t *b, char *s
             }
             else if (it_a->type == HEX_TYPE_STRING)
             {
-                int cmp = strcmp(it_a->data.str_value, it_b->data.str_value);
+                int cmp = hex_compare_strings(it_a, it_b);
                 if (cmp != 0)
                 {
                     is_greater = cmp > 0;
@@ -1029,31 +908,17 @@ static int hex_greater(hex_context_t *ctx, hex_item_t *a, hex_item_t *b, char *s
 
 int hex_symbol_equal(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
+    if (hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        int32_t b;
+        hex_item_t *a = hex_integer_operands(ctx, &b);
+        a->data.int_value = a->data.int_value == b;
+        return 0;
     }
+    HEX_POP(ctx, b);
     HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
-    }
-    if ((a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER) || (a->type == HEX_TYPE_STRING && b->type == HEX_TYPE_STRING) || (a->type == HEX_TYPE_QUOTATION && b->type == HEX_TYPE_QUOTATION))
-    {
-        int result = hex_push_integer(ctx, hex_equal(a, b));
-        if (result != 0)
-        {
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
-        }
-        return result;
-    }
-    // Different types => false
-    int result = hex_push_integer(ctx, 0);
+    // Items of different types are never equal
+    int result = hex_push_integer(ctx, hex_equal(a, b));
     HEX_FREE(ctx, a);
     HEX_FREE(ctx, b);
     return result;
@@ -1061,140 +926,131 @@ int hex_symbol_equal(hex_context_t *ctx)
 
 int hex_symbol_notequal(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
+    if (hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        int32_t b;
+        hex_item_t *a = hex_integer_operands(ctx, &b);
+        a->data.int_value = a->data.int_value != b;
+        return 0;
     }
+    HEX_POP(ctx, b);
     HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
-    }
-    if ((a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER) || (a->type == HEX_TYPE_STRING && b->type == HEX_TYPE_STRING) || (a->type == HEX_TYPE_QUOTATION && b->type == HEX_TYPE_QUOTATION))
-    {
-        int result = hex_push_integer(ctx, !hex_equal(a, b));
-        if (result != 0)
-        {
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
-        }
-        return result;
-    }
-    // Different types => true
-    int result = hex_push_integer(ctx, 1);
-    if (result != 0)
-    {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-    }
+    // Items of different types are never equal
+    int result = hex_push_integer(ctx, !hex_equal(a, b));
+    HEX_FREE(ctx, a);
+    HEX_FREE(ctx, b);
     return result;
 }
 
 int hex_symbol_greater(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
+    if (hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        int32_t b;
+        hex_item_t *a = hex_integer_operands(ctx, &b);
+        a->data.int_value = a->data.int_value > b;
+        return 0;
     }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    if (hex_vector_operands_available(ctx))
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        return hex_vector_operation(ctx, HEX_OP_GREATER, ">");
     }
-    hex_item_t *pa = a;
-    hex_item_t *pb = b;
-    int result = hex_push_integer(ctx, hex_greater(ctx, pa, pb, ">"));
-    if (result != 0)
+    HEX_POP(ctx, b);
+    HEX_POP(ctx, a);
+    int greater = hex_greater(ctx, a, b, ">");
+    if (greater < 0)
     {
         HEX_FREE(ctx, a);
         HEX_FREE(ctx, b);
+        return 1;
     }
+    int result = hex_push_integer(ctx, greater);
+    HEX_FREE(ctx, a);
+    HEX_FREE(ctx, b);
     return result;
 }
 
 int hex_symbol_less(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
+    if (hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        int32_t b;
+        hex_item_t *a = hex_integer_operands(ctx, &b);
+        a->data.int_value = a->data.int_value < b;
+        return 0;
     }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    if (hex_vector_operands_available(ctx))
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        return hex_vector_operation(ctx, HEX_OP_LESS, "<");
     }
-    hex_item_t *pa = a;
-    hex_item_t *pb = b;
-    int result = hex_push_integer(ctx, hex_greater(ctx, pb, pa, "<"));
-    if (result != 0)
+    HEX_POP(ctx, b);
+    HEX_POP(ctx, a);
+    int greater = hex_greater(ctx, b, a, "<");
+    if (greater < 0)
     {
         HEX_FREE(ctx, a);
         HEX_FREE(ctx, b);
+        return 1;
     }
+    int result = hex_push_integer(ctx, greater);
+    HEX_FREE(ctx, a);
+    HEX_FREE(ctx, b);
     return result;
 }
 
 int hex_symbol_greaterequal(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
+    if (hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        int32_t b;
+        hex_item_t *a = hex_integer_operands(ctx, &b);
+        a->data.int_value = a->data.int_value >= b;
+        return 0;
     }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    if (hex_vector_operands_available(ctx))
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        return hex_vector_operation(ctx, HEX_OP_GREATEREQUAL, ">=");
     }
-    hex_item_t *pa = a;
-    hex_item_t *pb = b;
-    int result = hex_push_integer(ctx, hex_greater(ctx, pa, pb, ">") || hex_equal(a, b));
-    if (result != 0)
+    HEX_POP(ctx, b);
+    HEX_POP(ctx, a);
+    int greater = hex_greater(ctx, a, b, ">");
+    if (greater < 0)
     {
         HEX_FREE(ctx, a);
         HEX_FREE(ctx, b);
+        return 1;
     }
+    int result = hex_push_integer(ctx, greater || hex_equal(a, b));
+    HEX_FREE(ctx, a);
+    HEX_FREE(ctx, b);
     return result;
 }
 
 int hex_symbol_lessequal(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
+    if (hex_integer_operands_available(ctx))
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        int32_t b;
+        hex_item_t *a = hex_integer_operands(ctx, &b);
+        a->data.int_value = a->data.int_value <= b;
+        return 0;
     }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    if (hex_vector_operands_available(ctx))
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        return hex_vector_operation(ctx, HEX_OP_LESSEQUAL, "<=");
     }
-    hex_item_t *pa = a;
-    hex_item_t *pb = b;
-    int result = hex_push_integer(ctx, hex_greater(ctx, pb, pa, "<") || hex_equal(a, b));
-    if (result != 0)
+    HEX_POP(ctx, b);
+    HEX_POP(ctx, a);
+    int greater = hex_greater(ctx, b, a, "<");
+    if (greater < 0)
     {
         HEX_FREE(ctx, a);
         HEX_FREE(ctx, b);
+        return 1;
     }
+    int result = hex_push_integer(ctx, greater || hex_equal(a, b));
+    HEX_FREE(ctx, a);
+    HEX_FREE(ctx, b);
     return result;
 }
 
@@ -1202,213 +1058,237 @@ int hex_symbol_lessequal(hex_context_t *ctx)
 
 int hex_symbol_and(hex_context_t *ctx)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, b);
-        return 1;
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value = a->data.int_value && b;
+    return 0;
+}
+
+int hex_symbol_or(hex_context_t *ctx)
+{
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value = a->data.int_value || b;
+    return 0;
+}
+
+int hex_symbol_not(hex_context_t *ctx)
+{
+    hex_item_t *a = ctx->stack->entries[ctx->stack->top];
+    a->data.int_value = !a->data.int_value;
+    return 0;
+}
+
+int hex_symbol_xor(hex_context_t *ctx)
+{
+    int32_t b;
+    hex_item_t *a = hex_integer_operands(ctx, &b);
+    a->data.int_value ^= b;
+    return 0;
+}
+
+// Quotation and String (List) Symbols
+
+// Make room for a string of the given size in a string or buffer item, growing its storage geometrically.
+// The shared bytes of a string are only grown in place if the string can append to them.
+static int hex_string_reserve(hex_item_t *item, size_t size)
+{
+    size_t capacity = item->str_capacity > item->str_size + 1 ? item->str_capacity : item->str_size + 1;
+    hex_share_t *share = item->share;
+    int shared = share && share->refs > 1;
+    if (shared && (share->refs - share->stored > 1 || item->str_size != share->used))
+    {
+        // Other items read the bytes after the string
+        capacity = item->str_size + 1;
     }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    else if (size + 1 <= capacity)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        return 0;
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
+    capacity *= 2;
+    if (capacity < size + 1)
     {
-        int result = hex_push_integer(ctx, a->data.int_value && b->data.int_value);
-        if (result != 0)
+        capacity = size + 1;
+    }
+    if (!shared)
+    {
+        char *buffer = (char *)realloc(item->data.str_value, capacity);
+        if (!buffer)
         {
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
+            return 1;
         }
-        return result;
+        item->data.str_value = buffer;
+        item->str_capacity = capacity;
+        return 0;
     }
-    hex_error(ctx, "[symbol and] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
+    char *buffer = (char *)malloc(capacity);
+    if (!buffer)
+    {
+        return 1;
+    }
+    memcpy(buffer, item->data.str_value, item->str_size);
+    buffer[item->str_size] = '\0';
+    share->refs--;
+    item->share = NULL;
+    item->data.str_value = buffer;
+    item->str_capacity = capacity;
+    return 0;
 }
 
-int hex_symbol_or(hex_context_t *ctx)
+// Make room for the given number of items in a quotation, growing its storage geometrically
+static int hex_quotation_reserve(hex_item_t *item, size_t size)
 {
-    HEX_POP(ctx, b);
-    if (b->type == HEX_TYPE_INVALID)
+    size_t capacity = item->quotation_capacity > item->quotation_size ? item->quotation_capacity : item->quotation_size;
+    if (size <= capacity)
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        return 0;
     }
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    capacity *= 2;
+    if (capacity < size)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
-        return 1;
+        capacity = size;
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
+    hex_item_t **items = (hex_item_t **)realloc(item->data.quotation_value, capacity * sizeof(hex_item_t *));
+    if (!items)
     {
-        int result = hex_push_integer(ctx, a->data.int_value || b->data.int_value);
-        if (result != 0)
-        {
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
-        }
-        return result;
+        return 1;
     }
-    hex_error(ctx, "[symbol or] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
+    item->data.quotation_value = items;
+    item->quotation_capacity = capacity;
+    return 0;
 }
 
-int hex_symbol_not(hex_context_t *ctx)
+// Push a quotation that was edited in place, freeing it on failure
+static int hex_push_edited(hex_context_t *ctx, hex_item_t *list)
 {
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    if (HEX_PUSH(ctx, list) != 0)
     {
-        HEX_FREE(ctx, a);
+        HEX_FREE(ctx, list);
         return 1;
     }
-    if (a->type == HEX_TYPE_INTEGER)
-    {
-        int result = hex_push_integer(ctx, !a->data.int_value);
-        if (result != 0)
-        {
-            HEX_FREE(ctx, a);
-        }
-        return result;
-    }
-    hex_error(ctx, "[symbol not] Integer required");
-    HEX_FREE(ctx, a);
-    return 1;
+    return 0;
 }
 
-int hex_symbol_xor(hex_context_t *ctx)
+// Check if the items of a quotation or the bytes of a string are shared with other items
+static int hex_is_shared(const hex_item_t *list)
 {
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
+    return list->share && list->share->refs > 1;
+}
+
+// Take an item out of a quotation popped by a native, copying it if the items are shared
+static hex_item_t *hex_take_item(hex_context_t *ctx, hex_item_t *list, size_t i)
+{
+    hex_item_t *item = list->data.quotation_value[i];
+    if (hex_is_shared(list))
     {
-        HEX_FREE(ctx, b);
-        return 1;
+        return hex_copy_item(ctx, item);
     }
-    HEX_POP(ctx, a);
-    ;
-    if (a->type == HEX_TYPE_INVALID)
+    list->data.quotation_value[i] = NULL;
+    return item;
+}
+
+// Get a quotation popped by a native ready to be edited in place, freeing the operands on failure
+static int hex_edit_list(hex_context_t *ctx, const char *symbol, hex_item_t *list, hex_item_t *item)
+{
+    if (hex_quotation_unshare(ctx, list) != 0)
     {
-        HEX_FREE(ctx, a);
-        HEX_FREE(ctx, b);
+        hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
+        HEX_FREE(ctx, list);
+        HEX_FREE(ctx, item);
         return 1;
     }
-    if (a->type == HEX_TYPE_INTEGER && b->type == HEX_TYPE_INTEGER)
-    {
-        int result = hex_push_integer(ctx, a->data.int_value ^ b->data.int_value);
-        if (result != 0)
-        {
-            HEX_FREE(ctx, a);
-            HEX_FREE(ctx, b);
-        }
-        return result;
-    }
-    hex_error(ctx, "[symbol xor] Two integers required");
-    HEX_FREE(ctx, a);
-    HEX_FREE(ctx, b);
-    return 1;
+    return 0;
 }
 
-// Quotation and String (List) Symbols
 int hex_symbol_cat(hex_context_t *ctx)
 {
     HEX_POP(ctx, value);
-    if (value->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, value);
-        return 1; // Failed to pop value
-    }
     HEX_POP(ctx, list);
-    ;
-    if (list->type == HEX_TYPE_INVALID)
+    if (list->type == HEX_TYPE_QUOTATION && value->type == HEX_TYPE_QUOTATION)
     {
-        HEX_FREE(ctx, list);
+        // Append in place: both quotations are owned by this native, so the items of the
+        // second one are moved to the end of the first one, which grows geometrically.
+        if (hex_quotation_unshare(ctx, list) != 0 || hex_quotation_unshare(ctx, value) != 0 ||
+            hex_quotation_reserve(list, list->quotation_size + value->quotation_size) != 0)
+        {
+            hex_error(ctx, "[symbol cat] Memory allocation failed");
+            HEX_FREE(ctx, list);
+            HEX_FREE(ctx, value);
+            return 1;
+        }
+        memcpy(list->data.quotation_value + list->quotation_size, value->data.quotation_value, value->quotation_size * sizeof(hex_item_t *));
+        list->quotation_size += value->quotation_size;
+        value->quotation_size = 0;
         HEX_FREE(ctx, value);
-        return 1; // Failed to pop list
+        return hex_push_edited(ctx, list);
     }
-    // Strategy: produce a fresh result (deep copies) and consume both inputs.
-    // This avoids aliasing between the original quotations and the new one.
-    if (list->type == HEX_TYPE_QUOTATION && value->type == HEX_TYPE_QUOTATION)
+    else if (list->type == HEX_TYPE_STRING && value->type == HEX_TYPE_STRING)
     {
-        size_t new_size = list->quotation_size + value->quotation_size;
-        hex_item_t **items = (hex_item_t **)calloc(new_size, sizeof(hex_item_t *));
-        if (!items)
+        // Append in place: the first string is owned by this native, and its buffer
+        // grows geometrically, so repeated cat builds a string in amortized linear time.
+        // The buffer is still appended to when it is shared with the value of a symbol
+        // the string was pushed from, so that "s" : round trips do not copy it.
+        if (hex_string_reserve(list, list->str_size + value->str_size) != 0)
         {
             hex_error(ctx, "[symbol cat] Memory allocation failed");
             HEX_FREE(ctx, list);
             HEX_FREE(ctx, value);
             return 1;
         }
-        size_t k = 0;
-        for (size_t i = 0; i < list->quotation_size; i++)
+        memcpy(list->data.str_value + list->str_size, value->data.str_value, value->str_size);
+        list->str_size += value->str_size;
+        list->data.str_value[list->str_size] = '\0';
+        if (list->share)
         {
-            items[k] = hex_copy_item(ctx, list->data.quotation_value[i]);
-            if (!items[k])
-            {
-                hex_error(ctx, "[symbol cat] Failed to copy element");
-                hex_free_list(ctx, items, k);
-                HEX_FREE(ctx, list);
-                HEX_FREE(ctx, value);
-                return 1;
-            }
-            k++;
+            list->share->used = list->str_size;
         }
-        for (size_t i = 0; i < value->quotation_size; i++)
+        HEX_FREE(ctx, value);
+        if (HEX_PUSH(ctx, list) != 0)
         {
-            items[k] = hex_copy_item(ctx, value->data.quotation_value[i]);
-            if (!items[k])
-            {
-                hex_error(ctx, "[symbol cat] Failed to copy element");
-                hex_free_list(ctx, items, k);
-                HEX_FREE(ctx, list);
-                HEX_FREE(ctx, value);
-                return 1;
-            }
-            k++;
+            HEX_FREE(ctx, list);
+            return 1;
         }
-        if (hex_push_quotation(ctx, items, new_size) != 0)
+        return 0;
+    }
+    else if (list->type == HEX_TYPE_BUFFER && value->type == HEX_TYPE_BUFFER)
+    {
+        if (hex_string_reserve(list, list->str_size + value->str_size) != 0)
         {
-            hex_free_list(ctx, items, new_size);
+            hex_error(ctx, "[symbol cat] Memory allocation failed");
             HEX_FREE(ctx, list);
             HEX_FREE(ctx, value);
             return 1;
         }
-        // Ownership of items array & its elements transferred; DO NOT free(items)
-        HEX_FREE(ctx, list);
+        memcpy(list->data.buffer_value + list->str_size, value->data.buffer_value, value->str_size);
+        list->str_size += value->str_size;
         HEX_FREE(ctx, value);
+        if (HEX_PUSH(ctx, list) != 0)
+        {
+            HEX_FREE(ctx, list);
+            return 1;
+        }
         return 0;
     }
-    else if (list->type == HEX_TYPE_STRING && value->type == HEX_TYPE_STRING)
+    else if (list->type == HEX_TYPE_VECTOR && value->type == HEX_TYPE_VECTOR)
     {
-        size_t new_len = strlen(list->data.str_value) + strlen(value->data.str_value) + 1;
-        char *buf = (char *)malloc(new_len);
-        if (!buf)
+        size_t size = list->quotation_size + value->quotation_size;
+        int32_t *values = (int32_t *)realloc(list->data.vector_value, size > 0 ? size * sizeof(int32_t) : 1);
+        if (!values)
         {
             hex_error(ctx, "[symbol cat] Memory allocation failed");
             HEX_FREE(ctx, list);
             HEX_FREE(ctx, value);
             return 1;
         }
-        strcpy(buf, list->data.str_value);
-        strcat(buf, value->data.str_value);
-        if (hex_push_string(ctx, buf) != 0)
+        memcpy(values + list->quotation_size, value->data.vector_value, value->quotation_size * sizeof(int32_t));
+        list->data.vector_value = values;
+        list->quotation_size = size;
+        HEX_FREE(ctx, value);
+        if (HEX_PUSH(ctx, list) != 0)
         {
-            free(buf);
             HEX_FREE(ctx, list);
-            HEX_FREE(ctx, value);
             return 1;
         }
-        free(buf); // temporary buffer
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, value);
         return 0;
     }
     else
@@ -1423,773 +1303,1841 @@ int hex_symbol_cat(hex_context_t *ctx)
 int hex_symbol_len(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
     int result = 0;
-    if (item->type == HEX_TYPE_QUOTATION)
+    if (item->type == HEX_TYPE_QUOTATION || item->type == HEX_TYPE_VECTOR)
     {
         result = hex_push_integer(ctx, item->quotation_size);
     }
-    else if (item->type == HEX_TYPE_STRING)
+    else if (item->type == HEX_TYPE_DICTIONARY)
     {
-        result = hex_push_integer(ctx, strlen(item->data.str_value));
+        result = hex_push_integer(ctx, item->data.dict_value->size);
     }
     else
     {
-        hex_error(ctx, "[symbol len] Quotation or string required");
-        result = 1;
-    }
-    if (result != 0)
-    {
-        HEX_FREE(ctx, item);
+        result = hex_push_integer(ctx, item->str_size);
     }
+    HEX_FREE(ctx, item);
     return result;
 }
 
 int hex_symbol_get(hex_context_t *ctx)
 {
     HEX_POP(ctx, index);
-    if (index->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, list);
+    int result = 0;
+    if (list->type == HEX_TYPE_DICTIONARY)
     {
+        // Dictionaries are indexed by key
+        hex_item_t *value = NULL;
+        if (index->type == HEX_TYPE_INTEGER || index->type == HEX_TYPE_STRING)
+        {
+            value = hex_dict_get(list->data.dict_value, index);
+        }
+        if (!value)
+        {
+            hex_error(ctx, "[symbol get] Key not found");
+            result = 1;
+        }
+        else
+        {
+            value = hex_copy_item(ctx, value);
+            result = value ? HEX_PUSH(ctx, value) : 1;
+            if (value && result != 0)
+            {
+                HEX_FREE(ctx, value);
+            }
+        }
+        HEX_FREE(ctx, list);
         HEX_FREE(ctx, index);
-        return 1;
+        return result;
     }
-    HEX_POP(ctx, list);
-    if (list->type == HEX_TYPE_INVALID)
+    if (index->type != HEX_TYPE_INTEGER)
     {
+        hex_error(ctx, "[symbol get] Index must be an integer");
         HEX_FREE(ctx, list);
         HEX_FREE(ctx, index);
         return 1;
     }
-    int result = 0;
-    hex_item_t *copy = NULL;
+    // The list is owned by this native: its storage is reused for the result instead of copied
     if (list->type == HEX_TYPE_QUOTATION)
     {
-        if (index->type != HEX_TYPE_INTEGER)
-        {
-            hex_error(ctx, "[symbol get] Index must be an integer");
-            result = 1;
-        }
-        else if (index->data.int_value < 0 || (size_t)index->data.int_value >= list->quotation_size)
+        if (index->data.int_value < 0 || (size_t)index->data.int_value >= list->quotation_size)
         {
             hex_error(ctx, "[symbol get] Index out of range");
             result = 1;
         }
         else
         {
-            copy = hex_copy_item(ctx, list->data.quotation_value[index->data.int_value]);
-            result = hex_push(ctx, copy);
+            hex_item_t *element = hex_take_item(ctx, list, index->data.int_value);
+            result = element ? HEX_PUSH(ctx, element) : 1;
+            if (result != 0)
+            {
+                HEX_FREE(ctx, element);
+            }
         }
+        HEX_FREE(ctx, list);
     }
-    else if (list->type == HEX_TYPE_STRING)
+    else if (list->type == HEX_TYPE_BUFFER)
     {
-        if (index->type != HEX_TYPE_INTEGER)
+        if (index->data.int_value < 0 || (size_t)index->data.int_value >= list->str_size)
         {
-            hex_error(ctx, "[symbol get] Index must be an integer");
+            hex_error(ctx, "[symbol get] Index out of range");
             result = 1;
         }
-        else if (index->data.int_value < 0 || index->data.int_value >= (int)strlen(list->data.str_value))
+        else
+        {
+            result = hex_push_integer(ctx, list->data.buffer_value[index->data.int_value]);
+        }
+        HEX_FREE(ctx, list);
+    }
+    else if (list->type == HEX_TYPE_VECTOR)
+    {
+        if (index->data.int_value < 0 || (size_t)index->data.int_value >= list->quotation_size)
         {
             hex_error(ctx, "[symbol get] Index out of range");
             result = 1;
         }
         else
         {
-            char str[2] = {list->data.str_value[index->data.int_value], '\0'};
-            copy = hex_string_item(ctx, str);
-            result = hex_push(ctx, copy);
+            result = hex_push_integer(ctx, list->data.vector_value[index->data.int_value]);
         }
+        HEX_FREE(ctx, list);
     }
     else
     {
-        hex_error(ctx, "[symbol get] Quotation or string required");
-        result = 1;
-    }
-    if (result != 0)
-    {
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, index);
+        if (index->data.int_value < 0 || (size_t)index->data.int_value >= list->str_size)
+        {
+            hex_error(ctx, "[symbol get] Index out of range");
+            HEX_FREE(ctx, list);
+            result = 1;
+        }
+        else if (hex_is_shared(list))
+        {
+            // The bytes of the string are read by other items: the character is copied
+            hex_item_t *item = hex_string_bytes_item(ctx, list->data.str_value + index->data.int_value, 1);
+            result = item ? HEX_PUSH(ctx, item) : 1;
+            if (item && result != 0)
+            {
+                HEX_FREE(ctx, item);
+            }
+            HEX_FREE(ctx, list);
+        }
+        else
+        {
+            // The buffer of the string is reused for the character, but shrunk if it is
+            // large, so that the result does not keep the whole allocation alive
+            hex_string_unshare(list);
+            size_t capacity = list->str_capacity > list->str_size + 1 ? list->str_capacity : list->str_size + 1;
+            list->data.str_value[0] = list->data.str_value[index->data.int_value];
+            list->data.str_value[1] = '\0';
+            list->str_size = 1;
+            list->str_capacity = capacity;
+            if (capacity > 16)
+            {
+                char *str = (char *)realloc(list->data.str_value, 2);
+                if (str)
+                {
+                    list->data.str_value = str;
+                    list->str_capacity = 0;
+                }
+            }
+            result = HEX_PUSH(ctx, list);
+            if (result != 0)
+            {
+                HEX_FREE(ctx, list);
+            }
+        }
     }
+    HEX_FREE(ctx, index);
     return result;
 }
 
 int hex_symbol_index(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    if (item->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, list);
+    int result = -1;
+    if (list->type == HEX_TYPE_QUOTATION)
     {
-        HEX_FREE(ctx, item);
-        return 1;
+        result = hex_quotation_find(list, item);
     }
-    HEX_POP(ctx, list);
-    if (list->type == HEX_TYPE_INVALID)
+    else if (list->type == HEX_TYPE_BUFFER)
     {
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, item);
-        return 1;
+        const uint8_t *ptr = NULL;
+        if (item->type == HEX_TYPE_INTEGER && item->data.int_value >= 0 && item->data.int_value <= 0xff)
+        {
+            ptr = (const uint8_t *)memchr(list->data.buffer_value, item->data.int_value, list->str_size);
+        }
+        if (ptr)
+        {
+            result = ptr - list->data.buffer_value;
+        }
     }
-    int result = -1;
-    if (list->type == HEX_TYPE_QUOTATION)
+    else if (list->type == HEX_TYPE_VECTOR)
     {
-        for (size_t i = 0; i < list->quotation_size; i++)
+        if (item->type == HEX_TYPE_INTEGER)
         {
-            if (hex_equal(list->data.quotation_value[i], item))
+            for (size_t i = 0; i < list->quotation_size; i++)
             {
-                result = i;
-                break;
+                if (list->data.vector_value[i] == item->data.int_value)
+                {
+                    result = i;
+                    break;
+                }
             }
         }
     }
-    else if (list->type == HEX_TYPE_STRING)
+    else
     {
-        char *ptr = strstr(list->data.str_value, item->data.str_value);
+        const char *ptr = hex_find(list->data.str_value, list->str_size, item->data.str_value, item->str_size);
         if (ptr)
         {
             result = ptr - list->data.str_value;
         }
     }
-    else
-    {
-        hex_error(ctx, "[symbol index] Quotation or string required");
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, item);
-        return 1;
-    }
+    HEX_FREE(ctx, list);
+    HEX_FREE(ctx, item);
     return hex_push_integer(ctx, result);
 }
 
-// String symbols
+// List editing symbols work in place on the quotation they pop, which is owned by the
+// native: items are moved, never copied, and the quotation grows geometrically. Items
+// shared with other quotation items are copied first.
 
-int hex_symbol_join(hex_context_t *ctx)
+// Insert an item at an index from 0 to the size of a quotation, taking ownership of the item
+static int hex_insert_item(hex_context_t *ctx, const char *symbol, hex_item_t *list, hex_item_t *item, size_t index)
 {
-    HEX_POP(ctx, separator);
-    if (separator->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, separator);
-        return 1;
-    }
-    HEX_POP(ctx, list);
-    if (list->type == HEX_TYPE_INVALID)
+    if (hex_quotation_unshare(ctx, list) != 0 || hex_quotation_reserve(list, list->quotation_size + 1) != 0)
     {
+        hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
         HEX_FREE(ctx, list);
-        HEX_FREE(ctx, separator);
+        HEX_FREE(ctx, item);
         return 1;
     }
-    int result = 0;
-    if (list->type == HEX_TYPE_QUOTATION && separator->type == HEX_TYPE_STRING)
+    hex_item_t **items = list->data.quotation_value;
+    memmove(items + index + 1, items + index, (list->quotation_size - index) * sizeof(hex_item_t *));
+    items[index] = item;
+    list->quotation_size++;
+    return hex_push_edited(ctx, list);
+}
+
+// Check that an index is within a quotation (or at its end, if allowed), freeing the operands otherwise
+static int hex_list_index(hex_context_t *ctx, const char *symbol, hex_item_t *list, hex_item_t *item, hex_item_t *index, int end)
+{
+    int32_t i = index->data.int_value;
+    if (i < 0 || (size_t)i > list->quotation_size || ((size_t)i == list->quotation_size && !end))
     {
-        int length = 0;
-        for (size_t i = 0; i < list->quotation_size; i++)
-        {
-            if (list->data.quotation_value[i]->type == HEX_TYPE_STRING)
-            {
-                length += strlen(list->data.quotation_value[i]->data.str_value);
-            }
-            else
-            {
-                hex_error(ctx, "[symbol join] Quotation must contain only strings");
-                HEX_FREE(ctx, list);
-                HEX_FREE(ctx, separator);
-                return 1;
-            }
-        }
-        if (result == 0)
-        {
-            length += (list->quotation_size - 1) * strlen(separator->data.str_value);
-            char *newStr = (char *)malloc(length + 1);
-            if (!newStr)
-            {
-                hex_error(ctx, "[symbol join] Memory allocation failed");
-                HEX_FREE(ctx, list);
-                HEX_FREE(ctx, separator);
-                return 1;
-            }
-            newStr[0] = '\0';
-            for (size_t i = 0; i < list->quotation_size; i++)
-            {
-                strcat(newStr, list->data.quotation_value[i]->data.str_value);
-                if (i < list->quotation_size - 1)
-                {
-                    strcat(newStr, separator->data.str_value);
-                }
-            }
-            result = hex_push_string(ctx, newStr);
-        }
+        hex_error(ctx, "[symbol %s] Index out of bounds", symbol);
+        HEX_FREE(ctx, list);
+        HEX_FREE(ctx, item);
+        HEX_FREE(ctx, index);
+        return -1;
     }
-    else
+    HEX_FREE(ctx, index);
+    return i;
+}
+
+int hex_symbol_push(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
+    HEX_POP(ctx, list);
+    return hex_insert_item(ctx, "push", list, item, list->quotation_size);
+}
+
+int hex_symbol_pop(hex_context_t *ctx)
+{
+    HEX_POP(ctx, list);
+    if (hex_edit_list(ctx, "pop", list, NULL) != 0)
     {
-        hex_error(ctx, "[symbol join] Quotation and string required");
-        result = 1;
+        return 1;
     }
-    if (result != 0)
+    if (list->quotation_size > 0)
     {
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, separator);
+        list->quotation_size--;
+        HEX_FREE(ctx, list->data.quotation_value[list->quotation_size]);
+        list->data.quotation_value[list->quotation_size] = NULL;
     }
-    return result;
+    return hex_push_edited(ctx, list);
 }
 
-int hex_symbol_split(hex_context_t *ctx)
+int hex_symbol_ins(hex_context_t *ctx)
 {
-    HEX_POP(ctx, separator);
-    if (separator->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, index);
+    HEX_POP(ctx, item);
+    HEX_POP(ctx, list);
+    int i = hex_list_index(ctx, "ins", list, item, index, 1);
+    if (i < 0)
     {
-        HEX_FREE(ctx, separator);
         return 1;
     }
-    HEX_POP(ctx, str);
-    if (str->type == HEX_TYPE_INVALID)
+    return hex_insert_item(ctx, "ins", list, item, i);
+}
+
+int hex_symbol_rem(hex_context_t *ctx)
+{
+    HEX_POP(ctx, index);
+    HEX_POP(ctx, list);
+    int i = hex_list_index(ctx, "rem", list, NULL, index, 0);
+    if (i < 0 || hex_edit_list(ctx, "rem", list, NULL) != 0)
     {
-        HEX_FREE(ctx, str);
-        HEX_FREE(ctx, separator);
         return 1;
     }
-    int result = 0;
-    if (str->type == HEX_TYPE_STRING && separator->type == HEX_TYPE_STRING)
+    hex_item_t **items = list->data.quotation_value;
+    HEX_FREE(ctx, items[i]);
+    memmove(items + i, items + i + 1, (list->quotation_size - i - 1) * sizeof(hex_item_t *));
+    list->quotation_size--;
+    return hex_push_edited(ctx, list);
+}
+
+int hex_symbol_set(hex_context_t *ctx)
+{
+    HEX_POP(ctx, index);
+    HEX_POP(ctx, item);
+    HEX_POP(ctx, list);
+    int i = hex_list_index(ctx, "set", list, item, index, 0);
+    if (i < 0 || hex_edit_list(ctx, "set", list, item) != 0)
     {
-        if (strlen(separator->data.str_value) == 0)
-        {
-            // Separator is an empty string: split into individual characters
-            size_t size = strlen(str->data.str_value);
-            hex_item_t **quotation = (hex_item_t **)calloc(size, sizeof(hex_item_t *));
-            if (!quotation)
-            {
-                hex_error(ctx, "[symbol split] Memory allocation failed");
-                result = 1;
-            }
-            else
-            {
-                for (size_t i = 0; i < size; i++)
-                {
-                    quotation[i] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-                    if (!quotation[i])
-                    {
-                        hex_error(ctx, "[symbol split] Memory allocation failed");
-                        result = 1;
-                        break;
-                    }
-                    quotation[i]->type = HEX_TYPE_STRING;
-                    quotation[i]->data.str_value = (char *)malloc(2); // Allocate 2 bytes: 1 for the character and 1 for null terminator
-                    if (!quotation[i]->data.str_value)
-                    {
-                        hex_error(ctx, "[symbol split] Memory allocation failed");
-                        result = 1;
-                        break;
-                    }
-                    quotation[i]->data.str_value[0] = str->data.str_value[i]; // Copy the single character
-                    quotation[i]->data.str_value[1] = '\0';                   // Null-terminate the string
-                }
-                if (result == 0)
-                {
-                    result = hex_push_quotation(ctx, quotation, size);
-                }
-            }
-        }
-        else
-        {
-            // Separator is not empty: split as usual
-            char *token = strtok(str->data.str_value, separator->data.str_value);
-            size_t capacity = 2;
-            size_t size = 0;
-            hex_item_t **quotation = (hex_item_t **)calloc(capacity, sizeof(hex_item_t *));
-            if (!quotation)
-            {
-                hex_error(ctx, "[symbol split] Memory allocation failed");
-                result = 1;
-            }
-            else
-            {
-                while (token)
-                {
-                    if (size >= capacity)
-                    {
-                        capacity *= 2;
-                        hex_item_t **tmp = (hex_item_t **)realloc(quotation, capacity * sizeof(hex_item_t *));
-                        if (!tmp)
-                        {
-                            hex_error(ctx, "[symbol split] Memory allocation failed");
-                            result = 1;
-                            break;
-                        }
-                        quotation = tmp;
-                        if (!quotation)
-                        {
-                            hex_error(ctx, "[symbol split] Memory allocation failed");
-                            result = 1;
-                            break;
-                        }
-                    }
-                    quotation[size] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-                    quotation[size]->type = HEX_TYPE_STRING;
-                    quotation[size]->data.str_value = strdup(token);
-                    size++;
-                    token = strtok(NULL, separator->data.str_value);
-                }
-                if (result == 0)
-                {
-                    result = hex_push_quotation(ctx, quotation, size);
-                }
-            }
-        }
+        return 1;
     }
-    else
+    HEX_FREE(ctx, list->data.quotation_value[i]);
+    list->data.quotation_value[i] = item;
+    return hex_push_edited(ctx, list);
+}
+
+int hex_symbol_reverse(hex_context_t *ctx)
+{
+    HEX_POP(ctx, list);
+    if (hex_edit_list(ctx, "reverse", list, NULL) != 0)
     {
-        hex_error(ctx, "[symbol split] Two strings required");
-        result = 1;
+        return 1;
     }
-    if (result != 0)
+    hex_item_t **items = list->data.quotation_value;
+    for (size_t i = 0, j = list->quotation_size; i + 1 < j; i++, j--)
     {
-        HEX_FREE(ctx, str);
-        HEX_FREE(ctx, separator);
+        hex_item_t *item = items[i];
+        items[i] = items[j - 1];
+        items[j - 1] = item;
     }
-    return result;
+    return hex_push_edited(ctx, list);
 }
 
-int hex_symbol_sub(hex_context_t *ctx)
+int hex_symbol_uncons(hex_context_t *ctx)
 {
-    HEX_POP(ctx, replacement);
-    if (replacement->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, list);
+    if (list->quotation_size == 0)
     {
-        HEX_FREE(ctx, replacement);
+        hex_error(ctx, "[symbol uncons] Quotation must not be empty");
+        HEX_FREE(ctx, list);
         return 1;
     }
-    HEX_POP(ctx, search);
-    if (search->type == HEX_TYPE_INVALID)
+    if (hex_edit_list(ctx, "uncons", list, NULL) != 0)
     {
-        HEX_FREE(ctx, search);
-        HEX_FREE(ctx, replacement);
         return 1;
     }
-    HEX_POP(ctx, list);
-    if (list->type == HEX_TYPE_INVALID)
+    hex_item_t **items = list->data.quotation_value;
+    hex_item_t *first = items[0];
+    memmove(items, items + 1, (list->quotation_size - 1) * sizeof(hex_item_t *));
+    list->quotation_size--;
+    if (HEX_PUSH(ctx, first) != 0)
     {
+        HEX_FREE(ctx, first);
         HEX_FREE(ctx, list);
-        HEX_FREE(ctx, search);
-        HEX_FREE(ctx, replacement);
         return 1;
     }
+    return hex_push_edited(ctx, list);
+}
+
+int hex_symbol_swons(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
+    HEX_POP(ctx, list);
+    return hex_insert_item(ctx, "swons", list, item, 0);
+}
+// String symbols
+
+int hex_symbol_join(hex_context_t *ctx)
+{
+    HEX_POP(ctx, separator);
+    HEX_POP(ctx, list);
     int result = 0;
-    if (list->type == HEX_TYPE_STRING && search->type == HEX_TYPE_STRING && replacement->type == HEX_TYPE_STRING)
+    size_t length = 0;
+    for (size_t i = 0; i < list->quotation_size; i++)
     {
-        char *str = list->data.str_value;
-        char *find = search->data.str_value;
-        char *replace = replacement->data.str_value;
-        char *ptr = strstr(str, find);
-        if (ptr)
+        if (list->data.quotation_value[i]->type == HEX_TYPE_STRING)
         {
-            int findLen = strlen(find);
-            int replaceLen = strlen(replace);
-            int newLen = strlen(str) - findLen + replaceLen + 1;
-            char *newStr = (char *)malloc(newLen);
-            if (!newStr)
-            {
-                hex_error(ctx, "[symbol sub] Memory allocation failed");
-                result = 1;
-            }
-            else
-            {
-                strncpy(newStr, str, ptr - str);
-                strcpy(newStr + (ptr - str), replace);
-                strcpy(newStr + (ptr - str) + replaceLen, ptr + findLen);
-                result = hex_push_string(ctx, newStr);
-            }
+            length += list->data.quotation_value[i]->str_size;
         }
         else
         {
-            result = hex_push_string(ctx, str);
+            hex_error(ctx, "[symbol join] Quotation must contain only strings");
+            HEX_FREE(ctx, list);
+            HEX_FREE(ctx, separator);
+            return 1;
         }
     }
-    else
-    {
-        hex_error(ctx, "[symbol sub] Three strings required");
-        result = 1;
-    }
-    if (result != 0)
-    {
-        HEX_FREE(ctx, list);
-        HEX_FREE(ctx, search);
-        HEX_FREE(ctx, replacement);
-    }
-    return result;
-}
-
-// File symbols
-
-int hex_symbol_read(hex_context_t *ctx)
-{
-    HEX_POP(ctx, filename);
-    ;
-    if (filename->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, filename);
-        return 1;
-    }
-    int result = 0;
-    if (filename->type == HEX_TYPE_STRING)
+    if (result == 0)
     {
-        FILE *file = fopen(filename->data.str_value, "rb");
-        if (!file)
+        if (list->quotation_size > 0)
         {
-            hex_error(ctx, "[symbol read] Could not open file for reading: %s", filename->data.str_value);
-            result = 1;
+            length += (list->quotation_size - 1) * separator->str_size;
         }
-        else
+        char *newStr = (char *)malloc(length + 1);
+        if (!newStr)
         {
-            fseek(file, 0, SEEK_END);
-            long length = ftell(file);
-            fseek(file, 0, SEEK_SET);
-
-            uint8_t *buffer = (uint8_t *)malloc(length);
-            if (!buffer)
-            {
-                hex_error(ctx, "[symbol read] Memory allocation failed");
-                result = 1;
-            }
-            else
+            hex_error(ctx, "[symbol join] Memory allocation failed");
+            HEX_FREE(ctx, list);
+            HEX_FREE(ctx, separator);
+            return 1;
+        }
+        char *dst = newStr;
+        for (size_t i = 0; i < list->quotation_size; i++)
+        {
+            hex_item_t *element = list->data.quotation_value[i];
+            memcpy(dst, element->data.str_value, element->str_size);
+            dst += element->str_size;
+            if (i < list->quotation_size - 1)
             {
-                size_t bytesRead = fread(buffer, 1, length, file);
-                if (hex_is_binary(buffer, bytesRead))
-                {
-                    hex_item_t **quotation = (hex_item_t **)calloc(bytesRead, sizeof(hex_item_t *));
-                    if (!quotation)
-                    {
-                        hex_error(ctx, "[symbol read] Memory allocation failed");
-                        result = 1;
-                    }
-                    else
-                    {
-                        for (size_t i = 0; i < bytesRead; i++)
-                        {
-                            quotation[i] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-                            quotation[i]->type = HEX_TYPE_INTEGER;
-                            quotation[i]->data.int_value = buffer[i];
-                        }
-                        result = hex_push_quotation(ctx, quotation, bytesRead);
-                    }
-                }
-                else
-                {
-                    char *str = hex_bytes_to_string(buffer, bytesRead);
-                    if (!str)
-                    {
-                        hex_error(ctx, "[symbol read] Memory allocation failed");
-                        result = 1;
-                    }
-                    else
-                    {
-                        hex_item_t *item = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-                        item->type = HEX_TYPE_STRING;
-                        item->data.str_value = hex_process_string(str);
-                        result = HEX_PUSH(ctx, item);
-                    }
-                }
+                memcpy(dst, separator->data.str_value, separator->str_size);
+                dst += separator->str_size;
             }
-            fclose(file);
         }
-    }
-    else
-    {
-        hex_error(ctx, "[symbol read] String required");
-        result = 1;
+        *dst = '\0';
+        result = hex_push_string_buffer(ctx, newStr, length);
     }
     if (result != 0)
     {
-        HEX_FREE(ctx, filename);
+        HEX_FREE(ctx, list);
+        HEX_FREE(ctx, separator);
     }
     return result;
 }
 
-int hex_symbol_write(hex_context_t *ctx)
+// Find the end of the piece of str starting at start, and where the next piece starts
+static size_t hex_split_piece(hex_item_t *str, hex_item_t *separator, size_t start, size_t *next)
 {
-    HEX_POP(ctx, filename);
-    if (filename->type == HEX_TYPE_INVALID)
+    if (separator->str_size == 0)
     {
-        HEX_FREE(ctx, filename);
-        return 1;
+        // Separator is an empty string: split into individual characters
+        *next = start + 1;
+        return start + 1;
     }
-    HEX_POP(ctx, data);
-    if (data->type == HEX_TYPE_INVALID)
+    const char *match = hex_find(str->data.str_value + start, str->str_size - start, separator->data.str_value, separator->str_size);
+    if (!match)
     {
-        HEX_FREE(ctx, data);
-        HEX_FREE(ctx, filename);
-        return 1;
+        *next = str->str_size;
+        return str->str_size;
     }
+    size_t end = match - str->data.str_value;
+    *next = end + separator->str_size;
+    return end;
+}
+
+int hex_symbol_split(hex_context_t *ctx)
+{
+    HEX_POP(ctx, separator);
+    HEX_POP(ctx, str);
     int result = 0;
-    if (filename->type == HEX_TYPE_STRING)
+    // Count the (non-empty) pieces first, so that the quotation is allocated once
+    size_t size = 0;
+    size_t next;
+    for (size_t start = 0; start < str->str_size; start = next)
     {
-        if (data->type == HEX_TYPE_STRING)
+        if (hex_split_piece(str, separator, start, &next) > start)
         {
-            FILE *file = fopen(filename->data.str_value, "w");
-            if (file)
-            {
-                fputs(data->data.str_value, file);
-                fclose(file);
-                result = 0;
-            }
-            else
-            {
-                hex_error(ctx, "[symbol write] Could not open file for writing: %s", filename->data.str_value);
-                result = 1;
-            }
+            size++;
         }
-        else if (data->type == HEX_TYPE_QUOTATION)
+    }
+    hex_item_t **quotation = (hex_item_t **)calloc(size > 0 ? size : 1, sizeof(hex_item_t *));
+    if (!quotation)
+    {
+        hex_error(ctx, "[symbol split] Memory allocation failed");
+        result = 1;
+    }
+    else
+    {
+        size_t i = 0;
+        for (size_t start = 0; start < str->str_size && result == 0; start = next)
         {
-            FILE *file = fopen(filename->data.str_value, "wb");
-            if (file)
+            size_t end = hex_split_piece(str, separator, start, &next);
+            if (end > start)
             {
-                for (size_t i = 0; i < data->quotation_size; i++)
+                quotation[i] = hex_string_bytes_item(ctx, str->data.str_value + start, end - start);
+                if (!quotation[i])
                 {
-                    if (data->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
-                    {
-                        hex_error(ctx, "[symbol write] Quotation must contain only integers");
-                        result = 1;
-                        break;
-                    }
-                    uint8_t byte = (uint8_t)data->data.quotation_value[i]->data.int_value;
-                    fwrite(&byte, 1, 1, file);
+                    result = 1;
+                    break;
                 }
-                fclose(file);
-                result = 0;
-            }
-            else
-            {
-                hex_error(ctx, "[symbol write] Could not open file for writing: %s", filename->data.str_value);
-                result = 1;
+                i++;
             }
         }
+        if (result == 0)
+        {
+            result = hex_push_quotation(ctx, quotation, size);
+        }
         else
         {
-            hex_error(ctx, "[symbol write] String or quotation of integers required");
-            result = 1;
+            hex_free_list(ctx, quotation, size);
         }
     }
-    else
-    {
-        hex_error(ctx, "[symbol write] String required");
-        result = 1;
-    }
-    if (result != 0)
-    {
-        HEX_FREE(ctx, data);
-        HEX_FREE(ctx, filename);
-    }
+    HEX_FREE(ctx, str);
+    HEX_FREE(ctx, separator);
     return result;
 }
 
-int hex_symbol_append(hex_context_t *ctx)
+// Slice a buffer from the start index to the end index, both included
+static int hex_buffer_slice(hex_context_t *ctx, hex_item_t *buffer, hex_item_t *start, hex_item_t *end)
 {
-    HEX_POP(ctx, filename);
-    if (filename->type == HEX_TYPE_INVALID)
+    int32_t first = start->data.int_value;
+    int32_t last = end->data.int_value;
+    if (first < 0 || last < 0 || (size_t)last >= buffer->str_size)
     {
-        HEX_FREE(ctx, filename);
+        hex_error(ctx, "[symbol sub] Index out of bounds");
         return 1;
     }
-    HEX_POP(ctx, data);
-    if (data->type == HEX_TYPE_INVALID)
+    size_t size = first <= last ? (size_t)(last - first + 1) : 0;
+    memmove(buffer->data.buffer_value, buffer->data.buffer_value + first, size);
+    buffer->str_size = size;
+    return 0;
+}
+
+int hex_symbol_sub(hex_context_t *ctx)
+{
+    HEX_POP(ctx, replacement);
+    HEX_POP(ctx, search);
+    HEX_POP(ctx, list);
+    int result = 0;
+    if (list->type == HEX_TYPE_BUFFER || search->type != HEX_TYPE_STRING || replacement->type != HEX_TYPE_STRING)
     {
-        HEX_FREE(ctx, data);
-        HEX_FREE(ctx, filename);
+        // The buffer is owned by this native: it is sliced in place
+        if (list->type != HEX_TYPE_BUFFER || search->type != HEX_TYPE_INTEGER || replacement->type != HEX_TYPE_INTEGER)
+        {
+            hex_error(ctx, "[symbol sub] Three strings or a buffer and two integers required");
+            result = 1;
+        }
+        else
+        {
+            result = hex_buffer_slice(ctx, list, search, replacement);
+        }
+        if (result == 0)
+        {
+            result = HEX_PUSH(ctx, list);
+        }
+        if (result != 0)
+        {
+            HEX_FREE(ctx, list);
+        }
+        HEX_FREE(ctx, search);
+        HEX_FREE(ctx, replacement);
+        return result;
+    }
+    // The string is owned by this native: the replacement is done in its own buffer
+    if (hex_string_unshare(list) != 0)
+    {
+        hex_error(ctx, "[symbol sub] Memory allocation failed");
+        HEX_FREE(ctx, list);
+        HEX_FREE(ctx, search);
+        HEX_FREE(ctx, replacement);
         return 1;
     }
+    const char *ptr = hex_find(list->data.str_value, list->str_size, search->data.str_value, search->str_size);
+    if (ptr)
+    {
+        size_t prefixLen = ptr - list->data.str_value;
+        size_t findLen = search->str_size;
+        size_t replaceLen = replacement->str_size;
+        size_t suffixLen = list->str_size - prefixLen - findLen;
+        if (hex_string_reserve(list, list->str_size - findLen + replaceLen) != 0)
+        {
+            hex_error(ctx, "[symbol sub] Memory allocation failed");
+            result = 1;
+        }
+        else
+        {
+            char *dst = list->data.str_value + prefixLen;
+            memmove(dst + replaceLen, dst + findLen, suffixLen + 1);
+            memcpy(dst, replacement->data.str_value, replaceLen);
+            list->str_size = prefixLen + replaceLen + suffixLen;
+        }
+    }
+    if (result == 0)
+    {
+        result = HEX_PUSH(ctx, list);
+    }
+    if (result != 0)
+    {
+        HEX_FREE(ctx, list);
+    }
+    HEX_FREE(ctx, search);
+    HEX_FREE(ctx, replacement);
+    return result;
+}
+
+int hex_symbol_gsub(hex_context_t *ctx)
+{
+    HEX_POP(ctx, replacement);
+    HEX_POP(ctx, search);
+    HEX_POP(ctx, str);
     int result = 0;
-    if (filename->type == HEX_TYPE_STRING)
+    const char *data = str->data.str_value;
+    const char *end = data + str->str_size;
+    // Count the occurrences first, so that the result is written into a single buffer
+    size_t count = 0;
+    if (search->str_size > 0)
     {
-        if (data->type == HEX_TYPE_STRING)
+        for (const char *ptr = data; (ptr = hex_find(ptr, end - ptr, search->data.str_value, search->str_size)); ptr += search->str_size)
         {
-            FILE *file = fopen(filename->data.str_value, "a");
-            if (file)
-            {
-                fputs(data->data.str_value, file);
-                fclose(file);
-                result = 0;
-            }
-            else
+            count++;
+        }
+    }
+    if (count == 0)
+    {
+        result = HEX_PUSH(ctx, str);
+        if (result != 0)
+        {
+            HEX_FREE(ctx, str);
+        }
+        HEX_FREE(ctx, search);
+        HEX_FREE(ctx, replacement);
+        return result;
+    }
+    size_t size = str->str_size - count * search->str_size + count * replacement->str_size;
+    char *buffer = (char *)malloc(size + 1);
+    if (!buffer)
+    {
+        hex_error(ctx, "[symbol gsub] Memory allocation failed");
+        result = 1;
+    }
+    else
+    {
+        char *dst = buffer;
+        const char *src = data;
+        const char *match;
+        while ((match = hex_find(src, end - src, search->data.str_value, search->str_size)))
+        {
+            memcpy(dst, src, match - src);
+            dst += match - src;
+            memcpy(dst, replacement->data.str_value, replacement->str_size);
+            dst += replacement->str_size;
+            src = match + search->str_size;
+        }
+        memcpy(dst, src, end - src);
+        dst += end - src;
+        *dst = '\0';
+        result = hex_push_string_buffer(ctx, buffer, size);
+    }
+    HEX_FREE(ctx, str);
+    HEX_FREE(ctx, search);
+    HEX_FREE(ctx, replacement);
+    return result;
+}
+
+// Return the index of the ${0} to ${9} placeholder at the start of str, or -1
+static int hex_fmt_placeholder(const char *str, size_t size, size_t count)
+{
+    if (size < 4 || str[0] != '$' || str[1] != '{' || str[3] != '}' || str[2] < '0' || str[2] > '9')
+    {
+        return -1;
+    }
+    int index = str[2] - '0';
+    return (size_t)index < count ? index : -1;
+}
+
+int hex_symbol_fmt(hex_context_t *ctx)
+{
+    HEX_POP(ctx, list);
+    HEX_POP(ctx, str);
+    int result = 0;
+    if (list->quotation_size > 10)
+    {
+        hex_error(ctx, "[symbol fmt] Only a maximum of 10 placeholders are supported");
+        result = 1;
+    }
+    // User symbols are pushed, as they were by the former definition of fmt in utils.hex,
+    // and replaced by the string they push
+    hex_item_t *values[10] = {NULL};
+    hex_item_t *pushed[10] = {NULL};
+    for (size_t i = 0; result == 0 && i < list->quotation_size; i++)
+    {
+        hex_item_t *item = list->data.quotation_value[i];
+        values[i] = item;
+        if (item->type == HEX_TYPE_USER_SYMBOL)
+        {
+            int top = ctx->stack->top;
+            if (hex_push(ctx, item) != 0)
             {
-                hex_error(ctx, "[symbol append] Could not open file for appending: %s", filename->data.str_value);
                 result = 1;
             }
-        }
-        else if (data->type == HEX_TYPE_QUOTATION)
-        {
-            FILE *file = fopen(filename->data.str_value, "ab");
-            if (file)
+            else if (ctx->stack->top != top + 1 || ctx->stack->entries[ctx->stack->top]->type != HEX_TYPE_STRING)
             {
-                for (size_t i = 0; i < data->quotation_size; i++)
-                {
-                    if (data->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
-                    {
-                        hex_error(ctx, "[symbol append] Quotation must contain only integers");
-                        result = 1;
-                        break;
-                    }
-                    uint8_t byte = (uint8_t)data->data.quotation_value[i]->data.int_value;
-                    fwrite(&byte, 1, 1, file);
-                }
-                fclose(file);
-                result = 0;
+                hex_error(ctx, "[symbol fmt] Symbol must push a string: %s", item->token->value);
+                result = 1;
             }
             else
             {
-                hex_error(ctx, "[symbol append] Could not open file for appending: %s", filename->data.str_value);
-                result = 1;
+                pushed[i] = hex_pop(ctx);
+                values[i] = pushed[i];
             }
         }
-        else
+        else if (item->type != HEX_TYPE_STRING)
         {
-            hex_error(ctx, "[symbol append] String or quotation of integers required");
+            hex_error(ctx, "[symbol fmt] Quotation must contain only strings");
             result = 1;
         }
     }
-    else
+    if (result == 0)
     {
-        hex_error(ctx, "[symbol append] String required");
-        result = 1;
+        const char *data = str->data.str_value;
+        // Compute the size of the result first, so that it is written into a single buffer
+        size_t size = 0;
+        for (size_t i = 0; i < str->str_size;)
+        {
+            int index = hex_fmt_placeholder(data + i, str->str_size - i, list->quotation_size);
+            size += index < 0 ? 1 : values[index]->str_size;
+            i += index < 0 ? 1 : 4;
+        }
+        char *buffer = (char *)malloc(size + 1);
+        if (!buffer)
+        {
+            hex_error(ctx, "[symbol fmt] Memory allocation failed");
+            result = 1;
+        }
+        else
+        {
+            char *dst = buffer;
+            for (size_t i = 0; i < str->str_size;)
+            {
+                int index = hex_fmt_placeholder(data + i, str->str_size - i, list->quotation_size);
+                if (index < 0)
+                {
+                    *dst++ = data[i++];
+                }
+                else
+                {
+                    memcpy(dst, values[index]->data.str_value, values[index]->str_size);
+                    dst += values[index]->str_size;
+                    i += 4;
+                }
+            }
+            *dst = '\0';
+            result = hex_push_string_buffer(ctx, buffer, size);
+        }
     }
-    if (result != 0)
+    for (size_t i = 0; i < 10; i++)
     {
-        HEX_FREE(ctx, data);
-        HEX_FREE(ctx, filename);
+        HEX_FREE(ctx, pushed[i]);
     }
+    HEX_FREE(ctx, str);
+    HEX_FREE(ctx, list);
     return result;
 }
 
-// Shell symbols
+int hex_symbol_begins(hex_context_t *ctx)
+{
+    HEX_POP(ctx, prefix);
+    HEX_POP(ctx, str);
+    int result = prefix->str_size <= str->str_size && memcmp(str->data.str_value, prefix->data.str_value, prefix->str_size) == 0;
+    HEX_FREE(ctx, str);
+    HEX_FREE(ctx, prefix);
+    return hex_push_integer(ctx, result);
+}
 
-int hex_symbol_args(hex_context_t *ctx)
+int hex_symbol_ends(hex_context_t *ctx)
 {
-    hex_item_t **quotation = (hex_item_t **)calloc(ctx->argc, sizeof(hex_item_t *));
-    if (!quotation)
+    HEX_POP(ctx, suffix);
+    HEX_POP(ctx, str);
+    int result = suffix->str_size <= str->str_size && memcmp(str->data.str_value + str->str_size - suffix->str_size, suffix->data.str_value, suffix->str_size) == 0;
+    HEX_FREE(ctx, str);
+    HEX_FREE(ctx, suffix);
+    return hex_push_integer(ctx, result);
+}
+
+// Vector symbols
+
+// Copy the integers of a quotation into a new array
+static int32_t *hex_quotation_integers(hex_context_t *ctx, const char *symbol, hex_item_t *list)
+{
+    int32_t *values = (int32_t *)malloc(list->quotation_size > 0 ? list->quotation_size * sizeof(int32_t) : 1);
+    if (!values)
     {
-        hex_error(ctx, "[symbol args] Memory allocation failed");
-        return 1;
+        hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
+        return NULL;
     }
-    else
+    for (size_t i = 0; i < list->quotation_size; i++)
     {
-        for (size_t i = 0; i < (size_t)ctx->argc; i++)
+        if (list->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
         {
-            quotation[i] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-            quotation[i]->type = HEX_TYPE_STRING;
-            quotation[i]->data.str_value = strdup(ctx->argv[i]);
-        }
-        if (hex_push_quotation(ctx, quotation, ctx->argc) != 0)
-        {
-            hex_free_list(ctx, quotation, ctx->argc);
-            return 1;
+            hex_error(ctx, "[symbol %s] Quotation must contain only integers", symbol);
+            free(values);
+            return NULL;
         }
+        values[i] = list->data.quotation_value[i]->data.int_value;
     }
-    return 0;
+    return values;
 }
 
-int hex_symbol_exit(hex_context_t *ctx)
+int hex_symbol_vec(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
+    if (item->type == HEX_TYPE_VECTOR)
     {
-        HEX_FREE(ctx, item);
-        return 1;
+        if (HEX_PUSH(ctx, item) != 0)
+        {
+            HEX_FREE(ctx, item);
+            return 1;
+        }
+        return 0;
     }
-    if (item->type != HEX_TYPE_INTEGER)
+    int32_t *values = NULL;
+    size_t size = 0;
+    if (item->type == HEX_TYPE_QUOTATION)
+    {
+        values = hex_quotation_integers(ctx, "vec", item);
+        size = item->quotation_size;
+    }
+    else if (item->str_size % 4 != 0)
+    {
+        hex_error(ctx, "[symbol vec] Buffer size must be a multiple of 4");
+    }
+    else
+    {
+        // Buffers contain 32-bit little-endian integers
+        size = item->str_size / 4;
+        values = (int32_t *)malloc(size > 0 ? size * sizeof(int32_t) : 1);
+        if (!values)
+        {
+            hex_error(ctx, "[symbol vec] Memory allocation failed");
+        }
+        else
+        {
+            const uint8_t *bytes = item->data.buffer_value;
+            for (size_t i = 0; i < size; i++)
+            {
+                values[i] = (int32_t)((uint32_t)bytes[i * 4] | (uint32_t)bytes[i * 4 + 1] << 8 |
+                                      (uint32_t)bytes[i * 4 + 2] << 16 | (uint32_t)bytes[i * 4 + 3] << 24);
+            }
+        }
+    }
+    HEX_FREE(ctx, item);
+    if (!values)
     {
-        hex_error(ctx, "[symbol exit] Integer required");
-        HEX_FREE(ctx, item);
         return 1;
     }
-    int exit_status = item->data.int_value;
-    exit(exit_status);
-    return 0; // This line will never be reached, but it's here to satisfy the return type
+    return hex_push_vector(ctx, values, size);
 }
 
-int hex_symbol_exec(hex_context_t *ctx)
+// Find the minimum or maximum item of a quotation of comparable items, moving it out of the
+// quotation, or copying it if the items are shared
+static int hex_quotation_extreme(hex_context_t *ctx, hex_opcode_t op, const char *symbol, hex_item_t *list)
 {
-    HEX_POP(ctx, command);
-    if (command->type == HEX_TYPE_INVALID)
+    size_t found = 0;
+    for (size_t i = 1; i < list->quotation_size; i++)
     {
-        HEX_FREE(ctx, command);
-        return 1;
+        hex_item_t *a = list->data.quotation_value[i];
+        hex_item_t *b = list->data.quotation_value[found];
+        int greater = op == HEX_OP_MAX ? hex_greater(ctx, a, b, symbol) : hex_greater(ctx, b, a, symbol);
+        if (greater < 0)
+        {
+            return 1;
+        }
+        if (greater)
+        {
+            found = i;
+        }
     }
-    int result = 0;
-    if (command->type == HEX_TYPE_STRING)
+    hex_item_t *item = hex_take_item(ctx, list, found);
+    if (!item)
     {
-        int status = system(command->data.str_value);
-        result = hex_push_integer(ctx, status);
+        return 1;
     }
-    else
+    if (HEX_PUSH(ctx, item) != 0)
     {
-        hex_error(ctx, "[symbol exec] String required");
-        result = 1;
+        HEX_FREE(ctx, item);
+        return 1;
     }
-    return result;
+    return 0;
 }
 
-int hex_symbol_run(hex_context_t *ctx)
+static int hex_vector_reduction(hex_context_t *ctx, hex_opcode_t op, const char *symbol)
 {
-    HEX_POP(ctx, command);
-    if (command->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, item);
+    const int32_t *values = item->data.vector_value;
+    int32_t *copy = NULL;
+    if (item->quotation_size == 0 && op != HEX_OP_SUM)
     {
-        HEX_FREE(ctx, command);
+        hex_error(ctx, "[symbol %s] Vector or quotation must not be empty", symbol);
+        HEX_FREE(ctx, item);
         return 1;
     }
-    if (command->type != HEX_TYPE_STRING)
+    if (item->type == HEX_TYPE_QUOTATION && op != HEX_OP_SUM)
     {
-        hex_error(ctx, "[symbol run] String required");
-        HEX_FREE(ctx, command);
-        return 1;
+        // Quotations of other items than integers are compared like by > and <
+        for (size_t i = 0; i < item->quotation_size; i++)
+        {
+            if (item->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
+            {
+                int result = hex_quotation_extreme(ctx, op, symbol, item);
+                HEX_FREE(ctx, item);
+                return result;
+            }
+        }
     }
-
-    size_t output_len = 0, output_cap = 4096;
-    size_t error_len = 0, error_cap = 4096;
-    char *output = (char *)malloc(output_cap);
-    char *error_buf = (char *)malloc(error_cap);
-    if (!output || !error_buf)
+    if (item->type == HEX_TYPE_QUOTATION)
     {
-        free(output);
-        free(error_buf);
-        hex_error(ctx, "[symbol run] Memory allocation failed");
-        HEX_FREE(ctx, command);
-        return 1;
+        copy = hex_quotation_integers(ctx, symbol, item);
+        if (!copy)
+        {
+            HEX_FREE(ctx, item);
+            return 1;
+        }
+        values = copy;
     }
-    output[0] = '\0';
-    error_buf[0] = '\0';
-    int return_code = 0;
+    int32_t value = hex_vector_reduce(op, values, item->quotation_size);
+    free(copy);
+    HEX_FREE(ctx, item);
+    return hex_push_integer(ctx, value);
+}
 
-/* helper macro: append chunk to a dynamic buffer */
-#define RUN_APPEND(buf, buf_len, buf_cap, chunk, chunk_len)                              \
-    do {                                                                                  \
-        while ((buf_len) + (chunk_len) + 1 > (buf_cap))                                 \
-        {                                                                                 \
-            (buf_cap) *= 2;                                                              \
-            char *_tmp = (char *)realloc((buf), (buf_cap));                             \
-            if (!_tmp) { free(buf); (buf) = NULL; break; }                              \
-            (buf) = _tmp;                                                                \
-        }                                                                                \
-        if (buf) { memcpy((buf) + (buf_len), (chunk), (chunk_len)); (buf_len) += (chunk_len); (buf)[(buf_len)] = '\0'; } \
-    } while (0)
+int hex_symbol_sum(hex_context_t *ctx)
+{
+    return hex_vector_reduction(ctx, HEX_OP_SUM, "sum");
+}
 
-#ifdef _WIN32
-    // Windows implementation
-    HANDLE hOutputRead, hOutputWrite;
-    HANDLE hErrorRead, hErrorWrite;
-    SECURITY_ATTRIBUTES sa;
-    PROCESS_INFORMATION pi;
-    STARTUPINFO si;
-    DWORD exitCode;
+int hex_symbol_min(hex_context_t *ctx)
+{
+    return hex_vector_reduction(ctx, HEX_OP_MIN, "min");
+}
 
-    sa.nLength = sizeof(SECURITY_ATTRIBUTES);
-    sa.lpSecurityDescriptor = NULL;
-    sa.bInheritHandle = TRUE;
+int hex_symbol_max(hex_context_t *ctx)
+{
+    return hex_vector_reduction(ctx, HEX_OP_MAX, "max");
+}
 
-    // Create pipes for capturing stdout and stderr
-    if (!CreatePipe(&hOutputRead, &hOutputWrite, &sa, 0) || !CreatePipe(&hErrorRead, &hErrorWrite, &sa, 0))
+// Dictionary symbols
+
+// Build a dictionary from a quotation of key/value pairs, moving the items out of the quotation,
+// or copying them if they are shared
+int hex_symbol_dict(hex_context_t *ctx)
+{
+    HEX_POP(ctx, list);
+    hex_dict_t *dict = hex_dict_create();
+    if (!dict)
     {
-        hex_error(ctx, "[symbol run] Failed to create pipes");
-        free(output);
-        free(error_buf);
-        HEX_FREE(ctx, command);
+        hex_error(ctx, "[symbol dict] Memory allocation failed");
+        HEX_FREE(ctx, list);
+        return 1;
+    }
+    for (size_t i = 0; i < list->quotation_size; i++)
+    {
+        hex_item_t *pair = list->data.quotation_value[i];
+        if (pair->type != HEX_TYPE_QUOTATION || pair->quotation_size != 2)
+        {
+            hex_error(ctx, "[symbol dict] Quotation of key/value pairs required");
+            hex_dict_release(ctx, dict);
+            HEX_FREE(ctx, list);
+            return 1;
+        }
+        hex_item_t *key = pair->data.quotation_value[0];
+        hex_item_t *value = pair->data.quotation_value[1];
+        if (key->type != HEX_TYPE_INTEGER && key->type != HEX_TYPE_STRING)
+        {
+            hex_error(ctx, "[symbol dict] Key must be a string or an integer");
+            hex_dict_release(ctx, dict);
+            HEX_FREE(ctx, list);
+            return 1;
+        }
+        int shared = hex_is_shared(list) || hex_is_shared(pair);
+        if (shared)
+        {
+            key = hex_copy_item(ctx, key);
+            value = key ? hex_copy_item(ctx, value) : NULL;
+        }
+        if (!key || !value || hex_dict_put(ctx, dict, key, value) != 0)
+        {
+            hex_error(ctx, "[symbol dict] Memory allocation failed");
+            if (shared)
+            {
+                HEX_FREE(ctx, key);
+                HEX_FREE(ctx, value);
+            }
+            hex_dict_release(ctx, dict);
+            HEX_FREE(ctx, list);
+            return 1;
+        }
+        if (!shared)
+        {
+            pair->data.quotation_value[0] = NULL;
+            pair->data.quotation_value[1] = NULL;
+            pair->quotation_size = 0;
+        }
+    }
+    HEX_FREE(ctx, list);
+    return hex_push_dict(ctx, dict);
+}
+
+int hex_symbol_put(hex_context_t *ctx)
+{
+    HEX_POP(ctx, value);
+    HEX_POP(ctx, key);
+    HEX_POP(ctx, item);
+    // The dictionary is modified in place, unless other items share it
+    hex_dict_t *dict = hex_dict_unshare(ctx, item->data.dict_value);
+    if (!dict || hex_dict_put(ctx, dict, key, value) != 0)
+    {
+        hex_error(ctx, "[symbol put] Memory allocation failed");
+        HEX_FREE(ctx, item);
+        HEX_FREE(ctx, key);
+        HEX_FREE(ctx, value);
+        return 1;
+    }
+    item->data.dict_value = dict;
+    if (HEX_PUSH(ctx, item) != 0)
+    {
+        HEX_FREE(ctx, item);
+        return 1;
+    }
+    return 0;
+}
+
+int hex_symbol_has(hex_context_t *ctx)
+{
+    HEX_POP(ctx, key);
+    HEX_POP(ctx, item);
+    int found = hex_dict_get(item->data.dict_value, key) != NULL;
+    HEX_FREE(ctx, item);
+    HEX_FREE(ctx, key);
+    return hex_push_integer(ctx, found);
+}
+
+int hex_symbol_del(hex_context_t *ctx)
+{
+    HEX_POP(ctx, key);
+    HEX_POP(ctx, item);
+    int result = 0;
+    if (hex_dict_get(item->data.dict_value, key))
+    {
+        hex_dict_t *dict = hex_dict_unshare(ctx, item->data.dict_value);
+        if (!dict)
+        {
+            hex_error(ctx, "[symbol del] Memory allocation failed");
+            result = 1;
+        }
+        else
+        {
+            hex_dict_delete(ctx, dict, key);
+            item->data.dict_value = dict;
+        }
+    }
+    HEX_FREE(ctx, key);
+    if (result == 0)
+    {
+        result = HEX_PUSH(ctx, item);
+    }
+    if (result != 0)
+    {
+        HEX_FREE(ctx, item);
+    }
+    return result;
+}
+
+// List the keys of a dictionary in insertion order
+int hex_symbol_keys(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
+    hex_dict_t *dict = item->data.dict_value;
+    hex_item_t **quotation = (hex_item_t **)malloc((dict->size > 0 ? dict->size : 1) * sizeof(hex_item_t *));
+    if (!quotation)
+    {
+        hex_error(ctx, "[symbol keys] Memory allocation failed");
+        HEX_FREE(ctx, item);
+        return 1;
+    }
+    size_t size = 0;
+    for (size_t i = 0; i < dict->count; i++)
+    {
+        if (!dict->entries[i].key)
+        {
+            continue;
+        }
+        quotation[size] = hex_copy_item(ctx, dict->entries[i].key);
+        if (!quotation[size])
+        {
+            for (size_t j = 0; j < size; j++)
+            {
+                HEX_FREE(ctx, quotation[j]);
+            }
+            free(quotation);
+            HEX_FREE(ctx, item);
+            return 1;
+        }
+        size++;
+    }
+    HEX_FREE(ctx, item);
+    return hex_push_quotation(ctx, quotation, size);
+}
+
+// Sequence symbols
+
+// Read the next line of a file, without its line terminator: returns 1 and sets item
+// if there is one, 0 at the end of the file, and -1 on error
+static int hex_read_line(hex_context_t *ctx, const char *symbol, FILE *file, hex_item_t **item)
+{
+    // Bytes are read one at a time from the stream buffer, so that NUL bytes are kept,
+    // and appended to the line a chunk at a time
+    char chunk[1024];
+    hex_item_t *line = NULL;
+    int c = 0;
+    while (c != '\n' && c != EOF)
+    {
+        size_t size = 0;
+        while (size < sizeof(chunk) && (c = HEX_GETC(file)) != EOF)
+        {
+            chunk[size++] = (char)c;
+            if (c == '\n')
+            {
+                break;
+            }
+        }
+        if (size == 0)
+        {
+            break;
+        }
+        if (!line)
+        {
+            line = hex_string_bytes_item(ctx, chunk, size);
+            if (!line)
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            if (hex_string_reserve(line, line->str_size + size) != 0)
+            {
+                hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
+                HEX_FREE(ctx, line);
+                return -1;
+            }
+            memcpy(line->data.str_value + line->str_size, chunk, size);
+            line->str_size += size;
+            line->data.str_value[line->str_size] = '\0';
+        }
+    }
+    if (!line)
+    {
+        if (ferror(file))
+        {
+            hex_error(ctx, "[symbol %s] Could not read file", symbol);
+            return -1;
+        }
+        return 0;
+    }
+    char *str = line->data.str_value;
+    if (line->str_size > 0 && str[line->str_size - 1] == '\n')
+    {
+        line->str_size--;
+        if (line->str_size > 0 && str[line->str_size - 1] == '\r')
+        {
+            line->str_size--;
+        }
+        str[line->str_size] = '\0';
+    }
+    *item = line;
+    return 1;
+}
+
+// Read the next line of the file of a sequence, closing the file at its end
+static int hex_seq_line(hex_context_t *ctx, hex_seq_t *seq, hex_item_t **item)
+{
+    if (!seq->file)
+    {
+        return 0;
+    }
+    int result = hex_read_line(ctx, "lines", seq->file, item);
+    if (result <= 0)
+    {
+        fclose(seq->file);
+        seq->file = NULL;
+    }
+    return result;
+}
+
+// Produce the next item of a sequence: returns 1 and sets item if there is one,
+// 0 at the end of the sequence, and -1 on error
+static int hex_seq_next(hex_context_t *ctx, hex_seq_t *seq, hex_item_t **item)
+{
+    switch (seq->kind)
+    {
+    case HEX_SEQ_RANGE:
+        if (seq->current >= seq->end)
+        {
+            return 0;
+        }
+        *item = hex_integer_item(ctx, seq->current++);
+        return *item ? 1 : -1;
+
+    case HEX_SEQ_LINES:
+        return hex_seq_line(ctx, seq, item);
+
+    case HEX_SEQ_PIECES:
+        while (seq->position < seq->string->str_size)
+        {
+            size_t start = seq->position;
+            size_t end = hex_split_piece(seq->string, seq->separator, start, &seq->position);
+            if (end > start)
+            {
+                *item = hex_string_bytes_item(ctx, seq->string->data.str_value + start, end - start);
+                return *item ? 1 : -1;
+            }
+        }
+        return 0;
+
+    case HEX_SEQ_MAP:
+    {
+        int result = hex_seq_next(ctx, seq->source, item);
+        if (result <= 0)
+        {
+            return result;
+        }
+        int top = ctx->stack->top;
+        if (hex_push_moved(ctx, *item) != 0 || hex_apply(ctx, seq->action) != 0)
+        {
+            return -1;
+        }
+        if (ctx->stack->top != top + 1)
+        {
+            hex_error(ctx, "[symbol map] Quotation must push one item for each sequence item");
+            return -1;
+        }
+        *item = hex_pop(ctx);
+        return 1;
+    }
+
+    case HEX_SEQ_FILTER:
+        while (1)
+        {
+            int result = hex_seq_next(ctx, seq->source, item);
+            if (result <= 0)
+            {
+                return result;
+            }
+            int top = ctx->stack->top;
+            hex_item_t *copy = hex_copy_item(ctx, *item);
+            if (!copy || hex_push_moved(ctx, copy) != 0 || hex_apply(ctx, seq->action) != 0)
+            {
+                HEX_FREE(ctx, *item);
+                return -1;
+            }
+            if (ctx->stack->top != top + 1 || ctx->stack->entries[ctx->stack->top]->type != HEX_TYPE_INTEGER)
+            {
+                hex_error(ctx, "[symbol filter] Quotation must push an integer for each item");
+                HEX_FREE(ctx, *item);
+                return -1;
+            }
+            hex_item_t *condition = hex_pop(ctx);
+            int keep = condition->data.int_value > 0;
+            HEX_FREE(ctx, condition);
+            if (keep)
+            {
+                return 1;
+            }
+            HEX_FREE(ctx, *item);
+        }
+    }
+    return 0;
+}
+
+// Add a map or filter stage to a sequence item, which is owned by the calling native
+// and updated in place, taking ownership of the quotation
+static int hex_seq_stage(hex_context_t *ctx, hex_seq_kind_t kind, hex_item_t *list, hex_item_t *action)
+{
+    hex_seq_t *stage = hex_seq_create(kind);
+    if (!stage)
+    {
+        hex_error(ctx, "[symbol %s] Memory allocation failed", kind == HEX_SEQ_MAP ? "map" : "filter");
+        HEX_FREE(ctx, list);
+        HEX_FREE(ctx, action);
+        return 1;
+    }
+    stage->source = list->data.seq_value;
+    stage->action = action;
+    list->data.seq_value = stage;
+    if (HEX_PUSH(ctx, list) != 0)
+    {
+        HEX_FREE(ctx, list);
+        return 1;
+    }
+    return 0;
+}
+
+int hex_symbol_seq(hex_context_t *ctx)
+{
+    HEX_POP(ctx, end);
+    HEX_POP(ctx, start);
+    hex_seq_t *seq = hex_seq_create(HEX_SEQ_RANGE);
+    if (seq)
+    {
+        seq->current = start->data.int_value;
+        seq->end = end->data.int_value;
+    }
+    HEX_FREE(ctx, start);
+    HEX_FREE(ctx, end);
+    if (!seq)
+    {
+        hex_error(ctx, "[symbol seq] Memory allocation failed");
+        return 1;
+    }
+    return hex_push_seq(ctx, seq);
+}
+
+int hex_symbol_lines(hex_context_t *ctx)
+{
+    HEX_POP(ctx, filename);
+    FILE *file = fopen(filename->data.str_value, "r");
+    if (!file)
+    {
+        hex_error(ctx, "[symbol lines] Could not open file for reading: %s", filename->data.str_value);
+        HEX_FREE(ctx, filename);
+        return 1;
+    }
+    HEX_FREE(ctx, filename);
+    hex_seq_t *seq = hex_seq_create(HEX_SEQ_LINES);
+    if (!seq)
+    {
+        hex_error(ctx, "[symbol lines] Memory allocation failed");
+        fclose(file);
+        return 1;
+    }
+    seq->file = file;
+    return hex_push_seq(ctx, seq);
+}
+
+int hex_symbol_pieces(hex_context_t *ctx)
+{
+    HEX_POP(ctx, separator);
+    HEX_POP(ctx, str);
+    hex_seq_t *seq = hex_seq_create(HEX_SEQ_PIECES);
+    if (!seq)
+    {
+        hex_error(ctx, "[symbol pieces] Memory allocation failed");
+        HEX_FREE(ctx, str);
+        HEX_FREE(ctx, separator);
+        return 1;
+    }
+    seq->string = str;
+    seq->separator = separator;
+    return hex_push_seq(ctx, seq);
+}
+
+// Consume up to the given number of items of a sequence into a quotation
+int hex_symbol_take(hex_context_t *ctx)
+{
+    HEX_POP(ctx, count);
+    HEX_POP(ctx, list);
+    int32_t limit = count->data.int_value;
+    HEX_FREE(ctx, count);
+    hex_item_t *result = hex_quotation_item(ctx, NULL, 0);
+    if (!result)
+    {
+        HEX_FREE(ctx, list);
+        return 1;
+    }
+    for (int32_t i = 0; i < limit; i++)
+    {
+        hex_item_t *item = NULL;
+        int next = hex_seq_next(ctx, list->data.seq_value, &item);
+        if (next == 0)
+        {
+            break;
+        }
+        if (next < 0 || hex_quotation_reserve(result, result->quotation_size + 1) != 0)
+        {
+            if (next > 0)
+            {
+                hex_error(ctx, "[symbol take] Memory allocation failed");
+                HEX_FREE(ctx, item);
+            }
+            HEX_FREE(ctx, result);
+            HEX_FREE(ctx, list);
+            return 1;
+        }
+        result->data.quotation_value[result->quotation_size++] = item;
+    }
+    HEX_FREE(ctx, list);
+    return hex_push_edited(ctx, result);
+}
+
+// File symbols
+
+int hex_symbol_read(hex_context_t *ctx)
+{
+    HEX_POP(ctx, filename);
+    int result = 0;
+    FILE *file = fopen(filename->data.str_value, "rb");
+    if (!file)
+    {
+        hex_error(ctx, "[symbol read] Could not open file for reading: %s", filename->data.str_value);
+        result = 1;
+    }
+    else
+    {
+        fseek(file, 0, SEEK_END);
+        long length = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        uint8_t *buffer = (uint8_t *)malloc(length > 0 ? length : 1);
+        if (!buffer)
+        {
+            hex_error(ctx, "[symbol read] Memory allocation failed");
+            result = 1;
+        }
+        else
+        {
+            size_t bytesRead = fread(buffer, 1, length, file);
+            if (hex_is_binary(buffer, bytesRead))
+            {
+                // Binary files are returned as a buffer that takes over the bytes read
+                result = hex_push_buffer(ctx, buffer, bytesRead);
+                buffer = NULL;
+            }
+            else
+            {
+                size_t str_size;
+                char *str = hex_bytes_to_string(buffer, bytesRead, &str_size);
+                if (!str)
+                {
+                    hex_error(ctx, "[symbol read] Memory allocation failed");
+                    result = 1;
+                }
+                else
+                {
+                    result = hex_push_string_buffer(ctx, str, str_size);
+                }
+            }
+            free(buffer);
+        }
+        fclose(file);
+    }
+    HEX_FREE(ctx, filename);
+    return result;
+}
+
+// Write a string, a buffer, a vector or a quotation of bytes to a stream with a single fwrite
+static int hex_write_data(hex_context_t *ctx, const char *symbol, hex_item_t *data, FILE *file)
+{
+    const void *bytes = data->data.str_value;
+    size_t size = data->str_size;
+    uint8_t *packed = NULL;
+    if (data->type == HEX_TYPE_QUOTATION)
+    {
+        packed = (uint8_t *)malloc(data->quotation_size > 0 ? data->quotation_size : 1);
+        if (!packed)
+        {
+            hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
+            return 1;
+        }
+        for (size_t i = 0; i < data->quotation_size; i++)
+        {
+            if (data->data.quotation_value[i]->type != HEX_TYPE_INTEGER)
+            {
+                hex_error(ctx, "[symbol %s] Quotation must contain only integers", symbol);
+                free(packed);
+                return 1;
+            }
+            packed[i] = (uint8_t)data->data.quotation_value[i]->data.int_value;
+        }
+        bytes = packed;
+        size = data->quotation_size;
+    }
+    else if (data->type == HEX_TYPE_BUFFER)
+    {
+        bytes = data->data.buffer_value;
+    }
+    else if (data->type == HEX_TYPE_VECTOR)
+    {
+        // Vectors are written as 32-bit little-endian integers
+        size = data->quotation_size * 4;
+        packed = (uint8_t *)malloc(size > 0 ? size : 1);
+        if (!packed)
+        {
+            hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
+            return 1;
+        }
+        for (size_t i = 0; i < data->quotation_size; i++)
+        {
+            uint32_t value = (uint32_t)data->data.vector_value[i];
+            packed[i * 4] = value & 0xff;
+            packed[i * 4 + 1] = (value >> 8) & 0xff;
+            packed[i * 4 + 2] = (value >> 16) & 0xff;
+            packed[i * 4 + 3] = (value >> 24) & 0xff;
+        }
+        bytes = packed;
+    }
+    int result = 0;
+    if (fwrite(bytes, 1, size, file) != size)
+    {
+        hex_error(ctx, "[symbol %s] Could not write to file", symbol);
+        result = 1;
+    }
+    free(packed);
+    return result;
+}
+
+static int hex_write_file(hex_context_t *ctx, const char *symbol, const char *action, hex_item_t *data, const char *filename, const char *mode)
+{
+    FILE *file = fopen(filename, mode);
+    if (!file)
+    {
+        hex_error(ctx, "[symbol %s] Could not open file for %s: %s", symbol, action, filename);
+        return 1;
+    }
+    int result = hex_write_data(ctx, symbol, data, file);
+    fclose(file);
+    return result;
+}
+
+// Get the stream of an open file handle
+static FILE *hex_file_stream(hex_context_t *ctx, const char *symbol, hex_item_t *handle)
+{
+    int32_t i = handle->data.int_value;
+    if (i < 0 || i >= HEX_MAX_OPEN_FILES || !ctx->files[i])
+    {
+        hex_error(ctx, "[symbol %s] Invalid file handle", symbol);
+        return NULL;
+    }
+    // Output buffered by puts, print and warn goes first
+    if (i == 0)
+    {
+        hex_flush_output(ctx);
+    }
+    else if (i == 1)
+    {
+        hex_output_flush(&ctx->out);
+    }
+    else if (i == 2)
+    {
+        hex_output_flush(&ctx->err);
+    }
+    return ctx->files[i];
+}
+
+int hex_symbol_write(hex_context_t *ctx)
+{
+    HEX_POP(ctx, filename);
+    HEX_POP(ctx, data);
+    if (filename->type == HEX_TYPE_INTEGER)
+    {
+        // Write to an open file handle, through its buffer
+        FILE *file = hex_file_stream(ctx, "write", filename);
+        int result = file ? hex_write_data(ctx, "write", data, file) : 1;
+        HEX_FREE(ctx, data);
+        HEX_FREE(ctx, filename);
+        return result;
+    }
+    int result = hex_write_file(ctx, "write", "writing", data, filename->data.str_value, data->type == HEX_TYPE_STRING ? "w" : "wb");
+    HEX_FREE(ctx, data);
+    HEX_FREE(ctx, filename);
+    return result;
+}
+
+int hex_symbol_append(hex_context_t *ctx)
+{
+    HEX_POP(ctx, filename);
+    HEX_POP(ctx, data);
+    int result = hex_write_file(ctx, "append", "appending", data, filename->data.str_value, data->type == HEX_TYPE_STRING ? "a" : "ab");
+    HEX_FREE(ctx, data);
+    HEX_FREE(ctx, filename);
+    return result;
+}
+
+// Open a file and store its stream in the first free slot of the handle table
+int hex_symbol_open(hex_context_t *ctx)
+{
+    HEX_POP(ctx, mode);
+    HEX_POP(ctx, filename);
+    const char *modes[] = {"r", "rb", "w", "wb", "a", "ab"};
+    const char *file_mode = NULL;
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i += 2)
+    {
+        if (strcmp(mode->data.str_value, modes[i]) == 0)
+        {
+            file_mode = modes[i + 1];
+        }
+    }
+    int handle = 3;
+    while (handle < HEX_MAX_OPEN_FILES && ctx->files[handle])
+    {
+        handle++;
+    }
+    int result = 1;
+    if (!file_mode)
+    {
+        hex_error(ctx, "[symbol open] Invalid mode: %s", mode->data.str_value);
+    }
+    else if (handle == HEX_MAX_OPEN_FILES)
+    {
+        hex_error(ctx, "[symbol open] Too many open files");
+    }
+    else
+    {
+        FILE *file = fopen(filename->data.str_value, file_mode);
+        if (!file)
+        {
+            hex_error(ctx, "[symbol open] Could not open file: %s", filename->data.str_value);
+        }
+        else
+        {
+            setvbuf(file, NULL, _IOFBF, HEX_FILE_BUFFER_SIZE);
+            ctx->files[handle] = file;
+            result = hex_push_integer(ctx, handle);
+        }
+    }
+    HEX_FREE(ctx, mode);
+    HEX_FREE(ctx, filename);
+    return result;
+}
+
+int hex_symbol_close(hex_context_t *ctx)
+{
+    HEX_POP(ctx, handle);
+    int32_t i = handle->data.int_value;
+    HEX_FREE(ctx, handle);
+    if (i < 3 || i >= HEX_MAX_OPEN_FILES || !ctx->files[i])
+    {
+        hex_error(ctx, "[symbol close] Invalid file handle");
+        return 1;
+    }
+    int result = fclose(ctx->files[i]);
+    ctx->files[i] = NULL;
+    if (result != 0)
+    {
+        hex_error(ctx, "[symbol close] Could not write to file");
+        return 1;
+    }
+    return 0;
+}
+
+int hex_symbol_flush(hex_context_t *ctx)
+{
+    HEX_POP(ctx, handle);
+    FILE *file = hex_file_stream(ctx, "flush", handle);
+    HEX_FREE(ctx, handle);
+    if (!file)
+    {
+        return 1;
+    }
+    if (fflush(file) != 0)
+    {
+        hex_error(ctx, "[symbol flush] Could not write to file");
+        return 1;
+    }
+    return 0;
+}
+
+int hex_symbol_readl(hex_context_t *ctx)
+{
+    HEX_POP(ctx, handle);
+    FILE *file = hex_file_stream(ctx, "readl", handle);
+    HEX_FREE(ctx, handle);
+    if (!file)
+    {
+        return 1;
+    }
+    hex_item_t *line = NULL;
+    int result = hex_read_line(ctx, "readl", file, &line);
+    if (result < 0)
+    {
+        return 1;
+    }
+    if (result == 0)
+    {
+        // 0x0 is pushed at the end of the file, unlike an empty line
+        return hex_push_integer(ctx, 0);
+    }
+    if (HEX_PUSH(ctx, line) != 0)
+    {
+        HEX_FREE(ctx, line);
+        return 1;
+    }
+    return 0;
+}
+
+int hex_symbol_readb(hex_context_t *ctx)
+{
+    HEX_POP(ctx, count);
+    HEX_POP(ctx, handle);
+    FILE *file = hex_file_stream(ctx, "readb", handle);
+    size_t size = count->data.int_value > 0 ? (size_t)count->data.int_value : 0;
+    HEX_FREE(ctx, handle);
+    HEX_FREE(ctx, count);
+    if (!file)
+    {
+        return 1;
+    }
+    // The buffer grows as chunks are read, so that a large count does not allocate
+    // more than the bytes actually available
+    size_t capacity = size < HEX_READ_CHUNK ? size : HEX_READ_CHUNK;
+    uint8_t *data = (uint8_t *)malloc(capacity > 0 ? capacity : 1);
+    if (!data)
+    {
+        hex_error(ctx, "[symbol readb] Memory allocation failed");
+        return 1;
+    }
+    size_t read = 0;
+    while (read < size)
+    {
+        if (read == capacity)
+        {
+            capacity = capacity * 2 < size ? capacity * 2 : size;
+            uint8_t *grown = (uint8_t *)realloc(data, capacity);
+            if (!grown)
+            {
+                hex_error(ctx, "[symbol readb] Memory allocation failed");
+                free(data);
+                return 1;
+            }
+            data = grown;
+        }
+        size_t chunk = capacity - read < HEX_READ_CHUNK ? capacity - read : HEX_READ_CHUNK;
+        size_t bytes = fread(data + read, 1, chunk, file);
+        read += bytes;
+        if (bytes < chunk)
+        {
+            break;
+        }
+    }
+    if (read < size && ferror(file))
+    {
+        hex_error(ctx, "[symbol readb] Could not read file");
+        free(data);
+        return 1;
+    }
+    if (read < capacity && read > 0)
+    {
+        uint8_t *shrunk = (uint8_t *)realloc(data, read);
+        data = shrunk ? shrunk : data;
+    }
+    return hex_push_buffer(ctx, data, read);
+}
+
+int hex_symbol_eof(hex_context_t *ctx)
+{
+    HEX_POP(ctx, handle);
+    FILE *file = hex_file_stream(ctx, "eof", handle);
+    HEX_FREE(ctx, handle);
+    if (!file)
+    {
+        return 1;
+    }
+    // Peek at the next byte, as the end-of-file indicator is only set by a read
+    int c = fgetc(file);
+    if (c != EOF)
+    {
+        ungetc(c, file);
+    }
+    return hex_push_integer(ctx, c == EOF);
+}
+
+// Shell symbols
+
+int hex_symbol_args(hex_context_t *ctx)
+{
+    hex_item_t **quotation = (hex_item_t **)calloc(ctx->argc, sizeof(hex_item_t *));
+    if (!quotation)
+    {
+        hex_error(ctx, "[symbol args] Memory allocation failed");
+        return 1;
+    }
+    else
+    {
+        for (size_t i = 0; i < (size_t)ctx->argc; i++)
+        {
+            quotation[i] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
+            quotation[i]->type = HEX_TYPE_STRING;
+            quotation[i]->data.str_value = strdup(ctx->argv[i]);
+            quotation[i]->str_size = strlen(ctx->argv[i]);
+        }
+        if (hex_push_quotation(ctx, quotation, ctx->argc) != 0)
+        {
+            hex_free_list(ctx, quotation, ctx->argc);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int hex_symbol_exit(hex_context_t *ctx)
+{
+    HEX_POP(ctx, item);
+    int exit_status = item->data.int_value;
+    hex_flush_output(ctx);
+    exit(exit_status);
+    return 0; // This line will never be reached, but it's here to satisfy the return type
+}
+
+int hex_symbol_exec(hex_context_t *ctx)
+{
+    HEX_POP(ctx, command);
+    int result = 0;
+    hex_flush_output(ctx);
+    int status = system(command->data.str_value);
+    result = hex_push_integer(ctx, status);
+    return result;
+}
+
+int hex_symbol_run(hex_context_t *ctx)
+{
+    HEX_POP(ctx, command);
+    hex_flush_output(ctx);
+
+    size_t output_len = 0, output_cap = 4096;
+    size_t error_len = 0, error_cap = 4096;
+    char *output = (char *)malloc(output_cap);
+    char *error_buf = (char *)malloc(error_cap);
+    if (!output || !error_buf)
+    {
+        free(output);
+        free(error_buf);
+        hex_error(ctx, "[symbol run] Memory allocation failed");
+        HEX_FREE(ctx, command);
+        return 1;
+    }
+    output[0] = '\0';
+    error_buf[0] = '\0';
+    int return_code = 0;
+
+/* helper macro: append chunk to a dynamic buffer */
+#define RUN_APPEND(buf, buf_len, buf_cap, chunk, chunk_len)                              \
+    do {                                                                                  \
+        while ((buf_len) + (chunk_len) + 1 > (buf_cap))                                 \
+        {                                                                                 \
+            (buf_cap) *= 2;                                                              \
+            char *_tmp = (char *)realloc((buf), (buf_cap));                             \
+            if (!_tmp) { free(buf); (buf) = NULL; break; }                              \
+            (buf) = _tmp;                                                                \
+        }                                                                                \
+        if (buf) { memcpy((buf) + (buf_len), (chunk), (chunk_len)); (buf_len) += (chunk_len); (buf)[(buf_len)] = '\0'; } \
+    } while (0)
+
+#ifdef _WIN32
+    // Windows implementation
+    HANDLE hOutputRead, hOutputWrite;
+    HANDLE hErrorRead, hErrorWrite;
+    SECURITY_ATTRIBUTES sa;
+    PROCESS_INFORMATION pi;
+    STARTUPINFO si;
+    DWORD exitCode;
+
+    sa.nLength = sizeof(SECURITY_ATTRIBUTES);
+    sa.lpSecurityDescriptor = NULL;
+    sa.bInheritHandle = TRUE;
+
+    // Create pipes for capturing stdout and stderr
+    if (!CreatePipe(&hOutputRead, &hOutputWrite, &sa, 0) || !CreatePipe(&hErrorRead, &hErrorWrite, &sa, 0))
+    {
+        hex_error(ctx, "[symbol run] Failed to create pipes");
+        free(output);
+        free(error_buf);
+        HEX_FREE(ctx, command);
         return 1;
     }
 
@@ -2209,560 +3157,1081 @@ int hex_symbol_run(hex_context_t *ctx)
         HEX_FREE(ctx, command);
         return 1;
     }
-
-    // Close write ends of the pipes
-    CloseHandle(hOutputWrite);
-    CloseHandle(hErrorWrite);
-
-    // Read stdout
-    DWORD bytesRead;
-    char buffer[1024];
-    while (ReadFile(hOutputRead, buffer, sizeof(buffer) - 1, &bytesRead, NULL) && bytesRead > 0)
+
+    // Close write ends of the pipes
+    CloseHandle(hOutputWrite);
+    CloseHandle(hErrorWrite);
+
+    // Read stdout
+    DWORD bytesRead;
+    char buffer[1024];
+    while (ReadFile(hOutputRead, buffer, sizeof(buffer) - 1, &bytesRead, NULL) && bytesRead > 0)
+    {
+        buffer[bytesRead] = '\0';
+        RUN_APPEND(output, output_len, output_cap, buffer, bytesRead);
+    }
+
+    // Read stderr
+    while (ReadFile(hErrorRead, buffer, sizeof(buffer) - 1, &bytesRead, NULL) && bytesRead > 0)
+    {
+        buffer[bytesRead] = '\0';
+        RUN_APPEND(error_buf, error_len, error_cap, buffer, bytesRead);
+    }
+
+    // Wait for the child process to finish and get the return code
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    GetExitCodeProcess(pi.hProcess, &exitCode);
+    return_code = exitCode;
+
+    // Close handles
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+    CloseHandle(hOutputRead);
+    CloseHandle(hErrorRead);
+#else
+    // POSIX implementation (Linux/macOS)
+    int stdout_pipe[2];
+    int stderr_pipe[2];
+    if (pipe(stdout_pipe) != 0 || pipe(stderr_pipe) != 0)
+    {
+        hex_error(ctx, "[symbol run] Failed to create pipes");
+        free(output);
+        free(error_buf);
+        HEX_FREE(ctx, command);
+        return 1;
+    }
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        hex_error(ctx, "[symbol run] Failed to fork process");
+        free(output);
+        free(error_buf);
+        HEX_FREE(ctx, command);
+        return 1;
+    }
+    else if (pid == 0)
+    {
+        // Child process
+        close(stdout_pipe[0]);
+        close(stderr_pipe[0]);
+        dup2(stdout_pipe[1], STDOUT_FILENO);
+        dup2(stderr_pipe[1], STDERR_FILENO);
+        execl("/bin/sh", "sh", "-c", command->data.str_value, (char *)NULL);
+        exit(1);
+    }
+    else
+    {
+        // Parent process
+        close(stdout_pipe[1]);
+        close(stderr_pipe[1]);
+
+        // Read stdout
+        FILE *stdout_fp = fdopen(stdout_pipe[0], "r");
+        char path[1035];
+        while (fgets(path, sizeof(path), stdout_fp) != NULL)
+        {
+            size_t chunk_len = strlen(path);
+            RUN_APPEND(output, output_len, output_cap, path, chunk_len);
+        }
+        fclose(stdout_fp);
+
+        // Read stderr
+        FILE *stderr_fp = fdopen(stderr_pipe[0], "r");
+        while (fgets(path, sizeof(path), stderr_fp) != NULL)
+        {
+            size_t chunk_len = strlen(path);
+            RUN_APPEND(error_buf, error_len, error_cap, path, chunk_len);
+        }
+        fclose(stderr_fp);
+
+        // Wait for child process to finish and get the return code
+        int status;
+        waitpid(pid, &status, 0);
+        return_code = WEXITSTATUS(status);
+    }
+#endif
+#undef RUN_APPEND
+
+    if (!output || !error_buf)
+    {
+        free(output);
+        free(error_buf);
+        hex_error(ctx, "[symbol run] Memory allocation failed while reading output");
+        HEX_FREE(ctx, command);
+        return 1;
+    }
+
+    // Push the return code, output, and error as a quotation
+    hex_item_t **quotation = (hex_item_t **)calloc(3, sizeof(hex_item_t *));
+    quotation[0] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
+    quotation[0]->type = HEX_TYPE_INTEGER;
+    quotation[0]->data.int_value = return_code;
+
+    quotation[1] = hex_string_buffer_item(ctx, output, output_len);      // transfer ownership
+    quotation[2] = hex_string_buffer_item(ctx, error_buf, error_len);    // transfer ownership
+
+    HEX_FREE(ctx, command);
+    return hex_push_quotation(ctx, quotation, 3);
+}
+
+// Control flow symbols
+
+int hex_symbol_if(hex_context_t *ctx)
+{
+    HEX_POP(ctx, elseBlock);
+    HEX_POP(ctx, thenBlock);
+    HEX_POP(ctx, condition);
+
+    for (size_t i = 0; i < condition->quotation_size; i++)
+    {
+        hex_item_t *copy = hex_copy_item(ctx, condition->data.quotation_value[i]);
+        if (!copy || hex_push(ctx, copy) != 0)
+        {
+            if (copy)
+                hex_free_item(ctx, copy);
+            HEX_FREE(ctx, condition);
+            HEX_FREE(ctx, thenBlock);
+            HEX_FREE(ctx, elseBlock);
+            return 1;
+        }
+    }
+    HEX_POP(ctx, evalResult);
+    if (evalResult->type == HEX_TYPE_INTEGER && evalResult->data.int_value > 0)
+    {
+        for (size_t i = 0; i < thenBlock->quotation_size; i++)
+        {
+            hex_item_t *copy = hex_copy_item(ctx, thenBlock->data.quotation_value[i]);
+            if (!copy || hex_push(ctx, copy) != 0)
+            {
+                if (copy)
+                    hex_free_item(ctx, copy);
+                HEX_FREE(ctx, condition);
+                HEX_FREE(ctx, thenBlock);
+                HEX_FREE(ctx, elseBlock);
+                HEX_FREE(ctx, evalResult);
+                return 1;
+            }
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < elseBlock->quotation_size; i++)
+        {
+            hex_item_t *copy = hex_copy_item(ctx, elseBlock->data.quotation_value[i]);
+            if (!copy || hex_push(ctx, copy) != 0)
+            {
+                if (copy)
+                    hex_free_item(ctx, copy);
+                HEX_FREE(ctx, condition);
+                HEX_FREE(ctx, thenBlock);
+                HEX_FREE(ctx, elseBlock);
+                HEX_FREE(ctx, evalResult);
+                return 1;
+            }
+        }
+    }
+    HEX_FREE(ctx, evalResult);
+    HEX_FREE(ctx, condition);
+    HEX_FREE(ctx, thenBlock);
+    HEX_FREE(ctx, elseBlock);
+    return 0;
+}
+
+int hex_symbol_while(hex_context_t *ctx)
+{
+    HEX_POP(ctx, action);
+    HEX_POP(ctx, condition);
+
+    while (1)
+    {
+        for (size_t i = 0; i < condition->quotation_size; i++)
+        {
+            // Create a copy to avoid ownership issues
+            hex_item_t *copy = hex_copy_item(ctx, condition->data.quotation_value[i]);
+            if (!copy || hex_push(ctx, copy) != 0)
+            {
+                if (copy)
+                    hex_free_item(ctx, copy);
+                HEX_FREE(ctx, action);
+                HEX_FREE(ctx, condition);
+                return 1;
+            }
+        }
+        HEX_POP(ctx, evalResult);
+        if (evalResult->type == HEX_TYPE_INTEGER && evalResult->data.int_value == 0)
+        {
+            // Don't free evalResult here as it might be shared - let normal cleanup handle it
+            break;
+        }
+
+        hex_item_t *act = hex_copy_item(ctx, action);
+        for (size_t i = 0; i < act->quotation_size; i++)
+        {
+            // Create a copy to avoid ownership issues
+            hex_item_t *copy = hex_copy_item(ctx, act->data.quotation_value[i]);
+            if (!copy || hex_push(ctx, copy) != 0)
+            {
+                if (copy)
+                    hex_free_item(ctx, copy);
+                HEX_FREE(ctx, act);
+                HEX_FREE(ctx, action);
+                HEX_FREE(ctx, condition);
+                return 1;
+            }
+        }
+        HEX_FREE(ctx, act); // Free the temporary copy
+    }
+
+    // Clean up after successful completion
+    HEX_FREE(ctx, action);
+    HEX_FREE(ctx, condition);
+    return 0;
+}
+
+int hex_symbol_times(hex_context_t *ctx)
+{
+    HEX_POP(ctx, count);
+    HEX_POP(ctx, action);
+    int result = 0;
+    for (int32_t i = 0; i < count->data.int_value && result == 0; i++)
+    {
+        result = hex_apply(ctx, action);
+    }
+    HEX_FREE(ctx, count);
+    HEX_FREE(ctx, action);
+    return result;
+}
+
+// Apply a quotation to the given number of items, unless it was applied to equal items
+// before: the items it pushed then are pushed again instead. The quotation must not
+// depend on anything else than these items.
+int hex_symbol_memo(hex_context_t *ctx)
+{
+    HEX_POP(ctx, arity);
+    HEX_POP(ctx, action);
+    int32_t n = arity->data.int_value;
+    HEX_FREE(ctx, arity);
+    if (n < 0 || n > ctx->stack->top + 1)
+    {
+        hex_error(ctx, "[symbol memo] Invalid arity");
+        HEX_FREE(ctx, action);
+        return 1;
+    }
+    // The results are kept for a quotation of the inputs followed by the quotation applied
+    int base = ctx->stack->top - n;
+    hex_item_t **items = (hex_item_t **)calloc(n + 1, sizeof(hex_item_t *));
+    hex_item_t *key = items ? hex_quotation_item(ctx, items, n + 1) : NULL;
+    if (!key)
+    {
+        hex_error(ctx, "[symbol memo] Memory allocation failed");
+        free(items);
+        HEX_FREE(ctx, action);
+        return 1;
+    }
+    items[n] = action;
+    for (int i = 0; i < n; i++)
     {
-        buffer[bytesRead] = '\0';
-        RUN_APPEND(output, output_len, output_cap, buffer, bytesRead);
+        items[i] = hex_copy_item(ctx, ctx->stack->entries[base + 1 + i]);
+        if (!items[i])
+        {
+            HEX_FREE(ctx, key);
+            return 1;
+        }
     }
-
-    // Read stderr
-    while (ReadFile(hErrorRead, buffer, sizeof(buffer) - 1, &bytesRead, NULL) && bytesRead > 0)
+    size_t hash = hex_item_hash(key);
+    hex_item_t *outputs = hex_memo_get(ctx, key, hash);
+    if (outputs)
     {
-        buffer[bytesRead] = '\0';
-        RUN_APPEND(error_buf, error_len, error_cap, buffer, bytesRead);
+        HEX_FREE(ctx, key);
+        for (int i = 0; i < n; i++)
+        {
+            HEX_FREE(ctx, hex_pop(ctx));
+        }
+        for (size_t i = 0; i < outputs->quotation_size; i++)
+        {
+            hex_item_t *copy = hex_copy_item(ctx, outputs->data.quotation_value[i]);
+            if (!copy || HEX_PUSH(ctx, copy) != 0)
+            {
+                HEX_FREE(ctx, copy);
+                return 1;
+            }
+        }
+        return 0;
     }
-
-    // Wait for the child process to finish and get the return code
-    WaitForSingleObject(pi.hProcess, INFINITE);
-    GetExitCodeProcess(pi.hProcess, &exitCode);
-    return_code = exitCode;
-
-    // Close handles
-    CloseHandle(pi.hProcess);
-    CloseHandle(pi.hThread);
-    CloseHandle(hOutputRead);
-    CloseHandle(hErrorRead);
-#else
-    // POSIX implementation (Linux/macOS)
-    int stdout_pipe[2];
-    int stderr_pipe[2];
-    if (pipe(stdout_pipe) != 0 || pipe(stderr_pipe) != 0)
+    if (hex_apply(ctx, action) != 0)
     {
-        hex_error(ctx, "[symbol run] Failed to create pipes");
-        free(output);
-        free(error_buf);
-        HEX_FREE(ctx, command);
+        HEX_FREE(ctx, key);
         return 1;
     }
-
-    pid_t pid = fork();
-    if (pid == -1)
+    if (ctx->stack->top < base)
     {
-        hex_error(ctx, "[symbol run] Failed to fork process");
-        free(output);
-        free(error_buf);
-        HEX_FREE(ctx, command);
-        return 1;
+        // The quotation consumed more items than its inputs: its results are not kept
+        HEX_FREE(ctx, key);
+        return 0;
     }
-    else if (pid == 0)
+    size_t count = ctx->stack->top - base;
+    hex_item_t **results = (hex_item_t **)calloc(count > 0 ? count : 1, sizeof(hex_item_t *));
+    outputs = results ? hex_quotation_item(ctx, results, count) : NULL;
+    if (!outputs)
     {
-        // Child process
-        close(stdout_pipe[0]);
-        close(stderr_pipe[0]);
-        dup2(stdout_pipe[1], STDOUT_FILENO);
-        dup2(stderr_pipe[1], STDERR_FILENO);
-        execl("/bin/sh", "sh", "-c", command->data.str_value, (char *)NULL);
-        exit(1);
+        free(results);
     }
-    else
+    for (size_t i = 0; outputs && i < count; i++)
     {
-        // Parent process
-        close(stdout_pipe[1]);
-        close(stderr_pipe[1]);
-
-        // Read stdout
-        FILE *stdout_fp = fdopen(stdout_pipe[0], "r");
-        char path[1035];
-        while (fgets(path, sizeof(path), stdout_fp) != NULL)
+        results[i] = hex_copy_item(ctx, ctx->stack->entries[base + 1 + i]);
+        if (!results[i])
         {
-            size_t chunk_len = strlen(path);
-            RUN_APPEND(output, output_len, output_cap, path, chunk_len);
+            outputs->quotation_size = i;
+            HEX_FREE(ctx, outputs);
+            outputs = NULL;
         }
-        fclose(stdout_fp);
+    }
+    if (!outputs || hex_memo_put(ctx, key, hash, outputs) != 0)
+    {
+        hex_error(ctx, "[symbol memo] Memory allocation failed");
+        HEX_FREE(ctx, outputs);
+        HEX_FREE(ctx, key);
+        return 1;
+    }
+    return 0;
+}
 
-        // Read stderr
-        FILE *stderr_fp = fdopen(stderr_pipe[0], "r");
-        while (fgets(path, sizeof(path), stderr_fp) != NULL)
+// Push a dictionary of the number of results kept by memo, and of the lookups that
+// found results (hits), that did not (misses), and of the results evicted
+int hex_symbol_memostats(hex_context_t *ctx)
+{
+    const char *names[] = {"size", "hits", "misses", "evictions"};
+    size_t values[] = {ctx->memo.size, ctx->memo.hits, ctx->memo.misses, ctx->memo.evictions};
+    hex_dict_t *dict = hex_dict_create();
+    if (!dict)
+    {
+        hex_error(ctx, "[symbol memostats] Memory allocation failed");
+        return 1;
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        hex_item_t *key = hex_string_item(ctx, names[i]);
+        hex_item_t *value = key ? hex_integer_item(ctx, (int)values[i]) : NULL;
+        if (!value || hex_dict_put(ctx, dict, key, value) != 0)
         {
-            size_t chunk_len = strlen(path);
-            RUN_APPEND(error_buf, error_len, error_cap, path, chunk_len);
+            hex_error(ctx, "[symbol memostats] Memory allocation failed");
+            HEX_FREE(ctx, key);
+            HEX_FREE(ctx, value);
+            hex_dict_release(ctx, dict);
+            return 1;
         }
-        fclose(stderr_fp);
-
-        // Wait for child process to finish and get the return code
-        int status;
-        waitpid(pid, &status, 0);
-        return_code = WEXITSTATUS(status);
     }
-#endif
-#undef RUN_APPEND
+    return hex_push_dict(ctx, dict);
+}
 
-    if (!output || !error_buf)
+int hex_symbol_error(hex_context_t *ctx)
+{
+    char *message = strdup(hex_error_message(ctx));
+    hex_clear_error(ctx);
+    int result = hex_push_string(ctx, message);
+    free(message);
+    return result;
+}
+
+int hex_symbol_try(hex_context_t *ctx)
+{
+    HEX_POP(ctx, catch_block);
+    HEX_POP(ctx, try_block);
+
+    // Errors raised within the try block are neither printed nor formatted
+    // until they are read; the first failure unwinds straight to the catch block.
+    hex_try_frame_t frame;
+    hex_enter_try(ctx, &frame);
+    int failed = 0;
+    for (size_t i = 0; i < try_block->quotation_size; i++)
     {
-        free(output);
-        free(error_buf);
-        hex_error(ctx, "[symbol run] Memory allocation failed while reading output");
-        HEX_FREE(ctx, command);
-        return 1;
+        hex_item_t *copy = hex_copy_item(ctx, try_block->data.quotation_value[i]);
+        if (!copy || hex_push(ctx, copy) != 0)
+        {
+            if (copy)
+                hex_free_item(ctx, copy);
+            failed = 1;
+            break;
+        }
     }
+    hex_leave_try(ctx, &frame);
 
-    // Push the return code, output, and error as a quotation
-    hex_item_t **quotation = (hex_item_t **)calloc(3, sizeof(hex_item_t *));
-    quotation[0] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-    quotation[0]->type = HEX_TYPE_INTEGER;
-    quotation[0]->data.int_value = return_code;
-
-    quotation[1] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-    quotation[1]->type = HEX_TYPE_STRING;
-    quotation[1]->data.str_value = output; // transfer ownership
+    if (failed || hex_has_error(ctx))
+    {
+        if (ctx->settings->debugging_enabled)
+        {
+            hex_debug(ctx, "[symbol try] Handling error: %s", hex_error_message(ctx));
+        }
+        for (size_t i = 0; i < catch_block->quotation_size; i++)
+        {
+            hex_item_t *copy = hex_copy_item(ctx, catch_block->data.quotation_value[i]);
+            if (!copy || hex_push(ctx, copy) != 0)
+            {
+                if (copy)
+                    hex_free_item(ctx, copy);
+                HEX_FREE(ctx, catch_block);
+                HEX_FREE(ctx, try_block);
+                return 1;
+            }
+        }
+    }
 
-    quotation[2] = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-    quotation[2]->type = HEX_TYPE_STRING;
-    quotation[2]->data.str_value = error_buf; // transfer ownership
+    hex_restore_error(ctx, &frame);
+    HEX_FREE(ctx, catch_block);
+    HEX_FREE(ctx, try_block);
+    return 0;
+}
 
-    HEX_FREE(ctx, command);
-    return hex_push_quotation(ctx, quotation, 3);
+int hex_symbol_throw(hex_context_t *ctx)
+{
+    HEX_POP(ctx, message);
+    hex_error(ctx, "%s", message->data.str_value);
+    HEX_FREE(ctx, message);
+    return 1;
 }
 
-// Control flow symbols
+// Quotation symbols
 
-int hex_symbol_if(hex_context_t *ctx)
+int hex_symbol_q(hex_context_t *ctx)
 {
-    HEX_POP(ctx, elseBlock);
-    ;
-    if (elseBlock->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, elseBlock);
-        return 1;
-    }
-    HEX_POP(ctx, thenBlock);
-    ;
-    if (thenBlock->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, item);
+
+    // The popped item is owned by this native, so it is moved into the quotation
+    hex_item_t *result = (hex_item_t *)calloc(1, sizeof(hex_item_t));
+    if (!result)
     {
-        HEX_FREE(ctx, thenBlock);
-        HEX_FREE(ctx, elseBlock);
+        hex_error(ctx, "[symbol '] Memory allocation failed");
+        HEX_FREE(ctx, item);
         return 1;
     }
-    HEX_POP(ctx, condition);
-    ;
-    if (condition->type == HEX_TYPE_INVALID)
+
+    result->type = HEX_TYPE_QUOTATION;
+    result->data.quotation_value = (hex_item_t **)calloc(1, sizeof(hex_item_t *));
+    if (!result->data.quotation_value)
     {
-        HEX_FREE(ctx, condition);
-        HEX_FREE(ctx, thenBlock);
-        HEX_FREE(ctx, elseBlock);
+        hex_error(ctx, "[symbol '] Memory allocation failed");
+        HEX_FREE(ctx, item);
+        HEX_FREE(ctx, result);
         return 1;
     }
 
-    if (condition->type != HEX_TYPE_QUOTATION || thenBlock->type != HEX_TYPE_QUOTATION || elseBlock->type != HEX_TYPE_QUOTATION)
+    result->data.quotation_value[0] = item;
+    result->quotation_size = 1;
+
+    if (HEX_PUSH(ctx, result) != 0)
     {
-        hex_error(ctx, "[symbol if] Three quotations required");
-        HEX_FREE(ctx, condition);
-        HEX_FREE(ctx, thenBlock);
-        HEX_FREE(ctx, elseBlock);
+        HEX_FREE(ctx, result); // will free contained copy via list free
         return 1;
     }
-    else
+    return 0;
+}
+
+// Compile a quotation made only of integers, dup, swap, drop and elementwise
+// operators into a kernel, checking that it turns one integer into one integer
+// without exceeding HEX_KERNEL_DEPTH items. Returns the number of steps, or -1 if
+// the quotation cannot be compiled.
+static int hex_kernel_compile(hex_item_t *action, hex_kernel_step_t *steps)
+{
+    int depth = 1;
+    for (size_t i = 0; i < action->quotation_size; i++)
     {
-        for (size_t i = 0; i < condition->quotation_size; i++)
+        hex_item_t *item = action->data.quotation_value[i];
+        uint8_t op = 0;
+        if (item->type == HEX_TYPE_INTEGER)
         {
-            hex_item_t *copy = hex_copy_item(ctx, condition->data.quotation_value[i]);
-            if (!copy || hex_push(ctx, copy) != 0)
+            depth++;
+        }
+        else if (item->type == HEX_TYPE_NATIVE_SYMBOL)
+        {
+            op = hex_symbol_to_opcode(item->token->value);
+            switch (op)
             {
-                if (copy)
-                    hex_free_item(ctx, copy);
-                HEX_FREE(ctx, condition);
-                HEX_FREE(ctx, thenBlock);
-                HEX_FREE(ctx, elseBlock);
-                return 1;
+            case HEX_OP_DUP:
+                depth = depth < 1 ? -1 : depth + 1;
+                break;
+            case HEX_OP_SWAP:
+                depth = depth < 2 ? -1 : depth;
+                break;
+            case HEX_OP_DROP:
+                depth = depth < 1 ? -1 : depth - 1;
+                break;
+            case HEX_OP_ADD:
+            case HEX_OP_SUBTRACT:
+            case HEX_OP_MULTIPLY:
+            case HEX_OP_BITAND:
+            case HEX_OP_BITOR:
+            case HEX_OP_BITXOR:
+            case HEX_OP_SHL:
+            case HEX_OP_SHR:
+            case HEX_OP_EQUAL:
+            case HEX_OP_NOTEQUAL:
+            case HEX_OP_GREATER:
+            case HEX_OP_LESS:
+            case HEX_OP_GREATEREQUAL:
+            case HEX_OP_LESSEQUAL:
+                depth = depth < 2 ? -1 : depth - 1;
+                break;
+            default:
+                return -1;
             }
         }
-        HEX_POP(ctx, evalResult);
-        if (evalResult->type == HEX_TYPE_INTEGER && evalResult->data.int_value > 0)
+        else
+        {
+            return -1;
+        }
+        if (depth < 0 || depth > HEX_KERNEL_DEPTH)
+        {
+            return -1;
+        }
+        steps[i].op = op;
+        steps[i].value = item->data.int_value;
+    }
+    return depth == 1 ? (int)action->quotation_size : -1;
+}
+
+// Run a compiled kernel over a vector in place, one block of elements at a time:
+// each step processes a whole block, so operators run through hex_vector_apply.
+// Items on the kernel stack are blocks of HEX_KERNEL_BLOCK elements or literals.
+static void hex_kernel_run(const hex_kernel_step_t *steps, int count, int32_t *values, size_t size)
+{
+    int32_t registers[HEX_KERNEL_DEPTH][HEX_KERNEL_BLOCK];
+    const int32_t *operands[HEX_KERNEL_DEPTH];
+    size_t operand_steps[HEX_KERNEL_DEPTH];
+    for (size_t start = 0; start < size; start += HEX_KERNEL_BLOCK)
+    {
+        size_t block = size - start < HEX_KERNEL_BLOCK ? size - start : HEX_KERNEL_BLOCK;
+        int depth = 1;
+        operands[0] = values + start;
+        operand_steps[0] = 1;
+        for (int k = 0; k < count; k++)
         {
-            for (size_t i = 0; i < thenBlock->quotation_size; i++)
+            const int32_t *operand;
+            size_t operand_step;
+            switch (steps[k].op)
+            {
+            case 0:
+                operands[depth] = &steps[k].value;
+                operand_steps[depth++] = 0;
+                break;
+            case HEX_OP_DUP:
+                operands[depth] = operands[depth - 1];
+                operand_steps[depth] = operand_steps[depth - 1];
+                depth++;
+                break;
+            case HEX_OP_SWAP:
+                operand = operands[depth - 1];
+                operand_step = operand_steps[depth - 1];
+                operands[depth - 1] = operands[depth - 2];
+                operand_steps[depth - 1] = operand_steps[depth - 2];
+                operands[depth - 2] = operand;
+                operand_steps[depth - 2] = operand_step;
+                break;
+            case HEX_OP_DROP:
+                depth--;
+                break;
+            default:
             {
-                hex_item_t *copy = hex_copy_item(ctx, thenBlock->data.quotation_value[i]);
-                if (!copy || hex_push(ctx, copy) != 0)
+                // Write the result into a register that no item below the operands refers to
+                int r = 0;
+                for (int j = 0; j < depth - 2; j++)
                 {
-                    if (copy)
-                        hex_free_item(ctx, copy);
-                    HEX_FREE(ctx, condition);
-                    HEX_FREE(ctx, thenBlock);
-                    HEX_FREE(ctx, elseBlock);
-                    HEX_FREE(ctx, evalResult);
-                    return 1;
+                    if (operands[j] == registers[r])
+                    {
+                        r++;
+                        j = -1;
+                    }
                 }
+                hex_vector_apply(steps[k].op, registers[r], operands[depth - 2], operand_steps[depth - 2], operands[depth - 1], operand_steps[depth - 1], block);
+                depth--;
+                operands[depth - 1] = registers[r];
+                operand_steps[depth - 1] = 1;
+                break;
+            }
             }
         }
-        else
+        if (operand_steps[0] == 0)
         {
-            for (size_t i = 0; i < elseBlock->quotation_size; i++)
+            for (size_t i = 0; i < block; i++)
             {
-                hex_item_t *copy = hex_copy_item(ctx, elseBlock->data.quotation_value[i]);
-                if (!copy || hex_push(ctx, copy) != 0)
-                {
-                    if (copy)
-                        hex_free_item(ctx, copy);
-                    HEX_FREE(ctx, condition);
-                    HEX_FREE(ctx, thenBlock);
-                    HEX_FREE(ctx, elseBlock);
-                    HEX_FREE(ctx, evalResult);
-                    return 1;
-                }
+                values[start + i] = operands[0][0];
             }
         }
-        HEX_FREE(ctx, evalResult);
-        HEX_FREE(ctx, condition);
-        HEX_FREE(ctx, thenBlock);
-        HEX_FREE(ctx, elseBlock);
+        else if (operands[0] != values + start)
+        {
+            memcpy(values + start, operands[0], block * sizeof(int32_t));
+        }
+    }
+}
+
+// Apply a quotation to each element of a vector, which is owned by map and updated in place
+static int hex_map_vector(hex_context_t *ctx, hex_item_t *action, hex_item_t *list)
+{
+    hex_kernel_step_t *steps = (hex_kernel_step_t *)malloc((action->quotation_size + 1) * sizeof(hex_kernel_step_t));
+    if (!steps)
+    {
+        hex_error(ctx, "[symbol map] Memory allocation failed");
+        return 1;
+    }
+    int count = hex_kernel_compile(action, steps);
+    if (count >= 0)
+    {
+        hex_kernel_run(steps, count, list->data.vector_value, list->quotation_size);
+        free(steps);
+        return 0;
+    }
+    free(steps);
+    // Other quotations are dequoted for each element, and must push one integer
+    for (size_t i = 0; i < list->quotation_size; i++)
+    {
+        int top = ctx->stack->top;
+        if (hex_push_integer(ctx, list->data.vector_value[i]) != 0 || hex_apply(ctx, action) != 0)
+        {
+            return 1;
+        }
+        if (ctx->stack->top != top + 1 || ctx->stack->entries[ctx->stack->top]->type != HEX_TYPE_INTEGER)
+        {
+            hex_error(ctx, "[symbol map] Quotation must push an integer for each vector element");
+            return 1;
+        }
+        hex_item_t *result_item = hex_pop(ctx);
+        list->data.vector_value[i] = result_item->data.int_value;
+        HEX_FREE(ctx, result_item);
     }
     return 0;
 }
 
-int hex_symbol_while(hex_context_t *ctx)
+int hex_symbol_map(hex_context_t *ctx)
 {
     HEX_POP(ctx, action);
-    ;
-    if (action->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, list);
+    if (list->type == HEX_TYPE_SEQUENCE)
     {
-        HEX_FREE(ctx, action);
-        return 1;
+        return hex_seq_stage(ctx, HEX_SEQ_MAP, list, action);
     }
-    HEX_POP(ctx, condition);
-    ;
-    if (condition->type == HEX_TYPE_INVALID)
+    if (list->type == HEX_TYPE_VECTOR)
     {
+        int result = hex_map_vector(ctx, action, list);
         HEX_FREE(ctx, action);
-        HEX_FREE(ctx, condition);
+        if (result == 0 && HEX_PUSH(ctx, list) == 0)
+        {
+            return 0;
+        }
+        HEX_FREE(ctx, list);
         return 1;
     }
 
-    if (condition->type != HEX_TYPE_QUOTATION || action->type != HEX_TYPE_QUOTATION)
+    // Allocate result quotation (array of element pointers)
+    hex_item_t **quotation = (hex_item_t **)calloc(list->quotation_size, sizeof(hex_item_t *));
+    if (!quotation)
     {
-        hex_error(ctx, "[symbol while] Two quotations required");
+        hex_error(ctx, "[symbol map] Memory allocation failed");
         HEX_FREE(ctx, action);
-        HEX_FREE(ctx, condition);
+        HEX_FREE(ctx, list);
         return 1;
     }
-    else
+    for (size_t i = 0; i < list->quotation_size; i++)
     {
-        while (1)
+        // Push a deep copy of the list element to avoid aliasing
+        hex_item_t *elem_copy = hex_copy_item(ctx, list->data.quotation_value[i]);
+        if (!elem_copy || hex_push(ctx, elem_copy) != 0)
         {
-            for (size_t i = 0; i < condition->quotation_size; i++)
-            {
-                // Create a copy to avoid ownership issues
-                hex_item_t *copy = hex_copy_item(ctx, condition->data.quotation_value[i]);
-                if (!copy || hex_push(ctx, copy) != 0)
-                {
-                    if (copy)
-                        hex_free_item(ctx, copy);
-                    HEX_FREE(ctx, action);
-                    HEX_FREE(ctx, condition);
-                    return 1;
-                }
-            }
-            HEX_POP(ctx, evalResult);
-            if (evalResult->type == HEX_TYPE_INTEGER && evalResult->data.int_value == 0)
+            if (elem_copy)
             {
-                // Don't free evalResult here as it might be shared - let normal cleanup handle it
-                break;
+                hex_free_item(ctx, elem_copy);
             }
-
-            hex_item_t *act = hex_copy_item(ctx, action);
-            for (size_t i = 0; i < act->quotation_size; i++)
+            HEX_FREE(ctx, action);
+            HEX_FREE(ctx, list);
+            hex_free_list(ctx, quotation, i);
+            return 1;
+        }
+        // Execute action quotation: push deep copies of its elements
+        for (size_t j = 0; j < action->quotation_size; j++)
+        {
+            hex_item_t *act_elem = hex_copy_item(ctx, action->data.quotation_value[j]);
+            if (!act_elem || hex_push(ctx, act_elem) != 0)
             {
-                // Create a copy to avoid ownership issues
-                hex_item_t *copy = hex_copy_item(ctx, act->data.quotation_value[i]);
-                if (!copy || hex_push(ctx, copy) != 0)
+                if (act_elem)
                 {
-                    if (copy)
-                        hex_free_item(ctx, copy);
-                    HEX_FREE(ctx, act);
-                    HEX_FREE(ctx, action);
-                    HEX_FREE(ctx, condition);
-                    return 1;
+                    hex_free_item(ctx, act_elem);
                 }
+                HEX_FREE(ctx, action);
+                HEX_FREE(ctx, list);
+                hex_free_list(ctx, quotation, i);
+                return 1;
             }
-            HEX_FREE(ctx, act); // Free the temporary copy
+        }
+        // Pop result of action execution, copy into result quotation, free temporary
+        hex_item_t *result_item = hex_pop(ctx);
+        quotation[i] = hex_copy_item(ctx, result_item);
+        HEX_FREE(ctx, result_item);
+        if (!quotation[i])
+        {
+            hex_error(ctx, "[symbol map] Failed to copy result item");
+            HEX_FREE(ctx, action);
+            HEX_FREE(ctx, list);
+            hex_free_list(ctx, quotation, i);
+            return 1;
         }
     }
-
-    // Clean up after successful completion
+    if (hex_push_quotation(ctx, quotation, list->quotation_size) != 0)
+    {
+        HEX_FREE(ctx, action);
+        HEX_FREE(ctx, list);
+        hex_free_list(ctx, quotation, list->quotation_size);
+        return 1;
+    }
+    // Free consumed inputs after success
     HEX_FREE(ctx, action);
-    HEX_FREE(ctx, condition);
+    HEX_FREE(ctx, list);
+
     return 0;
 }
 
-int hex_symbol_error(hex_context_t *ctx)
+// Apply a quotation to each item of a list (or sequence), moving the items out of the list
+// unless they are shared
+int hex_symbol_each(hex_context_t *ctx)
 {
-
-    char *message = strdup(ctx->error);
-    ctx->error[0] = '\0';
-    int result = hex_push_string(ctx, message);
-    free(message);
+    HEX_POP(ctx, action);
+    HEX_POP(ctx, list);
+    int result = 0;
+    if (list->type == HEX_TYPE_SEQUENCE)
+    {
+        hex_item_t *item = NULL;
+        while (result == 0 && (result = hex_seq_next(ctx, list->data.seq_value, &item)) > 0)
+        {
+            result = hex_push_moved(ctx, item);
+            if (result == 0)
+            {
+                result = hex_apply(ctx, action);
+            }
+        }
+        HEX_FREE(ctx, action);
+        HEX_FREE(ctx, list);
+        return result < 0 ? 1 : result;
+    }
+    for (size_t i = 0; i < list->quotation_size && result == 0; i++)
+    {
+        hex_item_t *item = hex_take_item(ctx, list, i);
+        result = item ? hex_push_moved(ctx, item) : 1;
+        if (result == 0)
+        {
+            result = hex_apply(ctx, action);
+        }
+    }
+    HEX_FREE(ctx, action);
+    HEX_FREE(ctx, list);
     return result;
 }
 
-int hex_symbol_try(hex_context_t *ctx)
+// Keep the items of a list for which a quotation pushes a positive integer, compacting the list in place
+int hex_symbol_filter(hex_context_t *ctx)
 {
-    HEX_POP(ctx, catch_block);
-    if (catch_block->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, action);
+    HEX_POP(ctx, list);
+    if (list->type == HEX_TYPE_SEQUENCE)
     {
-        HEX_FREE(ctx, catch_block);
-        return 1;
+        return hex_seq_stage(ctx, HEX_SEQ_FILTER, list, action);
     }
-    HEX_POP(ctx, try_block);
-    if (try_block->type == HEX_TYPE_INVALID)
+    if (hex_edit_list(ctx, "filter", list, action) != 0)
     {
-        HEX_FREE(ctx, catch_block);
-        HEX_FREE(ctx, try_block);
         return 1;
     }
-
-    if (try_block->type != HEX_TYPE_QUOTATION || catch_block->type != HEX_TYPE_QUOTATION)
+    size_t kept = 0;
+    for (size_t i = 0; i < list->quotation_size; i++)
     {
-        hex_error(ctx, "[symbol try] Two quotations required");
-        HEX_FREE(ctx, catch_block);
-        HEX_FREE(ctx, try_block);
-        return 1;
+        hex_item_t *item = list->data.quotation_value[i];
+        list->data.quotation_value[i] = NULL;
+        hex_item_t *copy = hex_copy_item(ctx, item);
+        int top = ctx->stack->top;
+        if (!copy || hex_push_moved(ctx, copy) != 0 || hex_apply(ctx, action) != 0)
+        {
+            HEX_FREE(ctx, item);
+            HEX_FREE(ctx, action);
+            HEX_FREE(ctx, list);
+            return 1;
+        }
+        if (ctx->stack->top != top + 1 || ctx->stack->entries[ctx->stack->top]->type != HEX_TYPE_INTEGER)
+        {
+            hex_error(ctx, "[symbol filter] Quotation must push an integer for each item");
+            HEX_FREE(ctx, item);
+            HEX_FREE(ctx, action);
+            HEX_FREE(ctx, list);
+            return 1;
+        }
+        hex_item_t *condition = hex_pop(ctx);
+        if (condition->data.int_value > 0)
+        {
+            list->data.quotation_value[kept++] = item;
+        }
+        else
+        {
+            HEX_FREE(ctx, item);
+        }
+        HEX_FREE(ctx, condition);
     }
-    else
+    list->quotation_size = kept;
+    HEX_FREE(ctx, action);
+    if (HEX_PUSH(ctx, list) != 0)
     {
-        char prevError[256];
-        strncpy(prevError, ctx->error, sizeof(ctx->error));
-        ctx->error[0] = '\0';
+        HEX_FREE(ctx, list);
+        return 1;
+    }
+    return 0;
+}
 
-        ctx->settings->errors_enabled = 0;
-        for (size_t i = 0; i < try_block->quotation_size; i++)
+// Push an initial value, then each item of a list followed by a quotation combining it with the value
+int hex_symbol_fold(hex_context_t *ctx)
+{
+    HEX_POP(ctx, action);
+    HEX_POP(ctx, initial);
+    HEX_POP(ctx, list);
+    int result = hex_push_moved(ctx, initial);
+    if (list->type == HEX_TYPE_SEQUENCE)
+    {
+        hex_item_t *item = NULL;
+        while (result == 0 && (result = hex_seq_next(ctx, list->data.seq_value, &item)) > 0)
         {
-            hex_item_t *copy = hex_copy_item(ctx, try_block->data.quotation_value[i]);
-            if (!copy || hex_push(ctx, copy) != 0)
+            result = hex_push_moved(ctx, item);
+            if (result == 0)
             {
-                if (copy)
-                    hex_free_item(ctx, copy);
-                ctx->settings->errors_enabled = 1;
-                // continue to allow catch block to handle the error
+                result = hex_apply(ctx, action);
             }
         }
-        ctx->settings->errors_enabled = 1;
-
-        if (strcmp(ctx->error, "") != 0)
+        HEX_FREE(ctx, action);
+        HEX_FREE(ctx, list);
+        return result < 0 ? 1 : result;
+    }
+    for (size_t i = 0; i < list->quotation_size && result == 0; i++)
+    {
+        hex_item_t *item = hex_take_item(ctx, list, i);
+        result = item ? hex_push_moved(ctx, item) : 1;
+        if (result == 0)
         {
-            hex_debug(ctx, "[symbol try] Handling error: %s", ctx->error);
-            for (size_t i = 0; i < catch_block->quotation_size; i++)
-            {
-                hex_item_t *copy = hex_copy_item(ctx, catch_block->data.quotation_value[i]);
-                if (!copy || hex_push(ctx, copy) != 0)
-                {
-                    if (copy)
-                        hex_free_item(ctx, copy);
-                    HEX_FREE(ctx, catch_block);
-                    HEX_FREE(ctx, try_block);
-                    return 1;
-                }
-            }
+            result = hex_apply(ctx, action);
         }
-
-        strncpy(ctx->error, prevError, sizeof(ctx->error));
-        HEX_FREE(ctx, catch_block);
-        HEX_FREE(ctx, try_block);
     }
-    return 0;
+    HEX_FREE(ctx, action);
+    HEX_FREE(ctx, list);
+    return result;
 }
 
-int hex_symbol_throw(hex_context_t *ctx)
+// Push a quotation of the integers from the first one included to the second one excluded
+int hex_symbol_range(hex_context_t *ctx)
 {
-    HEX_POP(ctx, message);
-    ;
-    if (message->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, end);
+    HEX_POP(ctx, start);
+    int32_t first = start->data.int_value;
+    int32_t last = end->data.int_value;
+    HEX_FREE(ctx, start);
+    HEX_FREE(ctx, end);
+    size_t size = last > first ? (size_t)((int64_t)last - first) : 0;
+    hex_item_t **quotation = (hex_item_t **)malloc((size > 0 ? size : 1) * sizeof(hex_item_t *));
+    if (!quotation)
     {
-        HEX_FREE(ctx, message);
+        hex_error(ctx, "[symbol range] Memory allocation failed");
         return 1;
     }
-    if (message->type != HEX_TYPE_STRING)
+    for (size_t i = 0; i < size; i++)
     {
-        hex_error(ctx, "[symbol throw] String required");
-        HEX_FREE(ctx, message);
-        return 1;
+        quotation[i] = hex_integer_item(ctx, (int32_t)(first + (int64_t)i));
+        if (!quotation[i])
+        {
+            hex_free_list(ctx, quotation, i);
+            return 1;
+        }
     }
-    hex_error(ctx, message->data.str_value);
-    return 1;
+    return hex_push_quotation(ctx, quotation, size);
 }
 
-// Quotation symbols
-
-int hex_symbol_q(hex_context_t *ctx)
+// Decide whether item a must be placed after item b: returns 1 if it must, 0 if not, -1 on error.
+// Without a comparator, items are integers or strings (checked by the caller) in ascending order;
+// otherwise the comparator is applied to copies of both items and must push an integer.
+static int hex_sort_after(hex_context_t *ctx, const char *symbol, hex_item_t *a, hex_item_t *b, hex_item_t *comparator)
 {
-    HEX_POP(ctx, item);
-    if (item->type == HEX_TYPE_INVALID)
+    if (!comparator)
     {
-        HEX_FREE(ctx, item);
-        return 1;
+        if (a->type == HEX_TYPE_INTEGER)
+        {
+            return a->data.int_value > b->data.int_value;
+        }
+        return hex_compare_strings(a, b) > 0;
     }
-
-    // Deep copy the popped item to avoid aliasing its internal pointers.
-    hex_item_t *copy = hex_copy_item(ctx, item);
-    if (!copy)
+    int top = ctx->stack->top;
+    hex_item_t *copy_a = hex_copy_item(ctx, a);
+    if (!copy_a || hex_push(ctx, copy_a) != 0)
     {
-        hex_error(ctx, "[symbol '] Failed to copy item");
-        HEX_FREE(ctx, item);
-        return 1;
+        HEX_FREE(ctx, copy_a);
+        return -1;
     }
-
-    hex_item_t *result = (hex_item_t *)calloc(1, sizeof(hex_item_t));
-    if (!result)
+    hex_item_t *copy_b = hex_copy_item(ctx, b);
+    if (!copy_b || hex_push(ctx, copy_b) != 0)
     {
-        hex_error(ctx, "[symbol '] Memory allocation failed");
-        HEX_FREE(ctx, item);
-        HEX_FREE(ctx, copy);
-        return 1;
+        HEX_FREE(ctx, copy_b);
+        return -1;
     }
-
-    result->type = HEX_TYPE_QUOTATION;
-    result->data.quotation_value = (hex_item_t **)calloc(1, sizeof(hex_item_t *));
-    if (!result->data.quotation_value)
+    if (hex_apply(ctx, comparator) != 0)
     {
-        hex_error(ctx, "[symbol '] Memory allocation failed");
-        HEX_FREE(ctx, item);
-        HEX_FREE(ctx, copy);
-        HEX_FREE(ctx, result);
-        return 1;
+        return -1;
     }
-
-    result->data.quotation_value[0] = copy;
-    result->quotation_size = 1;
-
-    // Original item no longer needed (we pushed a deep copy)
-    HEX_FREE(ctx, item);
-
-    if (HEX_PUSH(ctx, result) != 0)
+    if (ctx->stack->top != top + 1 || ctx->stack->entries[ctx->stack->top]->type != HEX_TYPE_INTEGER)
     {
-        HEX_FREE(ctx, result); // will free contained copy via list free
-        return 1;
+        hex_error(ctx, "[symbol %s] Quotation must push an integer for each pair of items", symbol);
+        return -1;
     }
-    return 0;
+    hex_item_t *result = hex_pop(ctx);
+    int after = result->data.int_value != 0;
+    HEX_FREE(ctx, result);
+    return after;
 }
 
-int hex_symbol_map(hex_context_t *ctx)
+// Sort items in place with a stable merge sort: runs of HEX_SORT_RUN items are sorted by
+// insertion, then merged pairwise, skipping merges of runs that are already in order.
+// Items are moved, never copied. Returns 0 on success, 1 on error.
+static int hex_sort_items(hex_context_t *ctx, const char *symbol, hex_item_t **items, size_t size, hex_item_t *comparator)
 {
-    HEX_POP(ctx, action);
-    ;
-    if (action->type == HEX_TYPE_INVALID)
+    for (size_t start = 0; start < size; start += HEX_SORT_RUN)
     {
-        HEX_FREE(ctx, action);
-        return 1;
+        size_t end = start + HEX_SORT_RUN < size ? start + HEX_SORT_RUN : size;
+        for (size_t i = start + 1; i < end; i++)
+        {
+            hex_item_t *item = items[i];
+            size_t j = i;
+            while (j > start)
+            {
+                int after = hex_sort_after(ctx, symbol, items[j - 1], item, comparator);
+                if (after < 0)
+                {
+                    items[j] = item;
+                    return 1;
+                }
+                if (!after)
+                {
+                    break;
+                }
+                items[j] = items[j - 1];
+                j--;
+            }
+            items[j] = item;
+        }
     }
-    HEX_POP(ctx, list);
-    ;
-    if (list->type == HEX_TYPE_INVALID)
+    if (size <= HEX_SORT_RUN)
     {
-        HEX_FREE(ctx, action);
-        HEX_FREE(ctx, list);
-        return 1;
+        return 0;
     }
-
-    if (list->type != HEX_TYPE_QUOTATION || action->type != HEX_TYPE_QUOTATION)
+    hex_item_t **buffer = (hex_item_t **)malloc(size * sizeof(hex_item_t *));
+    if (!buffer)
     {
-        hex_error(ctx, "[symbol map] Two quotations required");
-        HEX_FREE(ctx, action);
-        HEX_FREE(ctx, list);
+        hex_error(ctx, "[symbol %s] Memory allocation failed", symbol);
         return 1;
     }
-    else
+    for (size_t width = HEX_SORT_RUN; width < size; width *= 2)
     {
-        // Allocate result quotation (array of element pointers)
-        hex_item_t **quotation = (hex_item_t **)calloc(list->quotation_size, sizeof(hex_item_t *));
-        if (!quotation)
-        {
-            hex_error(ctx, "[symbol map] Memory allocation failed");
-            HEX_FREE(ctx, action);
-            HEX_FREE(ctx, list);
-            return 1;
-        }
-        for (size_t i = 0; i < list->quotation_size; i++)
+        for (size_t start = 0; start + width < size; start += 2 * width)
         {
-            // Push a deep copy of the list element to avoid aliasing
-            hex_item_t *elem_copy = hex_copy_item(ctx, list->data.quotation_value[i]);
-            if (!elem_copy || hex_push(ctx, elem_copy) != 0)
+            size_t mid = start + width;
+            size_t end = mid + width < size ? mid + width : size;
+            int after = hex_sort_after(ctx, symbol, items[mid - 1], items[mid], comparator);
+            if (after <= 0)
             {
-                if (elem_copy)
+                if (after < 0)
                 {
-                    hex_free_item(ctx, elem_copy);
+                    free(buffer);
+                    return 1;
                 }
-                HEX_FREE(ctx, action);
-                HEX_FREE(ctx, list);
-                hex_free_list(ctx, quotation, i);
-                return 1;
+                continue;
             }
-            // Execute action quotation: push deep copies of its elements
-            for (size_t j = 0; j < action->quotation_size; j++)
+            // Merge the left run (moved to the buffer) and the right run back into items
+            memcpy(buffer, items + start, width * sizeof(hex_item_t *));
+            size_t i = 0, j = mid, k = start;
+            while (i < width && j < end)
             {
-                hex_item_t *act_elem = hex_copy_item(ctx, action->data.quotation_value[j]);
-                if (!act_elem || hex_push(ctx, act_elem) != 0)
+                after = hex_sort_after(ctx, symbol, buffer[i], items[j], comparator);
+                if (after < 0)
                 {
-                    if (act_elem)
-                    {
-                        hex_free_item(ctx, act_elem);
-                    }
-                    HEX_FREE(ctx, action);
-                    HEX_FREE(ctx, list);
-                    hex_free_list(ctx, quotation, i);
+                    // Put the remaining items back so that none of them is lost
+                    memmove(items + k, buffer + i, (width - i) * sizeof(hex_item_t *));
+                    free(buffer);
                     return 1;
                 }
+                items[k++] = after ? items[j++] : buffer[i++];
             }
-            // Pop result of action execution, copy into result quotation, free temporary
-            hex_item_t *result_item = hex_pop(ctx);
-            quotation[i] = hex_copy_item(ctx, result_item);
-            HEX_FREE(ctx, result_item);
-            if (!quotation[i])
+            memcpy(items + k, buffer + i, (width - i) * sizeof(hex_item_t *));
+        }
+    }
+    free(buffer);
+    return 0;
+}
+
+static int hex_compare_integers(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *)a;
+    int32_t y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+int hex_symbol_sort(hex_context_t *ctx)
+{
+    HEX_POP(ctx, list);
+    if (list->type == HEX_TYPE_VECTOR)
+    {
+        qsort(list->data.vector_value, list->quotation_size, sizeof(int32_t), hex_compare_integers);
+    }
+    else
+    {
+        // All items must be integers, or all strings, so that comparing them cannot fail
+        for (size_t i = 0; i < list->quotation_size; i++)
+        {
+            hex_item_t *item = list->data.quotation_value[i];
+            if ((item->type != HEX_TYPE_INTEGER && item->type != HEX_TYPE_STRING) ||
+                item->type != list->data.quotation_value[0]->type)
             {
-                hex_error(ctx, "[symbol map] Failed to copy result item");
-                HEX_FREE(ctx, action);
+                hex_error(ctx, "[symbol sort] Quotation of integers or strings required");
                 HEX_FREE(ctx, list);
-                hex_free_list(ctx, quotation, i);
                 return 1;
             }
         }
-        if (hex_push_quotation(ctx, quotation, list->quotation_size) != 0)
+        if (hex_edit_list(ctx, "sort", list, NULL) != 0)
+        {
+            return 1;
+        }
+        if (hex_sort_items(ctx, "sort", list->data.quotation_value, list->quotation_size, NULL) != 0)
         {
-            HEX_FREE(ctx, action);
             HEX_FREE(ctx, list);
-            hex_free_list(ctx, quotation, list->quotation_size);
             return 1;
         }
-        // Free consumed inputs after success
-        HEX_FREE(ctx, action);
+    }
+    if (HEX_PUSH(ctx, list) != 0)
+    {
         HEX_FREE(ctx, list);
+        return 1;
     }
-
     return 0;
 }
 
-// Stack manipulation symbols
-int hex_symbol_swap(hex_context_t *ctx)
+int hex_symbol_sortby(hex_context_t *ctx)
 {
-    HEX_POP(ctx, a);
-    if (a->type == HEX_TYPE_INVALID)
+    HEX_POP(ctx, comparator);
+    HEX_POP(ctx, list);
+    if (hex_edit_list(ctx, "sortby", list, comparator) != 0)
     {
-        HEX_FREE(ctx, a);
         return 1;
     }
-    HEX_POP(ctx, b);
-    ;
-    if (b->type == HEX_TYPE_INVALID)
+    int result = hex_sort_items(ctx, "sortby", list->data.quotation_value, list->quotation_size, comparator);
+    HEX_FREE(ctx, comparator);
+    if (result == 0 && HEX_PUSH(ctx, list) == 0)
     {
-        HEX_FREE(ctx, b);
-        HEX_FREE(ctx, a);
-        return 1;
+        return 0;
     }
+    HEX_FREE(ctx, list);
+    return 1;
+}
+
+// Stack manipulation symbols
+int hex_symbol_swap(hex_context_t *ctx)
+{
+    HEX_POP(ctx, a);
+    HEX_POP(ctx, b);
     if (HEX_PUSH(ctx, a) != 0)
     {
         HEX_FREE(ctx, a);
@@ -2781,12 +4250,6 @@ int hex_symbol_swap(hex_context_t *ctx)
 int hex_symbol_dup(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    ;
-    if (item->type == HEX_TYPE_INVALID)
-    {
-        HEX_FREE(ctx, item);
-        return 1;
-    }
     hex_item_t *copy = hex_copy_item(ctx, item);
     if (!copy)
     {
@@ -2846,10 +4309,7 @@ int hex_symbol_stack(hex_context_t *ctx)
 int hex_symbol_drop(hex_context_t *ctx)
 {
     HEX_POP(ctx, item);
-    if (item != NULL)
-    {
-        HEX_FREE(ctx, item);
-    }
+    HEX_FREE(ctx, item);
     return 0;
 }
 
@@ -2878,70 +4338,121 @@ int hex_symbol_timestamp(hex_context_t *ctx)
 // Native Symbol Registration         //
 ////////////////////////////////////////
 
+// Signatures of all native symbols. The dispatcher checks the stack depth and
+// the operand types before calling a native, so natives can pop their
+// operands without validating them again.
+static const hex_native_t hex_natives[] = {
+    {":", hex_symbol_store, 2, {HEX_ARG_ANY, HEX_ARG_STRING}, {NULL, "Symbol name must be a string"}},
+    {"::", hex_symbol_define, 2, {HEX_ARG_ANY, HEX_ARG_STRING}, {NULL, "Symbol name must be a string"}},
+    {"#", hex_symbol_free, 1, {HEX_ARG_STRING}, {"Symbol name must be a string"}},
+    {"symbols", hex_symbol_symbols, 0, {0}, {NULL}},
+    {"type", hex_symbol_type, 1, {HEX_ARG_ANY}, {NULL}},
+    {".", hex_symbol_i, 1, {HEX_ARG_QUOTATION}, {"Quotation required"}},
+    {"!", hex_symbol_eval, 2, {HEX_ARG_STRING | HEX_ARG_QUOTATION | HEX_ARG_BUFFER, HEX_ARG_STRING}, {"String, buffer or a quotation of integers required", "File name or scope identifier required"}},
+    {"puts", hex_symbol_puts, 1, {HEX_ARG_ANY}, {NULL}},
+    {"warn", hex_symbol_warn, 1, {HEX_ARG_ANY}, {NULL}},
+    {"print", hex_symbol_print, 1, {HEX_ARG_ANY}, {NULL}},
+    {"gets", hex_symbol_gets, 0, {0}, {NULL}},
+    {"+", hex_symbol_add, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"-", hex_symbol_subtract, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"*", hex_symbol_multiply, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"/", hex_symbol_divide, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"%", hex_symbol_modulo, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"&", hex_symbol_bitand, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"|", hex_symbol_bitor, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"^", hex_symbol_bitxor, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"~", hex_symbol_bitnot, 1, {HEX_ARG_INTEGER}, {"Integer required"}},
+    {"<<", hex_symbol_shiftleft, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {">>", hex_symbol_shiftright, 2, {HEX_ARG_INTEGER | HEX_ARG_VECTOR, HEX_ARG_INTEGER | HEX_ARG_VECTOR}, {"Two integers or vectors required", "Two integers or vectors required"}},
+    {"int", hex_symbol_int, 1, {HEX_ARG_STRING}, {"String representing a hexadecimal integer required"}},
+    {"str", hex_symbol_str, 1, {HEX_ARG_INTEGER}, {"Integer required"}},
+    {"dec", hex_symbol_dec, 1, {HEX_ARG_INTEGER}, {"Integer required"}},
+    {"hex", hex_symbol_hex, 1, {HEX_ARG_STRING}, {"String representing a decimal integer required"}},
+    {"ints", hex_symbol_ints, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"chr", hex_symbol_chr, 1, {HEX_ARG_INTEGER}, {"Integer required"}},
+    {"ord", hex_symbol_ord, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"==", hex_symbol_equal, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {"!=", hex_symbol_notequal, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {">", hex_symbol_greater, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {"<", hex_symbol_less, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {">=", hex_symbol_greaterequal, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {"<=", hex_symbol_lessequal, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {"and", hex_symbol_and, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"or", hex_symbol_or, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"not", hex_symbol_not, 1, {HEX_ARG_INTEGER}, {"Integer required"}},
+    {"xor", hex_symbol_xor, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"cat", hex_symbol_cat, 2, {HEX_ARG_QUOTATION | HEX_ARG_STRING | HEX_ARG_BUFFER | HEX_ARG_VECTOR, HEX_ARG_QUOTATION | HEX_ARG_STRING | HEX_ARG_BUFFER | HEX_ARG_VECTOR}, {"Two quotations or two strings required", "Two quotations or two strings required"}},
+    {"len", hex_symbol_len, 1, {HEX_ARG_QUOTATION | HEX_ARG_STRING | HEX_ARG_BUFFER | HEX_ARG_VECTOR | HEX_ARG_DICTIONARY}, {"Quotation or string required"}},
+    {"get", hex_symbol_get, 2, {HEX_ARG_QUOTATION | HEX_ARG_STRING | HEX_ARG_BUFFER | HEX_ARG_VECTOR | HEX_ARG_DICTIONARY, HEX_ARG_INTEGER | HEX_ARG_STRING}, {"Quotation or string required", "Index must be an integer"}},
+    {"push", hex_symbol_push, 2, {HEX_ARG_QUOTATION, HEX_ARG_ANY}, {"Quotation required", NULL}},
+    {"pop", hex_symbol_pop, 1, {HEX_ARG_QUOTATION}, {"Quotation required"}},
+    {"ins", hex_symbol_ins, 3, {HEX_ARG_QUOTATION, HEX_ARG_ANY, HEX_ARG_INTEGER}, {"Quotation required", NULL, "Index must be an integer"}},
+    {"rem", hex_symbol_rem, 2, {HEX_ARG_QUOTATION, HEX_ARG_INTEGER}, {"Quotation required", "Index must be an integer"}},
+    {"set", hex_symbol_set, 3, {HEX_ARG_QUOTATION, HEX_ARG_ANY, HEX_ARG_INTEGER}, {"Quotation required", NULL, "Index must be an integer"}},
+    {"reverse", hex_symbol_reverse, 1, {HEX_ARG_QUOTATION}, {"Quotation required"}},
+    {"uncons", hex_symbol_uncons, 1, {HEX_ARG_QUOTATION}, {"Quotation required"}},
+    {"swons", hex_symbol_swons, 2, {HEX_ARG_QUOTATION, HEX_ARG_ANY}, {"Quotation required", NULL}},
+    {"index", hex_symbol_index, 2, {HEX_ARG_QUOTATION | HEX_ARG_STRING | HEX_ARG_BUFFER | HEX_ARG_VECTOR, HEX_ARG_ANY}, {"Quotation or string required", NULL}},
+    {"join", hex_symbol_join, 2, {HEX_ARG_QUOTATION, HEX_ARG_STRING}, {"Quotation and string required", "Quotation and string required"}},
+    {"split", hex_symbol_split, 2, {HEX_ARG_STRING, HEX_ARG_STRING}, {"Two strings required", "Two strings required"}},
+    {"sub", hex_symbol_sub, 3, {HEX_ARG_STRING | HEX_ARG_BUFFER, HEX_ARG_STRING | HEX_ARG_INTEGER, HEX_ARG_STRING | HEX_ARG_INTEGER}, {"String or buffer required", "String or integer required", "String or integer required"}},
+    {"gsub", hex_symbol_gsub, 3, {HEX_ARG_STRING, HEX_ARG_STRING, HEX_ARG_STRING}, {"Three strings required", "Three strings required", "Three strings required"}},
+    {"fmt", hex_symbol_fmt, 2, {HEX_ARG_STRING, HEX_ARG_QUOTATION}, {"String and quotation required", "String and quotation required"}},
+    {"begins", hex_symbol_begins, 2, {HEX_ARG_STRING, HEX_ARG_STRING}, {"Two strings required", "Two strings required"}},
+    {"ends", hex_symbol_ends, 2, {HEX_ARG_STRING, HEX_ARG_STRING}, {"Two strings required", "Two strings required"}},
+    {"vec", hex_symbol_vec, 1, {HEX_ARG_QUOTATION | HEX_ARG_BUFFER | HEX_ARG_VECTOR}, {"Quotation of integers or buffer required"}},
+    {"sum", hex_symbol_sum, 1, {HEX_ARG_QUOTATION | HEX_ARG_VECTOR}, {"Vector or quotation of integers required"}},
+    {"min", hex_symbol_min, 1, {HEX_ARG_QUOTATION | HEX_ARG_VECTOR}, {"Vector or quotation required"}},
+    {"max", hex_symbol_max, 1, {HEX_ARG_QUOTATION | HEX_ARG_VECTOR}, {"Vector or quotation required"}},
+    {"dict", hex_symbol_dict, 1, {HEX_ARG_QUOTATION}, {"Quotation required"}},
+    {"put", hex_symbol_put, 3, {HEX_ARG_DICTIONARY, HEX_ARG_INTEGER | HEX_ARG_STRING, HEX_ARG_ANY}, {"Dictionary required", "Key must be a string or an integer", NULL}},
+    {"has", hex_symbol_has, 2, {HEX_ARG_DICTIONARY, HEX_ARG_INTEGER | HEX_ARG_STRING}, {"Dictionary required", "Key must be a string or an integer"}},
+    {"del", hex_symbol_del, 2, {HEX_ARG_DICTIONARY, HEX_ARG_INTEGER | HEX_ARG_STRING}, {"Dictionary required", "Key must be a string or an integer"}},
+    {"keys", hex_symbol_keys, 1, {HEX_ARG_DICTIONARY}, {"Dictionary required"}},
+    {"seq", hex_symbol_seq, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"lines", hex_symbol_lines, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"pieces", hex_symbol_pieces, 2, {HEX_ARG_STRING, HEX_ARG_STRING}, {"Two strings required", "Two strings required"}},
+    {"take", hex_symbol_take, 2, {HEX_ARG_SEQUENCE, HEX_ARG_INTEGER}, {"Sequence required", "Integer required"}},
+    {"read", hex_symbol_read, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"write", hex_symbol_write, 2, {HEX_ARG_STRING | HEX_ARG_QUOTATION | HEX_ARG_BUFFER | HEX_ARG_VECTOR, HEX_ARG_STRING | HEX_ARG_INTEGER}, {"String or quotation of integers required", "String or file handle required"}},
+    {"append", hex_symbol_append, 2, {HEX_ARG_STRING | HEX_ARG_QUOTATION | HEX_ARG_BUFFER | HEX_ARG_VECTOR, HEX_ARG_STRING}, {"String or quotation of integers required", "String required"}},
+    {"open", hex_symbol_open, 2, {HEX_ARG_STRING, HEX_ARG_STRING}, {"Two strings required", "Two strings required"}},
+    {"close", hex_symbol_close, 1, {HEX_ARG_INTEGER}, {"File handle required"}},
+    {"flush", hex_symbol_flush, 1, {HEX_ARG_INTEGER}, {"File handle required"}},
+    {"readl", hex_symbol_readl, 1, {HEX_ARG_INTEGER}, {"File handle required"}},
+    {"readb", hex_symbol_readb, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"File handle required", "Integer required"}},
+    {"eof", hex_symbol_eof, 1, {HEX_ARG_INTEGER}, {"File handle required"}},
+    {"args", hex_symbol_args, 0, {0}, {NULL}},
+    {"exit", hex_symbol_exit, 1, {HEX_ARG_INTEGER}, {"Integer required"}},
+    {"exec", hex_symbol_exec, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"run", hex_symbol_run, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"if", hex_symbol_if, 3, {HEX_ARG_QUOTATION, HEX_ARG_QUOTATION, HEX_ARG_QUOTATION}, {"Three quotations required", "Three quotations required", "Three quotations required"}},
+    {"while", hex_symbol_while, 2, {HEX_ARG_QUOTATION, HEX_ARG_QUOTATION}, {"Two quotations required", "Two quotations required"}},
+    {"times", hex_symbol_times, 2, {HEX_ARG_QUOTATION, HEX_ARG_INTEGER}, {"Quotation and integer required", "Quotation and integer required"}},
+    {"memo", hex_symbol_memo, 2, {HEX_ARG_QUOTATION, HEX_ARG_INTEGER}, {"Quotation and integer required", "Quotation and integer required"}},
+    {"memostats", hex_symbol_memostats, 0, {0}, {NULL}},
+    {"error", hex_symbol_error, 0, {0}, {NULL}},
+    {"try", hex_symbol_try, 2, {HEX_ARG_QUOTATION, HEX_ARG_QUOTATION}, {"Two quotations required", "Two quotations required"}},
+    {"throw", hex_symbol_throw, 1, {HEX_ARG_STRING}, {"String required"}},
+    {"'", hex_symbol_q, 1, {HEX_ARG_ANY}, {NULL}},
+    {"map", hex_symbol_map, 2, {HEX_ARG_QUOTATION | HEX_ARG_VECTOR | HEX_ARG_SEQUENCE, HEX_ARG_QUOTATION}, {"Two quotations required", "Two quotations required"}},
+    {"each", hex_symbol_each, 2, {HEX_ARG_QUOTATION | HEX_ARG_SEQUENCE, HEX_ARG_QUOTATION}, {"Two quotations required", "Two quotations required"}},
+    {"filter", hex_symbol_filter, 2, {HEX_ARG_QUOTATION | HEX_ARG_SEQUENCE, HEX_ARG_QUOTATION}, {"Two quotations required", "Two quotations required"}},
+    {"fold", hex_symbol_fold, 3, {HEX_ARG_QUOTATION | HEX_ARG_SEQUENCE, HEX_ARG_ANY, HEX_ARG_QUOTATION}, {"Quotation required", NULL, "Quotation required"}},
+    {"range", hex_symbol_range, 2, {HEX_ARG_INTEGER, HEX_ARG_INTEGER}, {"Two integers required", "Two integers required"}},
+    {"sort", hex_symbol_sort, 1, {HEX_ARG_QUOTATION | HEX_ARG_VECTOR}, {"Quotation or vector required"}},
+    {"sortby", hex_symbol_sortby, 2, {HEX_ARG_QUOTATION, HEX_ARG_QUOTATION}, {"Two quotations required", "Two quotations required"}},
+    {"swap", hex_symbol_swap, 2, {HEX_ARG_ANY, HEX_ARG_ANY}, {NULL, NULL}},
+    {"dup", hex_symbol_dup, 1, {HEX_ARG_ANY}, {NULL}},
+    {"stack", hex_symbol_stack, 0, {0}, {NULL}},
+    {"drop", hex_symbol_drop, 1, {HEX_ARG_ANY}, {NULL}},
+    {"timestamp", hex_symbol_timestamp, 0, {0}, {NULL}},
+};
+
 void hex_register_symbols(hex_context_t *ctx)
 {
-    hex_set_native_symbol(ctx, ":", hex_symbol_store);
-    hex_set_native_symbol(ctx, "::", hex_symbol_define);
-    hex_set_native_symbol(ctx, "#", hex_symbol_free);
-    hex_set_native_symbol(ctx, "symbols", hex_symbol_symbols);
-    hex_set_native_symbol(ctx, "type", hex_symbol_type);
-    hex_set_native_symbol(ctx, ".", hex_symbol_i);
-    hex_set_native_symbol(ctx, "!", hex_symbol_eval);
-    hex_set_native_symbol(ctx, "puts", hex_symbol_puts);
-    hex_set_native_symbol(ctx, "warn", hex_symbol_warn);
-    hex_set_native_symbol(ctx, "print", hex_symbol_print);
-    hex_set_native_symbol(ctx, "gets", hex_symbol_gets);
-    hex_set_native_symbol(ctx, "+", hex_symbol_add);
-    hex_set_native_symbol(ctx, "-", hex_symbol_subtract);
-    hex_set_native_symbol(ctx, "*", hex_symbol_multiply);
-    hex_set_native_symbol(ctx, "/", hex_symbol_divide);
-    hex_set_native_symbol(ctx, "%", hex_symbol_modulo);
-    hex_set_native_symbol(ctx, "&", hex_symbol_bitand);
-    hex_set_native_symbol(ctx, "|", hex_symbol_bitor);
-    hex_set_native_symbol(ctx, "^", hex_symbol_bitxor);
-    hex_set_native_symbol(ctx, "~", hex_symbol_bitnot);
-    hex_set_native_symbol(ctx, "<<", hex_symbol_shiftleft);
-    hex_set_native_symbol(ctx, ">>", hex_symbol_shiftright);
-    hex_set_native_symbol(ctx, "int", hex_symbol_int);
-    hex_set_native_symbol(ctx, "str", hex_symbol_str);
-    hex_set_native_symbol(ctx, "dec", hex_symbol_dec);
-    hex_set_native_symbol(ctx, "hex", hex_symbol_hex);
-    hex_set_native_symbol(ctx, "chr", hex_symbol_chr);
-    hex_set_native_symbol(ctx, "ord", hex_symbol_ord);
-    hex_set_native_symbol(ctx, "==", hex_symbol_equal);
-    hex_set_native_symbol(ctx, "!=", hex_symbol_notequal);
-    hex_set_native_symbol(ctx, ">", hex_symbol_greater);
-    hex_set_native_symbol(ctx, "<", hex_symbol_less);
-    hex_set_native_symbol(ctx, ">=", hex_symbol_greaterequal);
-    hex_set_native_symbol(ctx, "<=", hex_symbol_lessequal);
-    hex_set_native_symbol(ctx, "and", hex_symbol_and);
-    hex_set_native_symbol(ctx, "or", hex_symbol_or);
-    hex_set_native_symbol(ctx, "not", hex_symbol_not);
-    hex_set_native_symbol(ctx, "xor", hex_symbol_xor);
-    hex_set_native_symbol(ctx, "cat", hex_symbol_cat);
-    hex_set_native_symbol(ctx, "len", hex_symbol_len);
-    hex_set_native_symbol(ctx, "get", hex_symbol_get);
-    hex_set_native_symbol(ctx, "index", hex_symbol_index);
-    hex_set_native_symbol(ctx, "join", hex_symbol_join);
-    hex_set_native_symbol(ctx, "split", hex_symbol_split);
-    hex_set_native_symbol(ctx, "sub", hex_symbol_sub);
-    hex_set_native_symbol(ctx, "read", hex_symbol_read);
-    hex_set_native_symbol(ctx, "write", hex_symbol_write);
-    hex_set_native_symbol(ctx, "append", hex_symbol_append);
-    hex_set_native_symbol(ctx, "args", hex_symbol_args);
-    hex_set_native_symbol(ctx, "exit", hex_symbol_exit);
-    hex_set_native_symbol(ctx, "exec", hex_symbol_exec);
-    hex_set_native_symbol(ctx, "run", hex_symbol_run);
-    hex_set_native_symbol(ctx, "if", hex_symbol_if);
-    hex_set_native_symbol(ctx, "while", hex_symbol_while);
-    hex_set_native_symbol(ctx, "error", hex_symbol_error);
-    hex_set_native_symbol(ctx, "try", hex_symbol_try);
-    hex_set_native_symbol(ctx, "throw", hex_symbol_throw);
-    hex_set_native_symbol(ctx, "'", hex_symbol_q);
-    hex_set_native_symbol(ctx, "map", hex_symbol_map);
-    hex_set_native_symbol(ctx, "swap", hex_symbol_swap);
-    hex_set_native_symbol(ctx, "dup", hex_symbol_dup);
-    hex_set_native_symbol(ctx, "stack", hex_symbol_stack);
-    hex_set_native_symbol(ctx, "drop", hex_symbol_drop);
-    hex_set_native_symbol(ctx, "timestamp", hex_symbol_timestamp);
+    for (size_t i = 0; i < sizeof(hex_natives) / sizeof(hex_natives[0]); i++)
+    {
+        hex_set_native_symbol(ctx, &hex_natives[i]);
+    }
 }
@@ -2,6 +2,35 @@
 #include "hex.h"
 #endif
 
+// Symbol tables can be overlays on top of a parent table: indexes below `base`
+// are resolved by the parent, and only the symbols added on top are stored.
+
+hex_symbol_table_t *hex_symboltable_create(hex_symbol_table_t *parent)
+{
+    hex_symbol_table_t *table = calloc(1, sizeof(hex_symbol_table_t));
+    if (table == NULL)
+    {
+        return NULL;
+    }
+    table->parent = parent;
+    table->base = parent ? parent->count : 0;
+    table->count = table->base;
+    return table;
+}
+
+static char *hex_symboltable_lookup(hex_symbol_table_t *table, uint16_t index)
+{
+    while (table != NULL && index < table->base)
+    {
+        table = table->parent;
+    }
+    if (table == NULL || index >= table->count)
+    {
+        return NULL;
+    }
+    return table->symbols[index - table->base];
+}
+
 int hex_symboltable_set(hex_context_t *ctx, const char *symbol)
 {
     hex_symbol_table_t *table = ctx->symbol_table;
@@ -17,15 +46,28 @@ int hex_symboltable_set(hex_context_t *ctx, const char *symbol)
         return -1; // Table full
     }
 
-    for (uint16_t i = 0; i < table->count; ++i)
+    if (hex_symboltable_get_index(ctx, symbol) >= 0)
     {
-        if (strcmp(table->symbols[i], symbol) == 0)
+        return 0;
+    }
+
+    size_t delta = table->count - table->base;
+    if (delta >= table->capacity)
+    {
+        size_t capacity = table->capacity ? table->capacity * 2 : 16;
+        char **symbols = realloc(table->symbols, capacity * sizeof(char *));
+        if (symbols == NULL)
         {
-            return 0;
+            return -1;
         }
+        table->symbols = symbols;
+        table->capacity = capacity;
+    }
+    table->symbols[delta] = strdup(symbol);
+    if (table->symbols[delta] == NULL)
+    {
+        return -1;
     }
-
-    table->symbols[table->count] = strdup(symbol);
     table->count++;
     return 0;
 }
@@ -35,7 +77,7 @@ int hex_symboltable_get_index(hex_context_t *ctx, const char *symbol)
     hex_symbol_table_t *table = ctx->symbol_table;
     for (uint16_t i = 0; i < table->count; ++i)
     {
-        if (strcmp(table->symbols[i], symbol) == 0)
+        if (strcmp(hex_symboltable_lookup(table, i), symbol) == 0)
         {
             return i;
         }
@@ -45,17 +87,24 @@ int hex_symboltable_get_index(hex_context_t *ctx, const char *symbol)
 
 char *hex_symboltable_get_value(hex_context_t *ctx, uint16_t index)
 {
-    if (index >= ctx->symbol_table->count)
+    return hex_symboltable_lookup(ctx->symbol_table, index);
+}
+
+// Drop all the symbols of a table, including the ones visible from its parent
+static void hex_symboltable_clear(hex_symbol_table_t *table)
+{
+    for (uint16_t i = 0; i < table->count - table->base; ++i)
     {
-        return NULL;
+        free(table->symbols[i]);
+        table->symbols[i] = NULL;
     }
-    return ctx->symbol_table->symbols[index];
+    table->base = 0;
+    table->count = 0;
 }
 
 int hex_decode_bytecode_symboltable(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t total)
 {
-    hex_symbol_table_t *table = ctx->symbol_table;
-    table->count = 0;
+    hex_symboltable_clear(ctx->symbol_table);
 
     for (size_t i = 0; i < total; i++)
     {
@@ -87,7 +136,7 @@ uint8_t *hex_encode_bytecode_symboltable(hex_context_t *ctx, size_t *out_size)
 
     for (uint16_t i = 0; i < table->count; ++i)
     {
-        total_size += 1 + strlen(table->symbols[i]);
+        total_size += 1 + strlen(hex_symboltable_lookup(table, i));
     }
 
     uint8_t *bytecode = malloc(total_size);
@@ -95,9 +144,10 @@ uint8_t *hex_encode_bytecode_symboltable(hex_context_t *ctx, size_t *out_size)
 
     for (uint16_t i = 0; i < table->count; ++i)
     {
-        size_t len = strlen(table->symbols[i]);
+        const char *symbol = hex_symboltable_lookup(table, i);
+        size_t len = strlen(symbol);
         bytecode[offset++] = (uint8_t)len;
-        memcpy(bytecode + offset, table->symbols[i], len);
+        memcpy(bytecode + offset, symbol, len);
         offset += len;
     }
 
@@ -105,43 +155,17 @@ uint8_t *hex_encode_bytecode_symboltable(hex_context_t *ctx, size_t *out_size)
     return bytecode;
 }
 
-hex_symbol_table_t *hex_symboltable_copy(hex_context_t *ctx)
+// Create a sandbox on top of the current symbol table: symbols added to it
+// do not affect the current table, and nothing is copied.
+hex_symbol_table_t *hex_symboltable_overlay(hex_context_t *ctx)
 {
-    hex_symbol_table_t *original = ctx->symbol_table;
-    hex_symbol_table_t *copy = malloc(sizeof(hex_symbol_table_t));
-    if (copy == NULL)
+    hex_symbol_table_t *overlay = hex_symboltable_create(ctx->symbol_table);
+    if (overlay == NULL)
     {
-        hex_error(ctx, "[symbol table copy] Memory allocation failed");
+        hex_error(ctx, "[symbol table overlay] Memory allocation failed");
         return NULL;
     }
-
-    copy->symbols = malloc(sizeof(char *) * HEX_MAX_USER_SYMBOLS);
-    if (copy->symbols == NULL)
-    {
-        hex_error(ctx, "[symbol table copy] Memory allocation failed for symbols array");
-        free(copy);
-        return NULL;
-    }
-
-    copy->count = original->count;
-    for (uint16_t i = 0; i < original->count; ++i)
-    {
-        copy->symbols[i] = strdup(original->symbols[i]);
-        if (copy->symbols[i] == NULL)
-        {
-            hex_error(ctx, "[symbol table copy] Memory allocation failed for symbol");
-            // Free already allocated symbols
-            for (uint16_t j = 0; j < i; ++j)
-            {
-                free(copy->symbols[j]);
-            }
-            free(copy->symbols);
-            free(copy);
-            return NULL;
-        }
-    }
-
-    return copy;
+    return overlay;
 }
 
 void hex_symboltable_destroy(hex_symbol_table_t *table)
@@ -152,13 +176,10 @@ void hex_symboltable_destroy(hex_symbol_table_t *table)
     }
     if (table->symbols)
     {
-        for (uint16_t i = 0; i < table->count; ++i)
+        for (uint16_t i = 0; i < table->count - table->base; ++i)
         {
-            if (table->symbols[i])
-            {
-                free(table->symbols[i]);
-                table->symbols[i] = NULL;
-            }
+            free(table->symbols[i]);
+            table->symbols[i] = NULL;
         }
         free(table->symbols);
         table->symbols = NULL;
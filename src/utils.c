@@ -35,6 +35,16 @@ EM_ASYNC_JS(char *, em_fgets, (const char *buf, size_t bufsize), {
 
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// AVX2 code is compiled for a target attribute and only used if the CPU supports it
+#if defined(__SSE2__) && defined(__GNUC__) && !defined(__EMSCRIPTEN__)
+#define HEX_AVX2_DISPATCH
+#include <immintrin.h>
+#endif
+
 void hex_rpad(const char *str, int total_length)
 {
     int len = strlen(str);
@@ -54,88 +64,129 @@ void hex_lpad(const char *str, int total_length)
     printf("%s", str);
 }
 
-char *hex_itoa(int num, int base)
+// Integer conversion: digits are written two at a time from tables of digit pairs,
+// backwards into a buffer provided by the caller, and parsed through a table of digit
+// values. Results wrap around like 32-bit arithmetic.
+
+static const char hex_decimal_pairs[] =
+    "00010203040506070809101112131415161718192021222324"
+    "25262728293031323334353637383940414243444546474849"
+    "50515253545556575859606162636465666768697071727374"
+    "75767778798081828384858687888990919293949596979899";
+
+static const char hex_hex_pairs[] =
+    "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+// Value of each hexadecimal digit plus one, or 0 for other bytes
+static const uint8_t hex_digit_values[256] = {
+    ['0'] = 1, ['1'] = 2, ['2'] = 3, ['3'] = 4, ['4'] = 5, ['5'] = 6, ['6'] = 7, ['7'] = 8, ['8'] = 9, ['9'] = 10,
+    ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16};
+
+// Write the hexadecimal digits of value (lowercase, without prefix) so that they end
+// right before end, and return where they start
+char *hex_format_hex(uint32_t value, char *end)
 {
-    static char str[20];
-    int i = 0;
-
-    // Handle 0 explicitly, otherwise empty string is printed
-    if (num == 0)
+    char *p = end;
+    while (value >= 0x10)
     {
-        str[i++] = '0';
-        str[i] = '\0';
-        return str;
+        p -= 2;
+        memcpy(p, hex_hex_pairs + (value & 0xff) * 2, 2);
+        value >>= 8;
     }
-
-    // Process each digit
-    while (num != 0)
+    if (value > 0 || p == end)
     {
-        int rem = num % base;
-        str[i++] = (rem > 9) ? (rem - 10) + 'a' : rem + '0';
-        num = num / base;
+        *--p = hex_hex_pairs[value * 2 + 1];
     }
+    return p;
+}
 
-    str[i] = '\0'; // Null-terminate string
-
-    // Reverse the string
-    int start = 0;
-    int end = i - 1;
-    while (start < end)
+// Write the decimal digits of value, with a minus sign if negative, so that they end
+// right before end, and return where they start
+char *hex_format_decimal(int32_t value, char *end)
+{
+    char *p = end;
+    uint32_t n = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+    while (n >= 100)
     {
-        char temp = str[start];
-        str[start] = str[end];
-        str[end] = temp;
-        start++;
-        end--;
+        p -= 2;
+        memcpy(p, hex_decimal_pairs + (n % 100) * 2, 2);
+        n /= 100;
     }
-
-    return str;
+    if (n >= 10)
+    {
+        p -= 2;
+        memcpy(p, hex_decimal_pairs + n * 2, 2);
+    }
+    else
+    {
+        *--p = (char)('0' + n);
+    }
+    if (value < 0)
+    {
+        *--p = '-';
+    }
+    return p;
 }
 
-char *hex_itoa_dec(int num)
+// Parse the run of hexadecimal digits at the start of text; end is set past the run
+uint32_t hex_parse_hex_digits(const char *text, const char **end)
 {
-    return hex_itoa(num, 10);
+    const uint8_t *p = (const uint8_t *)text;
+    uint32_t value = 0;
+    for (; hex_digit_values[*p]; p++)
+    {
+        value = (value << 4) | (uint32_t)(hex_digit_values[*p] - 1);
+    }
+    *end = (const char *)p;
+    return value;
 }
 
-char *hex_itoa_hex(int num)
+// Parse the run of decimal digits at the start of text; end is set past the run
+uint32_t hex_parse_decimal_digits(const char *text, const char **end)
 {
-    return hex_itoa(num, 16);
+    const char *p = text;
+    uint32_t value = 0;
+    while (isdigit((unsigned char)p[0]) && isdigit((unsigned char)p[1]))
+    {
+        value = value * 100 + (uint32_t)((p[0] - '0') * 10 + (p[1] - '0'));
+        p += 2;
+    }
+    if (isdigit((unsigned char)*p))
+    {
+        value = value * 10 + (uint32_t)(*p++ - '0');
+    }
+    *end = p;
+    return value;
 }
 
-void hex_raw_print_item(FILE *stream, hex_item_t item)
+// Parse an integer like strtol does: leading whitespace, an optional sign and the
+// digits in base 16 (optionally prefixed with 0x) or 10, ignoring what follows them
+int32_t hex_parse_number(const char *text, int base)
 {
-    switch (item.type)
+    while (isspace((unsigned char)*text))
     {
-    case HEX_TYPE_INTEGER:
-        fprintf(stream, "$%x", item.data.int_value);
-        break;
-    case HEX_TYPE_STRING:
-        fprintf(stream, "%s", item.data.str_value);
-        break;
-    case HEX_TYPE_USER_SYMBOL:
-    case HEX_TYPE_NATIVE_SYMBOL:
-        fprintf(stream, "%s", item.token->value);
-        break;
-    case HEX_TYPE_QUOTATION:
-        fprintf(stream, "(");
-        for (size_t i = 0; i < item.quotation_size; i++)
-        {
-            if (i > 0)
-            {
-                fprintf(stream, " ");
-            }
-            hex_print_item(stream, item.data.quotation_value[i]);
-        }
-        fprintf(stream, ")");
-        break;
-
-    case HEX_TYPE_INVALID:
-        fprintf(stream, "<invalid>");
-        break;
-    default:
-        fprintf(stream, "<unknown:%d>", item.type);
-        break;
+        text++;
+    }
+    int negative = *text == '-';
+    if (*text == '-' || *text == '+')
+    {
+        text++;
     }
+    if (base == 16 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X') && hex_digit_values[(uint8_t)text[2]])
+    {
+        text += 2;
+    }
+    const char *end;
+    uint32_t value = base == 16 ? hex_parse_hex_digits(text, &end) : hex_parse_decimal_digits(text, &end);
+    return (int32_t)(negative ? 0u - value : value);
 }
 
 void hex_encode_length(uint8_t **bytecode, size_t *size, size_t length)
@@ -154,7 +205,30 @@ int hex_is_binary(const uint8_t *data, size_t size)
 {
     const double binary_threshold = 0.1; // 10% of bytes being non-printable
     size_t non_printable_count = 0;
-    for (size_t i = 0; i < size; i++)
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(31);
+    const __m128i del = _mm_set1_epi8(127);
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(data + i));
+        // Bytes with the high bit set are negative, so they fall outside of the printable range
+        __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(block, space), _mm_cmplt_epi8(block, del));
+        printable = _mm_or_si128(printable, _mm_cmpeq_epi8(block, _mm_set1_epi8(9)));
+        printable = _mm_or_si128(printable, _mm_cmpeq_epi8(block, _mm_set1_epi8(10)));
+        printable = _mm_or_si128(printable, _mm_cmpeq_epi8(block, _mm_set1_epi8(13)));
+        unsigned int mask = ~(unsigned int)_mm_movemask_epi8(printable) & 0xffff;
+        for (; mask != 0; mask &= mask - 1)
+        {
+            non_printable_count++;
+        }
+        if ((double)non_printable_count / size > binary_threshold)
+        {
+            return 1;
+        }
+    }
+#endif
+    for (; i < size; i++)
     {
         uint8_t byte = data[i];
         // Check if the byte is a printable ASCII character or a common control character.
@@ -171,145 +245,365 @@ int hex_is_binary(const uint8_t *data, size_t size)
     return 0;
 }
 
-void hex_print_string(FILE *stream, char *value)
+static int hex_is_plain(char c)
+{
+    return c >= 0x20 && c < 0x7f && c != '\\' && c != '"';
+}
+
+#if defined(HEX_AVX2_DISPATCH)
+__attribute__((target("avx2"))) static size_t hex_plain_span_avx2(const char *data, size_t size)
 {
-    fprintf(stream, "\"");
-    for (char *c = value; *c != '\0'; c++)
+    const __m256i space = _mm256_set1_epi8(0x20);
+    const __m256i del = _mm256_set1_epi8(0x7f);
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i quote = _mm256_set1_epi8('"');
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32)
     {
-        switch (*c)
+        __m256i block = _mm256_loadu_si256((const __m256i *)(data + i));
+        // Bytes with the high bit set are negative, so they compare lower than a space like control characters
+        __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpgt_epi8(space, block), _mm256_cmpeq_epi8(block, del)),
+                                          _mm256_or_si256(_mm256_cmpeq_epi8(block, backslash), _mm256_cmpeq_epi8(block, quote)));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(special);
+        if (mask != 0)
         {
-        case '\n':
-            fprintf(stream, "\\n");
-            break;
-        case '\t':
-            fprintf(stream, "\\t");
-            break;
-        case '\r':
-            fprintf(stream, "\\r");
-            break;
-        case '\b':
-            fprintf(stream, "\\b");
-            break;
-        case '\f':
-            fprintf(stream, "\\f");
-            break;
-        case '\v':
-            fprintf(stream, "\\v");
-            break;
-        case '\\':
-            fprintf(stream, "\\\\");
-            break;
-        case '\"':
-            fprintf(stream, "\\\"");
-            break;
-        default:
-            fputc(*c, stream);
-            break;
+            return i + (size_t)__builtin_ctz(mask);
         }
     }
-    fprintf(stream, "\"");
+    return i;
 }
+#endif
 
-void hex_print_item(FILE *stream, hex_item_t *item)
+// Length of the run at the start of data made of printable ASCII characters other
+// than a backslash and a double quote, which can be copied without being escaped.
+// With SSE2 16 bytes are checked at a time, and 32 with AVX2 if the CPU supports it.
+size_t hex_plain_span(const char *data, size_t size)
 {
-    switch (item->type)
+    size_t i = 0;
+#if defined(HEX_AVX2_DISPATCH)
+    static int avx2 = -1;
+    if (avx2 < 0)
     {
-    case HEX_TYPE_INTEGER:
-        fprintf(stream, "$%x", item->data.int_value);
-        break;
-
-    case HEX_TYPE_STRING:
-        hex_print_string(stream, item->data.str_value);
-        break;
-
-    case HEX_TYPE_USER_SYMBOL:
-    case HEX_TYPE_NATIVE_SYMBOL:
-        fprintf(stream, "%s", item->token->value);
-        break;
+        avx2 = __builtin_cpu_supports("avx2") != 0;
+    }
+    if (avx2)
+    {
+        i = hex_plain_span_avx2(data, size);
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i del = _mm_set1_epi8(0x7f);
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i quote = _mm_set1_epi8('"');
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *)(data + i));
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmplt_epi8(block, space), _mm_cmpeq_epi8(block, del)),
+                                       _mm_or_si128(_mm_cmpeq_epi8(block, backslash), _mm_cmpeq_epi8(block, quote)));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(special);
+        if (mask != 0)
+        {
+            return i + (size_t)__builtin_ctz(mask);
+        }
+    }
+#endif
+    while (i < size && hex_is_plain(data[i]))
+    {
+        i++;
+    }
+    return i;
+}
 
-    case HEX_TYPE_QUOTATION:
-        fprintf(stream, "(");
-        for (size_t i = 0; i < item->quotation_size; i++)
+// Find the first occurrence of needle in haystack, comparing raw bytes.
+// Candidate positions are those where both the first and the last byte of the
+// needle match; with SSE2 they are found 16 positions at a time.
+const char *hex_find(const char *haystack, size_t haystack_size, const char *needle, size_t needle_size)
+{
+    if (needle_size == 0)
+    {
+        return haystack;
+    }
+    if (needle_size > haystack_size)
+    {
+        return NULL;
+    }
+    if (needle_size == 1)
+    {
+        return memchr(haystack, needle[0], haystack_size);
+    }
+    size_t last = haystack_size - needle_size; // Last possible start of a match
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i first_byte = _mm_set1_epi8(needle[0]);
+    const __m128i last_byte = _mm_set1_epi8(needle[needle_size - 1]);
+    for (; i + 15 <= last; i += 16)
+    {
+        __m128i block_first = _mm_loadu_si128((const __m128i *)(haystack + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i *)(haystack + i + needle_size - 1));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first_byte), _mm_cmpeq_epi8(block_last, last_byte)));
+        while (mask != 0)
         {
-            if (i > 0)
+            unsigned int bit = (unsigned int)__builtin_ctz(mask);
+            if (memcmp(haystack + i + bit + 1, needle + 1, needle_size - 2) == 0)
             {
-                fprintf(stream, " ");
+                return haystack + i + bit;
             }
-            hex_print_item(stream, item->data.quotation_value[i]);
+            mask &= mask - 1;
         }
-        fprintf(stream, ")");
-        break;
+    }
+#endif
+    while (i <= last)
+    {
+        const char *candidate = memchr(haystack + i, needle[0], last - i + 1);
+        if (candidate == NULL)
+        {
+            return NULL;
+        }
+        if (memcmp(candidate + 1, needle + 1, needle_size - 1) == 0)
+        {
+            return candidate;
+        }
+        i = (size_t)(candidate - haystack) + 1;
+    }
+    return NULL;
+}
+
+// Shift an integer left by a count of bits: counts outside 0 to 31 shift all the bits out
+int32_t hex_shift_left(int32_t value, int32_t count)
+{
+    return count < 0 || count > 31 ? 0 : (int32_t)((uint32_t)value << count);
+}
+
+// Shift an integer right by a count of bits, keeping its sign: counts outside 0 to 31
+// shift all the bits out, leaving $ffffffff for negative integers and $0 otherwise
+int32_t hex_shift_right(int32_t value, int32_t count)
+{
+    return count < 0 || count > 31 ? (value < 0 ? -1 : 0) : value >> count;
+}
 
-    case HEX_TYPE_INVALID:
-        fprintf(stream, "<invalid>");
+#if defined(__SSE2__)
+// Load four elements of an operand; an operand with a zero step repeats its only element
+static inline __m128i hex_vector_load(const int32_t *values, size_t step, size_t i)
+{
+    return step ? _mm_loadu_si128((const __m128i *)(values + i)) : _mm_set1_epi32(values[0]);
+}
+
+#define HEX_VECTOR_SSE2(expr)                                    \
+    for (; i + 4 <= size; i += 4)                                \
+    {                                                            \
+        __m128i a = hex_vector_load(left, left_step, i);         \
+        __m128i b = hex_vector_load(right, right_step, i);       \
+        _mm_storeu_si128((__m128i *)(out + i), (expr));          \
+    }
+#endif
+
+#define HEX_VECTOR_LOOP(expr)                \
+    for (; i < size; i++)                    \
+    {                                        \
+        int32_t a = left[i * left_step];     \
+        int32_t b = right[i * right_step];   \
+        out[i] = (expr);                     \
+    }
+
+// Apply the integer operation of an opcode to each pair of elements of two vectors.
+// An operand with a zero step is a single integer, paired with every element of the
+// other one. Comparisons produce $1 or $0, like their scalar counterparts; with SSE2,
+// four elements are processed at a time (except for multiplications and shifts).
+// Returns 1 if the opcode is not an elementwise operation.
+int hex_vector_apply(hex_opcode_t op, int32_t *out, const int32_t *left, size_t left_step, const int32_t *right, size_t right_step, size_t size)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i one = _mm_set1_epi32(1);
+    switch (op)
+    {
+    case HEX_OP_ADD:
+        HEX_VECTOR_SSE2(_mm_add_epi32(a, b));
+        break;
+    case HEX_OP_SUBTRACT:
+        HEX_VECTOR_SSE2(_mm_sub_epi32(a, b));
+        break;
+    case HEX_OP_BITAND:
+        HEX_VECTOR_SSE2(_mm_and_si128(a, b));
+        break;
+    case HEX_OP_BITOR:
+        HEX_VECTOR_SSE2(_mm_or_si128(a, b));
+        break;
+    case HEX_OP_BITXOR:
+        HEX_VECTOR_SSE2(_mm_xor_si128(a, b));
+        break;
+    case HEX_OP_EQUAL:
+        HEX_VECTOR_SSE2(_mm_and_si128(_mm_cmpeq_epi32(a, b), one));
+        break;
+    case HEX_OP_NOTEQUAL:
+        HEX_VECTOR_SSE2(_mm_add_epi32(_mm_cmpeq_epi32(a, b), one));
+        break;
+    case HEX_OP_GREATER:
+        HEX_VECTOR_SSE2(_mm_and_si128(_mm_cmpgt_epi32(a, b), one));
+        break;
+    case HEX_OP_LESS:
+        HEX_VECTOR_SSE2(_mm_and_si128(_mm_cmplt_epi32(a, b), one));
+        break;
+    case HEX_OP_GREATEREQUAL:
+        HEX_VECTOR_SSE2(_mm_add_epi32(_mm_cmplt_epi32(a, b), one));
+        break;
+    case HEX_OP_LESSEQUAL:
+        HEX_VECTOR_SSE2(_mm_add_epi32(_mm_cmpgt_epi32(a, b), one));
         break;
     default:
-        fprintf(stream, "<unknown:%d>", item->type);
         break;
     }
+#endif
+    switch (op)
+    {
+    case HEX_OP_ADD:
+        HEX_VECTOR_LOOP((int32_t)((uint32_t)a + (uint32_t)b));
+        break;
+    case HEX_OP_SUBTRACT:
+        HEX_VECTOR_LOOP((int32_t)((uint32_t)a - (uint32_t)b));
+        break;
+    case HEX_OP_MULTIPLY:
+        HEX_VECTOR_LOOP((int32_t)((uint32_t)a * (uint32_t)b));
+        break;
+    case HEX_OP_BITAND:
+        HEX_VECTOR_LOOP(a & b);
+        break;
+    case HEX_OP_BITOR:
+        HEX_VECTOR_LOOP(a | b);
+        break;
+    case HEX_OP_BITXOR:
+        HEX_VECTOR_LOOP(a ^ b);
+        break;
+    case HEX_OP_SHL:
+        HEX_VECTOR_LOOP(hex_shift_left(a, b));
+        break;
+    case HEX_OP_SHR:
+        HEX_VECTOR_LOOP(hex_shift_right(a, b));
+        break;
+    case HEX_OP_EQUAL:
+        HEX_VECTOR_LOOP(a == b);
+        break;
+    case HEX_OP_NOTEQUAL:
+        HEX_VECTOR_LOOP(a != b);
+        break;
+    case HEX_OP_GREATER:
+        HEX_VECTOR_LOOP(a > b);
+        break;
+    case HEX_OP_LESS:
+        HEX_VECTOR_LOOP(a < b);
+        break;
+    case HEX_OP_GREATEREQUAL:
+        HEX_VECTOR_LOOP(a >= b);
+        break;
+    case HEX_OP_LESSEQUAL:
+        HEX_VECTOR_LOOP(a <= b);
+        break;
+    default:
+        return 1;
+    }
+    return 0;
+}
+
+static inline int32_t hex_vector_combine(hex_opcode_t op, int32_t result, int32_t value)
+{
+    switch (op)
+    {
+    case HEX_OP_MIN:
+        return value < result ? value : result;
+    case HEX_OP_MAX:
+        return value > result ? value : result;
+    default:
+        return (int32_t)((uint32_t)result + (uint32_t)value);
+    }
+}
+
+// Reduce a vector to the sum (HEX_OP_SUM), the minimum (HEX_OP_MIN) or the maximum
+// (HEX_OP_MAX) of its elements; the latter two require at least one element.
+int32_t hex_vector_reduce(hex_opcode_t op, const int32_t *values, size_t size)
+{
+    size_t i = 0;
+    int32_t result = op == HEX_OP_SUM ? 0 : values[0];
+#if defined(__SSE2__)
+    if (size >= 8)
+    {
+        __m128i acc = op == HEX_OP_SUM ? _mm_setzero_si128() : _mm_loadu_si128((const __m128i *)values);
+        i = op == HEX_OP_SUM ? 0 : 4;
+        for (; i + 4 <= size; i += 4)
+        {
+            __m128i block = _mm_loadu_si128((const __m128i *)(values + i));
+            if (op == HEX_OP_SUM)
+            {
+                acc = _mm_add_epi32(acc, block);
+            }
+            else
+            {
+                __m128i mask = op == HEX_OP_MIN ? _mm_cmplt_epi32(block, acc) : _mm_cmpgt_epi32(block, acc);
+                acc = _mm_or_si128(_mm_and_si128(mask, block), _mm_andnot_si128(mask, acc));
+            }
+        }
+        int32_t lanes[4];
+        _mm_storeu_si128((__m128i *)lanes, acc);
+        for (int k = 0; k < 4; k++)
+        {
+            result = hex_vector_combine(op, result, lanes[k]);
+        }
+    }
+#endif
+    for (; i < size; i++)
+    {
+        result = hex_vector_combine(op, result, values[i]);
+    }
+    return result;
 }
 
-char *hex_bytes_to_string(const uint8_t *bytes, size_t size)
+void hex_print_item(FILE *stream, hex_item_t *item)
 {
-    char *str = (char *)malloc(size * 6 + 1); // Allocate enough space for worst case (\uXXXX format)
+    hex_output_t out;
+    hex_output_init(&out, stream);
+    hex_output_item(&out, item, 0);
+    hex_output_flush(&out);
+}
+
+// Convert the contents of a text file to a string, normalizing line endings to \n
+char *hex_bytes_to_string(const uint8_t *bytes, size_t size, size_t *length)
+{
+    char *str = (char *)malloc(size + 1);
     if (!str)
     {
         return NULL; // Allocation failed
     }
 
     char *ptr = str;
-    for (size_t i = 0; i < size; i++)
+    size_t i = 0;
+    while (i < size)
     {
-        uint8_t byte = bytes[i];
-        switch (byte)
+        // Copy the run up to the next carriage return as it is
+        const uint8_t *cr = memchr(bytes + i, '\r', size - i);
+        size_t run = (cr ? (size_t)(cr - bytes) : size) - i;
+        memcpy(ptr, bytes + i, run);
+        ptr += run;
+        i += run;
+        if (!cr)
         {
-        case '\n':
-            *ptr++ = '\\';
-            *ptr++ = 'n';
-            break;
-        case '\t':
-            *ptr++ = '\\';
-            *ptr++ = 't';
-            break;
-        case '\r':
-            if (i + 1 < size && bytes[i + 1] == '\n')
-            {
-                i++; // Skip the '\n' part of the '\r\n' sequence
-            }
-            *ptr++ = '\\';
-            *ptr++ = 'n';
-            break;
-        case '\b':
-            *ptr++ = '\\';
-            *ptr++ = 'b';
-            break;
-        case '\f':
-            *ptr++ = '\\';
-            *ptr++ = 'f';
-            break;
-        case '\v':
-            *ptr++ = '\\';
-            *ptr++ = 'v';
-            break;
-        case '\\':
-            *ptr++ = '\\';
-            break;
-        case '\"':
-            *ptr++ = '\\';
-            *ptr++ = '\"';
-            break;
-        default:
-            *ptr++ = byte;
             break;
         }
+        if (i + 1 < size && bytes[i + 1] == '\n')
+        {
+            i++; // Skip the '\n' part of the '\r\n' sequence
+        }
+        *ptr++ = '\n';
+        i++;
     }
     *ptr = '\0';
+    *length = ptr - str;
     return str;
 }
 
 char *hex_process_string(const char *value)
 {
-    int len = strlen(value);
+    size_t len = strlen(value);
     char *processed_str = (char *)malloc(len + 1);
     if (!processed_str)
     {
@@ -318,46 +612,57 @@ char *hex_process_string(const char *value)
 
     char *dst = processed_str;
     const char *src = value;
-    while (*src)
+    const char *end = value + len;
+    while (src < end)
     {
-        if (*src == '\\' && *(src + 1))
+        // Copy the run up to the next backslash as it is
+        const char *backslash = memchr(src, '\\', end - src);
+        size_t run = (backslash ? backslash : end) - src;
+        memcpy(dst, src, run);
+        dst += run;
+        src += run;
+        if (!backslash || src + 1 == end)
         {
-            src++;
-            switch (*src)
-            {
-            case 'n':
-                *dst++ = '\n';
-                break;
-            case 't':
-                *dst++ = '\t';
-                break;
-            case 'r':
-                *dst++ = '\r';
-                break;
-            case 'b':
-                *dst++ = '\b';
-                break;
-            case 'f':
-                *dst++ = '\f';
-                break;
-            case 'v':
-                *dst++ = '\v';
-                break;
-            case '\"':
-                *dst++ = '\"';
-                break;
-            default:
-                *dst++ = '\\';
-                *dst++ = *src;
-                break;
-            }
+            break;
         }
-        else
+        src++;
+        switch (*src)
         {
+        case 'n':
+            *dst++ = '\n';
+            break;
+        case 't':
+            *dst++ = '\t';
+            break;
+        case 'r':
+            *dst++ = '\r';
+            break;
+        case 'b':
+            *dst++ = '\b';
+            break;
+        case 'f':
+            *dst++ = '\f';
+            break;
+        case 'v':
+            *dst++ = '\v';
+            break;
+        case '\"':
+            *dst++ = '\"';
+            break;
+        case '\\':
+            *dst++ = '\\';
+            break;
+        default:
+            *dst++ = '\\';
             *dst++ = *src;
+            break;
         }
         src++;
     }
+    if (src < end)
+    {
+        *dst++ = *src; // Trailing backslash
+    }
     *dst = '\0';
     return processed_str;
 }
@@ -390,62 +695,60 @@ char *hex_unescape_string(const char *input)
 {
     size_t len = strlen(input);
     char *unescaped = (char *)malloc(len + 1);
+    if (!unescaped)
+    {
+        return NULL;
+    }
 
     size_t j = 0;
-    for (size_t i = 0; i < len; i++)
+    size_t i = 0;
+    while (i < len)
     {
-        if (input[i] == '\\' && i + 1 < len)
+        // Copy the run up to the next backslash as it is
+        const char *backslash = memchr(input + i, '\\', len - i);
+        size_t run = (backslash ? (size_t)(backslash - input) : len) - i;
+        memcpy(unescaped + j, input + i, run);
+        j += run;
+        i += run;
+        if (!backslash)
         {
-            switch (input[i + 1])
-            {
-            case 'n':
-                unescaped[j++] = '\n';
-                i++;
-                break;
-            case 't':
-                unescaped[j++] = '\t';
-                i++;
-                break;
-            case 'r':
-                unescaped[j++] = '\r';
-                i++;
-                break;
-            case '\\':
-                unescaped[j++] = '\\';
-                i++;
-                break;
-            case '\"':
-                unescaped[j++] = '\"';
-                i++;
-                break;
-            case '\'':
-                unescaped[j++] = '\'';
-                i++;
-                break;
-            case 'v':
-                unescaped[j++] = '\v';
-                i++;
-                break;
-            case 'f':
-                unescaped[j++] = '\f';
-                i++;
-                break;
-            case 'a':
-                unescaped[j++] = '\a';
-                i++;
-                break;
-            case 'b':
-                unescaped[j++] = '\b';
-                i++;
-                break;
-            default:
-                unescaped[j++] = input[i];
-            }
+            break;
         }
-        else
+        char c = i + 1 < len ? input[i + 1] : '\0';
+        switch (c)
         {
-            unescaped[j++] = input[i];
+        case 'n':
+            c = '\n';
+            break;
+        case 't':
+            c = '\t';
+            break;
+        case 'r':
+            c = '\r';
+            break;
+        case '\\':
+        case '\"':
+        case '\'':
+            break;
+        case 'v':
+            c = '\v';
+            break;
+        case 'f':
+            c = '\f';
+            break;
+        case 'a':
+            c = '\a';
+            break;
+        case 'b':
+            c = '\b';
+            break;
+        default:
+            // Not an escape sequence: the backslash is kept
+            unescaped[j++] = input[i++];
+            continue;
         }
+        unescaped[j++] = c;
+        i += 2;
     }
     unescaped[j] = '\0'; // Null-terminate the string
     return unescaped;
@@ -509,6 +812,22 @@ void hex_destroy(hex_context_t *ctx)
         free(ctx->stack);
     }
 
+    hex_eval_cache_destroy(ctx);
+    hex_literal_pool_destroy(ctx);
+    hex_memo_destroy(ctx);
+
+    hex_flush_output(ctx);
+
+    // Close file handles left open
+    for (int i = 3; i < HEX_MAX_OPEN_FILES; i++)
+    {
+        if (ctx->files[i])
+        {
+            fclose(ctx->files[i]);
+            ctx->files[i] = NULL;
+        }
+    }
+
     // Clean up registry
     if (ctx->registry)
     {
@@ -533,21 +852,7 @@ void hex_destroy(hex_context_t *ctx)
     }
 
     // Clean up symbol table
-    if (ctx->symbol_table)
-    {
-        if (ctx->symbol_table->symbols)
-        {
-            for (int i = 0; i < ctx->symbol_table->count && i < HEX_MAX_USER_SYMBOLS; i++)
-            {
-                if (ctx->symbol_table->symbols[i])
-                {
-                    free(ctx->symbol_table->symbols[i]);
-                }
-            }
-            free(ctx->symbol_table->symbols);
-        }
-        free(ctx->symbol_table);
-    }
+    hex_symboltable_destroy(ctx->symbol_table);
 
     // Clean up docs
     if (ctx->docs)
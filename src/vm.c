@@ -58,14 +58,7 @@ int hex_bytecode_integer(hex_context_t *ctx, uint8_t **bytecode, size_t *size, s
 
 int hex_bytecode_string(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t *capacity, const char *value)
 {
-    char *str = hex_process_string(value);
-    if (!str)
-    {
-        hex_error(ctx, "[add bytecode string] Memory allocation failed");
-        return 1;
-    }
-    hex_debug(ctx, "PUSHST[02]: \"%s\"", str);
-    free(str); // only needed for debug output
+    hex_debug(ctx, "PUSHST[02]: \"%s\"", value);
     size_t len = strlen(value);
     // Check if we need to resize the buffer (size + strlen + opcode (1) + max encoded length (4))
     if (*size + len + 1 + 4 > *capacity)
@@ -316,22 +309,14 @@ int hex_interpret_bytecode_integer(hex_context_t *ctx, uint8_t **bytecode, size_
         return 1;
     }
 
-    // Decode the integer value based on the length in little-endian format
-    value = 0;
+    // Decode the integer value based on the length in little-endian format.
+    // Negative values are always encoded in 4 bytes, so no sign extension is needed.
+    uint32_t bits = 0;
     for (size_t i = 0; i < length; i++)
     {
-        value |= (*bytecode)[i] << (8 * i); // Accumulate in little-endian order
-    }
-
-    // Handle sign extension for 32-bit value
-    if (length == 4)
-    {
-        // If the value is negative, we need to sign-extend it.
-        if (value & 0x80000000)
-        {                        // If the sign bit is set (negative value)
-            value |= 0xFF000000; // Sign-extend to 32 bits
-        }
+        bits |= (uint32_t)(*bytecode)[i] << (8 * i); // Accumulate in little-endian order
     }
+    value = (int32_t)bits;
 
     *bytecode += length;
     *size -= length;
@@ -387,7 +372,7 @@ int hex_interpret_bytecode_string(hex_context_t *ctx, uint8_t **bytecode, size_t
     *bytecode += length;
     *size -= length;
 
-    hex_item_t *item = hex_string_item(ctx, value);
+    hex_item_t *item = hex_string_literal_item(ctx, value);
     free(value); // raw buffer no longer needed after string item is created
     if (!item)
     {
@@ -417,37 +402,29 @@ int hex_interpret_bytecode_native_symbol(hex_context_t *ctx, uint8_t opcode, siz
         return 1;
     }
     item->type = HEX_TYPE_NATIVE_SYMBOL;
-    hex_item_t *value = calloc(1, sizeof(hex_item_t));
-    if (!value)
-    {
-        hex_error(ctx, "[interpret bytecode native symbol] Memory allocation failed");
-        free(item);
-        return 1;
-    }
     hex_token_t *token = (hex_token_t *)malloc(sizeof(hex_token_t));
     token->value = strdup(symbol);
     token->position = (hex_file_position_t *)malloc(sizeof(hex_file_position_t));
     token->position->filename = strdup(filename);
     token->position->line = 0;
     token->position->column = position;
-    if (hex_get_symbol(ctx, token->value, value))
+    const hex_native_t *native = hex_get_native_symbol(ctx, token->value);
+    if (native)
     {
         item->token = token;
         item->type = HEX_TYPE_NATIVE_SYMBOL;
-        item->data.fn_value = value->data.fn_value;
-        hex_free_item(ctx, value); // free the registry copy (including its token)
+        item->data.native_value = native;
     }
     else
     {
         hex_error(ctx, "(%d,%d) Unable to reference native symbol: %s (bytecode)", token->position->line, token->position->column, token->value);
         hex_free_token(token);
-        free(value); // just wrapper; get_symbol did not fill it
         free(item);
         return 1;
     }
     hex_debug(ctx, ">> NATSYM[%02x]: %s", opcode, token->value);
     *result = *item;
-    free(item); // free wrapper only; token/fn_value now owned by result
+    free(item); // free wrapper only; token now owned by result
     return 0;
 }
 
@@ -486,15 +463,87 @@ int hex_interpret_bytecode_user_symbol(hex_context_t *ctx, uint8_t **bytecode, s
     token->position->line = 0;
     token->position->column = position;
 
-    hex_item_t item;
-    item.type = HEX_TYPE_USER_SYMBOL;
-    item.token = token;
+    result->type = HEX_TYPE_USER_SYMBOL;
+    result->token = token;
 
     hex_debug(ctx, ">> LOOKUP[00]: %02x -> %s", index, value);
-    *result = item;
     return 0;
 }
 
+// Quotation literals are hash-consed: a decoded literal identical to one decoded
+// before shares its items, so that it takes no more memory and is found equal to
+// it without comparing them.
+
+static int hex_literal_pool_grow(hex_literal_pool_t *pool)
+{
+    size_t capacity = pool->capacity > 0 ? pool->capacity * 2 : 64;
+    hex_item_t **slots = (hex_item_t **)calloc(capacity, sizeof(hex_item_t *));
+    if (!slots)
+    {
+        return 1;
+    }
+    for (size_t i = 0; i < pool->capacity; i++)
+    {
+        if (pool->slots[i])
+        {
+            size_t j = hex_item_hash(pool->slots[i]) & (capacity - 1);
+            while (slots[j])
+            {
+                j = (j + 1) & (capacity - 1);
+            }
+            slots[j] = pool->slots[i];
+        }
+    }
+    free(pool->slots);
+    pool->slots = slots;
+    pool->capacity = capacity;
+    return 0;
+}
+
+static void hex_intern_quotation(hex_context_t *ctx, hex_item_t *item)
+{
+    hex_literal_pool_t *pool = &ctx->literals;
+    if ((pool->count + 1) * 2 > pool->capacity && hex_literal_pool_grow(pool) != 0)
+    {
+        return;
+    }
+    size_t hash = hex_item_hash(item);
+    size_t i = hash & (pool->capacity - 1);
+    while (pool->slots[i])
+    {
+        hex_item_t *literal = pool->slots[i];
+        if (hex_item_hash(literal) == hash && hex_equal(literal, item))
+        {
+            hex_item_t *copy = hex_copy_item(ctx, literal);
+            if (copy)
+            {
+                // The items of a literal just decoded are not shared yet
+                hex_free_list(ctx, item->data.quotation_value, item->quotation_size);
+                free(item->share);
+                *item = *copy;
+                free(copy);
+            }
+            return;
+        }
+        i = (i + 1) & (pool->capacity - 1);
+    }
+    pool->slots[i] = hex_copy_item(ctx, item);
+    if (pool->slots[i])
+    {
+        pool->count++;
+    }
+}
+
+void hex_literal_pool_destroy(hex_context_t *ctx)
+{
+    for (size_t i = 0; i < ctx->literals.capacity; i++)
+    {
+        HEX_FREE(ctx, ctx->literals.slots[i]);
+    }
+    free(ctx->literals.slots);
+    memset(&ctx->literals, 0, sizeof(ctx->literals));
+}
+
 int hex_interpret_bytecode_quotation(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t position, const char *filename, hex_item_t *result)
 {
     size_t n_items = 0;
@@ -545,7 +594,7 @@ int hex_interpret_bytecode_quotation(hex_context_t *ctx, uint8_t **bytecode, siz
 
     hex_debug(ctx, ">> PUSHQT[03]: <start> (items: %zu)", n_items);
 
-    hex_item_t **items = (hex_item_t **)malloc(n_items * sizeof(hex_item_t));
+    hex_item_t **items = (hex_item_t **)calloc(n_items > 0 ? n_items : 1, sizeof(hex_item_t *));
     if (!items)
     {
         hex_error(ctx, "[interpret bytecode quotation] Memory allocation failed");
@@ -602,22 +651,25 @@ int hex_interpret_bytecode_quotation(hex_context_t *ctx, uint8_t **bytecode, siz
     result->type = HEX_TYPE_QUOTATION;
     result->data.quotation_value = items;
     result->quotation_size = n_items;
+    if (ctx->settings->hash_consing_enabled)
+    {
+        hex_intern_quotation(ctx, result);
+    }
 
     hex_debug(ctx, ">> PUSHQT[03]: <end> (items: %zu)", n_items);
     return 0;
 }
 
-int hex_interpret_bytecode(hex_context_t *ctx, uint8_t *bytecode, size_t size, const char *filename)
+// Validate the header and decode the symbol table of a bytecode image
+static int hex_decode_bytecode_header(hex_context_t *ctx, uint8_t **bytecode, size_t *size)
 {
-    size_t bytecode_size = size;
-    size_t position = bytecode_size;
     uint8_t header[8];
-    if (size < 8)
+    if (*size < 8)
     {
         hex_error(ctx, "[interpret bytecode header] Bytecode size too small to contain a header");
         return 1;
     }
-    memcpy(header, bytecode, 8);
+    memcpy(header, *bytecode, 8);
     int symbol_table_size = hex_validate_header(header);
     hex_debug(ctx, "[Hex Bytecode eXecutable File - version: %d - symbols: %d]", header[4], symbol_table_size);
     if (symbol_table_size < 0)
@@ -625,12 +677,12 @@ int hex_interpret_bytecode(hex_context_t *ctx, uint8_t *bytecode, size_t size, c
         hex_error(ctx, "[interpret bytecode header] Invalid bytecode header");
         return 1;
     }
-    bytecode += 8;
-    size -= 8;
+    *bytecode += 8;
+    *size -= 8;
     // Extract the symbol table
     if (symbol_table_size > 0)
     {
-        if (hex_decode_bytecode_symboltable(ctx, &bytecode, &size, symbol_table_size) != 0)
+        if (hex_decode_bytecode_symboltable(ctx, bytecode, size, symbol_table_size) != 0)
         {
             hex_error(ctx, "[interpret bytecode symbol table] Failed to decode the symbol table");
             return 1;
@@ -640,63 +692,116 @@ int hex_interpret_bytecode(hex_context_t *ctx, uint8_t *bytecode, size_t size, c
     hex_debug(ctx, "--- Symbol Table Start ---");
     for (size_t i = 0; i < ctx->symbol_table->count; i++)
     {
-        hex_debug(ctx, "%03d: %s", i, ctx->symbol_table->symbols[i]);
+        hex_debug(ctx, "%03d: %s", i, hex_symboltable_get_value(ctx, (uint16_t)i));
     }
     hex_debug(ctx, "---  Symbol Table End  ---");
-    while (size > 0)
+    return 0;
+}
+
+// Decode the next item of a bytecode image
+static hex_item_t *hex_decode_bytecode_item(hex_context_t *ctx, uint8_t **bytecode, size_t *size, size_t position, const char *filename)
+{
+    uint8_t opcode = **bytecode;
+    hex_debug(ctx, "-- [%08d] OPCODE: %02x", position, opcode);
+    (*bytecode)++;
+    (*size)--;
+
+    hex_item_t *item = calloc(1, sizeof(hex_item_t));
+    if (!item)
     {
-        position = bytecode_size - size;
-        uint8_t opcode = *bytecode;
-        hex_debug(ctx, "-- [%08d] OPCODE: %02x", position, opcode);
-        bytecode++;
-        size--;
+        hex_error(ctx, "[interpret bytecode] Memory allocation failed");
+        return NULL;
+    }
+    int result;
+    switch (opcode)
+    {
+    case HEX_OP_PUSHIN:
+        result = hex_interpret_bytecode_integer(ctx, bytecode, size, item);
+        break;
+    case HEX_OP_PUSHST:
+        result = hex_interpret_bytecode_string(ctx, bytecode, size, item);
+        break;
+    case HEX_OP_LOOKUP:
+        result = hex_interpret_bytecode_user_symbol(ctx, bytecode, size, position, filename, item);
+        break;
+    case HEX_OP_PUSHQT:
+        result = hex_interpret_bytecode_quotation(ctx, bytecode, size, position, filename, item);
+        break;
+    default:
+        result = hex_interpret_bytecode_native_symbol(ctx, opcode, position, filename, item);
+        break;
+    }
+    if (result != 0)
+    {
+        HEX_FREE(ctx, item);
+        return NULL;
+    }
+    return item;
+}
 
-        HEX_ALLOC(item);
-        switch (opcode)
+int hex_interpret_bytecode(hex_context_t *ctx, uint8_t *bytecode, size_t size, const char *filename)
+{
+    size_t bytecode_size = size;
+    if (hex_decode_bytecode_header(ctx, &bytecode, &size) != 0)
+    {
+        return 1;
+    }
+    while (size > 0)
+    {
+        hex_item_t *item = hex_decode_bytecode_item(ctx, &bytecode, &size, bytecode_size - size, filename);
+        if (!item)
         {
-        case HEX_OP_PUSHIN:
-            if (hex_interpret_bytecode_integer(ctx, &bytecode, &size, item) != 0)
-            {
-                HEX_FREE(ctx, item);
-                return 1;
-            }
-            break;
-        case HEX_OP_PUSHST:
-            if (hex_interpret_bytecode_string(ctx, &bytecode, &size, item) != 0)
-            {
-                HEX_FREE(ctx, item);
-                return 1;
-            }
-            break;
-        case HEX_OP_LOOKUP:
-            if (hex_interpret_bytecode_user_symbol(ctx, &bytecode, &size, position, filename, item) != 0)
-            {
-                HEX_FREE(ctx, item);
-                return 1;
-            }
-            break;
-        case HEX_OP_PUSHQT:
+            return 1;
+        }
+        if (hex_push(ctx, item) != 0)
+        {
+            HEX_FREE(ctx, item);
+            return 1;
+        }
+    }
+    return 0;
+}
 
-            if (hex_interpret_bytecode_quotation(ctx, &bytecode, &size, position, filename, item) != 0)
-            {
-                HEX_FREE(ctx, item);
-                return 1;
-            }
-            break;
-        default:
-            if (hex_interpret_bytecode_native_symbol(ctx, opcode, position, filename, item) != 0)
+// Decode a whole bytecode image without executing it
+int hex_compile_bytecode(hex_context_t *ctx, uint8_t *bytecode, size_t size, const char *filename, hex_item_t ***items, size_t *count)
+{
+    size_t bytecode_size = size;
+    if (hex_decode_bytecode_header(ctx, &bytecode, &size) != 0)
+    {
+        return 1;
+    }
+    size_t capacity = 16;
+    size_t n = 0;
+    hex_item_t **list = malloc(capacity * sizeof(hex_item_t *));
+    if (!list)
+    {
+        hex_error(ctx, "[compile bytecode] Memory allocation failed");
+        return 1;
+    }
+    while (size > 0)
+    {
+        if (n >= capacity)
+        {
+            capacity *= 2;
+            hex_item_t **tmp = realloc(list, capacity * sizeof(hex_item_t *));
+            if (!tmp)
             {
-                HEX_FREE(ctx, item);
+                hex_error(ctx, "[compile bytecode] Memory allocation failed");
+                hex_free_list(ctx, list, n);
                 return 1;
             }
-            break;
+            list = tmp;
         }
-        if (hex_push(ctx, item) != 0)
+        list[n] = hex_decode_bytecode_item(ctx, &bytecode, &size, bytecode_size - size, filename);
+        if (!list[n])
         {
-            HEX_FREE(ctx, item);
+            hex_free_list(ctx, list, n);
             return 1;
         }
+        n++;
     }
+    *items = list;
+    *count = n;
     return 0;
 }
 